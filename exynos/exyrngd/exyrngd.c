@@ -30,10 +30,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
 #include <string.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
 #include <syslog.h>
 #include <linux/random.h>
+#include <sys/ioctl.h>
 #include <sys/poll.h>
 
 #ifdef ANDROID_CHANGES
@@ -56,15 +64,78 @@ typedef unsigned char bool;
 #define RANDOM_NUMBER_BYTES 256			/* random data byte to check randomness */
 /* Buffer to hold hardware entropy bytes (this must be 2KB for FIPS testing       */
 #define MAX_BUFFER 2048				/* do not change this value       */
-static unsigned char databuf[MAX_BUFFER];	/* create buffer for FIPS testing */
-static unsigned long buffsize;			/* size of data in buffer         */
-static unsigned long curridx;			/* position of current index      */
+#define NUM_BUFFERS 2				/* reader fills one while the other is fed */
+
+/* Entropy credited per byte, also the min-entropy assumed by the health tests */
+#define DEFAULT_ENTROPY_BITS 4
+#define MAX_ENTROPY_BITS 8
+
+/* SP 800-90B 4.4 health tests, false positive probability 2^-20 */
+#define HEALTH_ALPHA_BITS 20
+#define APT_WINDOW_SIZE 512			/* adaptive proportion window for non-binary samples */
+static const unsigned int apt_cutoffs[MAX_ENTROPY_BITS + 1] = {
+	0, 311, 177, 103, 62, 39, 25, 18, 13	/* indexed by entropy bits per byte */
+};
+
+/* Back-off after read or health test failures */
+#define BACKOFF_MIN_MS 10
+#define BACKOFF_MAX_MS 10000
+
+struct rng_buffer {
+	unsigned char data[MAX_BUFFER];
+	size_t size;				/* valid bytes, 0 if the buffer is empty */
+};
+
+/* Repetition count and adaptive proportion test state, only used by the reader */
+struct health_state {
+	unsigned int rct_cutoff;
+	unsigned int rct_count;
+	unsigned char rct_last;
+	unsigned int apt_cutoff;
+	unsigned int apt_count;
+	unsigned int apt_index;
+	unsigned char apt_first;
+	bool started;				/* start-up test passed */
+};
+
+struct rng_metrics {
+	unsigned long long bytes_read;		/* from the hardware source */
+	unsigned long long bytes_fed;		/* to the output device */
+	unsigned long long entropy_credited;	/* bits */
+	unsigned long wakeups;			/* output device asked for entropy */
+	unsigned long read_failures;
+	unsigned long rct_failures;
+	unsigned long apt_failures;
+	unsigned long fips_failures;
+	unsigned long backoffs;
+	unsigned long starved;			/* feeder waited for the reader */
+};
+
+/* Shared between the reader thread and the feeding main loop */
+struct rng_state {
+	pthread_mutex_t lock;
+	pthread_cond_t filled;
+	pthread_cond_t drained;
+	struct rng_buffer buffers[NUM_BUFFERS];
+	int read_idx;				/* next buffer to feed */
+	int write_idx;				/* next buffer to fill */
+	int hw_fd;
+	struct health_state health;
+	struct rng_metrics metrics;
+};
+
+static struct rng_state rng;
+static volatile sig_atomic_t dump_metrics;
+static volatile sig_atomic_t stop_requested;
 
 /* User parameters */
 struct user_options {
 	char            input_device_name[128];
 	char            output_device_name[128];
 	bool            run_as_daemon;
+	bool            write_only;		/* write() to the output, no RNDADDENTROPY */
+	unsigned int    entropy_bits;		/* entropy credited per byte */
+	unsigned long long byte_limit;		/* exit after feeding this many bytes, 0 runs forever */
 };
 
 /* Version number of this source */
@@ -82,7 +153,11 @@ const char *program_usage =
 "  -f                 foreground - do not fork and become a daemon\n"
 "  -r <device name>   hardware random input device (default: /dev/hw_random)\n"
 "  -o <device name>   system random output device (default: /dev/random)\n"
-"  -h                 help (this page)\n";
+"  -e <bits>          entropy credited per byte, 1-8 (default: 4)\n"
+"  -w                 write data to the output device without crediting entropy\n"
+"  -n <bytes>         exit after feeding the given number of bytes\n"
+"  -h                 help (this page)\n"
+"Send SIGUSR1 to log the runtime metrics.\n";
 
 /* Logging information */
 enum log_level {
@@ -173,6 +248,28 @@ static int get_user_options(struct user_options *user_ops, int argc, char **argv
 				else
 					return -1;
 
+			case 'e':
+				if (itr < max_params) {
+					user_ops->entropy_bits = atoi(argv[itr++]);
+					if (user_ops->entropy_bits < 1 || user_ops->entropy_bits > MAX_ENTROPY_BITS)
+						return -1;
+					break;
+				}
+				else
+					return -1;
+
+			case 'w':
+				user_ops->write_only = TRUE;
+				break;
+
+			case 'n':
+				if (itr < max_params) {
+					user_ops->byte_limit = strtoull(argv[itr++], NULL, 0);
+					break;
+				}
+				else
+					return -1;
+
 			case 'h':
 				return -1;
 
@@ -188,9 +285,9 @@ static int get_user_options(struct user_options *user_ops, int argc, char **argv
 /* Only check FIPS 140-2 (Continuous Random Number Generator Test) */
 static int fips_test(const unsigned char *buf, size_t size)
 {
-	unsigned long *buff_ul = (unsigned long *) buf;
+	const uint32_t *buff_ul = (const uint32_t *) buf;
 	size_t size_ul = size >> 2;	/* convert byte to word size */
-	unsigned long last_value;
+	uint32_t last_value;
 	unsigned int rnd_ctr[256];
 	int i;
 
@@ -236,8 +333,10 @@ static int read_src(int fd, void *buf, size_t size)
 		return -1;
 	do {
 		ret = read(fd, chr + offset, size);
-		/* any read failure is bad */
-		if (ret == -1)
+		if (ret == -1 && errno == EINTR)
+			continue;
+		/* any read failure or end of file is bad */
+		if (ret <= 0)
 			return -1;
 		size -= ret;
 		offset += ret;
@@ -246,20 +345,190 @@ static int read_src(int fd, void *buf, size_t size)
 	return 0;
 }
 
+/* Set up the health test cutoffs for the assumed entropy per byte */
+static void health_init(struct health_state *health, unsigned int entropy_bits)
+{
+	memset(health, 0, sizeof(*health));
+	health->rct_cutoff = 1 + (HEALTH_ALPHA_BITS + entropy_bits - 1) / entropy_bits;
+	health->apt_cutoff = apt_cutoffs[entropy_bits];
+}
+
+/*
+ * SP 800-90B repetition count and adaptive proportion tests. Both run over
+ * the sample stream, so a run or a window may span two buffers.
+ */
+static int health_test(struct health_state *health, const unsigned char *buf, size_t size)
+{
+	size_t i;
+	int ret = 0;
+
+	for (i = 0; i < size; i++) {
+		unsigned char sample = buf[i];
+
+		/* Repetition count test */
+		if (health->rct_count > 0 && sample == health->rct_last) {
+			if (++health->rct_count >= health->rct_cutoff) {
+				rng.metrics.rct_failures++;
+				ret = -1;
+				health->rct_count = 1;
+			}
+		} else {
+			health->rct_last = sample;
+			health->rct_count = 1;
+		}
+
+		/* Adaptive proportion test */
+		if (health->apt_index == 0) {
+			health->apt_first = sample;
+			health->apt_count = 1;
+		} else if (sample == health->apt_first) {
+			if (++health->apt_count >= health->apt_cutoff) {
+				rng.metrics.apt_failures++;
+				ret = -1;
+				health->apt_index = 0;
+				continue;
+			}
+		}
+		if (++health->apt_index == APT_WINDOW_SIZE)
+			health->apt_index = 0;
+	}
+
+	return ret;
+}
+
+static void sleep_ms(unsigned int ms)
+{
+	struct timespec ts;
+
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (ms % 1000) * 1000000L;
+	while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+		;
+}
+
+/* Prefetch hardware random data into the free buffer */
+static void *reader_thread(void *arg)
+{
+	unsigned int backoff_ms = 0;
+	struct rng_buffer *buffer;
+	int ret;
+
+	(void)arg;
+
+	while (1) {
+		/* wait for a free buffer */
+		pthread_mutex_lock(&rng.lock);
+		while (rng.buffers[rng.write_idx].size != 0)
+			pthread_cond_wait(&rng.drained, &rng.lock);
+		buffer = &rng.buffers[rng.write_idx];
+		pthread_mutex_unlock(&rng.lock);
+
+		if (backoff_ms) {
+			pthread_mutex_lock(&rng.lock);
+			rng.metrics.backoffs++;
+			pthread_mutex_unlock(&rng.lock);
+			sleep_ms(backoff_ms);
+		}
+
+		/* fill buffer with random data from hardware, it is owned by the reader until it is published */
+		ret = read_src(rng.hw_fd, buffer->data, MAX_BUFFER);
+		if (ret < 0) {
+			pthread_mutex_lock(&rng.lock);
+			rng.metrics.read_failures++;
+			pthread_mutex_unlock(&rng.lock);
+			log_print(ERROR, "ERROR: Can't read from hardware source.");
+			goto fail;
+		}
+
+		/* run health and FIPS tests on buffer, if buffer fails then ditch it and get new data */
+		pthread_mutex_lock(&rng.lock);
+		rng.metrics.bytes_read += MAX_BUFFER;
+		ret = health_test(&rng.health, buffer->data, MAX_BUFFER);
+		pthread_mutex_unlock(&rng.lock);
+		if (ret < 0) {
+			log_print(ERROR, "ERROR: Failed health test.");
+			rng.health.started = FALSE;
+			goto fail;
+		}
+		ret = fips_test(buffer->data, MAX_BUFFER);
+		if (ret < 0) {
+			pthread_mutex_lock(&rng.lock);
+			rng.metrics.fips_failures++;
+			pthread_mutex_unlock(&rng.lock);
+			log_print(INFO, "ERROR: Failed FIPS test.");
+			goto fail;
+		}
+
+		/* the first buffer after start-up or a failure only serves as start-up test */
+		if (!rng.health.started) {
+			rng.health.started = TRUE;
+			continue;
+		}
+
+		/* everything good, hand the full buffer to the feeder */
+		backoff_ms = 0;
+		pthread_mutex_lock(&rng.lock);
+		buffer->size = MAX_BUFFER;
+		rng.write_idx = (rng.write_idx + 1) % NUM_BUFFERS;
+		pthread_cond_signal(&rng.filled);
+		pthread_mutex_unlock(&rng.lock);
+		continue;
+
+fail:
+		/* a broken or stuck source must not turn into a busy loop */
+		if (backoff_ms == 0)
+			backoff_ms = BACKOFF_MIN_MS;
+		else
+			backoff_ms = min(backoff_ms * 2, BACKOFF_MAX_MS);
+	}
+
+	return NULL;
+}
+
+static void print_metrics(void)
+{
+	struct rng_metrics metrics;
+
+	pthread_mutex_lock(&rng.lock);
+	metrics = rng.metrics;
+	pthread_mutex_unlock(&rng.lock);
+
+	log_print(INFO, "read %llu bytes, fed %llu bytes, credited %llu bits, %lu wakeups, %lu starved",
+		  metrics.bytes_read, metrics.bytes_fed, metrics.entropy_credited,
+		  metrics.wakeups, metrics.starved);
+	log_print(INFO, "failures: read %lu, repetition count %lu, adaptive proportion %lu, fips %lu, back-offs %lu",
+		  metrics.read_failures, metrics.rct_failures, metrics.apt_failures,
+		  metrics.fips_failures, metrics.backoffs);
+}
+
+static void signal_handler(int signum)
+{
+	if (signum == SIGUSR1)
+		dump_metrics = 1;
+	else
+		stop_requested = 1;
+}
+
 /* The beginning of everything */
 int main(int argc, char **argv)
 {
 	struct user_options user_ops;		/* holds user configuration data     */
 	struct rand_pool_info *rand = NULL;	/* structure to pass entropy (IOCTL) */
-	int random_fd = 0;			/* output file descriptor            */
-	int random_hw_fd = 0;			/* input file descriptor             */
+	int random_fd = -1;			/* output file descriptor            */
+	int random_hw_fd = -1;			/* input file descriptor             */
 	int write_size;				/* max entropy data to pass          */
 	struct pollfd fds[1];			/* used for polling file descriptor  */
+	struct rng_buffer *buffer;
+	size_t curridx = 0;			/* position in the buffer being fed  */
+	struct sigaction sa;
+	pthread_t reader;
 	int ret;
 	int exitval = 0;
 
 	/* set default parameters */
+	memset(&user_ops, 0, sizeof(user_ops));
 	user_ops.run_as_daemon = TRUE;
+	user_ops.entropy_bits = DEFAULT_ENTROPY_BITS;
 	strncpy(user_ops.input_device_name, RANDOM_DEVICE_HW, strlen(RANDOM_DEVICE_HW) + 1);
 	strncpy(user_ops.output_device_name, RANDOM_DEVICE, strlen(RANDOM_DEVICE) + 1);
 
@@ -316,66 +585,113 @@ int main(int argc, char **argv)
 #endif
 	}
 
+	/* metrics on SIGUSR1, clean exit on SIGTERM/SIGINT */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = signal_handler;
+	sigaction(SIGUSR1, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sigaction(SIGINT, &sa, NULL);
+
+	/* start prefetching from the hardware source */
+	pthread_mutex_init(&rng.lock, NULL);
+	pthread_cond_init(&rng.filled, NULL);
+	pthread_cond_init(&rng.drained, NULL);
+	rng.hw_fd = random_hw_fd;
+	health_init(&rng.health, user_ops.entropy_bits);
+	if (pthread_create(&reader, NULL, reader_thread, NULL) != 0) {
+		log_print(ERROR, "ERROR: Can't create reader thread.");
+		exitval = 1;
+		goto exit;
+	}
+
 	/* log message */
-	log_print(INFO, APP_NAME " has started:\n" "Reading device:'%s' updating entropy for device:'%s'",
+	log_print(INFO, APP_NAME " has started:\n" "Reading device:'%s' updating entropy for device:'%s' crediting %u bits per byte",
 		  user_ops.input_device_name,
-		  user_ops.output_device_name);
+		  user_ops.output_device_name,
+		  user_ops.entropy_bits);
+
+	/* main loop to feed RNG entropy pool from the prefetched buffers */
+	while (!stop_requested) {
+		if (dump_metrics) {
+			dump_metrics = 0;
+			print_metrics();
+		}
 
-	/* main loop to get data from hardware and feed RNG entropy pool */
-	while (1) {
-		/* Check for empty buffer and fill with hardware random generated numbers */
-		if (buffsize == 0) {
-			/* fill buffer with random data from hardware */
-			ret = read_src(random_hw_fd, databuf, MAX_BUFFER);
-			if (ret < 0) {
-				log_print(ERROR, "ERROR: Can't read from hardware source.");
-				continue;
+		/* take the next full buffer, the reader is already refilling the other one */
+		pthread_mutex_lock(&rng.lock);
+		buffer = &rng.buffers[rng.read_idx];
+		if (buffer->size == 0) {
+			rng.metrics.starved++;
+			while (buffer->size == 0 && !stop_requested && !dump_metrics) {
+				/* wake up once in a while to serve signals */
+				struct timespec ts;
+				clock_gettime(CLOCK_REALTIME, &ts);
+				ts.tv_sec += 1;
+				pthread_cond_timedwait(&rng.filled, &rng.lock, &ts);
 			}
+		}
+		pthread_mutex_unlock(&rng.lock);
+		if (buffer->size == 0)
+			continue;
 
-			/* run FIPS test on buffer, if buffer fails then ditch it and get new data */
-			ret = fips_test(databuf, MAX_BUFFER);
-			if (ret < 0) {
-				buffsize = 0;
-				log_print(INFO, "ERROR: Failed FIPS test.");
+		/* fill entropy pool */
+		write_size = min(buffer->size, MAX_ENT_POOL_WRITES);
+
+		if (user_ops.write_only) {
+			/* Write the data without crediting entropy */
+			if (write(random_fd, &buffer->data[curridx], write_size) != write_size) {
+				log_print(ERROR, "ERROR: write() to output device failed.");
+				exitval = 1;
+				goto exit;
 			}
-			/* everything good, reset buffer variables to indicate full buffer */
-			else {
-				buffsize = MAX_BUFFER;
-				curridx  = 0;
+		} else {
+			/* Write some data to the device */
+			rand->entropy_count = write_size * user_ops.entropy_bits;
+			rand->buf_size      = write_size;
+			memcpy(rand->buf, &buffer->data[curridx], write_size);
+
+			/* Issue the ioctl to increase the entropy count */
+			if (ioctl(random_fd, RNDADDENTROPY, rand) < 0) {
+				log_print(ERROR,"ERROR: RNDADDENTROPY ioctl() failed.");
+				exitval = 1;
+				goto exit;
 			}
 		}
-		/* We should have data here, if not then something bad happened above and we should wait and try again */
-		if (buffsize == 0) {
-			log_print(ERROR, "ERROR: Timeout getting valid random data from hardware.");
-			continue;
-		}
 
-		/* fill entropy pool */
-		write_size = min(buffsize, MAX_ENT_POOL_WRITES);
-
-		/* Write some data to the device */
-		rand->entropy_count = write_size * 8;
-		rand->buf_size      = write_size;
-		memcpy(rand->buf, &databuf[curridx], write_size);
-		curridx  += write_size;
-		buffsize -= write_size;
-
-		/* Issue the ioctl to increase the entropy count */
-		if (ioctl(random_fd, RNDADDENTROPY, rand) < 0) {
-			log_print(ERROR,"ERROR: RNDADDENTROPY ioctl() failed.");
-			exitval = 1;
-			goto exit;
+		pthread_mutex_lock(&rng.lock);
+		rng.metrics.bytes_fed += write_size;
+		if (!user_ops.write_only)
+			rng.metrics.entropy_credited += write_size * user_ops.entropy_bits;
+		curridx += write_size;
+		buffer->size -= write_size;
+		if (buffer->size == 0) {
+			/* give the drained buffer back to the reader */
+			curridx = 0;
+			rng.read_idx = (rng.read_idx + 1) % NUM_BUFFERS;
+			pthread_cond_signal(&rng.drained);
 		}
+		pthread_mutex_unlock(&rng.lock);
+
+		if (user_ops.byte_limit && rng.metrics.bytes_fed >= user_ops.byte_limit)
+			break;
 
 		/* Wait if entropy pool is full */
 		ret = poll(fds, 1, -1);
 		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
 			log_print(ERROR,"ERROR: poll call failed.");
 			exitval = 1;
 			goto exit;
 		}
+		pthread_mutex_lock(&rng.lock);
+		rng.metrics.wakeups++;
+		pthread_mutex_unlock(&rng.lock);
 	}
 
+	/* the reader may block in read() on the source, it ends with the process */
+	print_metrics();
+
 exit:
 	/* free other resources */
 	if (rand)
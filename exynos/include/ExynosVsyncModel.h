@@ -0,0 +1,119 @@
+#ifndef EXYNOS_VSYNC_MODEL_H
+#define EXYNOS_VSYNC_MODEL_H
+
+#include <stdint.h>
+#include <string.h>
+#include <cutils/atomic.h>
+#include <utils/Timers.h>
+
+/*
+ * Filtered primary vsync, shared by the vsync thread of libhwc and its
+ * readers. Kept free of the HWC device so the filter can be tested on the
+ * host.
+ */
+
+#define VSYNC_PERIOD_FILTER     16
+#define VSYNC_PHASE_FILTER      4
+#define VSYNC_RESYNC_PERIODS    8
+/* idle invalidate is sent this long before the predicted vsync */
+#define VSYNC_INVALIDATE_LEAD   2000000
+
+/*
+ * Only the vsync thread writes the model; readers on any thread copy it out
+ * with exynos5_vsync_snapshot(), which retries instead of blocking when it
+ * races with an update. phase is the filtered time of the last vsync, period
+ * the filtered interval. The error fields compare each timestamp against its
+ * prediction, delivery is timestamp to the return of the vsync callback.
+ */
+struct exynos5_vsync_model_t {
+    volatile int32_t    seq;
+    nsecs_t             nominal;
+    nsecs_t             period;
+    nsecs_t             phase;
+    uint64_t            samples;
+    uint64_t            missed;
+    uint64_t            resyncs;
+    nsecs_t             sum_abs_error;
+    nsecs_t             max_abs_error;
+    nsecs_t             sum_delivery;
+    nsecs_t             max_delivery;
+};
+
+/*
+ * Folds one vsync timestamp into the model. Vsyncs that were not reported
+ * (missed interrupts, or vsync turned off by SurfaceFlinger for a while) are
+ * bridged by counting whole periods; a gap longer than VSYNC_RESYNC_PERIODS
+ * restarts the phase from the new timestamp.
+ */
+static inline void exynos5_vsync_update(struct exynos5_vsync_model_t *model,
+        nsecs_t timestamp, nsecs_t delivery)
+{
+    nsecs_t period = model->period;
+    nsecs_t phase = model->phase;
+    nsecs_t error = 0;
+    int64_t n = 0;
+
+    if (phase && timestamp > phase)
+        n = (timestamp - phase + period / 2) / period;
+
+    if (n < 1 || n > VSYNC_RESYNC_PERIODS) {
+        if (phase)
+            model->resyncs++;
+        phase = timestamp;
+    } else {
+        error = timestamp - (phase + n * period);
+        phase += n * period + error / VSYNC_PHASE_FILTER;
+        period += error / n / VSYNC_PERIOD_FILTER;
+        if (period < model->nominal / 2 || period > model->nominal * 2)
+            period = model->nominal;
+    }
+
+    android_atomic_release_store(model->seq + 1, &model->seq);
+    android_memory_barrier();
+
+    model->period = period;
+    model->phase = phase;
+    if (n >= 1 && n <= VSYNC_RESYNC_PERIODS) {
+        nsecs_t abs_error = error < 0 ? -error : error;
+        model->samples++;
+        model->missed += n - 1;
+        model->sum_abs_error += abs_error;
+        if (abs_error > model->max_abs_error)
+            model->max_abs_error = abs_error;
+    }
+    model->sum_delivery += delivery;
+    if (delivery > model->max_delivery)
+        model->max_delivery = delivery;
+
+    android_atomic_release_store(model->seq + 1, &model->seq);
+}
+
+static inline void exynos5_vsync_snapshot(const struct exynos5_vsync_model_t *model,
+        struct exynos5_vsync_model_t *out)
+{
+    while (true) {
+        int32_t seq = android_atomic_acquire_load(&model->seq);
+        if (seq & 1)
+            continue;
+        memcpy(out, (const void *)model, sizeof(*out));
+        android_memory_barrier();
+        if (seq == model->seq)
+            return;
+    }
+}
+
+/* first vsync expected after now, 0 until a vsync has been seen */
+static inline nsecs_t exynos5_vsync_predict(const struct exynos5_vsync_model_t *model,
+        nsecs_t now)
+{
+    struct exynos5_vsync_model_t snap;
+
+    exynos5_vsync_snapshot(model, &snap);
+    if (!snap.phase || snap.period <= 0)
+        return 0;
+    if (now < snap.phase)
+        return snap.phase;
+    return snap.phase + ((now - snap.phase) / snap.period + 1) * snap.period;
+}
+
+#endif
@@ -569,9 +569,10 @@ void ExynosCameraActivityControl::stopPreFlash(void)
 
 int ExynosCameraActivityControl::startMainFlash(void)
 {
-    int totalWaitingTime = 0;
+    unsigned int totalWaitingTime = 0;
     int waitCount = 0;
     unsigned int shotFcount = 0;
+    unsigned int stateSeq = 0;
     enum ExynosCameraActivityFlash::FLASH_TRIGGER triggerPath;
 
     m_flashMgr->getFlashTrigerPath(&triggerPath);
@@ -589,15 +590,14 @@ int ExynosCameraActivityControl::startMainFlash(void)
 
     /* get best shot frame count */
     m_flashMgr->resetShotFcount();
+    stateSeq = m_flashMgr->getStateSeq();
     do {
         waitCount = m_flashMgr->getWaitingCount();
-        if (0 < waitCount) {
-            usleep(FLASH_WAITING_SLEEP_TIME);
-            totalWaitingTime += FLASH_WAITING_SLEEP_TIME;
-        }
-    } while (0 < waitCount && totalWaitingTime <= FLASH_MAX_WAITING_TIME);
+        if (0 < waitCount)
+            totalWaitingTime += m_flashMgr->waitStateChange(&stateSeq, FLASH_MAX_WAITING_TIME - totalWaitingTime);
+    } while (0 < waitCount && totalWaitingTime < FLASH_MAX_WAITING_TIME);
 
-    if (0 < waitCount || FLASH_MAX_WAITING_TIME < totalWaitingTime)
+    if (0 < waitCount || FLASH_MAX_WAITING_TIME <= totalWaitingTime)
         ALOGE("ERR(%s):waiting too much (%d msec)", __FUNCTION__, totalWaitingTime);
 
     shotFcount = m_flashMgr->getShotFcount();
@@ -632,16 +632,15 @@ void ExynosCameraActivityControl::setHdrMode(bool hdrMode)
 int ExynosCameraActivityControl::getHdrFcount(int index)
 {
     int startFcount = 0;
-    int totalWaitingTime = 0;
+    unsigned int totalWaitingTime = 0;
     unsigned int shotFcount = 0;
+    unsigned int stateSeq = m_specialCaptureMgr->getStateSeq();
 
     do {
         startFcount = m_specialCaptureMgr->getHdrStartFcount(index);
-        if (startFcount == 0) {
-            usleep(HDR_WAITING_SLEEP_TIME);
-            totalWaitingTime += HDR_WAITING_SLEEP_TIME;
-        }
-    } while (startFcount == 0 && totalWaitingTime <= HDR_MAX_WAITING_TIME);
+        if (startFcount == 0)
+            totalWaitingTime += m_specialCaptureMgr->waitStateChange(&stateSeq, HDR_MAX_WAITING_TIME - totalWaitingTime);
+    } while (startFcount == 0 && totalWaitingTime < HDR_MAX_WAITING_TIME);
 
     if (startFcount == 0 || totalWaitingTime >= HDR_MAX_WAITING_TIME)
         ALOGE("ERR(%s):waiting too much (%d msec)", __FUNCTION__, totalWaitingTime);
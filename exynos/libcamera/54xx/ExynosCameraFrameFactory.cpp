@@ -260,18 +260,18 @@ status_t ExynosCameraFrameFactory::destroy(void)
         }
     }
 
+    /* frames still alive here are leaked or waiting in a selector */
+    ExynosCameraFrame::dumpPool();
+
     return NO_ERROR;
 }
 
 status_t ExynosCameraFrameFactory::m_initFrameMetadata(ExynosCameraFrame *frame)
 {
     int ret = 0;
-    struct camera2_shot_ext *shot_ext = new struct camera2_shot_ext;
-
-    if (shot_ext == NULL) {
-        ALOGE("ERR(%s[%d]): new struct camera2_shot_ext fail", __FUNCTION__, __LINE__);
-        return INVALID_OPERATION;
-    }
+    /* on the stack, this runs once per frame */
+    struct camera2_shot_ext shot;
+    struct camera2_shot_ext *shot_ext = &shot;
 
     memset(shot_ext, 0x0, sizeof(struct camera2_shot_ext));
 
@@ -300,9 +300,6 @@ status_t ExynosCameraFrameFactory::m_initFrameMetadata(ExynosCameraFrame *frame)
                        m_requestDIS,
                        m_requestSCP);
 
-    delete shot_ext;
-    shot_ext = NULL;
-
     return ret;
 }
 
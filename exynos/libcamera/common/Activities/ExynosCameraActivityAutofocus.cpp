@@ -26,7 +26,6 @@ namespace android {
 #define AUTOFOCUS_WAIT_COUNT_STEP_REQUEST    (3)
 
 #define AUTOFOCUS_WAIT_COUNT_FRAME_COUNT_NUM (3)       /* n + x frame count */
-#define AUTOFOCUS_WATING_TIME_LOCK_AF        (10000)   /* 10msec */
 #define AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF  (300000)  /* 300msec */
 #define AUTOFOCUS_SKIP_FRAME_LOCK_AF         (6)       /* == NUM_BAYER_BUFFERS */
 
@@ -355,6 +354,8 @@ bool ExynosCameraActivityAutofocus::startAutofocus(void)
     m_autofocusStep = AUTOFOCUS_STEP_REQUEST;
     m_flagAutofocusStart = true;
 
+    t_notifyStateChange();
+
     return true;
 }
 
@@ -365,6 +366,8 @@ bool ExynosCameraActivityAutofocus::stopAutofocus(void)
     m_autofocusStep = AUTOFOCUS_STEP_STOP;
     m_flagAutofocusStart = false;
 
+    t_notifyStateChange();
+
     return true;
 }
 
@@ -394,8 +397,9 @@ bool ExynosCameraActivityAutofocus::lockAutofocus()
         unsigned int i = 0;
         bool flagScanningDetected = false;
         int  scanningDetectedFrameCount = 0;
+        unsigned int stateSeq = this->getStateSeq();
 
-        for (i = 0; i < AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF; i += AUTOFOCUS_WATING_TIME_LOCK_AF) {
+        while (i < AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF) {
             if (lockFrameCount + AUTOFOCUS_WAIT_COUNT_FRAME_COUNT_NUM <= m_frameCount) {
                 ALOGD("DEBUG(%s):find lockFrameCount(%d) + %d, m_frameCount(%d), m_aaAfState(%d)",
                     __FUNCTION__, lockFrameCount, AUTOFOCUS_WAIT_COUNT_FRAME_COUNT_NUM, m_frameCount, m_aaAfState);
@@ -410,7 +414,7 @@ bool ExynosCameraActivityAutofocus::lockAutofocus()
                 }
             }
 
-            usleep(AUTOFOCUS_WATING_TIME_LOCK_AF);
+            i += this->waitStateChange(&stateSeq, AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF - i);
         }
 
         if (AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF <= i) {
@@ -418,14 +422,17 @@ bool ExynosCameraActivityAutofocus::lockAutofocus()
         } else {
             /* skip bayer frame when scanning detected */
             if (flagScanningDetected == true) {
-                for (i = 0; i < AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF; i += AUTOFOCUS_WATING_TIME_LOCK_AF) {
+                i = 0;
+                stateSeq = this->getStateSeq();
+
+                while (i < AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF) {
                     if (scanningDetectedFrameCount + AUTOFOCUS_SKIP_FRAME_LOCK_AF <= m_frameCount) {
                         ALOGD("DEBUG(%s):kcoolsw find scanningDetectedFrameCount(%d) + %d, m_frameCount(%d), m_aaAfState(%d)",
                             __FUNCTION__, scanningDetectedFrameCount, AUTOFOCUS_SKIP_FRAME_LOCK_AF, m_frameCount, m_aaAfState);
                         break;
                     }
 
-                    usleep(AUTOFOCUS_WATING_TIME_LOCK_AF);
+                    i += this->waitStateChange(&stateSeq, AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF - i);
                 }
 
                 if (AUTOFOCUS_TOTAL_WATING_TIME_LOCK_AF <= i)
@@ -467,8 +474,9 @@ bool ExynosCameraActivityAutofocus::getAutofocusResult(void)
     bool flagScanningStarted = false;
 
     unsigned int i = 0;
+    unsigned int stateSeq = this->getStateSeq();
 
-    for (i = 0; i < AUTOFOCUS_TOTAL_WATING_TIME; i += AUTOFOCUS_WATING_TIME) {
+    while (i < AUTOFOCUS_TOTAL_WATING_TIME) {
         currentState = this->getCurrentState();
 
         /* If stopAutofocus() called */
@@ -539,7 +547,7 @@ bool ExynosCameraActivityAutofocus::getAutofocusResult(void)
         if (af_over == true)
             break;
 
-        usleep(AUTOFOCUS_WATING_TIME);
+        i += this->waitStateChange(&stateSeq, AUTOFOCUS_TOTAL_WATING_TIME - i);
     }
 
     if (AUTOFOCUS_TOTAL_WATING_TIME <= i)
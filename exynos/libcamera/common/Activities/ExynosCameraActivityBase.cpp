@@ -29,6 +29,7 @@ ExynosCameraActivityBase::ExynosCameraActivityBase()
     t_reqNum = 0;
     t_reqStatus = 0;
     pFunc = NULL;
+    m_stateSeq = 0;
 }
 
 ExynosCameraActivityBase::~ExynosCameraActivityBase()
@@ -72,7 +73,46 @@ int ExynosCameraActivityBase::execFunction(CALLBACK_TYPE callbackType, void *arg
         break;
     }
 
-    return (this->*pFunc)(args);
+    int ret = (this->*pFunc)(args);
+
+    /* every callback may move AF, flash or AE state on */
+    t_notifyStateChange();
+
+    return ret;
+}
+
+unsigned int ExynosCameraActivityBase::getStateSeq(void)
+{
+    Mutex::Autolock lock(m_stateLock);
+
+    return m_stateSeq;
+}
+
+unsigned int ExynosCameraActivityBase::waitStateChange(unsigned int *seq, unsigned int timeoutUs)
+{
+    nsecs_t startTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    nsecs_t timeout = (nsecs_t)timeoutUs * 1000LL;
+    nsecs_t elapsed = 0;
+
+    m_stateLock.lock();
+    while (*seq == m_stateSeq && elapsed < timeout) {
+        m_stateCondition.waitRelative(m_stateLock, timeout - elapsed);
+        elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+    }
+    *seq = m_stateSeq;
+    m_stateLock.unlock();
+
+    elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - startTime;
+
+    return (unsigned int)(elapsed / 1000LL);
+}
+
+void ExynosCameraActivityBase::t_notifyStateChange(void)
+{
+    m_stateLock.lock();
+    m_stateSeq++;
+    m_stateCondition.broadcast();
+    m_stateLock.unlock();
 }
 
 } /* namespace android */
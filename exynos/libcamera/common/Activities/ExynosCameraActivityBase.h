@@ -84,6 +84,18 @@ public:
 
     int execFunction(CALLBACK_TYPE callbackType, void *args);
 
+    /*
+     * State waits: take a sequence with getStateSeq() before checking the
+     * condition, then waitStateChange() blocks until a callback (or a setter
+     * calling t_notifyStateChange()) moves the sequence on, or timeoutUs
+     * passes. Returns the time spent waiting in usec.
+     */
+    unsigned int getStateSeq(void);
+    unsigned int waitStateChange(unsigned int *seq, unsigned int timeoutUs);
+
+protected:
+    void t_notifyStateChange(void);
+
 protected:
     virtual int t_funcNull(void *args) = 0;
     virtual int t_funcSensorBefore(void *args) = 0;
@@ -103,6 +115,11 @@ protected:
     bool t_isActivated;
     int  t_reqNum;
     int  t_reqStatus;
+
+private:
+    Mutex        m_stateLock;
+    Condition    m_stateCondition;
+    unsigned int m_stateSeq;
 };
 }
 
@@ -851,6 +851,8 @@ bool ExynosCameraActivityFlash::setFlashStep(enum FLASH_STEP flashStepVal)
     if (flashStepVal != FLASH_STEP_OFF)
         m_flashStepErrorCount = 0;
 
+    t_notifyStateChange();
+
     return true;
 }
 
@@ -891,9 +893,10 @@ bool ExynosCameraActivityFlash::waitAeDone(void)
 
     int status = 0;
     unsigned int totalWaitingTime = 0;
+    unsigned int stateSeq = this->getStateSeq();
 
     while (status == 0 &&
-        totalWaitingTime <= FLASH_MAX_AEDONE_WAITING_TIME &&
+        totalWaitingTime < FLASH_MAX_AEDONE_WAITING_TIME &&
         m_checkFlashWaitCancel == false) {
         if (m_flashStatus == FLASH_STATUS_PRE_ON || m_flashStep == FLASH_STEP_PRE_START) {
             if ((m_aeWaitMaxCount <= 0) || (m_flashStatus == FLASH_STATUS_PRE_AE_DONE)) {
@@ -908,11 +911,10 @@ bool ExynosCameraActivityFlash::waitAeDone(void)
             break;
         }
 
-        usleep(FLASH_WAITING_SLEEP_TIME);
-        totalWaitingTime += FLASH_WAITING_SLEEP_TIME;
+        totalWaitingTime += this->waitStateChange(&stateSeq, FLASH_MAX_AEDONE_WAITING_TIME - totalWaitingTime);
     }
 
-    if (status == 0 || FLASH_MAX_AEDONE_WAITING_TIME < totalWaitingTime) {
+    if (status == 0 || FLASH_MAX_AEDONE_WAITING_TIME <= totalWaitingTime) {
         ALOGW("DEBUG(%s):waiting too much (%d msec)", __FUNCTION__, totalWaitingTime);
         ret = false;
     }
@@ -924,19 +926,19 @@ bool ExynosCameraActivityFlash::waitMainReady(void)
 {
     bool ret = true;
     unsigned int totalWaitingTime = 0;
+    unsigned int stateSeq = this->getStateSeq();
 
     ALOGV("DEBUG(%s[%d]):", __FUNCTION__, __LINE__);
 
     while (m_flashStatus < FLASH_STATUS_MAIN_READY &&
-        totalWaitingTime <= FLASH_MAX_PRE_DONE_WAITING_TIME &&
+        totalWaitingTime < FLASH_MAX_PRE_DONE_WAITING_TIME &&
         m_checkFlashWaitCancel == false) {
         ALOGV("DEBUG(%s[%d]):(%d)(%d)(%d)", __FUNCTION__, __LINE__, m_flashStatus, totalWaitingTime, m_checkFlashWaitCancel);
 
-        usleep(FLASH_WAITING_SLEEP_TIME);
-        totalWaitingTime += FLASH_WAITING_SLEEP_TIME;
+        totalWaitingTime += this->waitStateChange(&stateSeq, FLASH_MAX_PRE_DONE_WAITING_TIME - totalWaitingTime);
     }
 
-    if (m_flashStatus < FLASH_STATUS_MAIN_READY && FLASH_MAX_PRE_DONE_WAITING_TIME < totalWaitingTime) {
+    if (m_flashStatus < FLASH_STATUS_MAIN_READY && FLASH_MAX_PRE_DONE_WAITING_TIME <= totalWaitingTime) {
         ALOGW("DEBUG(%s)::waiting too much (%d msec)", __FUNCTION__, totalWaitingTime);
         m_flashStatus = FLASH_STATUS_MAIN_READY;
         ret = false;
@@ -1042,6 +1044,8 @@ bool ExynosCameraActivityFlash::updateAeState()
 void ExynosCameraActivityFlash::setFlashWaitCancel(bool cancel)
 {
     m_checkFlashWaitCancel = cancel;
+
+    t_notifyStateChange();
 }
 
 bool ExynosCameraActivityFlash::getFlashWaitCancel(void)
@@ -20,9 +20,24 @@
 #include <cutils/log.h>
 
 #include "ExynosCameraFrame.h"
+#include "ExynosCameraFramePool.h"
 
 namespace android {
 
+static ExynosCameraFramePool<ExynosCameraFrame> *m_getFramePool(void)
+{
+    static ExynosCameraFramePool<ExynosCameraFrame> framePool("frame", FRAME_POOL_FRAME_SLOT_NUM);
+
+    return &framePool;
+}
+
+static ExynosCameraFramePool<ExynosCameraFrameEntity> *m_getEntityPool(void)
+{
+    static ExynosCameraFramePool<ExynosCameraFrameEntity> entityPool("entity", FRAME_POOL_ENTITY_SLOT_NUM);
+
+    return &entityPool;
+}
+
 ExynosCameraFrame::ExynosCameraFrame(
         ExynosCameraParameters *obj_param,
         uint32_t frameCount)
@@ -47,12 +62,32 @@ ExynosCameraFrame::ExynosCameraFrame(
         memset(&m_node_gorup[i], 0x0, sizeof(struct camera2_node_group));
 }
 
+void *ExynosCameraFrame::operator new(size_t size) throw()
+{
+    return m_getFramePool()->alloc(size);
+}
+
+void ExynosCameraFrame::operator delete(void *ptr)
+{
+    m_getFramePool()->release(ptr);
+}
+
+void ExynosCameraFrame::dumpPool(void)
+{
+    m_getFramePool()->dump();
+    m_getEntityPool()->dump();
+}
+
 ExynosCameraFrame::~ExynosCameraFrame()
 {
     List<ExynosCameraFrameEntity *>::iterator r;
     ExynosCameraFrameEntity *curEntity = NULL;
     ExynosCameraFrameEntity *tmpEntity = NULL;
 
+    /* a second delete would free the entities and the list again */
+    if (m_getFramePool()->isLive(this) == false)
+        android_printAssert(NULL, LOG_TAG, "ASSERT(%s):frame %p deleted twice", __FUNCTION__, this);
+
     while (!m_linkageList.empty()) {
         r = m_linkageList.begin()++;
         if (*r) {
@@ -938,6 +973,16 @@ bool ExynosCameraFrame::getRequest(uint32_t pipeId)
  * ExynosCameraFrameEntity class
  */
 
+void *ExynosCameraFrameEntity::operator new(size_t size) throw()
+{
+    return m_getEntityPool()->alloc(size);
+}
+
+void ExynosCameraFrameEntity::operator delete(void *ptr)
+{
+    m_getEntityPool()->release(ptr);
+}
+
 ExynosCameraFrameEntity::ExynosCameraFrameEntity(
         uint32_t pipeId,
         entity_type_t type,
@@ -26,6 +26,10 @@
 
 namespace android {
 
+/* slots added to the frame / entity pool each time it runs dry */
+#define FRAME_POOL_FRAME_SLOT_NUM   (16)
+#define FRAME_POOL_ENTITY_SLOT_NUM  (64)
+
 typedef enum entity_type {
     ENTITY_TYPE_INPUT_ONLY              = 0, /* Need input buffer only */
     ENTITY_TYPE_OUTPUT_ONLY             = 1, /* Need output buffer only */
@@ -64,6 +68,11 @@ public:
         uint32_t pipeId,
         entity_type_t type,
         entity_buffer_type_t bufType);
+
+    /* storage comes from a recycling pool, see ExynosCameraFramePool.h */
+    static void *operator new(size_t size) throw();
+    static void  operator delete(void *ptr);
+
     uint32_t getPipeId(void);
 
     status_t setSrcBuf(ExynosCameraBuffer buf);
@@ -139,6 +148,11 @@ public:
             uint32_t frameCount);
     ~ExynosCameraFrame();
 
+    /* storage comes from a recycling pool, see ExynosCameraFramePool.h */
+    static void    *operator new(size_t size) throw();
+    static void     operator delete(void *ptr);
+    static void     dumpPool(void);
+
     /* If curEntity is NULL, newEntity is added to m_linkageList */
     status_t        addSiblingEntity(
                         ExynosCameraFrameEntity *curEntity,
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2013, Samsung Electronics Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*!
+ * \file      ExynosCameraFramePool.h
+ * \brief     fixed size slot pool backing frame and entity allocation
+ * \date      2013/11/20
+ *
+ */
+
+#ifndef EXYNOS_CAMERA_FRAME_POOL_H__
+#define EXYNOS_CAMERA_FRAME_POOL_H__
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <utils/threads.h>
+#include <cutils/log.h>
+
+namespace android {
+
+#define FRAME_POOL_SLOT_FREE    (0xF4EEF4EE)
+#define FRAME_POOL_SLOT_USED    (0x05ED05ED)
+#define FRAME_POOL_CHUNK_MAX    (32)
+
+/*
+ * Slots are carved out of chunks that are allocated once and kept until
+ * process exit, so steady state streaming does no heap work at all and the
+ * pool never grows past the high water mark of objects alive at once.
+ *
+ * Every slot carries a state tag. operator delete only reaches release()
+ * after the destructor has run, so a second delete has to be caught by the
+ * owner calling isLive() at the top of its destructor; release() checking
+ * the tag again only keeps the free list consistent. Released slots go to
+ * the tail of the free list, which keeps a stale pointer looking at a FREE
+ * slot for as long as possible before the slot is handed out again. Once a
+ * slot is reused a stale delete can no longer be told apart.
+ */
+template<typename T>
+class ExynosCameraFramePool {
+private:
+    struct pool_slot {
+        uint32_t            state;
+        struct pool_slot   *next;
+        uint64_t            storage[(sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    };
+
+public:
+    ExynosCameraFramePool(const char *name, int slotsPerChunk)
+    {
+        m_name = name;
+        m_slotsPerChunk = slotsPerChunk;
+        m_freeList = NULL;
+        m_freeTail = NULL;
+        m_numChunk = 0;
+        m_numSlot = 0;
+        m_numUsed = 0;
+        m_maxUsed = 0;
+        memset(m_chunk, 0x0, sizeof(m_chunk));
+    }
+
+    ~ExynosCameraFramePool()
+    {
+        if (m_numUsed != 0)
+            ALOGW("WARN(%s):%s pool destroyed with %d object(s) alive",
+                __FUNCTION__, m_name, m_numUsed);
+
+        for (int i = 0; i < m_numChunk; i++)
+            free(m_chunk[i]);
+    }
+
+    void *alloc(size_t size)
+    {
+        struct pool_slot *slot = NULL;
+
+        if (sizeof(T) < size) {
+            /* derived class bigger than the slot, fall back to the heap */
+            return malloc(size);
+        }
+
+        Mutex::Autolock lock(m_lock);
+
+        if (m_freeList == NULL && m_grow() != NO_ERROR) {
+            ALOGE("ERR(%s):%s pool exhausted, used(%d)", __FUNCTION__, m_name, m_numUsed);
+            return NULL;
+        }
+
+        slot = m_freeList;
+        m_freeList = slot->next;
+        if (m_freeList == NULL)
+            m_freeTail = NULL;
+
+        slot->state = FRAME_POOL_SLOT_USED;
+        slot->next = NULL;
+
+        m_numUsed++;
+        if (m_maxUsed < m_numUsed)
+            m_maxUsed = m_numUsed;
+
+        return (void *)slot->storage;
+    }
+
+    void release(void *ptr)
+    {
+        struct pool_slot *slot = NULL;
+        bool inPool = false;
+
+        if (ptr == NULL)
+            return;
+
+        Mutex::Autolock lock(m_lock);
+
+        slot = m_findSlot(ptr, &inPool);
+        if (inPool == false) {
+            /* came from the heap fallback in alloc() */
+            free(ptr);
+            return;
+        }
+
+        if (slot == NULL) {
+            ALOGE("ERR(%s):%s release of %p inside a slot", __FUNCTION__, m_name, ptr);
+            return;
+        }
+
+        if (slot->state != FRAME_POOL_SLOT_USED) {
+            ALOGE("ERR(%s):%s double release of %p, state(0x%x)",
+                __FUNCTION__, m_name, ptr, slot->state);
+            return;
+        }
+
+        slot->state = FRAME_POOL_SLOT_FREE;
+        slot->next = NULL;
+        if (m_freeTail == NULL)
+            m_freeList = slot;
+        else
+            m_freeTail->next = slot;
+        m_freeTail = slot;
+
+        m_numUsed--;
+    }
+
+    /* false only for a slot already released, heap fallbacks are not tracked */
+    bool isLive(void *ptr)
+    {
+        struct pool_slot *slot = NULL;
+        bool inPool = false;
+
+        Mutex::Autolock lock(m_lock);
+
+        slot = m_findSlot(ptr, &inPool);
+        if (inPool == false)
+            return true;
+
+        return (slot != NULL && slot->state == FRAME_POOL_SLOT_USED);
+    }
+
+    int getNumUsed(void)
+    {
+        Mutex::Autolock lock(m_lock);
+        return m_numUsed;
+    }
+
+    void dump(void)
+    {
+        Mutex::Autolock lock(m_lock);
+        ALOGD("DEBUG(%s):%s pool slot(%d) used(%d) maxUsed(%d) chunk(%d)",
+            __FUNCTION__, m_name, m_numSlot, m_numUsed, m_maxUsed, m_numChunk);
+    }
+
+private:
+    status_t m_grow(void)
+    {
+        struct pool_slot *chunk = NULL;
+
+        if (FRAME_POOL_CHUNK_MAX <= m_numChunk)
+            return NO_MEMORY;
+
+        chunk = (struct pool_slot *)malloc(sizeof(struct pool_slot) * m_slotsPerChunk);
+        if (chunk == NULL)
+            return NO_MEMORY;
+
+        /* only called with the free list empty */
+        for (int i = 0; i < m_slotsPerChunk; i++) {
+            chunk[i].state = FRAME_POOL_SLOT_FREE;
+            chunk[i].next = (i + 1 < m_slotsPerChunk) ? &chunk[i + 1] : NULL;
+        }
+        m_freeList = &chunk[0];
+        m_freeTail = &chunk[m_slotsPerChunk - 1];
+
+        m_chunk[m_numChunk++] = chunk;
+        m_numSlot += m_slotsPerChunk;
+
+        ALOGV("DEBUG(%s):%s pool grown to %d slots", __FUNCTION__, m_name, m_numSlot);
+
+        return NO_ERROR;
+    }
+
+    struct pool_slot *m_findSlot(void *ptr, bool *inPool)
+    {
+        uintptr_t addr = (uintptr_t)ptr;
+
+        *inPool = false;
+
+        for (int i = 0; i < m_numChunk; i++) {
+            uintptr_t base = (uintptr_t)m_chunk[i];
+            uintptr_t end = base + sizeof(struct pool_slot) * m_slotsPerChunk;
+
+            if (addr < base || end <= addr)
+                continue;
+
+            *inPool = true;
+
+            if ((addr - base) % sizeof(struct pool_slot) != offsetof(struct pool_slot, storage))
+                return NULL;
+
+            return (struct pool_slot *)(addr - offsetof(struct pool_slot, storage));
+        }
+
+        return NULL;
+    }
+
+private:
+    const char         *m_name;
+    int                 m_slotsPerChunk;
+
+    mutable Mutex       m_lock;
+    struct pool_slot   *m_freeList;
+    struct pool_slot   *m_freeTail;
+    struct pool_slot   *m_chunk[FRAME_POOL_CHUNK_MAX];
+    int                 m_numChunk;
+    int                 m_numSlot;
+    int                 m_numUsed;
+    int                 m_maxUsed;
+};
+
+}; /* namespace android */
+
+#endif /* EXYNOS_CAMERA_FRAME_POOL_H__ */
@@ -19,6 +19,8 @@
 #define LOG_TAG "ExynosCameraPipe"
 #include <cutils/log.h>
 
+#include <sys/eventfd.h>
+
 #include "ExynosCameraPipe.h"
 
 namespace android {
@@ -61,10 +63,21 @@ ExynosCameraPipe::ExynosCameraPipe()
 
     memset(&m_perframeMainNodeGroupInfo, 0x00, sizeof(camera_pipe_perframe_node_group_info_t));
 
+    m_stopLatency = 0;
+    m_stopLatencyMax = 0;
+    m_stopCount = 0;
+
+    m_wakeupFd = eventfd(0, EFD_NONBLOCK);
+    if (m_wakeupFd < 0)
+        ALOGE("ERR(%s[%d]):eventfd fail, errno(%d)", __FUNCTION__, __LINE__, errno);
 }
 
 ExynosCameraPipe::~ExynosCameraPipe()
 {
+    if (0 <= m_wakeupFd) {
+        close(m_wakeupFd);
+        m_wakeupFd = -1;
+    }
 }
 
 status_t ExynosCameraPipe::create(int32_t *sensorIds)
@@ -199,6 +212,7 @@ status_t ExynosCameraPipe::start(void)
 
     m_flagStartPipe = true;
     m_flagTryStop = false;
+    m_wakeupThread();
 
     return NO_ERROR;
 }
@@ -208,6 +222,8 @@ status_t ExynosCameraPipe::stop(void)
     CLOGD("DEBUG(%s[%d])", __FUNCTION__, __LINE__);
     int ret = 0;
 
+    m_stopTimer.start();
+
     m_flagStartPipe = false;
 
     ret = m_mainNode->stop();
@@ -216,8 +232,12 @@ status_t ExynosCameraPipe::stop(void)
         return ret;
     }
 
+    m_mainThread->requestExit();
+    m_wakeupThread();
     m_mainThread->requestExitAndWait();
 
+    m_updateStopLatency();
+
     ret = m_mainNode->clrBuffers();
     if (ret < 0) {
         CLOGE("ERR(%s): node clrBuffers fail, ret(%d)", __FUNCTION__, ret);
@@ -263,6 +283,7 @@ status_t ExynosCameraPipe::stopThread(void)
 {
     m_mainThread->requestExit();
     m_inputFrameQ->sendCmd(WAKE_UP);
+    m_wakeupThread();
 
     m_dumpRunningFrameList();
 
@@ -318,11 +339,20 @@ status_t ExynosCameraPipe::setParam(struct v4l2_streamparm streamParam)
     return ret;
 }
 
+status_t ExynosCameraPipe::getStopLatency(uint64_t *lastUsec, uint64_t *maxUsec)
+{
+    *lastUsec = m_stopLatency;
+    *maxUsec = m_stopLatencyMax;
+
+    return NO_ERROR;
+}
+
 status_t ExynosCameraPipe::setStopFlag(void)
 {
     CLOGD("DEBUG(%s[%d])", __FUNCTION__, __LINE__);
 
     m_flagTryStop = true;
+    m_wakeupThread();
 
     return NO_ERROR;
 }
@@ -786,7 +816,7 @@ bool ExynosCameraPipe::m_mainThreadFunc(void)
     /*       running list != empty */
 
     if (m_flagTryStop == true) {
-        usleep(5000);
+        m_waitWakeup(PIPE_WAKEUP_TIMEOUT);
         return true;
     }
 
@@ -941,6 +971,9 @@ void ExynosCameraPipe::dump()
     if (m_mainNode != NULL)
         m_mainNode->dump();
 
+    CLOGI("INFO(%s[%d]):stop latency last(%llu usec) max(%llu usec) count(%d)", __FUNCTION__, __LINE__,
+        (unsigned long long)m_stopLatency, (unsigned long long)m_stopLatencyMax, m_stopCount);
+
     return;
 }
 
@@ -1000,4 +1033,91 @@ void ExynosCameraPipe::m_configDvfs(void) {
     }
 }
 
+void ExynosCameraPipe::m_wakeupThread(void)
+{
+    uint64_t value = 1;
+
+    if (m_wakeupFd < 0)
+        return;
+
+    if (write(m_wakeupFd, &value, sizeof(value)) != sizeof(value))
+        CLOGW("WARN(%s[%d]):wakeup write fail, errno(%d)", __FUNCTION__, __LINE__, errno);
+}
+
+/*
+ * Block until start/stop/setStopFlag/stopThread kicks the eventfd or
+ * timeoutMsec passes. The kick is consumed. Returns 1 when kicked, 0 on
+ * timeout or error.
+ */
+int ExynosCameraPipe::m_waitWakeup(int timeoutMsec)
+{
+    struct pollfd event;
+    uint64_t value = 0;
+    ssize_t readSize = 0;
+    int ret = 0;
+
+    if (m_wakeupFd < 0) {
+        usleep(timeoutMsec * 1000);
+        return 0;
+    }
+
+    event.fd = m_wakeupFd;
+    event.events = POLLIN;
+    event.revents = 0;
+
+    ret = poll(&event, 1, timeoutMsec);
+    if (ret < 0) {
+        if (errno != EINTR)
+            CLOGE("ERR(%s[%d]):poll fail, errno(%d)", __FUNCTION__, __LINE__, errno);
+        return 0;
+    }
+
+    if (ret == 0 || !(event.revents & POLLIN))
+        return 0;
+
+    readSize = read(m_wakeupFd, &value, sizeof(value));
+    if (readSize != sizeof(value)) {
+        if (readSize < 0 && errno == EAGAIN)
+            return 0;
+        CLOGW("WARN(%s[%d]):wakeup read fail, ret(%d), errno(%d)", __FUNCTION__, __LINE__, (int)readSize, errno);
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Timed hold on a skip path, not an idle wait. Only the eventfd is polled,
+ * a readable node would end every wait at once. A kick consumed here while
+ * the pipe is stopping is written back so the idle path still sees it.
+ * Returns true when the pipe is stopping.
+ */
+bool ExynosCameraPipe::m_waitSkip(int timeoutMsec)
+{
+    if (m_waitWakeup(timeoutMsec) == 0)
+        return false;
+
+    if (m_flagTryStop == true || m_flagStartPipe == false) {
+        m_wakeupThread();
+        return true;
+    }
+
+    /* a start kick nobody waited for, nothing to hand on */
+    return false;
+}
+
+/* called at the end of stop(), m_stopTimer was started on entry */
+void ExynosCameraPipe::m_updateStopLatency(void)
+{
+    m_stopTimer.stop();
+
+    m_stopLatency = m_stopTimer.durationUsecs();
+    if (m_stopLatencyMax < m_stopLatency)
+        m_stopLatencyMax = m_stopLatency;
+    m_stopCount++;
+
+    CLOGI("INFO(%s[%d]):stop latency(%llu usec) max(%llu usec) count(%d)", __FUNCTION__, __LINE__,
+        (unsigned long long)m_stopLatency, (unsigned long long)m_stopLatencyMax, m_stopCount);
+}
+
 }; /* namespace android */
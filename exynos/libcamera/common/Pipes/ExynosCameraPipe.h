@@ -30,6 +30,10 @@
 
 namespace android {
 
+/* upper bound of an idle wait, the eventfd normally ends it much earlier */
+#define PIPE_WAKEUP_TIMEOUT     (100)   /* msec */
+#define PIPE_SKIP_WAIT_TIME     (33)    /* msec */
+
 typedef ExynosCameraList<ExynosCameraFrame *> frame_queue_t;
 
 enum PIPE_POSITION {
@@ -128,6 +132,7 @@ public:
     virtual status_t        getThreadRenew(int **timeRenew);
     virtual status_t        incThreadRenew();
     virtual status_t        setStopFlag(void);
+    virtual status_t        getStopLatency(uint64_t *lastUsec, uint64_t *maxUsec);
     virtual void            dump(void);
 
 protected:
@@ -153,6 +158,11 @@ protected:
 
     void                    m_configDvfs(void);
 
+    void                    m_wakeupThread(void);
+    int                     m_waitWakeup(int timeoutMsec);
+    bool                    m_waitSkip(int timeoutMsec);
+    void                    m_updateStopLatency(void);
+
 protected:
     ExynosCameraNode           *m_mainNode;
     int32_t                     m_mainNodeNum;
@@ -192,6 +202,12 @@ protected:
 
 
     bool                        m_dvfsLocked;
+
+    int                         m_wakeupFd;
+    ExynosCameraDurationTimer   m_stopTimer;
+    uint64_t                    m_stopLatency;
+    uint64_t                    m_stopLatencyMax;
+    uint32_t                    m_stopCount;
 };
 
 }; /* namespace android */
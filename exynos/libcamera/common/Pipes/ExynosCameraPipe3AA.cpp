@@ -260,6 +260,7 @@ status_t ExynosCameraPipe3AA::start(void)
 
     m_flagStartPipe = true;
     m_flagTryStop = false;
+    m_wakeupThread();
 
     return NO_ERROR;
 }
@@ -269,6 +270,8 @@ status_t ExynosCameraPipe3AA::stop(void)
     ALOGD("INFO(%s[%d])", __FUNCTION__, __LINE__);
     int ret = 0;
 
+    m_stopTimer.start();
+
     m_flagStartPipe = false;
     m_flagTryStop = false;
 
@@ -298,9 +301,12 @@ status_t ExynosCameraPipe3AA::stop(void)
         return ret;
     }
 
+    m_mainThread->requestExit();
+    m_wakeupThread();
     m_mainThread->requestExitAndWait();
 
     CLOGD("DEBUG(%s[%d]): thead exited", __FUNCTION__, __LINE__);
+    m_updateStopLatency();
 
     m_inputFrameQ->release();
 
@@ -444,6 +444,7 @@ status_t ExynosCameraPipe3AA_ISP::start(void)
 
     m_flagStartPipe = true;
     m_flagTryStop = false;
+    m_wakeupThread();
 
     return NO_ERROR;
 }
@@ -453,6 +454,8 @@ status_t ExynosCameraPipe3AA_ISP::stop(void)
     ALOGD("DEBUG(%s[%d])", __FUNCTION__, __LINE__);
     int ret = 0;
 
+    m_stopTimer.start();
+
     m_flagStartPipe = false;
     m_flagTryStop = false;
 
@@ -495,6 +498,8 @@ status_t ExynosCameraPipe3AA_ISP::stop(void)
         return ret;
     }
 
+    m_mainThread->requestExit();
+    m_wakeupThread();
     m_mainThread->requestExitAndWait();
     m_ispThread->requestExitAndWait();
 
@@ -507,6 +512,7 @@ status_t ExynosCameraPipe3AA_ISP::stop(void)
     m_numOfRunningFrame = 0;
 
     CLOGD("DEBUG(%s[%d]): thead exited", __FUNCTION__, __LINE__);
+    m_updateStopLatency();
 
     m_mainNode->removeItemBufferQ();
     m_subNode->removeItemBufferQ();
@@ -538,6 +544,7 @@ status_t ExynosCameraPipe3AA_ISP::stopThread(void)
 
     m_inputFrameQ->sendCmd(WAKE_UP);
     m_ispBufferQ->sendCmd(WAKE_UP);
+    m_wakeupThread();
 
     m_dumpRunningFrameList();
 
@@ -1034,7 +1041,7 @@ bool ExynosCameraPipe3AA_ISP::m_mainThreadFunc(void)
     int ret = 0;
 
     if (m_flagTryStop == true) {
-        usleep(5000);
+        m_waitWakeup(PIPE_WAKEUP_TIMEOUT);
         return true;
     }
 
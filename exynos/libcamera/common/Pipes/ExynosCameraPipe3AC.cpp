@@ -146,7 +146,7 @@ bool ExynosCameraPipe3AC::m_mainThreadFunc(void)
 
     if (m_flagStartPipe == false) {
         /* waiting for pipe started */
-        usleep(5000);
+        m_waitWakeup(PIPE_WAKEUP_TIMEOUT);
         return m_checkThreadLoop();
     }
 
@@ -168,7 +168,7 @@ bool ExynosCameraPipeFlite::m_mainThreadFunc(void)
     int ret = 0;
 
     if (m_flagTryStop == true) {
-        usleep(5000);
+        m_waitWakeup(PIPE_WAKEUP_TIMEOUT);
         return true;
     }
 
@@ -183,12 +183,12 @@ bool ExynosCameraPipeSCC::m_mainThreadFunc(void)
 
     if (m_flagStartPipe == false) {
         /* waiting for pipe started */
-        usleep(5000);
+        m_waitWakeup(PIPE_WAKEUP_TIMEOUT);
         return m_checkThreadLoop();
     }
 
     if (m_flagTryStop == true) {
-        usleep(5000);
+        m_waitWakeup(PIPE_WAKEUP_TIMEOUT);
         return true;
     }
 
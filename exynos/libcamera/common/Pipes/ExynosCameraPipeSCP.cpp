@@ -239,6 +239,7 @@ status_t ExynosCameraPipeSCP::m_putBuffer(void)
 {
     ExynosCameraFrame *newFrame = NULL;
     ExynosCameraBuffer newBuffer;
+    bool isStopping = false;
     int ret = 0;
 
 retry:
@@ -287,9 +288,14 @@ retry:
         CLOGV("DEBUG(%s):entity pipeId(%d), frameCount(%d), numOfRunningFrame(%d), requestCount(%d)",
                 __FUNCTION__, getPipeId(), newFrame->getFrameCount(), m_numOfRunningFrame, m_requestCount);
 
-        usleep(33000);
+        /* hold the skipped frame for one frame time, a stop cuts the wait short */
+        isStopping = m_waitSkip(PIPE_SKIP_WAIT_TIME);
         m_outputFrameQ->pushProcessQ(&newFrame);
 
+        /* back to the main loop so the stop is handled there */
+        if (isStopping == true)
+            return OK;
+
         goto retry;
     } else {
         if (m_runningFrameList[newBuffer.index] != NULL) {
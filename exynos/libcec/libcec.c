@@ -15,6 +15,12 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -61,6 +67,12 @@ inline static void CECPrintFrame(unsigned char *buffer, unsigned int size);
 
 static int fd = -1;
 
+static int CECEngineSend(unsigned char *buffer, int size);
+static int CECEngineTransmit(unsigned char *buffer, int size);
+static int CECEngineReceive(unsigned char *buffer, int size, long timeout);
+static int CECEngineRunning(void);
+static int CECOnEngineThread(void);
+
 /**
  * Open device driver and assign CEC file descriptor.
  *
@@ -68,6 +80,11 @@ static int fd = -1;
  */
 int CECOpen()
 {
+    if (CECOnEngineThread()) {
+        ALOGE("CECOpen() called from a CEC callback!\n");
+        return -1;
+    }
+
     if (fd != -1)
         CECClose();
 
@@ -88,6 +105,13 @@ int CECClose()
 {
     int res = 1;
 
+    if (CECOnEngineThread()) {
+        ALOGE("CECClose() called from a CEC callback!\n");
+        return 0;
+    }
+
+    CECEngineStop();
+
     if (fd != -1) {
         if (close(fd) != 0) {
             ALOGE("close() failed!\n");
@@ -99,6 +123,32 @@ int CECClose()
     return res;
 }
 
+/**
+ * Send a polling message to a logical address.
+ *
+ * @param laddr   [in] logical address to poll.
+ *
+ * @return 0 if nobody acknowledged it, 1 if the address is taken,
+ *         -1 if the message could not be sent.
+ */
+static int CECPollAddress(unsigned char laddr)
+{
+    unsigned char message = (laddr << 4) | laddr;
+
+    if (CECEngineRunning()) {
+        switch (CECEngineTransmit(&message, 1)) {
+        case CEC_TX_OK:
+            return 1;
+        case CEC_TX_NACK:
+            return 0;
+        default:
+            return -1;
+        }
+    }
+
+    return (write(fd, &message, 1) == 1) ? 1 : 0;
+}
+
 /**
  * Allocate logical address.
  *
@@ -117,6 +167,11 @@ int CECAllocLogicalAddress(int paddr, enum CECDeviceType devtype)
         return 0;
     }
 
+    if (CECOnEngineThread()) {
+        ALOGE("CECAllocLogicalAddress() called from a CEC callback!\n");
+        return 0;
+    }
+
     if (CECSetLogicalAddr(laddr) < 0) {
         ALOGE("CECSetLogicalAddr() failed!\n");
         return 0;
@@ -129,8 +184,12 @@ int CECAllocLogicalAddress(int paddr, enum CECDeviceType devtype)
     while (i < sizeof(laddresses) / sizeof(laddresses[0])) {
         if (laddresses[i].devtype == devtype) {
             unsigned char _laddr = laddresses[i].laddr;
-            unsigned char message = ((_laddr << 4) | _laddr);
-            if (CECSendMessage(&message, 1) != 1) {
+            int taken = CECPollAddress(_laddr);
+            if (taken < 0) {
+                ALOGE("polling logical address %d failed!\n", _laddr);
+                return 0;
+            }
+            if (!taken) {
                 laddr = _laddr;
                 break;
             }
@@ -184,6 +243,9 @@ int CECSendMessage(unsigned char *buffer, int size)
         return 0;
     }
 
+    if (CECEngineRunning())
+        return CECEngineSend(buffer, size);
+
 #if CEC_DEBUG
     ALOGI("CECSendMessage() : ");
     CECPrintFrame(buffer, size);
@@ -213,6 +275,9 @@ int CECReceiveMessage(unsigned char *buffer, int size, long timeout)
         return 0;
     }
 
+    if (CECEngineRunning())
+        return CECEngineReceive(buffer, size, timeout);
+
     tv.tv_sec = 0;
     tv.tv_usec = timeout;
 
@@ -250,6 +315,683 @@ int CECSetLogicalAddr(unsigned int laddr)
     return 1;
 }
 
+/*
+ * Asynchronous engine
+ *
+ * A single thread owns the CEC fd while the engine runs. It polls the fd for
+ * incoming frames and a wakeup pipe for new transmit requests, sends the
+ * queued frames highest priority first and hands received frames to the
+ * registered receivers. A frame that gets NACKed is retried with exponential
+ * back-off; while it waits, other frames keep flowing so a slow sink does not
+ * hold up remote control traffic to everyone else.
+ */
+
+/* Transmit queue depth per priority */
+#define CEC_TX_QUEUE_SIZE       16
+/* Frames kept for CECReceiveMessage() that no receiver took */
+#define CEC_RX_QUEUE_SIZE       8
+#define CEC_RECEIVER_MAX        8
+/* Retries after a NACK, the delay doubles on each attempt */
+#define CEC_TX_RETRY_MAX        2
+#define CEC_TX_RETRY_DELAY_MS   50
+/* CECEngineTransmit() only, the frame never made it into a queue */
+#define CEC_TX_NOT_QUEUED       -3
+
+struct CECFrame {
+    unsigned char buffer[CEC_MAX_FRAME_SIZE];
+    int size;
+};
+
+struct CECTxEntry {
+    struct CECFrame frame;
+    enum CECPriority priority;
+    int retries;
+    int attempt;
+    unsigned long long notBefore;   /* msec, CLOCK_MONOTONIC */
+    CECTransmitCallback callback;
+    void *priv;
+};
+
+struct CECTxQueue {
+    struct CECTxEntry entry[CEC_TX_QUEUE_SIZE];
+    int count;
+};
+
+struct CECReceiver {
+    int used;
+    int busy;       /* callbacks picked by CECDispatch() and not yet returned */
+    int opcode;
+    CECReceiveCallback callback;
+    void *priv;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;
+    int wakeup[2];
+
+    struct CECTxQueue txq[CEC_PRIORITY_MAX];
+
+    struct CECFrame rxq[CEC_RX_QUEUE_SIZE];
+    int rxHead;
+    int rxCount;
+
+    struct CECReceiver receivers[CEC_RECEIVER_MAX];
+} engine = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .wakeup = { -1, -1 },
+};
+
+static int CECEngineRunning(void)
+{
+    int running;
+
+    pthread_mutex_lock(&engine.lock);
+    running = engine.running;
+    pthread_mutex_unlock(&engine.lock);
+
+    return running;
+}
+
+/* callbacks run on the engine thread, which must never wait for itself */
+static int CECOnEngineThread(void)
+{
+    int on;
+
+    pthread_mutex_lock(&engine.lock);
+    on = engine.running && pthread_equal(pthread_self(), engine.thread);
+    pthread_mutex_unlock(&engine.lock);
+
+    return on;
+}
+
+static unsigned long long CECGetTimeMs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (unsigned long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void CECWakeupEngine(void)
+{
+    unsigned char c = 0;
+
+    if (engine.wakeup[1] != -1)
+        write(engine.wakeup[1], &c, 1);
+}
+
+/**
+ * Check if a newer copy of the message makes a queued one pointless.
+ *
+ * @param opcode   [in] message opcode.
+ *
+ * @return 1 if only the latest report matters, otherwise, return 0.
+ */
+static int CECIsCoalescable(unsigned char opcode)
+{
+    switch (opcode) {
+    case CEC_OPCODE_ACTIVE_SOURCE:
+    case CEC_OPCODE_INACTIVE_SOURCE:
+    case CEC_OPCODE_REPORT_PHYSICAL_ADDRESS:
+    case CEC_OPCODE_REPORT_POWER_STATUS:
+    case CEC_OPCODE_REPORT_AUDIO_STATUS:
+    case CEC_OPCODE_DEVICE_VENDOR_ID:
+    case CEC_OPCODE_CEC_VERSION:
+    case CEC_OPCODE_SET_OSD_NAME:
+    case CEC_OPCODE_MENU_STATUS:
+    case CEC_OPCODE_DECK_STATUS:
+    case CEC_OPCODE_SYSTEM_AUDIO_MODE_STATUS:
+        return 1;
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+static void CECTxRemove(struct CECTxQueue *q, int index)
+{
+    memmove(&q->entry[index], &q->entry[index + 1],
+            (q->count - index - 1) * sizeof(struct CECTxEntry));
+    q->count--;
+}
+
+/**
+ * Take the first frame that is not backing off, called with lock held.
+ *
+ * @param *entry    [out] frame to send.
+ * @param *waitMs   [out] time until the next backed off frame is due, or -1.
+ *
+ * @return 1 if a frame was taken, otherwise, return 0.
+ */
+static int CECTxPick(struct CECTxEntry *entry, int *waitMs)
+{
+    unsigned long long now = CECGetTimeMs();
+    unsigned long long next = 0;
+    int p, i;
+
+    for (p = 0; p < CEC_PRIORITY_MAX; p++) {
+        struct CECTxQueue *q = &engine.txq[p];
+
+        for (i = 0; i < q->count; i++) {
+            if (q->entry[i].notBefore <= now) {
+                *entry = q->entry[i];
+                CECTxRemove(q, i);
+                return 1;
+            }
+
+            if (next == 0 || q->entry[i].notBefore < next)
+                next = q->entry[i].notBefore;
+        }
+    }
+
+    *waitMs = (next == 0) ? -1 : (int)(next - now);
+
+    return 0;
+}
+
+static void CECDispatch(struct CECFrame *frame)
+{
+    int matched[CEC_RECEIVER_MAX];
+    int opcode = (frame->size > 1) ? frame->buffer[1] : CEC_OPCODE_ANY;
+    int numMatched = 0;
+    int i;
+
+    pthread_mutex_lock(&engine.lock);
+
+    for (i = 0; i < CEC_RECEIVER_MAX; i++) {
+        struct CECReceiver *r = &engine.receivers[i];
+
+        if (r->used && (r->opcode == CEC_OPCODE_ANY || r->opcode == opcode)) {
+            /* CECUnregisterReceiver() waits for this to drop back to 0 */
+            r->busy++;
+            matched[numMatched++] = i;
+        }
+    }
+
+    /* nobody took it, keep it for CECReceiveMessage() */
+    if (numMatched == 0) {
+        int tail = (engine.rxHead + engine.rxCount) % CEC_RX_QUEUE_SIZE;
+
+        if (engine.rxCount == CEC_RX_QUEUE_SIZE) {
+            /* drop the oldest frame */
+            engine.rxHead = (engine.rxHead + 1) % CEC_RX_QUEUE_SIZE;
+            engine.rxCount--;
+        }
+
+        engine.rxq[tail] = *frame;
+        engine.rxCount++;
+        pthread_cond_broadcast(&engine.cond);
+    }
+
+    for (i = 0; i < numMatched; i++) {
+        struct CECReceiver *r = &engine.receivers[matched[i]];
+        CECReceiveCallback callback = r->callback;
+        void *priv = r->priv;
+
+        /* an earlier callback may have unregistered it */
+        if (r->used) {
+            pthread_mutex_unlock(&engine.lock);
+            callback(frame->buffer, frame->size, priv);
+            pthread_mutex_lock(&engine.lock);
+        }
+
+        r->busy--;
+        if (r->busy == 0)
+            pthread_cond_broadcast(&engine.cond);
+    }
+
+    pthread_mutex_unlock(&engine.lock);
+}
+
+static void CECTransmit(struct CECTxEntry *entry)
+{
+    int ret;
+
+#if CEC_DEBUG
+    ALOGI("CECTransmit() : attempt(%d)", entry->attempt);
+    CECPrintFrame(entry->frame.buffer, entry->frame.size);
+#endif
+
+    ret = write(fd, entry->frame.buffer, entry->frame.size);
+    if (ret == entry->frame.size) {
+        if (entry->callback)
+            entry->callback(entry->frame.buffer, entry->frame.size, CEC_TX_OK, entry->priv);
+        return;
+    }
+
+    if (0 < entry->retries) {
+        struct CECTxQueue *q = &engine.txq[entry->priority];
+
+        entry->retries--;
+        entry->notBefore = CECGetTimeMs() + ((unsigned long long)CEC_TX_RETRY_DELAY_MS << entry->attempt);
+        entry->attempt++;
+
+        pthread_mutex_lock(&engine.lock);
+        /* keep its place, at the head of its own queue */
+        if (q->count < CEC_TX_QUEUE_SIZE) {
+            memmove(&q->entry[1], &q->entry[0], q->count * sizeof(struct CECTxEntry));
+            q->entry[0] = *entry;
+            q->count++;
+            pthread_mutex_unlock(&engine.lock);
+            return;
+        }
+        pthread_mutex_unlock(&engine.lock);
+    }
+
+    if (entry->callback)
+        entry->callback(entry->frame.buffer, entry->frame.size, CEC_TX_NACK, entry->priv);
+}
+
+static void *CECEngineThread(void *arg)
+{
+    struct pollfd fds[2];
+    struct CECTxEntry entry;
+    struct CECFrame frame;
+    int waitMs;
+    int picked;
+    unsigned char c[16];
+
+    (void)arg;
+
+    fds[0].fd = fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = engine.wakeup[0];
+    fds[1].events = POLLIN;
+
+    for (;;) {
+        pthread_mutex_lock(&engine.lock);
+        if (!engine.running) {
+            pthread_mutex_unlock(&engine.lock);
+            break;
+        }
+        picked = CECTxPick(&entry, &waitMs);
+        pthread_mutex_unlock(&engine.lock);
+
+        if (picked) {
+            CECTransmit(&entry);
+            /* only look for incoming frames before sending the next one */
+            waitMs = 0;
+        }
+
+        fds[0].revents = 0;
+        fds[1].revents = 0;
+
+        if (poll(fds, 2, waitMs) < 0) {
+            if (errno != EINTR) {
+                ALOGE("poll() failed, errno(%d)\n", errno);
+                usleep(10000);
+            }
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            frame.size = read(fd, frame.buffer, CEC_MAX_FRAME_SIZE);
+            if (0 < frame.size) {
+#if CEC_DEBUG
+                ALOGI("CECEngineThread() : received size(%d)", frame.size);
+                CECPrintFrame(frame.buffer, frame.size);
+#endif
+                CECDispatch(&frame);
+            }
+        }
+
+        if (fds[1].revents & POLLIN)
+            read(engine.wakeup[0], c, sizeof(c));
+    }
+
+    return NULL;
+}
+
+/**
+ * Start the asynchronous engine on the opened CEC device. Not done by
+ * CECOpen(), see libcec.h for who should call it.
+ *
+ * @return 1 if success, otherwise, return 0.
+ */
+int CECEngineStart()
+{
+    int flags;
+
+    if (fd == -1) {
+        ALOGE("open device first!\n");
+        return 0;
+    }
+
+    pthread_mutex_lock(&engine.lock);
+
+    if (engine.running) {
+        pthread_mutex_unlock(&engine.lock);
+        return 1;
+    }
+
+    if (pipe(engine.wakeup) < 0) {
+        ALOGE("pipe() failed!\n");
+        engine.wakeup[0] = engine.wakeup[1] = -1;
+        pthread_mutex_unlock(&engine.lock);
+        return 0;
+    }
+
+    flags = fcntl(engine.wakeup[0], F_GETFL);
+    fcntl(engine.wakeup[0], F_SETFL, flags | O_NONBLOCK);
+    flags = fcntl(engine.wakeup[1], F_GETFL);
+    fcntl(engine.wakeup[1], F_SETFL, flags | O_NONBLOCK);
+
+    engine.rxHead = 0;
+    engine.rxCount = 0;
+    engine.running = 1;
+
+    if (pthread_create(&engine.thread, NULL, CECEngineThread, NULL) != 0) {
+        ALOGE("pthread_create() failed!\n");
+        engine.running = 0;
+        close(engine.wakeup[0]);
+        close(engine.wakeup[1]);
+        engine.wakeup[0] = engine.wakeup[1] = -1;
+        pthread_mutex_unlock(&engine.lock);
+        return 0;
+    }
+
+    pthread_mutex_unlock(&engine.lock);
+
+    return 1;
+}
+
+/**
+ * Stop the asynchronous engine. Queued frames complete with CEC_TX_DROPPED.
+ */
+void CECEngineStop()
+{
+    struct CECTxEntry entry;
+    int p;
+
+    if (CECOnEngineThread()) {
+        ALOGE("CECEngineStop() called from a CEC callback!\n");
+        return;
+    }
+
+    pthread_mutex_lock(&engine.lock);
+    if (!engine.running) {
+        pthread_mutex_unlock(&engine.lock);
+        return;
+    }
+    engine.running = 0;
+    pthread_mutex_unlock(&engine.lock);
+
+    CECWakeupEngine();
+    pthread_join(engine.thread, NULL);
+
+    close(engine.wakeup[0]);
+    close(engine.wakeup[1]);
+    engine.wakeup[0] = engine.wakeup[1] = -1;
+
+    for (p = 0; p < CEC_PRIORITY_MAX; p++) {
+        pthread_mutex_lock(&engine.lock);
+        while (engine.txq[p].count) {
+            entry = engine.txq[p].entry[0];
+            CECTxRemove(&engine.txq[p], 0);
+            pthread_mutex_unlock(&engine.lock);
+
+            if (entry.callback)
+                entry.callback(entry.frame.buffer, entry.frame.size, CEC_TX_DROPPED, entry.priv);
+
+            pthread_mutex_lock(&engine.lock);
+        }
+        pthread_mutex_unlock(&engine.lock);
+    }
+
+    /* wake up CECReceiveMessage() callers */
+    pthread_mutex_lock(&engine.lock);
+    pthread_cond_broadcast(&engine.cond);
+    pthread_mutex_unlock(&engine.lock);
+}
+
+/**
+ * Queue CEC message for transmission.
+ *
+ * A report that is still queued for the same destination is replaced by the
+ * newer one, which goes into the queue of its own priority; the replaced
+ * request completes with CEC_TX_DROPPED.
+ *
+ * @param *buffer   [in] pointer to buffer address where message located.
+ * @param size      [in] message size.
+ * @param priority  [in] queue priority.
+ * @param callback  [in] called from the engine thread once done, may be NULL.
+ * @param priv      [in] passed to callback.
+ *
+ * @return 1 if queued, otherwise, return 0.
+ */
+int CECQueueMessage(const unsigned char *buffer, int size, enum CECPriority priority,
+                    CECTransmitCallback callback, void *priv)
+{
+    struct CECTxEntry dropped;
+    struct CECTxEntry *entry = NULL;
+    struct CECTxQueue *q;
+    int hasDropped = 0;
+    int matchQueue = -1;
+    int matchIndex = -1;
+    int p, i;
+
+    if (size <= 0 || size > CEC_MAX_FRAME_SIZE) {
+        ALOGE("size should be 1 ~ %d\n", CEC_MAX_FRAME_SIZE);
+        return 0;
+    }
+
+    if (priority < 0 || priority >= CEC_PRIORITY_MAX)
+        priority = CEC_PRIORITY_NORMAL;
+
+    pthread_mutex_lock(&engine.lock);
+
+    if (!engine.running) {
+        pthread_mutex_unlock(&engine.lock);
+        ALOGE("start engine first!\n");
+        return 0;
+    }
+
+    if (size > 1 && CECIsCoalescable(buffer[1])) {
+        for (p = 0; p < CEC_PRIORITY_MAX && matchQueue < 0; p++) {
+            q = &engine.txq[p];
+            for (i = 0; i < q->count; i++) {
+                if (q->entry[i].frame.size > 1 &&
+                    q->entry[i].frame.buffer[0] == buffer[0] &&
+                    q->entry[i].frame.buffer[1] == buffer[1]) {
+                    matchQueue = p;
+                    matchIndex = i;
+                    break;
+                }
+            }
+        }
+    }
+
+    q = &engine.txq[priority];
+    if (matchQueue == (int)priority) {
+        /* same queue, the newer report takes the old one's place */
+        entry = &q->entry[matchIndex];
+        dropped = *entry;
+        hasDropped = 1;
+    } else {
+        if (q->count == CEC_TX_QUEUE_SIZE) {
+            pthread_mutex_unlock(&engine.lock);
+            ALOGE("transmit queue(%d) full!\n", priority);
+            return 0;
+        }
+        if (0 <= matchQueue) {
+            dropped = engine.txq[matchQueue].entry[matchIndex];
+            hasDropped = 1;
+            CECTxRemove(&engine.txq[matchQueue], matchIndex);
+        }
+        entry = &q->entry[q->count++];
+    }
+
+    memcpy(entry->frame.buffer, buffer, size);
+    entry->frame.size = size;
+    entry->priority = priority;
+    /* a NACKed polling message means the address is free, never retry it */
+    entry->retries = (size == 1) ? 0 : CEC_TX_RETRY_MAX;
+    entry->attempt = 0;
+    entry->notBefore = 0;
+    entry->callback = callback;
+    entry->priv = priv;
+
+    pthread_mutex_unlock(&engine.lock);
+
+    CECWakeupEngine();
+
+    if (hasDropped && dropped.callback)
+        dropped.callback(dropped.frame.buffer, dropped.frame.size, CEC_TX_DROPPED, dropped.priv);
+
+    return 1;
+}
+
+/**
+ * Register receive callback.
+ *
+ * @param opcode    [in] opcode to receive, or CEC_OPCODE_ANY.
+ * @param callback  [in] called from the engine thread for each matching frame.
+ * @param priv      [in] passed to callback.
+ *
+ * @return receiver id, or -1 if an error occured.
+ */
+int CECRegisterReceiver(int opcode, CECReceiveCallback callback, void *priv)
+{
+    int i;
+
+    if (callback == NULL)
+        return -1;
+
+    pthread_mutex_lock(&engine.lock);
+    for (i = 0; i < CEC_RECEIVER_MAX; i++) {
+        /* a slot still being called back is not free yet */
+        if (!engine.receivers[i].used && !engine.receivers[i].busy) {
+            engine.receivers[i].used = 1;
+            engine.receivers[i].opcode = opcode;
+            engine.receivers[i].callback = callback;
+            engine.receivers[i].priv = priv;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&engine.lock);
+
+    if (i == CEC_RECEIVER_MAX) {
+        ALOGE("too many receivers!\n");
+        return -1;
+    }
+
+    return i;
+}
+
+/**
+ * Unregister receive callback. Once this returns the callback is not
+ * running and will not be called again, so priv may be freed. Called from
+ * a callback it cannot wait for itself; the callback being run must then
+ * be the only user of priv.
+ *
+ * @param id        [in] receiver id from CECRegisterReceiver().
+ */
+void CECUnregisterReceiver(int id)
+{
+    if (id < 0 || id >= CEC_RECEIVER_MAX)
+        return;
+
+    pthread_mutex_lock(&engine.lock);
+    engine.receivers[id].used = 0;
+
+    if (!(engine.running && pthread_equal(pthread_self(), engine.thread))) {
+        while (engine.receivers[id].busy)
+            pthread_cond_wait(&engine.cond, &engine.lock);
+    }
+    pthread_mutex_unlock(&engine.lock);
+}
+
+struct CECSyncTx {
+    int done;
+    int result;
+};
+
+static void CECSyncTxDone(const unsigned char *buffer, int size, int result, void *priv)
+{
+    struct CECSyncTx *tx = (struct CECSyncTx *)priv;
+
+    (void)buffer;
+    (void)size;
+
+    pthread_mutex_lock(&engine.lock);
+    tx->done = 1;
+    tx->result = result;
+    pthread_cond_broadcast(&engine.cond);
+    pthread_mutex_unlock(&engine.lock);
+}
+
+/**
+ * Queue a frame and wait until the engine is done with it.
+ *
+ * @return CEC_TX_OK, CEC_TX_NACK, CEC_TX_DROPPED, or CEC_TX_NOT_QUEUED if it
+ *         could not be queued at all.
+ */
+static int CECEngineTransmit(unsigned char *buffer, int size)
+{
+    struct CECSyncTx tx = { 0, CEC_TX_DROPPED };
+
+    if (!CECQueueMessage(buffer, size, CEC_PRIORITY_NORMAL, CECSyncTxDone, &tx))
+        return CEC_TX_NOT_QUEUED;
+
+    pthread_mutex_lock(&engine.lock);
+    while (!tx.done)
+        pthread_cond_wait(&engine.cond, &engine.lock);
+    pthread_mutex_unlock(&engine.lock);
+
+    return tx.result;
+}
+
+static int CECEngineSend(unsigned char *buffer, int size)
+{
+    /* a reply from a callback, the result only comes after we return */
+    if (CECOnEngineThread())
+        return CECQueueMessage(buffer, size, CEC_PRIORITY_NORMAL, NULL, NULL) ? size : 0;
+
+    return (CECEngineTransmit(buffer, size) == CEC_TX_OK) ? size : 0;
+}
+
+static int CECEngineReceive(unsigned char *buffer, int size, long timeout)
+{
+    struct timeval now;
+    struct timespec abstime;
+    int bytes = 0;
+
+    /* nothing can arrive while the engine thread is in here */
+    if (CECOnEngineThread())
+        timeout = 0;
+
+    gettimeofday(&now, NULL);
+    abstime.tv_sec = now.tv_sec + (now.tv_usec + timeout) / 1000000;
+    abstime.tv_nsec = ((now.tv_usec + timeout) % 1000000) * 1000;
+
+    pthread_mutex_lock(&engine.lock);
+
+    while (engine.running && engine.rxCount == 0) {
+        if (pthread_cond_timedwait(&engine.cond, &engine.lock, &abstime) == ETIMEDOUT)
+            break;
+    }
+
+    if (engine.rxCount) {
+        struct CECFrame *frame = &engine.rxq[engine.rxHead];
+
+        bytes = (frame->size < size) ? frame->size : size;
+        memcpy(buffer, frame->buffer, bytes);
+
+        engine.rxHead = (engine.rxHead + 1) % CEC_RX_QUEUE_SIZE;
+        engine.rxCount--;
+    }
+
+    pthread_mutex_unlock(&engine.lock);
+
+    return bytes;
+}
+
 #if CEC_DEBUG
 /**
  * Print CEC frame.
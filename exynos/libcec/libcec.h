@@ -139,6 +139,28 @@ extern "C" {
 #define CEC_DECK_CONTROL_MODE_STOP      0x03
 #define CEC_PLAY_MODE_PLAY_FORWARD      0x24
 
+/*
+ * @enum CECPriority
+ * Transmit queue priority, higher priorities are always sent first
+ */
+enum CECPriority {
+    /* user control, routing */
+    CEC_PRIORITY_HIGH,
+    /* replies to requests */
+    CEC_PRIORITY_NORMAL,
+    /* unsolicited reports */
+    CEC_PRIORITY_LOW,
+    CEC_PRIORITY_MAX,
+};
+
+/* Transmit results passed to CECTransmitCallback */
+#define CEC_TX_OK                0
+#define CEC_TX_NACK             -1
+#define CEC_TX_DROPPED          -2
+
+/* Opcode filter matching every message, polling messages included */
+#define CEC_OPCODE_ANY          -1
+
 /*
  * @enum CECDeviceType
  * Type of CEC device
@@ -158,6 +180,27 @@ enum CECDeviceType {
 
 int CECOpen();
 int CECClose();
+
+/*
+ * Asynchronous engine. CECOpen() does not start it: while it runs, the
+ * engine thread owns the fd, so a client that still polls the fd from
+ * CECOpen() itself must leave it off. A client that wants callbacks calls
+ * CECEngineStart() after CECOpen(), and CECClose() stops it again.
+ * Receivers stay registered across CECClose()/CECOpen().
+ * Once started, CECSendMessage() and CECReceiveMessage() go through the
+ * engine's queues as well. Inside a callback CECSendMessage() queues the
+ * frame without waiting for the result; CECClose(), CECEngineStop() and
+ * CECAllocLogicalAddress() are refused there.
+ */
+typedef void (*CECTransmitCallback)(const unsigned char *buffer, int size, int result, void *priv);
+typedef void (*CECReceiveCallback)(const unsigned char *buffer, int size, void *priv);
+
+int CECEngineStart();
+void CECEngineStop();
+int CECQueueMessage(const unsigned char *buffer, int size, enum CECPriority priority,
+                    CECTransmitCallback callback, void *priv);
+int CECRegisterReceiver(int opcode, CECReceiveCallback callback, void *priv);
+void CECUnregisterReceiver(int id);
 int CECAllocLogicalAddress(int paddr, enum CECDeviceType devtype);
 int CECSendMessage(unsigned char *buffer, int size);
 int CECReceiveMessage(unsigned char *buffer, int size, long timeout);
@@ -71,3 +71,4 @@ LOCAL_MODULE_TAGS := eng
 LOCAL_MODULE := libdisplay
 include $(BUILD_SHARED_LIBRARY)
 
+include $(LOCAL_PATH)/test/Android.mk
@@ -28,3 +28,23 @@ int ExynosDisplay::set(hwc_display_contents_1_t *contents)
 void ExynosDisplay::freeMPP()
 {
 }
+
+/* see ExynosLayerSignatures::update() */
+bool ExynosDisplay::updateLayerSignatures(hwc_display_contents_1_t *contents,
+        size_t first, size_t last, int fbWindow)
+{
+    return mLayerSignatures.update(contents, first, last, fbWindow);
+}
+
+void ExynosDisplay::invalidateLayerSignatures()
+{
+    mLayerSignatures.invalidate();
+}
+
+void ExynosDisplay::dumpLayerSignatures(android::String8 &result, const char *name)
+{
+    result.appendFormat("    %s: frames %u / %u (partial %u), layers %u / %u\n", name,
+            mLayerSignatures.mStaticFrames, mLayerSignatures.mFrames,
+            mLayerSignatures.mPartialFrames, mLayerSignatures.mStaticLayers,
+            mLayerSignatures.mLayers);
+}
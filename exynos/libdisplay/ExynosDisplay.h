@@ -2,6 +2,7 @@
 #define EXYNOS_DISPLAY_H
 
 #include "ExynosHWC.h"
+#include "ExynosLayerSignature.h"
 
 class ExynosMPPModule;
 
@@ -16,6 +17,11 @@ class ExynosDisplay {
         virtual int set(hwc_display_contents_1_t *contents);
         virtual void freeMPP();
 
+        bool updateLayerSignatures(hwc_display_contents_1_t *contents,
+                size_t first, size_t last, int fbWindow);
+        void invalidateLayerSignatures();
+        void dumpLayerSignatures(android::String8 &result, const char *name);
+
         /* Fields */
         int                     mDisplayFd;
         int32_t                 mXres;
@@ -31,6 +37,8 @@ class ExynosDisplay {
         int                     mNumMPPs;
 
         struct exynos5_hwc_composer_device_1_t *mHwc;
+
+        ExynosLayerSignatures   mLayerSignatures;
 };
 
 #endif
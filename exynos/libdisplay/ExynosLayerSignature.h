@@ -0,0 +1,154 @@
+#ifndef EXYNOS_LAYER_SIGNATURE_H
+#define EXYNOS_LAYER_SIGNATURE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <hardware/hwcomposer.h>
+
+/*
+ * Static framebuffer layer detection shared by the primary, external and
+ * virtual displays. Kept free of the HWC device so it can be tested on the
+ * host.
+ */
+
+#define MAX_LAYER_SIGNATURES    32
+
+/* what a framebuffer layer looked like the last time it was composed */
+struct exynos_layer_signature {
+    buffer_handle_t handle;
+    hwc_frect_t     sourceCropf;
+    hwc_rect_t      displayFrame;
+    uint32_t        transform;
+    int32_t         blending;
+    uint8_t         planeAlpha;
+    uint32_t        age;
+};
+
+inline bool isSameLayerSignature(const exynos_layer_signature &a, const exynos_layer_signature &b)
+{
+    return a.handle == b.handle &&
+        a.sourceCropf.left == b.sourceCropf.left &&
+        a.sourceCropf.top == b.sourceCropf.top &&
+        a.sourceCropf.right == b.sourceCropf.right &&
+        a.sourceCropf.bottom == b.sourceCropf.bottom &&
+        a.displayFrame.left == b.displayFrame.left &&
+        a.displayFrame.top == b.displayFrame.top &&
+        a.displayFrame.right == b.displayFrame.right &&
+        a.displayFrame.bottom == b.displayFrame.bottom &&
+        a.transform == b.transform &&
+        a.blending == b.blending &&
+        a.planeAlpha == b.planeAlpha;
+}
+
+class ExynosLayerSignatures {
+    public:
+        ExynosLayerSignatures()
+        {
+            invalidate();
+            mFrames = 0;
+            mStaticFrames = 0;
+            mPartialFrames = 0;
+            mLayers = 0;
+            mStaticLayers = 0;
+        }
+
+        void invalidate()
+        {
+            mNumSignatures = 0;
+            mFbWindow = -1;
+            mValid = false;
+        }
+
+        /*
+         * Records the framebuffer layers in [first, last] and returns true
+         * when they match the previous frame one for one, i.e. the
+         * framebuffer target would be composed from exactly the same input
+         * and the last one can be shown again. A layer's age counts the
+         * frames it has been unchanged. It is looked up by handle, so layers
+         * keep their age when others are added, removed or move in and out
+         * of the framebuffer.
+         */
+        bool update(hwc_display_contents_1_t *contents, size_t first, size_t last, int fbWindow)
+        {
+            exynos_layer_signature signatures[MAX_LAYER_SIGNATURES];
+            size_t count = 0;
+            size_t run = 0, longestRun = 0;
+            /* a geometry change can move what SurfaceFlinger clears in the target */
+            bool isStatic = mValid && (mFbWindow == fbWindow) &&
+                    !(contents->flags & HWC_GEOMETRY_CHANGED);
+
+            for (size_t i = first; i <= last && i < contents->numHwLayers; i++) {
+                hwc_layer_1_t &layer = contents->hwLayers[i];
+
+                if (layer.compositionType != HWC_FRAMEBUFFER)
+                    continue;
+
+                if (count == MAX_LAYER_SIGNATURES) {
+                    invalidate();
+                    return false;
+                }
+
+                exynos_layer_signature &sig = signatures[count];
+                /* nothing is known about what a skipped layer showed */
+                sig.handle = (layer.flags & HWC_SKIP_LAYER) ? NULL : layer.handle;
+                sig.sourceCropf = layer.sourceCropf;
+                sig.displayFrame = layer.displayFrame;
+                sig.transform = layer.transform;
+                sig.blending = layer.blending;
+                sig.planeAlpha = layer.planeAlpha;
+                sig.age = 0;
+
+                if (sig.handle) {
+                    for (size_t j = 0; j < mNumSignatures; j++) {
+                        if (mSignatures[j].handle != sig.handle)
+                            continue;
+                        if (isSameLayerSignature(mSignatures[j], sig))
+                            sig.age = mSignatures[j].age + 1;
+                        break;
+                    }
+                }
+
+                if (!sig.age || count >= mNumSignatures ||
+                        !isSameLayerSignature(mSignatures[count], sig))
+                    isStatic = false;
+
+                if (sig.age) {
+                    mStaticLayers++;
+                    if (++run > longestRun)
+                        longestRun = run;
+                } else {
+                    run = 0;
+                }
+                mLayers++;
+                count++;
+            }
+
+            if (!count || count != mNumSignatures)
+                isStatic = false;
+
+            mFrames++;
+            if (isStatic)
+                mStaticFrames++;
+            else if (longestRun > 1)
+                mPartialFrames++;
+
+            memcpy(mSignatures, signatures, sizeof(exynos_layer_signature) * count);
+            mNumSignatures = count;
+            mFbWindow = fbWindow;
+            mValid = true;
+
+            return isStatic;
+        }
+
+        exynos_layer_signature  mSignatures[MAX_LAYER_SIGNATURES];
+        size_t                  mNumSignatures;
+        int                     mFbWindow;
+        bool                    mValid;
+        uint32_t                mFrames;
+        uint32_t                mStaticFrames;
+        uint32_t                mPartialFrames;
+        uint32_t                mLayers;
+        uint32_t                mStaticLayers;
+};
+
+#endif
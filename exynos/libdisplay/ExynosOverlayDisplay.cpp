@@ -16,6 +16,29 @@ ExynosOverlayDisplay::ExynosOverlayDisplay(int numMPPs, struct exynos5_hwc_compo
 
     mOtfMode = OTF_OFF;
     this->mHwc = pdev;
+#ifdef G2D_COMPOSITION
+    memset(mG2dDamage, 0, sizeof(mG2dDamage));
+    mG2dBlitPixels = 0;
+    mG2dFullPixels = 0;
+    mG2dDamageEnabled = false;
+    mG2dIonClient = -1;
+    mG2dDamageTime = 0;
+    mG2dDamageFrames = 0;
+    mG2dFullTime = 0;
+    mG2dFullFrames = 0;
+    memset(mWinBuf, 0, sizeof(mWinBuf));
+    memset(mWinBufVirtualAddress, 0, sizeof(mWinBufVirtualAddress));
+    memset(mWinBufWidth, 0, sizeof(mWinBufWidth));
+    memset(mWinBufHeight, 0, sizeof(mWinBufHeight));
+    mG2dMemoryAllocated = 0;
+    mAllocatedLayers = 0;
+    pthread_mutex_init(&mG2dPoolLock, NULL);
+    mG2dPoolThreadStarted = false;
+    mG2dPoolBusy = false;
+    mG2dPoolRequest = 0;
+    mG2dPoolWindows = 0;
+    mG2dPoolWaiting = false;
+#endif
 }
 
 ExynosOverlayDisplay::~ExynosOverlayDisplay()
@@ -23,6 +46,13 @@ ExynosOverlayDisplay::~ExynosOverlayDisplay()
     for (int i = 0; i < mNumMPPs; i++)
         delete mMPPs[i];
     delete[] mMPPs;
+#ifdef G2D_COMPOSITION
+    if (mG2dPoolThreadStarted)
+        pthread_join(mG2dPoolThread, NULL);
+    pthread_mutex_destroy(&mG2dPoolLock);
+    if (mG2dIonClient >= 0)
+        ion_client_destroy(mG2dIonClient);
+#endif
 }
 
 bool ExynosOverlayDisplay::isOverlaySupported(hwc_layer_1_t &layer, size_t i)
@@ -210,10 +240,12 @@ CHANGE_COMPOS_MODE:
     }
 #endif
 
-    if (mPopupPlayYuvContents)
+    if (mPopupPlayYuvContents) {
         mVirtualOverlayFlag = 0;
-    else
+        invalidateLayerSignatures();
+    } else {
         skipStaticLayers(contents);
+    }
     if (mVirtualOverlayFlag)
         mFbNeeded = 0;
 
@@ -638,20 +670,13 @@ int32_t ExynosOverlayDisplay::getDisplayAttributes(const uint32_t attribute)
 
 void ExynosOverlayDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
 {
-    static int init_flag = 0;
     int last_ovly_lay_idx = -1;
 
     mVirtualOverlayFlag = 0;
     mLastOverlayWindowIndex = -1;
 
-    if (!mHwc->hwc_ctrl.skip_static_layer_mode)
-        return;
-
-    if (mBypassSkipStaticLayer)
-        return;
-
-    if (contents->flags & HWC_GEOMETRY_CHANGED) {
-        init_flag = 0;
+    if (!mHwc->hwc_ctrl.skip_static_layer_mode || mBypassSkipStaticLayer) {
+        invalidateLayerSignatures();
         return;
     }
 
@@ -664,40 +689,21 @@ void ExynosOverlayDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
 
     if ((last_ovly_lay_idx == -1) || !mFbNeeded ||
         ((mLastFb - mFirstFb + 1) > NUM_VIRT_OVER)) {
-        init_flag = 0;
+        invalidateLayerSignatures();
         return;
     }
     mLastOverlayLayerIndex = last_ovly_lay_idx;
 
-    if (init_flag == 1) {
-        for (size_t i = mFirstFb; i <= mLastFb; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (!layer.handle || (layer.flags & HWC_SKIP_LAYER) || (mLastLayerHandles[i - mFirstFb] !=  layer.handle)) {
-                init_flag = 0;
-                return;
-            }
-        }
-
-        mVirtualOverlayFlag = 1;
-        for (size_t i = 0; i < contents->numHwLayers-1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (layer.compositionType == HWC_FRAMEBUFFER)
-                layer.compositionType = HWC_OVERLAY;
-        }
-        mLastFbWindow = mPostData.fb_window;
+    if (!updateLayerSignatures(contents, mFirstFb, mLastFb, mPostData.fb_window))
         return;
-    }
-
-    init_flag = 1;
-    for (size_t i = 0; i < NUM_VIRT_OVER; i++)
-        mLastLayerHandles[i] = 0;
 
-    for (size_t i = mFirstFb; i <= mLastFb; i++) {
+    mVirtualOverlayFlag = 1;
+    for (size_t i = 0; i < contents->numHwLayers-1; i++) {
         hwc_layer_1_t &layer = contents->hwLayers[i];
-        mLastLayerHandles[i - mFirstFb] = layer.handle;
+        if (layer.compositionType == HWC_FRAMEBUFFER)
+            layer.compositionType = HWC_OVERLAY;
     }
-
-    return;
+    mLastFbWindow = mPostData.fb_window;
 }
 
 void ExynosOverlayDisplay::forceYuvLayersToFb(hwc_display_contents_1_t *contents)
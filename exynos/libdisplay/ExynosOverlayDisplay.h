@@ -42,8 +42,31 @@ class ExynosOverlayDisplay : public ExynosDisplay {
         int                      mG2dCurrentBuffer[NUM_HW_WINDOWS];
         uint32_t	             mLastG2dLayerHandle[NUM_HW_WINDOWS];
         uint32_t                 mWinBufMapSize[NUM_HW_WINDOWS];
+        int                      mWinBufWidth[NUM_HW_WINDOWS];
+        int                      mWinBufHeight[NUM_HW_WINDOWS];
         int                      mG2dMemoryAllocated;
         int                      mG2dBypassCount;
+        exynos5_g2d_damage_t     mG2dDamage[NUM_HW_WINDOWS];
+        uint64_t                 mG2dBlitPixels;
+        uint64_t                 mG2dFullPixels;
+        /* damage tracking is off unless debug.hwc.g2d_damage is set */
+        bool                     mG2dDamageEnabled;
+        int                      mG2dIonClient;
+        nsecs_t                  mG2dDamageTime;
+        uint32_t                 mG2dDamageFrames;
+        nsecs_t                  mG2dFullTime;
+        uint32_t                 mG2dFullFrames;
+        /* window buffer pool, mWinBuf[0..mG2dPoolWindows) are allocated and mapped */
+        pthread_mutex_t          mG2dPoolLock;
+        pthread_t                mG2dPoolThread;
+        bool                     mG2dPoolThreadStarted;
+        bool                     mG2dPoolBusy;
+        int                      mG2dPoolRequest;
+        int                      mG2dPoolRequestWidth[NUM_HW_WINDOWS];
+        int                      mG2dPoolRequestHeight[NUM_HW_WINDOWS];
+        int                      mG2dPoolWindows;
+        /* this frame wanted G2D but the pool was not ready yet */
+        bool                     mG2dPoolWaiting;
 #endif
 #endif
 
@@ -51,7 +74,6 @@ class ExynosOverlayDisplay : public ExynosDisplay {
         size_t                   mLastFbWindow;
         const void               *mLastHandles[NUM_HW_WINDOWS];
         exynos5_gsc_map_t        mLastGscMap[NUM_HW_WINDOWS];
-        const void               *mLastLayerHandles[NUM_VIRT_OVER];
         int                      mLastOverlayWindowIndex;
         int                      mLastOverlayLayerIndex;
         int                      mVirtualOverlayFlag;
@@ -0,0 +1,194 @@
+/*
+ * Host test and replay of the static framebuffer layer detection
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ExynosLayerSignature.h"
+
+#define TEST_MAX_LAYERS     8
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+/* only compared, any distinct address will do */
+static native_handle_t handles[16];
+
+static hwc_display_contents_1_t *createContents()
+{
+    size_t size = sizeof(hwc_display_contents_1_t) + sizeof(hwc_layer_1_t) * TEST_MAX_LAYERS;
+    hwc_display_contents_1_t *contents = (hwc_display_contents_1_t *)calloc(1, size);
+
+    return contents;
+}
+
+static void setLayer(hwc_display_contents_1_t *contents, size_t i, int handle, int top, int compositionType)
+{
+    hwc_layer_1_t &layer = contents->hwLayers[i];
+
+    memset(&layer, 0, sizeof(layer));
+    layer.compositionType = compositionType;
+    layer.handle = &handles[handle];
+    layer.sourceCropf.right = 100;
+    layer.sourceCropf.bottom = 50;
+    layer.displayFrame.top = top;
+    layer.displayFrame.right = 100;
+    layer.displayFrame.bottom = top + 50;
+    layer.planeAlpha = 0xff;
+    if (contents->numHwLayers <= i)
+        contents->numHwLayers = i + 1;
+}
+
+static void testStatic()
+{
+    hwc_display_contents_1_t *contents = createContents();
+    ExynosLayerSignatures sigs;
+
+    setLayer(contents, 0, 0, 0, HWC_FRAMEBUFFER);
+    setLayer(contents, 1, 1, 50, HWC_FRAMEBUFFER);
+    setLayer(contents, 2, 2, 100, HWC_FRAMEBUFFER_TARGET);
+
+    /* nothing to compare with on the first frame */
+    CHECK(!sigs.update(contents, 0, 1, 0));
+    CHECK(sigs.update(contents, 0, 1, 0));
+    CHECK(sigs.update(contents, 0, 1, 0));
+    CHECK(sigs.mSignatures[0].age == 2);
+
+    /* the framebuffer moved to another window */
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    CHECK(sigs.update(contents, 0, 1, 1));
+
+    /* geometry changes always recompose */
+    contents->flags = HWC_GEOMETRY_CHANGED;
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    contents->flags = 0;
+    CHECK(sigs.update(contents, 0, 1, 1));
+
+    /* any property of a layer counts */
+    contents->hwLayers[1].planeAlpha = 0x80;
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    CHECK(sigs.mSignatures[0].age > 0);
+    CHECK(sigs.mSignatures[1].age == 0);
+    CHECK(sigs.update(contents, 0, 1, 1));
+
+    contents->hwLayers[1].transform = HAL_TRANSFORM_ROT_90;
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    CHECK(sigs.update(contents, 0, 1, 1));
+
+    contents->hwLayers[1].sourceCropf.top = 1;
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    CHECK(sigs.update(contents, 0, 1, 1));
+
+    /* skip layers are never static, nor on the frame after they stop skipping */
+    contents->hwLayers[0].flags = HWC_SKIP_LAYER;
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    contents->hwLayers[0].flags = 0;
+
+    /* after an invalidate the next frame recomposes */
+    CHECK(!sigs.update(contents, 0, 1, 1));
+    CHECK(sigs.update(contents, 0, 1, 1));
+    sigs.invalidate();
+    CHECK(!sigs.update(contents, 0, 1, 1));
+
+    free(contents);
+}
+
+/* a layer keeps its age when another one leaves the framebuffer */
+static void testAge()
+{
+    hwc_display_contents_1_t *contents = createContents();
+    ExynosLayerSignatures sigs;
+
+    setLayer(contents, 0, 0, 0, HWC_FRAMEBUFFER);
+    setLayer(contents, 1, 1, 50, HWC_FRAMEBUFFER);
+    setLayer(contents, 2, 2, 100, HWC_FRAMEBUFFER);
+
+    sigs.update(contents, 0, 2, 0);
+    sigs.update(contents, 0, 2, 0);
+
+    contents->hwLayers[0].compositionType = HWC_OVERLAY;
+    CHECK(!sigs.update(contents, 0, 2, 0));
+    CHECK(sigs.mNumSignatures == 2);
+    CHECK(sigs.mSignatures[0].handle == &handles[1]);
+    CHECK(sigs.mSignatures[0].age == 2);
+    CHECK(sigs.mSignatures[1].age == 2);
+
+    /* a new buffer in the middle restarts only that layer */
+    contents->hwLayers[1].handle = &handles[5];
+    CHECK(!sigs.update(contents, 0, 2, 0));
+    CHECK(sigs.mSignatures[0].age == 0);
+    CHECK(sigs.mSignatures[1].age == 3);
+
+    free(contents);
+}
+
+/*
+ * Replays a launcher with a clock: wallpaper, icons and status bar stay, the
+ * clock layer gets a new buffer every 60 frames and a dialog fades in and
+ * out once. Reports how much could be reused.
+ */
+static void testReplay()
+{
+    hwc_display_contents_1_t *contents = createContents();
+    ExynosLayerSignatures sigs;
+    int frames = 600;
+    int staticFrames = 0;
+
+    setLayer(contents, 0, 0, 0, HWC_FRAMEBUFFER);      /* wallpaper */
+    setLayer(contents, 1, 1, 50, HWC_FRAMEBUFFER);     /* icons */
+    setLayer(contents, 2, 2, 100, HWC_FRAMEBUFFER);    /* clock */
+    setLayer(contents, 3, 4, 150, HWC_FRAMEBUFFER);    /* status bar */
+
+    for (int frame = 0; frame < frames; frame++) {
+        if (frame % 60 == 0)
+            contents->hwLayers[2].handle = &handles[(frame / 60) % 2 ? 2 : 3];
+
+        /* dialog fade between 200 and 230 */
+        if (frame >= 200 && frame < 230) {
+            setLayer(contents, 4, 6, 20, HWC_FRAMEBUFFER);
+            contents->hwLayers[4].planeAlpha = (frame - 200) * 8;
+        } else {
+            contents->numHwLayers = 4;
+        }
+
+        if (sigs.update(contents, 0, contents->numHwLayers - 1, 0))
+            staticFrames++;
+    }
+
+    printf("layer replay: frames %u / %u (partial %u), layers %u / %u\n",
+            sigs.mStaticFrames, sigs.mFrames, sigs.mPartialFrames,
+            sigs.mStaticLayers, sigs.mLayers);
+    CHECK(sigs.mFrames == (uint32_t)frames);
+    CHECK(sigs.mStaticFrames == (uint32_t)staticFrames);
+    /* 10 clock ticks counting the first frame, 30 fade frames and the frame after it */
+    CHECK(staticFrames == frames - 10 - 30 - 1);
+    CHECK(sigs.mPartialFrames == 10 + 30);
+
+    free(contents);
+}
+
+int main()
+{
+    testStatic();
+    testAge();
+    testReplay();
+
+    if (failCount != 0) {
+        printf("ExynosLayerSignature_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+
+    printf("ExynosLayerSignature_test: pass\n");
+    return 0;
+}
@@ -49,6 +49,11 @@ ExynosExternalDisplay::ExynosExternalDisplay(struct exynos5_hwc_composer_device_
     mNumMPPs = 1;
     mOtfMode = OTF_OFF;
     mUseSubtitles = false;
+    memset(mSinkCache, 0, sizeof(mSinkCache));
+    mCurrentSink = -1;
+    mNextSink = 0;
+    pthread_mutex_init(&mSinkLock, NULL);
+    mHotplugTime = 0;
 
     for (size_t i = 0; i < MAX_NUM_HDMI_DMA_CH; i++) {
         mDmaChannelMaxBandwidth[i] = HDMI_DMA_CH_BW_SET[i];
@@ -59,6 +64,7 @@ ExynosExternalDisplay::ExynosExternalDisplay(struct exynos5_hwc_composer_device_
 ExynosExternalDisplay::~ExynosExternalDisplay()
 {
     delete mMPPs[0];
+    pthread_mutex_destroy(&mSinkLock);
 }
 
 bool ExynosExternalDisplay::isOverlaySupported(hwc_layer_1_t &layer, size_t i)
@@ -315,6 +321,12 @@ int ExynosExternalDisplay::postFrame(hwc_display_contents_1_t* contents)
         return ret;
     }
 
+    if (mHotplugTime) {
+        ALOGI("HDMI first frame %lld us after hotplug",
+                (long long)ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - mHotplugTime));
+        mHotplugTime = 0;
+    }
+
     if (mGscLayers < MAX_HDMI_VIDEO_LAYERS) {
         cleanupGscs();
     }
@@ -432,20 +444,13 @@ int ExynosExternalDisplay::set(hwc_display_contents_1_t* contents)
 
 void ExynosExternalDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
 {
-    static int init_flag = 0;
     int last_ovly_lay_idx = -1;
 
     mVirtualOverlayFlag = 0;
     mLastOverlayWindowIndex = -1;
 
-    if (!mHwc->hwc_ctrl.skip_static_layer_mode)
-        return;
-
-    if (mBypassSkipStaticLayer)
-        return;
-
-    if (contents->flags & HWC_GEOMETRY_CHANGED) {
-        init_flag = 0;
+    if (!mHwc->hwc_ctrl.skip_static_layer_mode || mBypassSkipStaticLayer) {
+        invalidateLayerSignatures();
         return;
     }
 
@@ -458,38 +463,22 @@ void ExynosExternalDisplay::skipStaticLayers(hwc_display_contents_1_t* contents)
 
     if ((last_ovly_lay_idx == -1) || ((uint32_t)last_ovly_lay_idx >= (contents->numHwLayers - 2)) ||
         ((contents->numHwLayers - last_ovly_lay_idx - 1) >= NUM_VIRT_OVER)) {
-        init_flag = 0;
+        invalidateLayerSignatures();
         return;
     }
     mLastOverlayLayerIndex = last_ovly_lay_idx;
     last_ovly_lay_idx++;
-    if (init_flag == 1) {
-        for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers -1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (!layer.handle || (layer.flags & HWC_SKIP_LAYER) || (mLastLayerHandles[i - last_ovly_lay_idx] !=  layer.handle)) {
-                init_flag = 0;
-                return;
-            }
-        }
 
-        mVirtualOverlayFlag = 1;
-        for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers-1; i++) {
-            hwc_layer_1_t &layer = contents->hwLayers[i];
-            if (layer.compositionType == HWC_FRAMEBUFFER)
-                layer.compositionType = HWC_OVERLAY;
-        }
+    if (!updateLayerSignatures(contents, last_ovly_lay_idx, contents->numHwLayers - 2,
+                mPostData.fb_window))
         return;
-    }
 
-    init_flag = 1;
-    for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers; i++) {
+    mVirtualOverlayFlag = 1;
+    for (size_t i = last_ovly_lay_idx; i < contents->numHwLayers-1; i++) {
         hwc_layer_1_t &layer = contents->hwLayers[i];
-        mLastLayerHandles[i - last_ovly_lay_idx] = layer.handle;
+        if (layer.compositionType == HWC_FRAMEBUFFER)
+            layer.compositionType = HWC_OVERLAY;
     }
-    for (size_t i = contents->numHwLayers - last_ovly_lay_idx; i < NUM_VIRT_OVER; i++)
-        mLastLayerHandles[i] = 0;
-
-    return;
 }
 
 void ExynosExternalDisplay::determineYuvOverlay(hwc_display_contents_1_t *contents)
@@ -878,28 +867,24 @@ void ExynosExternalDisplay::setHdmiStatus(bool status)
         disable();
 }
 
-bool ExynosExternalDisplay::isPresetSupported(unsigned int preset)
+int ExynosExternalDisplay::identifySink()
 {
-    bool found = false;
-    int index = 0;
-    int ret = 0;
     exynos_hdmi_data hdmi_data;
-    int dv_timings_index = getDVTimingsIndex(preset);
-
-    if (dv_timings_index < 0) {
-        ALOGE("%s: unsupported preset, %d", __func__, preset);
-        return -1;
-    }
+    uint32_t id = HDMI_SINK_HASH_INIT;
+    uint32_t supported = 0;
+    int index = 0;
+    int sink;
 
     hdmi_data.state = hdmi_data.EXYNOS_HDMI_STATE_ENUM_PRESET;
     while (true) {
         hdmi_data.etimings.index = index++;
-        ret = ioctl(this->mDisplayFd, EXYNOS_GET_HDMI_CONFIG, &hdmi_data);
-
-        if (ret < 0) {
+        if (ioctl(this->mDisplayFd, EXYNOS_GET_HDMI_CONFIG, &hdmi_data) < 0) {
             if (errno == EINVAL)
                 break;
             ALOGE("%s: enum_dv_timings error, %d", __func__, errno);
+            pthread_mutex_lock(&mSinkLock);
+            mCurrentSink = -1;
+            pthread_mutex_unlock(&mSinkLock);
             return -1;
         }
 
@@ -907,15 +892,97 @@ bool ExynosExternalDisplay::isPresetSupported(unsigned int preset)
                 __func__, hdmi_data.etimings.index,
                 hdmi_data.etimings.timings.bt.width, hdmi_data.etimings.timings.bt.height);
 
-        if (is_same_dv_timings(&hdmi_data.etimings.timings, &dv_timings[dv_timings_index])) {
-            mXres  = hdmi_data.etimings.timings.bt.width;
-            mYres  = hdmi_data.etimings.timings.bt.height;
-            found = true;
-            mHwc->mHdmiCurrentPreset = preset;
-            break;
+        id = hdmiSinkHashTiming(id, hdmi_data.etimings.timings.bt);
+        for (int i = 0; i < SUPPORTED_DV_TIMINGS_NUM; i++) {
+            int dv_timings_index = preset_index_mappings[i].dv_timings_index;
+            if (is_same_dv_timings(&hdmi_data.etimings.timings, &dv_timings[dv_timings_index]))
+                supported |= 1 << dv_timings_index;
         }
     }
-    return found;
+
+    pthread_mutex_lock(&mSinkLock);
+    bool isNew;
+    sink = hdmiSinkCacheLookup(mSinkCache, &mNextSink, id, HDMI_PRESET_ERROR, &isNew);
+    if (isNew)
+        ALOGD("%s: new sink %08x, %d timings", __func__, id, index - 1);
+    else
+        ALOGD("%s: known sink %08x, last preset %d", __func__, id, mSinkCache[sink].lastPreset);
+    mSinkCache[sink].supported = supported;
+    mCurrentSink = sink;
+    pthread_mutex_unlock(&mSinkLock);
+
+    return sink;
+}
+
+bool ExynosExternalDisplay::isPresetSupported(unsigned int preset)
+{
+    int dv_timings_index = getDVTimingsIndex(preset);
+
+    if (dv_timings_index < 0) {
+        ALOGE("%s: unsupported preset, %d", __func__, preset);
+        return false;
+    }
+
+    /* the uevent thread may drop the sink at any time, work on a copy */
+    pthread_mutex_lock(&mSinkLock);
+    int sink = mCurrentSink;
+    pthread_mutex_unlock(&mSinkLock);
+    if (sink < 0 && (sink = identifySink()) < 0)
+        return false;
+
+    pthread_mutex_lock(&mSinkLock);
+    uint32_t supported = mSinkCache[sink].supported;
+    pthread_mutex_unlock(&mSinkLock);
+    if (!(supported & (1 << dv_timings_index)))
+        return false;
+
+    mXres = dv_timings[dv_timings_index].bt.width;
+    mYres = dv_timings[dv_timings_index].bt.height;
+    mHwc->mHdmiCurrentPreset = preset;
+    return true;
+}
+
+void ExynosExternalDisplay::hotplugSink(bool connected)
+{
+    if (!connected) {
+        pthread_mutex_lock(&mSinkLock);
+        mCurrentSink = -1;
+        pthread_mutex_unlock(&mSinkLock);
+        mHotplugTime = 0;
+        return;
+    }
+
+    mHotplugTime = systemTime(SYSTEM_TIME_MONOTONIC);
+    int sink = identifySink();
+    if (sink < 0)
+        return;
+
+    pthread_mutex_lock(&mSinkLock);
+    int preset = mSinkCache[sink].lastPreset;
+    uint32_t supported = mSinkCache[sink].supported;
+    pthread_mutex_unlock(&mSinkLock);
+
+    /* SurfaceFlinger has not been told yet, so the mode can change for free */
+    if (mEnabled || preset == HDMI_PRESET_ERROR || preset == mHwc->mHdmiCurrentPreset)
+        return;
+
+    int dv_timings_index = getDVTimingsIndex(preset);
+    if (dv_timings_index < 0 || !(supported & (1 << dv_timings_index)))
+        return;
+
+    exynos_hdmi_data hdmi_data;
+    hdmi_data.state = hdmi_data.EXYNOS_HDMI_STATE_PRESET;
+    hdmi_data.timings = dv_timings[dv_timings_index];
+    if (ioctl(this->mDisplayFd, EXYNOS_SET_HDMI_CONFIG, &hdmi_data) < 0) {
+        ALOGE("%s: failed to restore preset %d, %d", __func__, preset, errno);
+        return;
+    }
+
+    mXres = dv_timings[dv_timings_index].bt.width;
+    mYres = dv_timings[dv_timings_index].bt.height;
+    mHwc->mHdmiCurrentPreset = preset;
+    mHwc->mHdmiPreset = preset;
+    ALOGI("HDMI restored last resolution %dx%d", mXres, mYres);
 }
 
 int ExynosExternalDisplay::getConfig()
@@ -1010,11 +1077,44 @@ void ExynosExternalDisplay::setPreset(int preset)
         return;
     }
 
-    disable();
-
     exynos_hdmi_data hdmi_data;
     hdmi_data.state = hdmi_data.EXYNOS_HDMI_STATE_PRESET;
     hdmi_data.timings = dv_timings[dv_timings_index];
+
+    if (mHwc->mS3DMode == S3D_MODE_DISABLED) {
+        pthread_mutex_lock(&mSinkLock);
+        if (mCurrentSink >= 0)
+            mSinkCache[mCurrentSink].lastPreset = preset;
+        pthread_mutex_unlock(&mSinkLock);
+
+        /*
+         * Same frame size, scan type and refresh rate in 2D: the GSC and
+         * window setup stay valid and SurfaceFlinger does not need a hotplug
+         * cycle, only the timing changes underneath. A new refresh rate
+         * goes through the full path so SurfaceFlinger picks up the new
+         * vsync period. isPresetSupported() already moved mXres and
+         * mYres to the new preset, so ask the driver what is on the wire.
+         */
+        exynos_hdmi_data current;
+        current.state = current.EXYNOS_HDMI_STATE_PRESET;
+        if (mEnabled &&
+                ioctl(this->mDisplayFd, EXYNOS_GET_HDMI_CONFIG, &current) == 0 &&
+                hdmiCanSwitchInPlace(current.timings.bt, hdmi_data.timings.bt)) {
+            blank();
+            if (ioctl(this->mDisplayFd, EXYNOS_SET_HDMI_CONFIG, &hdmi_data) < 0)
+                ALOGE("%s: failed to set preset %d, %d", __func__, preset, errno);
+            else
+                mHwc->mHdmiCurrentPreset = preset;
+            if (ioctl(this->mDisplayFd, FBIOBLANK, FB_BLANK_UNBLANK) < 0 && errno != EBUSY)
+                ALOGE("%s: unblank ioctl failed: %s", __func__, strerror(errno));
+            mHwc->hdmi_hpd = true;
+            mHwc->mHdmiResolutionHandled = true;
+            return;
+        }
+    }
+
+    disable();
+
     if (ioctl(this->mDisplayFd, EXYNOS_SET_HDMI_CONFIG, &hdmi_data) != -1) {
         if (mHwc->procs)
             mHwc->procs->hotplug(mHwc->procs, HWC_DISPLAY_EXTERNAL, false);
@@ -5,6 +5,7 @@
 #include "ExynosDisplay.h"
 #include "../../exynos/kernel-3.10-headers/videodev2.h"
 #include "../../exynos/kernel-3.10-headers/v4l2-dv-timings.h"
+#include "ExynosHdmiSink.h"
 
 #define NUM_VIRT_OVER_HDMI 5
 #define MAX_HDMI_VIDEO_LAYERS 1
@@ -69,6 +70,7 @@ class ExynosExternalDisplay : public ExynosDisplay {
         void setAudioChannel(uint32_t channels);
         uint32_t getAudioChannel();
         int getCecPaddr();
+        void hotplugSink(bool connected);
 
         virtual int openHdmi();
         virtual int blank();
@@ -81,7 +83,6 @@ class ExynosExternalDisplay : public ExynosDisplay {
         bool                    mEnabled;
         bool                    mBlanked;
 
-        const void              *mLastLayerHandles[NUM_VIRT_OVER_HDMI];
         int                     mVirtualOverlayFlag;
 
         exynos5_hwc_post_data_t  mPostData;
@@ -106,6 +107,12 @@ class ExynosExternalDisplay : public ExynosDisplay {
         const void               *mLastHandles[NUM_HDMI_WINDOWS];
         bool                    mUseSubtitles;
 
+        struct hdmi_sink_info   mSinkCache[HDMI_SINK_CACHE_NUM];
+        int                     mCurrentSink;
+        int                     mNextSink;
+        pthread_mutex_t         mSinkLock;      /* guards the three above */
+        nsecs_t                 mHotplugTime;
+
     protected:
         void determineYuvOverlay(hwc_display_contents_1_t *contents);
         void determineSupportedOverlays(hwc_display_contents_1_t *contents);
@@ -121,6 +128,7 @@ class ExynosExternalDisplay : public ExynosDisplay {
         void cleanupGscs();
         int clearDisplay();
         int getDVTimingsIndex(int preset);
+        int identifySink();
 
         //virtual void configureOverlay(hwc_layer_1_t *layer, s3c_fb_win_config &cfg);
         //virtual bool isOverlaySupported(hwc_layer_1_t &layer, size_t i);
@@ -0,0 +1,93 @@
+#ifndef EXYNOS_HDMI_SINK_H
+#define EXYNOS_HDMI_SINK_H
+
+#include <stdint.h>
+#include "../../exynos/kernel-3.10-headers/videodev2.h"
+
+/*
+ * Sink identification and timing rules of the decon_tv HDMI path. Kept free
+ * of the driver so they can be tested on the host, ExynosExternalDisplay
+ * runs the ioctls.
+ */
+
+#define HDMI_SINK_CACHE_NUM     4
+#define HDMI_SINK_HASH_INIT     2166136261U
+#define HDMI_SINK_HASH_PRIME    16777619U
+
+/* timings a sink offered, kept across unplug so a known TV reconnects fast */
+struct hdmi_sink_info {
+    bool        valid;
+    uint32_t    id;
+    uint32_t    supported;      /* bit per dv_timings index */
+    int         lastPreset;
+};
+
+/*
+ * decon_tv has no EDID query, so a sink is told apart by the timing list the
+ * driver built from its EDID. Fold each enumerated timing in order, starting
+ * from HDMI_SINK_HASH_INIT.
+ */
+inline uint32_t hdmiSinkHashTiming(uint32_t hash, const struct v4l2_bt_timings &bt)
+{
+    const uint32_t fields[] = {
+        bt.width, bt.height, bt.interlaced, bt.polarities,
+        (uint32_t)bt.pixelclock, (uint32_t)(bt.pixelclock >> 32),
+        bt.hfrontporch, bt.hsync, bt.hbackporch,
+        bt.vfrontporch, bt.vsync, bt.vbackporch,
+    };
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+        hash = (hash ^ fields[i]) * HDMI_SINK_HASH_PRIME;
+    return hash;
+}
+
+/*
+ * Returns the cache slot of sink id. An unknown sink takes the slot at *next,
+ * oldest first, with no last preset; *isNew tells the two apart.
+ */
+inline int hdmiSinkCacheLookup(struct hdmi_sink_info *cache, int *next, uint32_t id,
+        int nonePreset, bool *isNew)
+{
+    for (int i = 0; i < HDMI_SINK_CACHE_NUM; i++) {
+        if (cache[i].valid && cache[i].id == id) {
+            *isNew = false;
+            return i;
+        }
+    }
+
+    int sink = *next;
+    *next = (*next + 1) % HDMI_SINK_CACHE_NUM;
+    cache[sink].valid = true;
+    cache[sink].id = id;
+    cache[sink].supported = 0;
+    cache[sink].lastPreset = nonePreset;
+    *isNew = true;
+    return sink;
+}
+
+/* frames per 1000 seconds, blanking included */
+inline uint32_t hdmiRefreshMilliHz(const struct v4l2_bt_timings &bt)
+{
+    uint64_t htotal = bt.width + bt.hfrontporch + bt.hsync + bt.hbackporch;
+    uint64_t vtotal = bt.height + bt.vfrontporch + bt.vsync + bt.vbackporch;
+
+    if (bt.interlaced)
+        vtotal += bt.il_vfrontporch + bt.il_vsync + bt.il_vbackporch;
+    if (!htotal || !vtotal)
+        return 0;
+    return (uint32_t)((bt.pixelclock * 1000 + htotal * vtotal / 2) / (htotal * vtotal));
+}
+
+/*
+ * A preset can be switched under a blank, without a hotplug cycle, only when
+ * nothing SurfaceFlinger sees changes: frame size, scan type and refresh rate.
+ */
+inline bool hdmiCanSwitchInPlace(const struct v4l2_bt_timings &cur, const struct v4l2_bt_timings &next)
+{
+    return cur.width == next.width &&
+            cur.height == next.height &&
+            cur.interlaced == next.interlaced &&
+            hdmiRefreshMilliHz(cur) == hdmiRefreshMilliHz(next);
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Host test of the HDMI sink hash, sink cache and in-place preset switch
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ExynosHdmiSink.h"
+#include "../../kernel-3.10-headers/v4l2-dv-timings.h"
+
+#define TEST_PRESET_NONE    -1
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+static const struct v4l2_dv_timings t480p = V4L2_DV_BT_CEA_720X480P59_94;
+static const struct v4l2_dv_timings t720p50 = V4L2_DV_BT_CEA_1280X720P50;
+static const struct v4l2_dv_timings t720p60 = V4L2_DV_BT_CEA_1280X720P60;
+static const struct v4l2_dv_timings t1080i60 = V4L2_DV_BT_CEA_1920X1080I60;
+static const struct v4l2_dv_timings t1080p50 = V4L2_DV_BT_CEA_1920X1080P50;
+static const struct v4l2_dv_timings t1080p60 = V4L2_DV_BT_CEA_1920X1080P60;
+
+/* what identifySink() folds while enumerating the driver's list */
+static uint32_t hashSink(const struct v4l2_dv_timings *const *list, int num)
+{
+    uint32_t id = HDMI_SINK_HASH_INIT;
+
+    for (int i = 0; i < num; i++)
+        id = hdmiSinkHashTiming(id, list[i]->bt);
+    return id;
+}
+
+static void testHash()
+{
+    const struct v4l2_dv_timings *tvA[] = {&t480p, &t720p60, &t1080p60};
+    const struct v4l2_dv_timings *tvA2[] = {&t480p, &t720p60, &t1080p60};
+    const struct v4l2_dv_timings *tvB[] = {&t480p, &t720p60, &t1080p60, &t1080p50};
+    const struct v4l2_dv_timings *tvC[] = {&t480p, &t1080p60, &t720p60};
+    const struct v4l2_dv_timings *tvD[] = {&t480p, &t720p50, &t1080p60};
+
+    CHECK(hashSink(tvA, 3) == hashSink(tvA2, 3));
+    CHECK(hashSink(tvA, 3) != hashSink(tvB, 4));
+    CHECK(hashSink(tvA, 3) != hashSink(tvC, 3));
+    CHECK(hashSink(tvA, 3) != hashSink(tvD, 3));
+    CHECK(hashSink(tvA, 3) != HDMI_SINK_HASH_INIT);
+
+    /* a sink that only differs in the pixel clock of one mode */
+    struct v4l2_dv_timings t1080p59 = t1080p60;
+    t1080p59.bt.pixelclock = 148351648;
+    const struct v4l2_dv_timings *tvE[] = {&t480p, &t720p60, &t1080p59};
+    CHECK(hashSink(tvA, 3) != hashSink(tvE, 3));
+}
+
+static void testCache()
+{
+    struct hdmi_sink_info cache[HDMI_SINK_CACHE_NUM];
+    int next = 0;
+    bool isNew;
+
+    memset(cache, 0, sizeof(cache));
+
+    int a = hdmiSinkCacheLookup(cache, &next, 0xa, TEST_PRESET_NONE, &isNew);
+    CHECK(isNew && a == 0);
+    CHECK(cache[a].lastPreset == TEST_PRESET_NONE);
+    cache[a].lastPreset = 5;
+    cache[a].supported = 0x8;
+
+    CHECK(hdmiSinkCacheLookup(cache, &next, 0xa, TEST_PRESET_NONE, &isNew) == a && !isNew);
+    CHECK(cache[a].lastPreset == 5);
+
+    for (uint32_t id = 0xb; id < 0xb + HDMI_SINK_CACHE_NUM - 1; id++) {
+        hdmiSinkCacheLookup(cache, &next, id, TEST_PRESET_NONE, &isNew);
+        CHECK(isNew);
+    }
+    CHECK(hdmiSinkCacheLookup(cache, &next, 0xa, TEST_PRESET_NONE, &isNew) == a && !isNew);
+
+    /* one sink too many pushes out the oldest */
+    int e = hdmiSinkCacheLookup(cache, &next, 0xe, TEST_PRESET_NONE, &isNew);
+    CHECK(isNew && e == a);
+    CHECK(cache[e].lastPreset == TEST_PRESET_NONE && cache[e].supported == 0);
+    hdmiSinkCacheLookup(cache, &next, 0xa, TEST_PRESET_NONE, &isNew);
+    CHECK(isNew);
+}
+
+static void testSwitchInPlace()
+{
+    CHECK(hdmiRefreshMilliHz(t1080p60.bt) == 60000);
+    CHECK(hdmiRefreshMilliHz(t1080p50.bt) == 50000);
+    CHECK(hdmiRefreshMilliHz(t720p60.bt) == 60000);
+    CHECK(hdmiRefreshMilliHz(t480p.bt) == 59940);
+
+    struct v4l2_dv_timings t1080p59 = t1080p60;
+    t1080p59.bt.pixelclock = 148351648;
+    CHECK(hdmiRefreshMilliHz(t1080p59.bt) == 59940);
+
+    /* another sync polarity keeps everything SurfaceFlinger sees */
+    struct v4l2_dv_timings t1080p60neg = t1080p60;
+    t1080p60neg.bt.polarities = 0;
+
+    CHECK(hdmiCanSwitchInPlace(t1080p60.bt, t1080p60.bt));
+    CHECK(hdmiCanSwitchInPlace(t1080p60.bt, t1080p60neg.bt));
+    CHECK(!hdmiCanSwitchInPlace(t1080p60.bt, t1080p50.bt));
+    CHECK(!hdmiCanSwitchInPlace(t1080p60.bt, t1080p59.bt));
+    CHECK(!hdmiCanSwitchInPlace(t1080p60.bt, t1080i60.bt));
+    CHECK(!hdmiCanSwitchInPlace(t1080p60.bt, t720p60.bt));
+}
+
+int main()
+{
+    testHash();
+    testCache();
+    testSwitchInPlace();
+
+    if (failCount) {
+        printf("ExynosHdmiSink_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+    printf("ExynosHdmiSink_test: pass\n");
+    return 0;
+}
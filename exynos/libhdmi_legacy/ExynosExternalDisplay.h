@@ -91,7 +91,6 @@ class ExynosExternalDisplay : public ExynosDisplay {
         int                     mUiIndex;
         int                     mVideoIndex;
         bool                    mUseSubtitles;
-        const void              *mLastLayerHandles[NUM_VIRT_OVER_HDMI];
         int                     mVirtualOverlayFlag;
 };
 
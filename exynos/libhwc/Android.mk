@@ -82,6 +82,7 @@ ifeq ($(BOARD_HDMI_INCAPABLE), true)
 else
 ifeq ($(BOARD_USES_NEW_HDMI), true)
 	LOCAL_C_INCLUDES += $(LOCAL_PATH)/../libhdmi
+	LOCAL_CFLAGS += -DUSES_NEW_HDMI
 else
 	LOCAL_C_INCLUDES += $(LOCAL_PATH)/../libhdmi_legacy
 endif
@@ -113,3 +114,4 @@ LOCAL_MODULE := hwcomposer.$(TARGET_BOARD_PLATFORM)
 LOCAL_MODULE_TAGS := optional
 include $(BUILD_SHARED_LIBRARY)
 
+include $(LOCAL_PATH)/test/Android.mk
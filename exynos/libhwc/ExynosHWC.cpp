@@ -55,15 +55,25 @@ void doPSRExit(struct exynos5_hwc_composer_device_1_t *pdev)
 }
 
 #if defined(USES_CEC)
-void handle_cec(exynos5_hwc_composer_device_1_t *pdev)
+/* receiver id, receivers outlive CECClose() so this is registered once */
+static int cec_receiver = -1;
+
+/* runs on the libcec engine thread, replies are queued, not waited for */
+void handle_cec(const unsigned char *msg, int msgSize, void *priv)
 {
-    unsigned char buffer[16];
+    exynos5_hwc_composer_device_1_t *pdev =
+            (exynos5_hwc_composer_device_1_t *)priv;
+    unsigned char buffer[CEC_MAX_FRAME_SIZE];
     int size;
     unsigned char lsrc, ldst, opcode;
 
-    size = CECReceiveMessage(buffer, CEC_MAX_FRAME_SIZE, 1000);
+    /* nothing to answer with before a logical address is allocated */
+    if (!pdev->hdmi_hpd || pdev->mCecLaddr == CEC_LADDR_UNREGISTERED)
+        return;
+
+    size = (msgSize < CEC_MAX_FRAME_SIZE) ? msgSize : CEC_MAX_FRAME_SIZE;
+    memcpy(buffer, msg, size);
 
-    /* no data available or ctrl-c */
     if (!size)
         return;
 
@@ -175,6 +185,17 @@ void start_cec(exynos5_hwc_composer_device_1_t *pdev)
     unsigned char buffer[CEC_MAX_FRAME_SIZE];
     int size;
     pdev->mCecFd = CECOpen();
+    if (pdev->mCecFd < 0)
+        return;
+
+    pdev->mCecLaddr = CEC_LADDR_UNREGISTERED;
+
+    /* the engine thread owns the fd from here, frames come to handle_cec() */
+    if (cec_receiver < 0)
+        cec_receiver = CECRegisterReceiver(CEC_OPCODE_ANY, handle_cec, pdev);
+    if (!CECEngineStart())
+        ALOGE("CECEngineStart() failed!!!");
+
     pdev->mCecPaddr = CEC_NOT_VALID_PHYSICAL_ADDRESS;
     pdev->mCecPaddr = pdev->externalDisplay->getCecPaddr();
     if (pdev->mCecPaddr < 0) {
@@ -215,6 +236,9 @@ void exynos5_boot_finished(exynos5_hwc_composer_device_1_t *dev)
                 pdev->externalDisplay->mBlanked = false;
 #if defined(USES_CEC)
                 start_cec(pdev);
+#endif
+#if defined(USES_NEW_HDMI)
+                pdev->externalDisplay->hotplugSink(pdev->hdmi_hpd);
 #endif
                 if (pdev->procs) {
                     pdev->procs->hotplug(pdev->procs, HWC_DISPLAY_EXTERNAL, true);
@@ -250,6 +274,14 @@ int exynos5_prepare(hwc_composer_device_1_t *dev,
 
     pdev->totPixels = 0;
 
+    /*
+     * Releasing an MPP closes its device, which is too slow for the vsync
+     * thread. prepare and set are the only users of the MPPs and both run on
+     * the SurfaceFlinger thread, so no lock is needed here.
+     */
+    if (android_atomic_and(0, &pdev->free_mpp_pending))
+        pdev->primaryDisplay->freeMPP();
+
     pdev->externalDisplay->setHdmiStatus(pdev->hdmi_hpd);
 
     if (fimd_contents) {
@@ -422,6 +454,10 @@ void handle_hdmi_uevent(struct exynos5_hwc_composer_device_1_t *pdev,
     }
 #endif
 
+#if defined(USES_NEW_HDMI)
+    pdev->externalDisplay->hotplugSink(pdev->hdmi_hpd);
+#endif
+
     ALOGV("HDMI HPD changed to %s", pdev->hdmi_hpd ? "enabled" : "disabled");
     if (pdev->hdmi_hpd)
         ALOGI("HDMI Resolution changed to %dx%d",
@@ -439,26 +475,42 @@ void handle_vsync_event(struct exynos5_hwc_composer_device_1_t *pdev)
     if (!pdev->procs)
         return;
 
-    int err = lseek(pdev->vsync_fd, 0, SEEK_SET);
-    if (err < 0) {
-        ALOGE("error seeking to vsync timestamp: %s", strerror(errno));
-        return;
-    }
-
-    char buf[4096];
-    err = read(pdev->vsync_fd, buf, sizeof(buf));
+    char buf[32];
+    int err = pread(pdev->vsync_fd, buf, sizeof(buf) - 1, 0);
     if (err < 0) {
         ALOGE("error reading vsync timestamp: %s", strerror(errno));
         return;
     }
-    buf[sizeof(buf) - 1] = '\0';
-
-    pdev->primaryDisplay->freeMPP();
+    buf[err] = '\0';
 
     errno = 0;
     uint64_t timestamp = strtoull(buf, NULL, 0);
-    if (!errno)
+    if (!errno) {
         pdev->procs->vsync(pdev->procs, 0, timestamp);
+        nsecs_t delivered = systemTime(SYSTEM_TIME_MONOTONIC);
+        exynos5_vsync_update(&pdev->vsync_model, timestamp, delivered - (nsecs_t)timestamp);
+    }
+
+    /* MPPs that left the screen are released by the next prepare */
+    android_atomic_or(1, &pdev->free_mpp_pending);
+}
+
+/*
+ * Sleeps for at least delay, then up to just before the next predicted
+ * vsync. An invalidate sent then is picked up on that vsync instead of
+ * racing it and slipping to the following one.
+ */
+static void hwc_sleep_to_vsync(struct exynos5_hwc_composer_device_1_t *pdev,
+        nsecs_t delay)
+{
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+    nsecs_t wake = exynos5_vsync_predict(&pdev->vsync_model, now + delay + VSYNC_INVALIDATE_LEAD);
+
+    if (wake)
+        wake -= VSYNC_INVALIDATE_LEAD;
+    else
+        wake = now + delay;
+    usleep(ns2us(wake - now));
 }
 
 void *hwc_update_stat_thread(void *data)
@@ -473,7 +525,7 @@ void *hwc_update_stat_thread(void *data)
          * If there is no update for more than 100ms, favor the 3D composition mode.
          * If all other conditions are met, mode will be switched to 3D composition.
          */
-        usleep(100000);
+        hwc_sleep_to_vsync(pdev, ms2ns(100));
         if (event_cnt == pdev->update_event_cnt) {
             if (pdev->primaryDisplay->getCompModeSwitch() == HWC_2_GLES) {
                 if ((pdev->procs) && (pdev->procs->invalidate))
@@ -502,31 +554,14 @@ void *hwc_vsync_thread(void *data)
         return NULL;
     }
 
-#if defined(USES_CEC)
-    struct pollfd fds[3];
-#else
     struct pollfd fds[2];
-#endif
     fds[0].fd = pdev->vsync_fd;
     fds[0].events = POLLPRI;
     fds[1].fd = uevent_get_fd();
     fds[1].events = POLLIN;
-#if defined(USES_CEC)
-    fds[2].fd = pdev->mCecFd;
-    fds[2].events = POLLIN;
-#endif
 
     while (true) {
-#if defined(USES_CEC)
-        int err;
-        fds[2].fd = pdev->mCecFd;
-        if (fds[2].fd > 0)
-            err = poll(fds, 3, -1);
-        else
-            err = poll(fds, 2, -1);
-#else
         int err = poll(fds, 2, -1);
-#endif
 
         if (err > 0) {
             if (fds[0].revents & POLLPRI) {
@@ -541,10 +576,6 @@ void *hwc_vsync_thread(void *data)
 
                 if (hdmi)
                     handle_hdmi_uevent(pdev, uevent_desc, len);
-#if defined(USES_CEC)
-            } else if (pdev->hdmi_hpd && fds[2].revents & POLLIN) {
-                handle_cec(pdev);
-#endif
             }
         }
         else if (err == -1) {
@@ -669,6 +700,56 @@ void exynos5_dump(hwc_composer_device_1* dev, char *buff, int buff_len)
         result.append("\n");
     }
 
+    result.append("\n  m2m buffers: allocated / reused\n");
+    for (int i = 0; i < pdev->primaryDisplay->mNumMPPs; i++)
+        result.appendFormat("    mpp %d: %u / %u\n", i,
+                pdev->primaryDisplay->mMPPs[i]->mBufferAllocCount,
+                pdev->primaryDisplay->mMPPs[i]->mBufferReuseCount);
+
+#ifdef G2D_COMPOSITION
+    result.appendFormat("\n  g2d pixels: blitted / full\n    %llu / %llu\n",
+            (unsigned long long)pdev->primaryDisplay->mG2dBlitPixels,
+            (unsigned long long)pdev->primaryDisplay->mG2dFullPixels);
+    result.appendFormat("  g2d blit time: damage %u frames avg %lld us, full %u frames avg %lld us%s\n",
+            pdev->primaryDisplay->mG2dDamageFrames,
+            pdev->primaryDisplay->mG2dDamageFrames ?
+                (long long)ns2us(pdev->primaryDisplay->mG2dDamageTime / pdev->primaryDisplay->mG2dDamageFrames) : 0LL,
+            pdev->primaryDisplay->mG2dFullFrames,
+            pdev->primaryDisplay->mG2dFullFrames ?
+                (long long)ns2us(pdev->primaryDisplay->mG2dFullTime / pdev->primaryDisplay->mG2dFullFrames) : 0LL,
+            pdev->primaryDisplay->mG2dDamageEnabled ? "" : " (damage tracking off)");
+    {
+        size_t poolSize = 0;
+        for (int i = 0; i < pdev->primaryDisplay->mG2dPoolWindows; i++)
+            poolSize += (size_t)pdev->primaryDisplay->mWinBufMapSize[i] * NUM_GSC_DST_BUFS;
+        result.appendFormat("  g2d pool windows: %d, %u KB of %u KB budget\n",
+                pdev->primaryDisplay->mG2dPoolWindows, (unsigned int)(poolSize / 1024),
+                (unsigned int)(G2D_WIN_BUF_POOL_BUDGET / 1024));
+    }
+#endif
+
+    result.append("\n  static layers reused: frames / total (partial runs), layers / total\n");
+    pdev->primaryDisplay->dumpLayerSignatures(result, "primary");
+    pdev->externalDisplay->dumpLayerSignatures(result, "external");
+#ifdef USES_VIRTUAL_DISPLAY
+    pdev->virtualDisplay->dumpLayerSignatures(result, "virtual");
+#endif
+
+    struct exynos5_vsync_model_t vsync;
+    exynos5_vsync_snapshot(&pdev->vsync_model, &vsync);
+    result.appendFormat("\n  vsync: period %lld ns (nominal %lld), %llu samples, %llu missed, %llu resyncs\n",
+            (long long)vsync.period, (long long)vsync.nominal,
+            (unsigned long long)vsync.samples, (unsigned long long)vsync.missed,
+            (unsigned long long)vsync.resyncs);
+    if (vsync.samples)
+        result.appendFormat("    prediction error: mean %lld us, max %lld us\n",
+                (long long)ns2us(vsync.sum_abs_error / (nsecs_t)vsync.samples),
+                (long long)ns2us(vsync.max_abs_error));
+    if (vsync.samples + vsync.resyncs)
+        result.appendFormat("    delivery: mean %lld us, max %lld us\n",
+                (long long)ns2us(vsync.sum_delivery / (nsecs_t)(vsync.samples + vsync.resyncs)),
+                (long long)ns2us(vsync.max_delivery));
+
     strlcpy(buff, result.string(), buff_len);
 }
 
@@ -831,6 +912,10 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
     char value[PROPERTY_VALUE_MAX];
     property_get("debug.hwc.force_gpu", value, "0");
     dev->force_gpu = atoi(value);
+#ifdef G2D_COMPOSITION
+    property_get("debug.hwc.g2d_damage", value, "0");
+    dev->primaryDisplay->mG2dDamageEnabled = atoi(value) != 0;
+#endif
 
     /* restore physical lcd width, height from reserved[] */
     int lcd_xres, lcd_yres;
@@ -854,6 +939,8 @@ int exynos5_open(const struct hw_module_t *module, const char *name,
     dev->primaryDisplay->mXdpi = 1000 * (lcd_xres * 25.4f) / info.width;
     dev->primaryDisplay->mYdpi = 1000 * (lcd_yres * 25.4f) / info.height;
     dev->primaryDisplay->mVsyncPeriod  = 1000000000 / refreshRate;
+    dev->vsync_model.nominal = dev->primaryDisplay->mVsyncPeriod;
+    dev->vsync_model.period = dev->vsync_model.nominal;
 
     ALOGD("using\n"
           "xres         = %d px\n"
@@ -1036,6 +1123,14 @@ int exynos5_close(hw_device_t *device)
             (struct exynos5_hwc_composer_device_1_t *)device;
     pthread_kill(dev->vsync_thread, SIGTERM);
     pthread_join(dev->vsync_thread, NULL);
+#if defined(USES_CEC)
+    /* stops the engine thread, handle_cec() must not see dev after this */
+    CECClose();
+    if (cec_receiver >= 0) {
+        CECUnregisterReceiver(cec_receiver);
+        cec_receiver = -1;
+    }
+#endif
     if (pthread_kill(dev->update_stat_thread, 0) != ESRCH) {
         pthread_kill(dev->update_stat_thread, SIGTERM);
         pthread_join(dev->update_stat_thread, NULL);
@@ -224,8 +224,33 @@ struct exynos5_g2d_data_t {
      int    ovly_lay_idx[NUM_HW_WIN_FB_PHY];
      int    win_used[NUM_HW_WINDOWS];
 };
+
+#define G2D_WIN_BUF_POOL_BUDGET (48 * 1024 * 1024)
+#define G2D_WIN_BUF_SIZE_CLASS  128
+#define G2D_DAMAGE_TILE_SIZE    64
+#define G2D_DAMAGE_MAX_RECTS    8
+#define G2D_DAMAGE_BACKOFF      30
+
+/*
+ * Per G2D window damage state. tile_dirty[j] holds the tiles window buffer j
+ * is missing, so a buffer that skipped some frames repaints everything that
+ * changed since it was last written. full_time is how long the last full
+ * blit of the window took, the damage path backs off when it is slower.
+ */
+struct exynos5_g2d_damage_t {
+    int         tile_cols;
+    int         tile_rows;
+    uint64_t    *tile_hash;
+    uint8_t     *tile_dirty[NUM_GSC_DST_BUFS];
+    bool        hash_valid;
+    int         backoff;
+    nsecs_t     full_time;
+    hwc_rect_t  src_crop;
+};
 #endif
 
+#include "ExynosVsyncModel.h"
+
 class ExynosPrimaryDisplay;
 class ExynosExternalDisplay;
 class ExynosVirtualDisplay;
@@ -239,6 +264,8 @@ struct exynos5_hwc_composer_device_1_t {
     struct v4l2_rect        mVirtualDisplayRect;
 
     int                     vsync_fd;
+    struct exynos5_vsync_model_t vsync_model;
+    volatile int32_t        free_mpp_pending;
     int                     psrInfoFd;
     int                     psrMode;
 
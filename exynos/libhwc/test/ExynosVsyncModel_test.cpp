@@ -0,0 +1,148 @@
+/*
+ * Host test and replay of the primary vsync filter
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ExynosVsyncModel.h"
+
+#define TEST_NOMINAL        16666667
+/* the panel runs a little slower than it reports */
+#define TEST_PERIOD         16683000
+#define TEST_JITTER         400000
+#define TEST_FRAMES         3000
+#define TEST_DROP_EVERY     37
+#define TEST_GAP_AT         1500
+#define TEST_GAP            1000000000LL
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+static uint32_t seed = 1;
+
+/* -TEST_JITTER .. TEST_JITTER, the same sequence on every run */
+static nsecs_t jitter()
+{
+    seed = seed * 1103515245 + 12345;
+    return (nsecs_t)((seed >> 8) % (2 * TEST_JITTER + 1)) - TEST_JITTER;
+}
+
+static nsecs_t absNs(nsecs_t v)
+{
+    return v < 0 ? -v : v;
+}
+
+static void initModel(struct exynos5_vsync_model_t *model)
+{
+    memset(model, 0, sizeof(*model));
+    model->nominal = TEST_NOMINAL;
+    model->period = TEST_NOMINAL;
+}
+
+static void testEmpty()
+{
+    struct exynos5_vsync_model_t model;
+
+    initModel(&model);
+    CHECK(exynos5_vsync_predict(&model, 1000) == 0);
+
+    exynos5_vsync_update(&model, 1000000000, 0);
+    CHECK(model.phase == 1000000000);
+    CHECK(model.samples == 0 && model.resyncs == 0);
+    CHECK(exynos5_vsync_predict(&model, 0) == 1000000000);
+    CHECK(exynos5_vsync_predict(&model, 1000000000) == 1000000000 + TEST_NOMINAL);
+    CHECK((model.seq & 1) == 0);
+}
+
+static void testReplay()
+{
+    struct exynos5_vsync_model_t model;
+    nsecs_t start = 5000000000LL;
+    uint64_t dropped = 0;
+    nsecs_t maxLateError = 0;
+    int reported = 0;
+
+    initModel(&model);
+
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        nsecs_t t = start + (nsecs_t)i * TEST_PERIOD + jitter();
+        if (i >= TEST_GAP_AT)
+            t += TEST_GAP - TEST_GAP % TEST_PERIOD;
+
+        if (i % TEST_DROP_EVERY == TEST_DROP_EVERY - 1) {
+            dropped++;
+            continue;
+        }
+
+        /* after settling, the prediction from just past the last vsync */
+        if (i > 500 && i != TEST_GAP_AT && i < TEST_GAP_AT + 300 && i > TEST_GAP_AT - 1000) {
+            nsecs_t predicted = exynos5_vsync_predict(&model, model.phase + 1000000);
+            nsecs_t error = absNs(predicted - t);
+            if (predicted - t > TEST_PERIOD / 2 || t - predicted > TEST_PERIOD / 2)
+                error = 0;      /* the previous one was dropped */
+            if (error > maxLateError)
+                maxLateError = error;
+        }
+
+        exynos5_vsync_update(&model, t, 100000 + i % 7 * 10000);
+        reported++;
+    }
+
+    printf("period %lld ns (true %d), missed %llu, resyncs %llu, mean error %lld ns, "
+            "max error %lld ns, late prediction error %lld ns\n",
+            (long long)model.period, TEST_PERIOD,
+            (unsigned long long)model.missed, (unsigned long long)model.resyncs,
+            (long long)(model.sum_abs_error / (nsecs_t)model.samples),
+            (long long)model.max_abs_error, (long long)maxLateError);
+
+    CHECK(absNs(model.period - TEST_PERIOD) < 20000);
+    CHECK(model.resyncs == 1);
+    CHECK(model.missed == dropped);
+    CHECK(model.samples + model.resyncs + 1 == (uint64_t)reported);
+    CHECK(maxLateError < TEST_JITTER * 2);
+    CHECK(model.max_delivery == 160000);
+    CHECK((model.seq & 1) == 0);
+}
+
+static void testOutOfRangePeriod()
+{
+    struct exynos5_vsync_model_t model;
+
+    initModel(&model);
+    model.phase = 1000000000;
+
+    /* in range, the filtered period is kept */
+    model.period = TEST_NOMINAL * 3 / 2;
+    exynos5_vsync_update(&model, model.phase + model.period, 0);
+    CHECK(model.samples == 1);
+    CHECK(model.period == TEST_NOMINAL * 3 / 2);
+
+    /* a filter that ran off is pulled back to the nominal period */
+    model.period = TEST_NOMINAL * 3;
+    exynos5_vsync_update(&model, model.phase + model.period, 0);
+    CHECK(model.samples == 2);
+    CHECK(model.period == TEST_NOMINAL);
+}
+
+int main()
+{
+    testEmpty();
+    testReplay();
+    testOutOfRangePeriod();
+
+    if (failCount) {
+        printf("ExynosVsyncModel_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+    printf("ExynosVsyncModel_test: pass\n");
+    return 0;
+}
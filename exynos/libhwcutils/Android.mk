@@ -91,3 +91,4 @@ LOCAL_MODULE_TAGS := eng
 LOCAL_MODULE := libhwcutils
 include $(BUILD_SHARED_LIBRARY)
 
+include $(LOCAL_PATH)/test/Android.mk
@@ -0,0 +1,138 @@
+#ifndef EXYNOS_G2D_DAMAGE_H
+#define EXYNOS_G2D_DAMAGE_H
+
+#include <stdint.h>
+#include <hardware/hwcomposer_defs.h>
+
+/*
+ * Tile signatures and damage rectangles of the G2D window buffers. Kept free
+ * of ion and fimg2d so the rules can be tested on the host,
+ * ExynosG2DWrapper maps the source and runs the blits.
+ */
+
+#define G2D_DAMAGE_HASH_INIT    14695981039346656037ULL
+#define G2D_DAMAGE_HASH_PRIME   1099511628211ULL
+
+/*
+ * 64 bit FNV-1a over the pixels of each tile. Every step is invertible, so a
+ * tile that differs in a single pixel always gets a new signature.
+ */
+template<typename T> inline void g2dDamageHashLine(const T *px, int x0, int x1, uint64_t *hash)
+{
+    uint64_t h = *hash;
+
+    for (int x = x0; x < x1; x++)
+        h = (h ^ px[x]) * G2D_DAMAGE_HASH_PRIME;
+    *hash = h;
+}
+
+/*
+ * Signs the w x h source at src (stride in pixels, 2 or 4 bytes per pixel)
+ * tile by tile. Tiles whose signature differs from tile_hash, or all of them
+ * when hash_valid is false, are updated and marked in each of the num_bufs
+ * dirty maps. band is scratch space for one row of tiles. Returns the number
+ * of changed tiles.
+ */
+inline int g2dDamageHashTiles(uint64_t *tile_hash, uint64_t *band, bool hash_valid,
+        int tile_size, int cols, int rows, const uint8_t *src, int stride, uint32_t bpp,
+        int w, int h, uint8_t *const *dirty, int num_bufs)
+{
+    int changed = 0;
+
+    for (int ty = 0; ty < rows; ty++) {
+        int y0 = ty * tile_size;
+        int y1 = (y0 + tile_size < h) ? y0 + tile_size : h;
+
+        for (int tx = 0; tx < cols; tx++)
+            band[tx] = G2D_DAMAGE_HASH_INIT;
+
+        for (int y = y0; y < y1; y++) {
+            const uint8_t *line = src + y * stride * bpp;
+
+            for (int tx = 0; tx < cols; tx++) {
+                int x0 = tx * tile_size;
+                int x1 = (x0 + tile_size < w) ? x0 + tile_size : w;
+
+                if (bpp == 4)
+                    g2dDamageHashLine((const uint32_t *)line, x0, x1, &band[tx]);
+                else
+                    g2dDamageHashLine((const uint16_t *)line, x0, x1, &band[tx]);
+            }
+        }
+
+        for (int tx = 0; tx < cols; tx++) {
+            int t = ty * cols + tx;
+
+            if (hash_valid && tile_hash[t] == band[tx])
+                continue;
+            tile_hash[t] = band[tx];
+            for (int j = 0; j < num_bufs; j++)
+                dirty[j][t] = 1;
+            changed++;
+        }
+    }
+
+    return changed;
+}
+
+/*
+ * Turns the dirty tiles of one window buffer into rectangles: one span per
+ * tile row, stacked with the row above when the span matches. More than
+ * max_rects rectangles collapse into their bounding box.
+ */
+inline int g2dDamageBuildRects(const uint8_t *dirty, int tile_size, int cols, int rows,
+        int w, int h, hwc_rect_t *rects, int max_rects)
+{
+    int num_rects = 0;
+    bool overflow = false;
+    hwc_rect_t bound = {w, h, 0, 0};
+
+    for (int ty = 0; ty < rows; ty++) {
+        int first = -1, last = -1;
+
+        for (int tx = 0; tx < cols; tx++) {
+            if (dirty[ty * cols + tx]) {
+                if (first < 0)
+                    first = tx;
+                last = tx;
+            }
+        }
+        if (first < 0)
+            continue;
+
+        hwc_rect_t rect;
+        rect.left = first * tile_size;
+        rect.top = ty * tile_size;
+        rect.right = ((last + 1) * tile_size < w) ? (last + 1) * tile_size : w;
+        rect.bottom = ((ty + 1) * tile_size < h) ? (ty + 1) * tile_size : h;
+
+        if (rect.left < bound.left)
+            bound.left = rect.left;
+        if (rect.top < bound.top)
+            bound.top = rect.top;
+        if (rect.right > bound.right)
+            bound.right = rect.right;
+        if (rect.bottom > bound.bottom)
+            bound.bottom = rect.bottom;
+
+        if (num_rects > 0 &&
+                rects[num_rects - 1].left == rect.left &&
+                rects[num_rects - 1].right == rect.right &&
+                rects[num_rects - 1].bottom == rect.top) {
+            rects[num_rects - 1].bottom = rect.bottom;
+        } else if (num_rects < max_rects) {
+            rects[num_rects++] = rect;
+        } else {
+            overflow = true;
+        }
+    }
+
+    if (overflow) {
+        rects[0] = bound;
+        num_rects = 1;
+    }
+
+    return num_rects;
+}
+
+#endif
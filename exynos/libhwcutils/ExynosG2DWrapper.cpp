@@ -1,4 +1,5 @@
 #include "ExynosG2DWrapper.h"
+#include "ExynosG2DDamage.h"
 #include "ExynosHWCUtils.h"
 #include "ExynosOverlayDisplay.h"
 #ifdef USES_VIRTUAL_DISPLAY
@@ -93,7 +94,7 @@ ExynosG2DWrapper::~ExynosG2DWrapper()
 int ExynosG2DWrapper::runCompositor(hwc_layer_1_t &src_layer, private_handle_t *dst_handle,
         uint32_t transform, uint32_t global_alpha, unsigned long solid,
         blit_op mode, bool force_clear, unsigned long srcAddress,
-        unsigned long dstAddress, int is_lcd)
+        unsigned long dstAddress, int is_lcd, hwc_rect_t *damage)
 {
     int ret = 0;
     unsigned long srcYAddress = 0;
@@ -141,6 +142,13 @@ int ExynosG2DWrapper::runCompositor(hwc_layer_1_t &src_layer, private_handle_t *
         srcImgRect.fullW = src_handle->stride;
         srcImgRect.fullH = src_handle->vstride;
         srcImgRect.colorFormat = src_handle->format;
+        /* damage is only passed for unscaled copies, src and dst move together */
+        if (is_lcd && damage) {
+            srcImgRect.x += damage->left;
+            srcImgRect.y += damage->top;
+            srcImgRect.w = WIDTH(*damage);
+            srcImgRect.h = HEIGHT(*damage);
+        }
     }
 
 #ifndef USES_VIRTUAL_DISPLAY
@@ -152,10 +160,17 @@ int ExynosG2DWrapper::runCompositor(hwc_layer_1_t &src_layer, private_handle_t *
 #endif
 
     if (is_lcd) {
-        dstImgRect.x = 0;
-        dstImgRect.y = 0;
-        dstImgRect.w = WIDTH(src_layer.displayFrame);
-        dstImgRect.h = HEIGHT(src_layer.displayFrame);
+        if (damage) {
+            dstImgRect.x = damage->left;
+            dstImgRect.y = damage->top;
+            dstImgRect.w = WIDTH(*damage);
+            dstImgRect.h = HEIGHT(*damage);
+        } else {
+            dstImgRect.x = 0;
+            dstImgRect.y = 0;
+            dstImgRect.w = WIDTH(src_layer.displayFrame);
+            dstImgRect.h = HEIGHT(src_layer.displayFrame);
+        }
         dstImgRect.fullW = dst_handle->stride;
         dstImgRect.fullH = dst_handle->vstride;
         dstImgRect.colorFormat = dst_handle->format;
@@ -638,8 +653,19 @@ void ExynosG2DWrapper::exynos5_cleanup_g2d(int force)
 #ifdef G2D_COMPOSITION
     exynos5_g2d_data_t &mG2d = mDisplay->mG2d;
 
-    if (!mDisplay->mG2dMemoryAllocated && !force)
+    /*
+     * Trim on every frame that did not want G2D, a trim skipped while the
+     * filler was busy or a filler finishing after G2D was dropped leave the
+     * pool above the budget otherwise. Frames still waiting for the pool
+     * keep it, or it would be refilled and trimmed over and over.
+     */
+    if (!mDisplay->mG2dMemoryAllocated && !force) {
+        if (mDisplay->mG2dPoolWaiting)
+            mDisplay->mG2dPoolWaiting = false;
+        else
+            exynos5_g2d_pool_trim(G2D_WIN_BUF_POOL_BUDGET);
         return;
+    }
 
     for (int i = 0; i < (int)NUM_HW_WIN_FB_PHY; i++) {
         mDisplay->mG2dCurrentBuffer[i] = 0;
@@ -653,83 +679,87 @@ void ExynosG2DWrapper::exynos5_cleanup_g2d(int force)
         }
     }
 
+    for (int i = 0; i < (int)NUM_HW_WINDOWS; i++)
+        exynos5_g2d_damage_free(i);
+
     memset(&mG2d, 0, sizeof(mG2d));
     mDisplay->mG2dLayers = 0;
     mDisplay->mG2dComposition = 0;
 
-    for (int i = 0; i < mDisplay->mAllocatedLayers; i++) {
-        for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
-            if (mDisplay->mWinBufVirtualAddress[i][j]) {
-                ion_unmap((void *)mDisplay->mWinBufVirtualAddress[i][j], mDisplay->mWinBufMapSize[i]);
-                mDisplay->mWinBufVirtualAddress[i][j] = 0;
-            }
+    /* the pool outlives the composition mode, keep what fits the budget */
+    if (force) {
+        if (mDisplay->mG2dPoolThreadStarted) {
+            pthread_join(mDisplay->mG2dPoolThread, NULL);
+            mDisplay->mG2dPoolThreadStarted = false;
         }
+        exynos5_g2d_pool_trim(0);
+    } else {
+        exynos5_g2d_pool_trim(G2D_WIN_BUF_POOL_BUDGET);
     }
 
-    for (int i = 0; i < mDisplay->mAllocatedLayers; i++) {
-        for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
-            if (mDisplay->mWinBuf[i][j]) {
-                mDisplay->mAllocDevice->free(mDisplay->mAllocDevice, mDisplay->mWinBuf[i][j]);
-                mDisplay->mWinBuf[i][j] = NULL;
-            }
-        }
-    }
     mDisplay->mAllocatedLayers = 0;
     mDisplay->mG2dMemoryAllocated = 0;
+    mDisplay->mG2dPoolWaiting = false;
 #endif
 }
 
 int ExynosG2DWrapper::exynos5_g2d_buf_alloc(hwc_display_contents_1_t* contents)
 {
 #ifdef G2D_COMPOSITION
-    int w, h;
-    int dst_stride;
-    int format = HAL_PIXEL_FORMAT_RGBX_8888;
-    int usage;
+    bool ready;
 
     if (mDisplay->mG2dMemoryAllocated)
         return 0;
 
-    usage = GRALLOC_USAGE_SW_READ_NEVER |
-            GRALLOC_USAGE_SW_WRITE_NEVER | GRALLOC_USAGE_PHYSICALLY_LINEAR |
-            GRALLOC_USAGE_HW_COMPOSER;
-    usage |= GRALLOC_USAGE_PROTECTED;
-    usage &= ~GRALLOC_USAGE_PRIVATE_NONSECURE;
+    pthread_mutex_lock(&mDisplay->mG2dPoolLock);
+    /* the filler may be replacing any window, nothing is ready until it is done */
+    ready = !mDisplay->mG2dPoolBusy && mDisplay->mG2dPoolWindows >= mDisplay->mG2dLayers;
+    for (int i = 0; ready && i < mDisplay->mG2dLayers; i++) {
+        hwc_layer_1_t &layer = contents->hwLayers[mDisplay->mG2d.ovly_lay_idx[i]];
 
-    for (int i = 0; i < mDisplay->mG2dLayers; i++) {
-        int lay_idx = mDisplay->mG2d.ovly_lay_idx[i];
-        hwc_layer_1_t &layer = contents->hwLayers[lay_idx];
-        w = WIDTH(layer.displayFrame);
-        h = HEIGHT(layer.displayFrame);
-
-        for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
-            int ret = mDisplay->mAllocDevice->alloc(mDisplay->mAllocDevice, w, h,
-                    format, usage, &mDisplay->mWinBuf[i][j],
-                    &dst_stride);
-            if (ret < 0) {
-                ALOGE("failed to allocate win %d buf %d buffer [w %d h %d f %x]: %s",
-                        i, j, w, h, format, strerror(-ret));
-                goto G2D_BUF_ALLOC_FAIL;
-            }
+        if (mDisplay->mWinBufWidth[i] < WIDTH(layer.displayFrame) ||
+                mDisplay->mWinBufHeight[i] < HEIGHT(layer.displayFrame))
+            ready = false;
+    }
+    if (!ready && !mDisplay->mG2dPoolBusy) {
+        if (mDisplay->mG2dPoolThreadStarted)
+            pthread_join(mDisplay->mG2dPoolThread, NULL);
+        for (int i = 0; i < mDisplay->mG2dLayers; i++) {
+            hwc_layer_1_t &layer = contents->hwLayers[mDisplay->mG2d.ovly_lay_idx[i]];
+
+            mDisplay->mG2dPoolRequestWidth[i] = WIDTH(layer.displayFrame);
+            mDisplay->mG2dPoolRequestHeight[i] = HEIGHT(layer.displayFrame);
+        }
+        mDisplay->mG2dPoolRequest = mDisplay->mG2dLayers;
+        mDisplay->mG2dPoolBusy = true;
+        mDisplay->mG2dPoolThreadStarted = true;
+        if (pthread_create(&mDisplay->mG2dPoolThread, NULL, exynos5_g2d_pool_thread, this) != 0) {
+            ALOGE("%s: failed to start g2d pool thread", __func__);
+            mDisplay->mG2dPoolBusy = false;
+            mDisplay->mG2dPoolThreadStarted = false;
         }
-        mDisplay->mWinBufMapSize[i] = dst_stride * h * 4 + 0x8000;
     }
-    mDisplay->mAllocatedLayers = mDisplay->mG2dLayers;
+    pthread_mutex_unlock(&mDisplay->mG2dPoolLock);
+
+    /* not on this frame, it stays with GLES until the pool is filled */
+    if (!ready) {
+        mDisplay->mG2dPoolWaiting = true;
+        return 1;
+    }
 
-    uint32_t vir_addr;
     for (int i = 0; i < mDisplay->mG2dLayers; i++) {
-        for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
+        int lay_idx = mDisplay->mG2d.ovly_lay_idx[i];
+        hwc_layer_1_t &layer = contents->hwLayers[lay_idx];
+
+        for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++)
             mDisplay->mWinBufFence[i][j] = -1;
-            private_handle_t *buf_handle = private_handle_t::dynamicCast(mDisplay->mWinBuf[i][j]);
-            vir_addr = (uint32_t) ion_map(buf_handle->fd, mDisplay->mWinBufMapSize[i], 0);
-            if (vir_addr != (unsigned int)MAP_FAILED) {
-                mDisplay->mWinBufVirtualAddress[i][j] = vir_addr;
-            } else {
-                ALOGE("Failed to map win %d buf %d buffer", i, j);
-                goto G2D_BUF_ALLOC_FAIL;
-            }
+
+        if (exynos5_g2d_damage_alloc(i, WIDTH(layer.displayFrame), HEIGHT(layer.displayFrame)) < 0) {
+            ALOGE("failed to allocate win %d damage tiles", i);
+            goto G2D_BUF_ALLOC_FAIL;
         }
     }
+    mDisplay->mAllocatedLayers = mDisplay->mG2dLayers;
 
     mDisplay->mG2dMemoryAllocated = 1;
     return 0;
@@ -742,6 +772,153 @@ G2D_BUF_ALLOC_FAIL:
     return 1;
 }
 
+#ifdef G2D_COMPOSITION
+static void freePoolWindow(ExynosOverlayDisplay *display, int i)
+{
+    for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
+        if (display->mWinBufVirtualAddress[i][j]) {
+            ion_unmap((void *)display->mWinBufVirtualAddress[i][j], display->mWinBufMapSize[i]);
+            display->mWinBufVirtualAddress[i][j] = 0;
+        }
+        if (display->mWinBuf[i][j]) {
+            display->mAllocDevice->free(display->mAllocDevice, display->mWinBuf[i][j]);
+            display->mWinBuf[i][j] = NULL;
+        }
+    }
+    display->mWinBufWidth[i] = 0;
+    display->mWinBufHeight[i] = 0;
+}
+
+static int allocPoolWindow(ExynosOverlayDisplay *display, int i, int w, int h)
+{
+    int format = HAL_PIXEL_FORMAT_RGBX_8888;
+    int usage;
+    int dst_stride = 0;
+
+    usage = GRALLOC_USAGE_SW_READ_NEVER |
+            GRALLOC_USAGE_SW_WRITE_NEVER | GRALLOC_USAGE_PHYSICALLY_LINEAR |
+            GRALLOC_USAGE_HW_COMPOSER;
+    usage |= GRALLOC_USAGE_PROTECTED;
+    usage &= ~GRALLOC_USAGE_PRIVATE_NONSECURE;
+
+    for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
+        int ret = display->mAllocDevice->alloc(display->mAllocDevice, w, h,
+                format, usage, &display->mWinBuf[i][j], &dst_stride);
+        if (ret < 0) {
+            ALOGE("failed to allocate win %d buf %d buffer [w %d h %d f %x]: %s",
+                    i, j, w, h, format, strerror(-ret));
+            display->mWinBuf[i][j] = NULL;
+            freePoolWindow(display, i);
+            return ret;
+        }
+    }
+    display->mWinBufMapSize[i] = dst_stride * h * 4 + 0x8000;
+
+    for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
+        private_handle_t *buf_handle = private_handle_t::dynamicCast(display->mWinBuf[i][j]);
+        uint32_t vir_addr = (uint32_t) ion_map(buf_handle->fd, display->mWinBufMapSize[i], 0);
+        if (vir_addr == (unsigned int)MAP_FAILED) {
+            ALOGE("Failed to map win %d buf %d buffer", i, j);
+            freePoolWindow(display, i);
+            return -1;
+        }
+        display->mWinBufVirtualAddress[i][j] = vir_addr;
+    }
+    display->mWinBufWidth[i] = w;
+    display->mWinBufHeight[i] = h;
+
+    return 0;
+}
+#endif
+
+/*
+ * Window buffers are sized to the layer that asked for them, rounded up to
+ * G2D_WIN_BUF_SIZE_CLASS so a window keeps fitting while a layer grows a
+ * little. They are allocated and mapped here, off the composition thread,
+ * one window at a time. A pooled window that is too small for its new layer
+ * is replaced.
+ */
+void *ExynosG2DWrapper::exynos5_g2d_pool_thread(void *data)
+{
+#ifdef G2D_COMPOSITION
+    ExynosG2DWrapper *g2d = (ExynosG2DWrapper *)data;
+    ExynosOverlayDisplay *display = g2d->mDisplay;
+    int windows, request;
+    bool filled;
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    pthread_mutex_lock(&display->mG2dPoolLock);
+    windows = display->mG2dPoolWindows;
+    request = display->mG2dPoolRequest;
+    pthread_mutex_unlock(&display->mG2dPoolLock);
+
+    for (int i = 0; i < request; i++) {
+        int w = display->mG2dPoolRequestWidth[i];
+        int h = display->mG2dPoolRequestHeight[i];
+
+        if (i < windows && display->mWinBufWidth[i] >= w && display->mWinBufHeight[i] >= h)
+            continue;
+
+        w = min(ALIGN(w, G2D_WIN_BUF_SIZE_CLASS), max(w, display->mXres));
+        h = min(ALIGN(h, G2D_WIN_BUF_SIZE_CLASS), max(h, display->mYres));
+
+        if (i < windows)
+            freePoolWindow(display, i);
+
+        if (allocPoolWindow(display, i, w, h) < 0) {
+            /* keep the pool contiguous, the windows above this one go too */
+            for (int k = i + 1; k < windows; k++)
+                freePoolWindow(display, k);
+            windows = i;
+            break;
+        }
+        if (i >= windows)
+            windows = i + 1;
+    }
+
+    pthread_mutex_lock(&display->mG2dPoolLock);
+    display->mG2dPoolWindows = windows;
+    ALOGD("g2d pool: %d of %d windows ready in %lld us", windows,
+            request, (long long)ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start));
+    filled = windows >= request;
+    display->mG2dPoolBusy = false;
+    pthread_mutex_unlock(&display->mG2dPoolLock);
+
+    /* let the next prepare pick G2D again */
+    if (filled && display->mHwc->procs && display->mHwc->procs->invalidate)
+        display->mHwc->procs->invalidate(display->mHwc->procs);
+#endif
+    return NULL;
+}
+
+/* keeps the lowest windows that fit in budget bytes, frees the rest */
+void ExynosG2DWrapper::exynos5_g2d_pool_trim(size_t budget)
+{
+#ifdef G2D_COMPOSITION
+    size_t size = 0;
+    int windows = 0;
+
+    pthread_mutex_lock(&mDisplay->mG2dPoolLock);
+    if (mDisplay->mG2dPoolBusy) {
+        /* the filler owns the windows, next frame trims */
+        pthread_mutex_unlock(&mDisplay->mG2dPoolLock);
+        return;
+    }
+
+    while (windows < mDisplay->mG2dPoolWindows) {
+        size += (size_t)mDisplay->mWinBufMapSize[windows] * NUM_GSC_DST_BUFS;
+        if (size > budget)
+            break;
+        windows++;
+    }
+
+    for (int i = windows; i < mDisplay->mG2dPoolWindows; i++)
+        freePoolWindow(mDisplay, i);
+    mDisplay->mG2dPoolWindows = windows;
+    pthread_mutex_unlock(&mDisplay->mG2dPoolLock);
+#endif
+}
+
 int ExynosG2DWrapper::exynos5_config_g2d(hwc_layer_1_t &layer, private_handle_t *dst_handle, s3c_fb_win_config &cfg, int win_idx_2d, int win_idx)
 {
 #ifdef G2D_COMPOSITION
@@ -777,11 +954,11 @@ int ExynosG2DWrapper::exynos5_config_g2d(hwc_layer_1_t &layer, private_handle_t
         }
 
         if (dst_handle->format == HAL_PIXEL_FORMAT_RGBX_8888) {
-            ret = runCompositor(layer, dst_handle, 0, 0xff, 0, BLIT_OP_SRC, false, 0,
-                    mDisplay->mWinBufVirtualAddress[win_idx_2d][cur_buf] + 0x8000, 1);
+            ret = exynos5_g2d_damage_blit(layer, dst_handle, win_idx_2d, cur_buf,
+                    mDisplay->mWinBufVirtualAddress[win_idx_2d][cur_buf] + 0x8000);
         } else {
-            ret = runCompositor(layer, dst_handle, 0, 0xff, 0, BLIT_OP_SRC, false, 0,
-                    mDisplay->mWinBufVirtualAddress[win_idx_2d][cur_buf], 1);
+            ret = exynos5_g2d_damage_blit(layer, dst_handle, win_idx_2d, cur_buf,
+                    mDisplay->mWinBufVirtualAddress[win_idx_2d][cur_buf]);
         }
         if (ret < 0)
             ALOGE("%s:runCompositor: Failed", __func__);
@@ -797,3 +974,195 @@ int ExynosG2DWrapper::exynos5_config_g2d(hwc_layer_1_t &layer, private_handle_t
     return -1;
 #endif
 }
+
+int ExynosG2DWrapper::exynos5_g2d_damage_alloc(int win_idx_2d, int w, int h)
+{
+#ifdef G2D_COMPOSITION
+    exynos5_g2d_damage_t &damage = mDisplay->mG2dDamage[win_idx_2d];
+    int tiles;
+
+    exynos5_g2d_damage_free(win_idx_2d);
+
+    damage.tile_cols = (w + G2D_DAMAGE_TILE_SIZE - 1) / G2D_DAMAGE_TILE_SIZE;
+    damage.tile_rows = (h + G2D_DAMAGE_TILE_SIZE - 1) / G2D_DAMAGE_TILE_SIZE;
+    tiles = damage.tile_cols * damage.tile_rows;
+
+    /* one extra row of hashes is the scratch row for the band being hashed */
+    damage.tile_hash = (uint64_t *)calloc(tiles + damage.tile_cols, sizeof(uint64_t));
+    if (!damage.tile_hash)
+        return -1;
+
+    for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++) {
+        damage.tile_dirty[j] = (uint8_t *)malloc(tiles);
+        if (!damage.tile_dirty[j])
+            return -1;
+        /* a fresh buffer holds nothing yet */
+        memset(damage.tile_dirty[j], 1, tiles);
+    }
+#endif
+    return 0;
+}
+
+void ExynosG2DWrapper::exynos5_g2d_damage_free(int win_idx_2d)
+{
+#ifdef G2D_COMPOSITION
+    exynos5_g2d_damage_t &damage = mDisplay->mG2dDamage[win_idx_2d];
+
+    free(damage.tile_hash);
+    for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++)
+        free(damage.tile_dirty[j]);
+    memset(&damage, 0, sizeof(damage));
+#endif
+}
+
+#ifdef G2D_COMPOSITION
+static void markAllTilesDirty(exynos5_g2d_damage_t &damage)
+{
+    int tiles = damage.tile_cols * damage.tile_rows;
+
+    for (int j = 0; j < (int)NUM_GSC_DST_BUFS; j++)
+        memset(damage.tile_dirty[j], 1, tiles);
+    damage.hash_valid = false;
+}
+#endif
+
+/*
+ * Brings window buffer buf_idx up to date with the layer. With
+ * debug.hwc.g2d_damage set, only the tiles that changed since this buffer
+ * was last written are blitted. Scaled layers, formats that can't be hashed
+ * and content that keeps changing everywhere (video, full screen animations)
+ * take the full blit, and so does a window whose hashing plus partial blits
+ * took longer than its last full blit.
+ */
+int ExynosG2DWrapper::exynos5_g2d_damage_blit(hwc_layer_1_t &layer, private_handle_t *dst_handle,
+        int win_idx_2d, int buf_idx, unsigned long dstAddress)
+{
+#ifdef G2D_COMPOSITION
+    exynos5_g2d_damage_t &damage = mDisplay->mG2dDamage[win_idx_2d];
+    private_handle_t *src_handle = private_handle_t::dynamicCast(layer.handle);
+    int w = WIDTH(layer.displayFrame);
+    int h = HEIGHT(layer.displayFrame);
+    int tiles = damage.tile_cols * damage.tile_rows;
+    hwc_rect_t rects[G2D_DAMAGE_MAX_RECTS];
+    int num_rects = 0;
+    hwc_rect_t crop;
+    color_format g2d_format;
+    pixel_order g2d_order;
+    uint32_t bpp = 0;
+    unsigned long srcAddress = 0;
+    size_t srcMapSize = 0;
+    uint32_t blitPixels = 0;
+    int changed;
+    nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+    nsecs_t elapsed;
+    int ret = 0;
+
+    crop.left = (int)layer.sourceCropf.left;
+    crop.top = (int)layer.sourceCropf.top;
+    crop.right = (int)layer.sourceCropf.right;
+    crop.bottom = (int)layer.sourceCropf.bottom;
+
+    mDisplay->mG2dFullPixels += w * h;
+
+    if (!mDisplay->mG2dDamageEnabled ||
+            damage.tile_hash == NULL || src_handle->fd < 0 ||
+            WIDTH(crop) != w || HEIGHT(crop) != h ||
+            formatValueHAL2G2D(src_handle->format, &g2d_format, &g2d_order, &bpp) < 0 ||
+            (bpp != 2 && bpp != 4))
+        goto FULL_BLIT;
+
+    if (memcmp(&damage.src_crop, &crop, sizeof(crop))) {
+        markAllTilesDirty(damage);
+        damage.src_crop = crop;
+    }
+
+    /* nothing to weigh the damage path against until a full blit was timed */
+    if (damage.backoff > 0 || !damage.full_time) {
+        if (damage.backoff > 0)
+            damage.backoff--;
+        goto FULL_BLIT;
+    }
+
+    if (mDisplay->mG2dIonClient < 0)
+        mDisplay->mG2dIonClient = ion_client_create();
+    if (mDisplay->mG2dIonClient < 0)
+        goto FULL_BLIT;
+
+    srcMapSize = src_handle->stride * src_handle->vstride * bpp;
+    srcAddress = (unsigned long)ion_map(src_handle->fd, srcMapSize, 0);
+    if ((void *)srcAddress == MAP_FAILED) {
+        srcAddress = 0;
+        goto FULL_BLIT;
+    }
+
+    /* the source was written by the GPU, drop stale CPU cache lines before hashing it */
+    if (ion_sync(mDisplay->mG2dIonClient, src_handle->fd) < 0) {
+        ion_unmap((void *)srcAddress, srcMapSize);
+        srcAddress = 0;
+        goto FULL_BLIT;
+    }
+
+    changed = g2dDamageHashTiles(damage.tile_hash, damage.tile_hash + tiles, damage.hash_valid,
+            G2D_DAMAGE_TILE_SIZE, damage.tile_cols, damage.tile_rows,
+            (const uint8_t *)srcAddress + (crop.top * src_handle->stride + crop.left) * bpp,
+            src_handle->stride, bpp, w, h, damage.tile_dirty, NUM_GSC_DST_BUFS);
+    if (changed == tiles && damage.hash_valid) {
+        /* everything moved, hashing only costs until the content settles */
+        damage.backoff = G2D_DAMAGE_BACKOFF;
+    }
+    damage.hash_valid = true;
+
+    num_rects = g2dDamageBuildRects(damage.tile_dirty[buf_idx], G2D_DAMAGE_TILE_SIZE,
+            damage.tile_cols, damage.tile_rows, w, h, rects, G2D_DAMAGE_MAX_RECTS);
+    for (int i = 0; i < num_rects; i++) {
+        ret = runCompositor(layer, dst_handle, 0, 0xff, 0, BLIT_OP_SRC, false,
+                srcAddress, dstAddress, 1, &rects[i]);
+        if (ret < 0)
+            break;
+        blitPixels += WIDTH(rects[i]) * HEIGHT(rects[i]);
+    }
+
+    ion_unmap((void *)srcAddress, srcMapSize);
+
+    if (ret < 0) {
+        /* contents of this buffer are unknown now */
+        memset(damage.tile_dirty[buf_idx], 1, tiles);
+        return ret;
+    }
+
+    memset(damage.tile_dirty[buf_idx], 0, tiles);
+    mDisplay->mG2dBlitPixels += blitPixels;
+
+    elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    mDisplay->mG2dDamageTime += elapsed;
+    mDisplay->mG2dDamageFrames++;
+    if (elapsed > damage.full_time)
+        damage.backoff = G2D_DAMAGE_BACKOFF;
+
+    ALOGV("%s: win %d buf %d: %d rects, %u of %d pixels in %lld us (full %lld us)", __func__,
+            win_idx_2d, buf_idx, num_rects, blitPixels, w * h,
+            (long long)ns2us(elapsed), (long long)ns2us(damage.full_time));
+    return 0;
+
+FULL_BLIT:
+    if (damage.tile_hash)
+        markAllTilesDirty(damage);
+
+    ret = runCompositor(layer, dst_handle, 0, 0xff, 0, BLIT_OP_SRC, false, 0,
+            dstAddress, 1);
+    if (ret < 0)
+        return ret;
+
+    if (damage.tile_hash)
+        memset(damage.tile_dirty[buf_idx], 0, tiles);
+    mDisplay->mG2dBlitPixels += w * h;
+
+    elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - start;
+    damage.full_time = elapsed;
+    mDisplay->mG2dFullTime += elapsed;
+    mDisplay->mG2dFullFrames++;
+    return 0;
+#else
+    return -1;
+#endif
+}
@@ -42,7 +42,7 @@ class ExynosG2DWrapper {
         int runCompositor(hwc_layer_1_t &src_layer, private_handle_t *dst_handle,
                 uint32_t transform, uint32_t global_alpha, unsigned long solid,
                 blit_op mode, bool force_clear, unsigned long srcAddress,
-                unsigned long dstAddress, int is_lcd);
+                unsigned long dstAddress, int is_lcd, hwc_rect_t *damage = NULL);
 #ifdef USES_VIRTUAL_DISPLAY
         int runSecureCompositor(hwc_layer_1_t &src_layer, private_handle_t *dst_handle,
                 private_handle_t *secure_handle, uint32_t global_alpha, unsigned long solid,
@@ -53,6 +53,12 @@ class ExynosG2DWrapper {
         void exynos5_cleanup_g2d(int force);
         int exynos5_g2d_buf_alloc(hwc_display_contents_1_t* contents);
         int exynos5_config_g2d(hwc_layer_1_t &layer, private_handle_t *dstHandle, s3c_fb_win_config &cfg, int win_idx_2d, int win_idx);
+        static void *exynos5_g2d_pool_thread(void *data);
+        void exynos5_g2d_pool_trim(size_t budget);
+        int exynos5_g2d_damage_alloc(int win_idx_2d, int w, int h);
+        void exynos5_g2d_damage_free(int win_idx_2d);
+        int exynos5_g2d_damage_blit(hwc_layer_1_t &layer, private_handle_t *dst_handle,
+                int win_idx_2d, int buf_idx, unsigned long dstAddress);
 
         ExynosOverlayDisplay *mDisplay;
         ExynosExternalDisplay *mExternalDisplay;
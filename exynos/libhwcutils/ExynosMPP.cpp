@@ -29,6 +29,18 @@ ExynosMPP::ExynosMPP(ExynosDisplay *display, int gscIndex)
     mS3DMode = 0;
     mppFact = NULL;
     libmpp = NULL;
+    mBufferUsage = 0;
+    for (uint32_t i = 0; i < MPP_BUFFER_CACHE_NUM; i++) {
+        mBufferCache[i].handle = NULL;
+        mBufferCache[i].usage = 0;
+        mBufferCache[i].format = 0;
+        mBufferCache[i].stride = 0;
+        mBufferCache[i].vstride = 0;
+        mBufferCache[i].fence = -1;
+        mBufferCache[i].lastUsed = 0;
+    }
+    mBufferAllocCount = 0;
+    mBufferReuseCount = 0;
 }
 
 ExynosMPP::~ExynosMPP()
@@ -506,9 +518,7 @@ void ExynosMPP::setupM2MDestination(exynos_mpp_img &src_img, exynos_mpp_img &dst
 
 int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &dst_img, exynos_mpp_img &mid_img, bool need_gsc_op_twice)
 {
-    alloc_device_t* alloc_device = mDisplay->mAllocDevice;
     int ret = 0;
-    int dst_stride;
     int usage = GRALLOC_USAGE_SW_READ_NEVER |
             GRALLOC_USAGE_SW_WRITE_NEVER |
 #ifdef USE_FB_PHY_LINEAR
@@ -550,31 +560,33 @@ int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &d
         }
     }
 
+    ageBufferCache();
+
+    /* hand everything back first so the best fit can be picked below */
     for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
         if (mDstBuffers[i]) {
-            alloc_device->free(alloc_device, mDstBuffers[i]);
+            putCachedBuffer(mDstBuffers[i], mBufferUsage, mDstBufFence[i]);
             mDstBuffers[i] = NULL;
-        }
-
-        if (mDstBufFence[i] >= 0) {
+        } else if (mDstBufFence[i] >= 0) {
             close(mDstBufFence[i]);
-            mDstBufFence[i] = -1;
         }
+        mDstBufFence[i] = -1;
 
         if (mMidBuffers[i] != NULL) {
-            alloc_device->free(alloc_device, mMidBuffers[i]);
+            putCachedBuffer(mMidBuffers[i], mBufferUsage, mMidBufFence[i]);
             mMidBuffers[i] = NULL;
-        }
-
-        if (mMidBufFence[i] >= 0) {
+        } else if (mMidBufFence[i] >= 0) {
             close(mMidBufFence[i]);
-            mMidBufFence[i] = -1;
         }
+        mMidBufFence[i] = -1;
+    }
+
+    mBufferUsage = usage;
 
+    for (size_t i = 0; i < NUM_GSC_DST_BUFS; i++) {
         int format = dst_img.format;
-        ret = alloc_device->alloc(alloc_device, w, h,
-                format, usage, &mDstBuffers[i],
-                &dst_stride);
+        ret = getCachedBuffer(w, h, format, usage, &mDstBuffers[i],
+                &mDstBufFence[i]);
         if (ret < 0) {
             ALOGE("failed to allocate destination buffer(%dx%d): %s", w, h,
                     strerror(-ret));
@@ -582,9 +594,9 @@ int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &d
         }
 
         if (need_gsc_op_twice) {
-            ret = alloc_device->alloc(alloc_device, mid_img.w, mid_img.h,
+            ret = getCachedBuffer(mid_img.w, mid_img.h,
                      HAL_PIXEL_FORMAT_EXYNOS_YCrCb_420_SP_M, usage, &mMidBuffers[i],
-                     &dst_stride);
+                     &mMidBufFence[i]);
             if (ret < 0) {
                 ALOGE("failed to allocate intermediate buffer(%dx%d): %s", mid_img.w, mid_img.h,
                         strerror(-ret));
@@ -595,6 +607,97 @@ int ExynosMPP::reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &d
     return ret;
 }
 
+static void freeCachedEntry(alloc_device_t *alloc_device, struct mpp_cached_buffer &entry)
+{
+    if (entry.fence >= 0)
+        close(entry.fence);
+    alloc_device->free(alloc_device, entry.handle);
+
+    entry.handle = NULL;
+    entry.fence = -1;
+}
+
+/*
+ * Returns the smallest cached buffer that fits, see mppBufferCacheFind(),
+ * together with the release fence it was put back with, so the next GSC run
+ * still waits for the display to let go of it.
+ * Non protected allocations are rounded up to MPP_BUFFER_SIZE_CLASS so a
+ * resize animation keeps fitting in the same buffers. Protected buffers are
+ * never cached, see putCachedBuffer().
+ */
+int ExynosMPP::getCachedBuffer(int w, int h, int format, int usage, buffer_handle_t *handle, int *fence)
+{
+    alloc_device_t* alloc_device = mDisplay->mAllocDevice;
+    int best = mppBufferCacheFind(mBufferCache, MPP_BUFFER_CACHE_NUM, w, h, format, usage);
+    int stride;
+    int ret;
+
+    if (best >= 0) {
+        *handle = mBufferCache[best].handle;
+        *fence = mBufferCache[best].fence;
+        mBufferCache[best].handle = NULL;
+        mBufferCache[best].fence = -1;
+        mBufferReuseCount++;
+        return 0;
+    }
+
+    mppBufferCacheAllocSize(!!(usage & GRALLOC_USAGE_PROTECTED), &w, &h);
+
+    *fence = -1;
+    ret = alloc_device->alloc(alloc_device, w, h, format, usage, handle, &stride);
+    if (ret >= 0)
+        mBufferAllocCount++;
+
+    return ret;
+}
+
+void ExynosMPP::putCachedBuffer(buffer_handle_t handle, int usage, int fence)
+{
+    private_handle_t *buf = private_handle_t::dynamicCast(handle);
+    int slot;
+
+    /*
+     * Protected buffers are exact size and rarely fit the next layer, keeping
+     * them would hold old and new copies in the small secure carveout at once
+     */
+    if (usage & GRALLOC_USAGE_PROTECTED) {
+        if (fence >= 0)
+            close(fence);
+        mDisplay->mAllocDevice->free(mDisplay->mAllocDevice, handle);
+        return;
+    }
+
+    slot = mppBufferCacheSlot(mBufferCache, MPP_BUFFER_CACHE_NUM);
+    if (mBufferCache[slot].handle)
+        freeCachedEntry(mDisplay->mAllocDevice, mBufferCache[slot]);
+
+    mBufferCache[slot].handle = handle;
+    mBufferCache[slot].usage = usage;
+    mBufferCache[slot].format = buf->format;
+    mBufferCache[slot].stride = buf->stride;
+    mBufferCache[slot].vstride = buf->vstride;
+    mBufferCache[slot].fence = fence;
+    mBufferCache[slot].lastUsed = systemTime(SYSTEM_TIME_MONOTONIC);
+}
+
+void ExynosMPP::ageBufferCache()
+{
+    nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
+
+    for (size_t i = 0; i < MPP_BUFFER_CACHE_NUM; i++) {
+        if (mppBufferCacheExpired(mBufferCache[i], now))
+            freeCachedEntry(mDisplay->mAllocDevice, mBufferCache[i]);
+    }
+}
+
+void ExynosMPP::freeBufferCache()
+{
+    for (size_t i = 0; i < MPP_BUFFER_CACHE_NUM; i++) {
+        if (mBufferCache[i].handle)
+            freeCachedEntry(mDisplay->mAllocDevice, mBufferCache[i]);
+    }
+}
+
 #ifdef USES_VIRTUAL_DISPLAY
 int ExynosMPP::processM2M(hwc_layer_1_t &layer, int dst_format, hwc_frect_t *sourceCrop, bool isNeedBufferAlloc)
 #else
@@ -652,6 +755,9 @@ int ExynosMPP::processM2M(hwc_layer_1_t &layer, int dst_format, hwc_frect_t *sou
             isDstConfigChanged(dst_img, mDstConfig);
     bool realloc = true;
 
+    if (!reconfigure)
+        ageBufferCache();
+
 #ifdef USES_VIRTUAL_DISPLAY
     if (isNeedBufferAlloc) {
 #endif
@@ -839,6 +945,7 @@ err_alloc:
            mMidBufFence[i] = -1;
        }
     }
+    freeBufferCache();
 #ifdef USES_VIRTUAL_DISPLAY
     }
 #endif
@@ -880,6 +987,9 @@ void ExynosMPP::cleanupM2M()
         if (mMidBufFence[i] >= 0)
             close(mMidBufFence[i]);
     }
+    freeBufferCache();
+    ALOGV("gscaler %u buffers allocated(%u) reused(%u)", AVAILABLE_GSC_UNITS[mIndex],
+            mBufferAllocCount, mBufferReuseCount);
 
     mGscHandle = NULL;
     memset(&mSrcConfig, 0, sizeof(mSrcConfig));
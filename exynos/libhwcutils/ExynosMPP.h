@@ -3,6 +3,7 @@
 
 #include "ExynosDisplay.h"
 #include "MppFactory.h"
+#include "ExynosMPPBufferCache.h"
 
 class ExynosMPP {
 	MppFactory *mppFact;
@@ -59,6 +60,10 @@ class ExynosMPP {
         int                             mGSCMode;
         uint32_t                        mLastGSCLayerHandle;
         int                             mS3DMode;
+        int                             mBufferUsage;
+        struct mpp_cached_buffer        mBufferCache[MPP_BUFFER_CACHE_NUM];
+        uint32_t                        mBufferAllocCount;
+        uint32_t                        mBufferReuseCount;
 
     protected:
         /* Methods */
@@ -78,6 +83,10 @@ class ExynosMPP {
         virtual void setupM2MDestination(exynos_mpp_img &src_img, exynos_mpp_img &dst_img, int dst_format, hwc_layer_1_t &layer, hwc_frect_t *sourceCrop);
         bool setupDoubleOperation(exynos_mpp_img &src_img, exynos_mpp_img &mid_img, hwc_layer_1_t &layer);
         int reallocateBuffers(private_handle_t *src_handle, exynos_mpp_img &dst_img, exynos_mpp_img &mid_img, bool need_gsc_op_twice);
+        int getCachedBuffer(int w, int h, int format, int usage, buffer_handle_t *handle, int *fence);
+        void putCachedBuffer(buffer_handle_t handle, int usage, int fence);
+        void ageBufferCache();
+        void freeBufferCache();
 
         /*
          * Override these virtual functions in chip directory to handle per-chip differences
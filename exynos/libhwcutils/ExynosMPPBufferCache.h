@@ -0,0 +1,93 @@
+#ifndef EXYNOS_MPP_BUFFER_CACHE_H
+#define EXYNOS_MPP_BUFFER_CACHE_H
+
+#include <stddef.h>
+#include <system/window.h>
+#include <utils/Timers.h>
+
+/*
+ * Bookkeeping of the MPP destination buffer cache. Kept free of gralloc so
+ * the selection rules can be tested on the host, ExynosMPP does the actual
+ * alloc and free.
+ */
+
+/* buffers released by a reconfiguration are kept for reuse */
+#define MPP_BUFFER_CACHE_NUM        (NUM_GSC_DST_BUFS * 2)
+/* allocations are rounded up so small size changes fit the same buffer */
+#define MPP_BUFFER_SIZE_CLASS       (128)
+#define MPP_BUFFER_CACHE_TIMEOUT    ms2ns(1000)
+
+#define MPP_BUFFER_ALIGN(x, a)      (((x) + (a) - 1) & ~((a) - 1))
+
+struct mpp_cached_buffer {
+    buffer_handle_t handle;
+    int             usage;
+    int             format;
+    int             stride;
+    int             vstride;
+    int             fence;
+    nsecs_t         lastUsed;
+};
+
+/*
+ * Smallest entry of the same format and usage that w x h fits in, or -1.
+ * Entries with more than twice the rounded up area are left for a bigger
+ * layer.
+ */
+inline int mppBufferCacheFind(const struct mpp_cached_buffer *cache, size_t num,
+        int w, int h, int format, int usage)
+{
+    int maxArea = MPP_BUFFER_ALIGN(w, MPP_BUFFER_SIZE_CLASS) * MPP_BUFFER_ALIGN(h, MPP_BUFFER_SIZE_CLASS) * 2;
+    int best = -1;
+    int bestArea = 0;
+
+    for (size_t i = 0; i < num; i++) {
+        if (!cache[i].handle || cache[i].usage != usage || cache[i].format != format)
+            continue;
+        if (cache[i].stride < w || cache[i].vstride < h)
+            continue;
+
+        int area = cache[i].stride * cache[i].vstride;
+        if (area > maxArea)
+            continue;
+
+        if (best < 0 || area < bestArea) {
+            best = i;
+            bestArea = area;
+        }
+    }
+
+    return best;
+}
+
+/* slot for a buffer handed back: a free one, else the least recently used */
+inline int mppBufferCacheSlot(const struct mpp_cached_buffer *cache, size_t num)
+{
+    int slot = -1;
+
+    for (size_t i = 0; i < num; i++) {
+        if (!cache[i].handle)
+            return i;
+        if (slot < 0 || cache[i].lastUsed < cache[slot].lastUsed)
+            slot = i;
+    }
+
+    return slot;
+}
+
+inline bool mppBufferCacheExpired(const struct mpp_cached_buffer &entry, nsecs_t now)
+{
+    return entry.handle && (now - entry.lastUsed) > MPP_BUFFER_CACHE_TIMEOUT;
+}
+
+/* size a new allocation is made at, protected buffers are not rounded */
+inline void mppBufferCacheAllocSize(bool isProtected, int *w, int *h)
+{
+    if (isProtected)
+        return;
+
+    *w = MPP_BUFFER_ALIGN(*w, MPP_BUFFER_SIZE_CLASS);
+    *h = MPP_BUFFER_ALIGN(*h, MPP_BUFFER_SIZE_CLASS);
+}
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Host test of the G2D tile signatures and damage rectangles, with a CPU
+ * reference blitter standing in for fimg2d
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ExynosG2DDamage.h"
+
+#define TEST_TILE           16
+#define TEST_BUFS           3
+#define TEST_MAX_RECTS      4
+#define TEST_W              200
+#define TEST_H              150
+#define TEST_STRIDE         208
+#define TEST_COLS           ((TEST_W + TEST_TILE - 1) / TEST_TILE)
+#define TEST_ROWS           ((TEST_H + TEST_TILE - 1) / TEST_TILE)
+#define TEST_TILES          (TEST_COLS * TEST_ROWS)
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+struct testWindow {
+    uint64_t tileHash[TEST_TILES + TEST_COLS];
+    uint8_t  dirtyMap[TEST_BUFS][TEST_TILES];
+    uint8_t  *dirty[TEST_BUFS];
+    bool     hashValid;
+};
+
+static void initWindow(struct testWindow &win)
+{
+    memset(&win, 0, sizeof(win));
+    for (int j = 0; j < TEST_BUFS; j++) {
+        win.dirty[j] = win.dirtyMap[j];
+        memset(win.dirty[j], 1, TEST_TILES);
+    }
+}
+
+static int hashWindow(struct testWindow &win, const uint32_t *src)
+{
+    int changed = g2dDamageHashTiles(win.tileHash, win.tileHash + TEST_TILES, win.hashValid,
+            TEST_TILE, TEST_COLS, TEST_ROWS, (const uint8_t *)src, TEST_STRIDE, 4,
+            TEST_W, TEST_H, win.dirty, TEST_BUFS);
+    win.hashValid = true;
+    return changed;
+}
+
+static int countDirty(const uint8_t *dirty)
+{
+    int count = 0;
+
+    for (int t = 0; t < TEST_TILES; t++)
+        count += dirty[t];
+    return count;
+}
+
+static bool rectEquals(const hwc_rect_t &r, int l, int t, int rr, int b)
+{
+    return r.left == l && r.top == t && r.right == rr && r.bottom == b;
+}
+
+static void testRects()
+{
+    uint8_t dirty[TEST_TILES];
+    hwc_rect_t rects[TEST_MAX_RECTS];
+    int n;
+
+    memset(dirty, 0, sizeof(dirty));
+    CHECK(g2dDamageBuildRects(dirty, TEST_TILE, TEST_COLS, TEST_ROWS, TEST_W, TEST_H, rects, TEST_MAX_RECTS) == 0);
+
+    /* a 2x3 tile block stacks into one rectangle */
+    for (int ty = 1; ty < 4; ty++) {
+        dirty[ty * TEST_COLS + 2] = 1;
+        dirty[ty * TEST_COLS + 3] = 1;
+    }
+    n = g2dDamageBuildRects(dirty, TEST_TILE, TEST_COLS, TEST_ROWS, TEST_W, TEST_H, rects, TEST_MAX_RECTS);
+    CHECK(n == 1);
+    CHECK(rectEquals(rects[0], 32, 16, 64, 64));
+
+    /* the last column and row are clipped to the layer */
+    memset(dirty, 0, sizeof(dirty));
+    dirty[TEST_TILES - 1] = 1;
+    n = g2dDamageBuildRects(dirty, TEST_TILE, TEST_COLS, TEST_ROWS, TEST_W, TEST_H, rects, TEST_MAX_RECTS);
+    CHECK(n == 1);
+    CHECK(rectEquals(rects[0], 192, 144, TEST_W, TEST_H));
+
+    /* a row span covers the gap between its first and last dirty tile */
+    memset(dirty, 0, sizeof(dirty));
+    dirty[0] = 1;
+    dirty[5] = 1;
+    n = g2dDamageBuildRects(dirty, TEST_TILE, TEST_COLS, TEST_ROWS, TEST_W, TEST_H, rects, TEST_MAX_RECTS);
+    CHECK(n == 1);
+    CHECK(rectEquals(rects[0], 0, 0, 96, 16));
+
+    /* more spans than rectangles collapse into the bounding box */
+    memset(dirty, 0, sizeof(dirty));
+    for (int ty = 0; ty < TEST_ROWS; ty += 2)
+        dirty[ty * TEST_COLS + (ty % 3)] = 1;
+    n = g2dDamageBuildRects(dirty, TEST_TILE, TEST_COLS, TEST_ROWS, TEST_W, TEST_H, rects, TEST_MAX_RECTS);
+    CHECK(n == 1);
+    CHECK(rectEquals(rects[0], 0, 0, 48, 144));
+}
+
+static void testHash()
+{
+    static uint32_t src[TEST_STRIDE * TEST_H];
+    struct testWindow win;
+
+    for (int i = 0; i < TEST_STRIDE * TEST_H; i++)
+        src[i] = i * 2654435761U;
+    initWindow(win);
+
+    /* the first frame has nothing to compare with */
+    CHECK(hashWindow(win, src) == TEST_TILES);
+
+    for (int j = 0; j < TEST_BUFS; j++)
+        memset(win.dirty[j], 0, TEST_TILES);
+    CHECK(hashWindow(win, src) == 0);
+    CHECK(countDirty(win.dirty[0]) == 0);
+
+    /* one pixel flips one tile, in every buffer */
+    src[40 * TEST_STRIDE + 100] ^= 1;
+    CHECK(hashWindow(win, src) == 1);
+    for (int j = 0; j < TEST_BUFS; j++) {
+        CHECK(countDirty(win.dirty[j]) == 1);
+        CHECK(win.dirty[j][(40 / TEST_TILE) * TEST_COLS + 100 / TEST_TILE] == 1);
+    }
+
+    /* swapping two pixels inside a tile is still a change */
+    for (int j = 0; j < TEST_BUFS; j++)
+        memset(win.dirty[j], 0, TEST_TILES);
+    uint32_t tmp = src[5 * TEST_STRIDE + 5];
+    src[5 * TEST_STRIDE + 5] = src[5 * TEST_STRIDE + 6];
+    src[5 * TEST_STRIDE + 6] = tmp;
+    CHECK(hashWindow(win, src) == 1);
+
+    /* the padding beyond the layer width is not part of any tile */
+    src[10 * TEST_STRIDE + TEST_W + 3] ^= 0xff;
+    CHECK(hashWindow(win, src) == 0);
+}
+
+static void referenceBlit(uint32_t *dst, const uint32_t *src, const hwc_rect_t &r)
+{
+    for (int y = r.top; y < r.bottom; y++)
+        memcpy(dst + y * TEST_STRIDE + r.left, src + y * TEST_STRIDE + r.left,
+                (r.right - r.left) * sizeof(uint32_t));
+}
+
+/*
+ * A blinking cursor and a clock over a static background, displayed through
+ * three rotating window buffers. Every buffer must match the source right
+ * after it was brought up to date, no matter how many frames it missed.
+ */
+static void testReplay()
+{
+    static uint32_t src[TEST_STRIDE * TEST_H];
+    static uint32_t buf[TEST_BUFS][TEST_STRIDE * TEST_H];
+    struct testWindow win;
+    unsigned long long blitPixels = 0, fullPixels = 0;
+    int frames = 90;
+
+    for (int i = 0; i < TEST_STRIDE * TEST_H; i++)
+        src[i] = 0xff000000 | (i & 0xffff);
+    memset(buf, 0, sizeof(buf));
+    initWindow(win);
+
+    for (int frame = 0; frame < frames; frame++) {
+        int cur = frame % TEST_BUFS;
+        hwc_rect_t rects[TEST_MAX_RECTS];
+        int n;
+
+        /* cursor blinks every 15 frames, the clock ticks every 30 */
+        if (frame % 15 == 0) {
+            for (int y = 70; y < 86; y++)
+                src[y * TEST_STRIDE + 120] ^= 0x00ffffff;
+        }
+        if (frame % 30 == 0) {
+            for (int y = 2; y < 12; y++)
+                for (int x = 150; x < 190; x++)
+                    src[y * TEST_STRIDE + x] += frame;
+        }
+
+        hashWindow(win, src);
+        n = g2dDamageBuildRects(win.dirty[cur], TEST_TILE, TEST_COLS, TEST_ROWS,
+                TEST_W, TEST_H, rects, TEST_MAX_RECTS);
+        for (int i = 0; i < n; i++) {
+            referenceBlit(buf[cur], src, rects[i]);
+            blitPixels += (rects[i].right - rects[i].left) * (rects[i].bottom - rects[i].top);
+        }
+        memset(win.dirty[cur], 0, TEST_TILES);
+        fullPixels += TEST_W * TEST_H;
+
+        for (int y = 0; y < TEST_H; y++) {
+            if (memcmp(buf[cur] + y * TEST_STRIDE, src + y * TEST_STRIDE, TEST_W * sizeof(uint32_t))) {
+                fprintf(stderr, "frame %d buffer %d differs at line %d\n", frame, cur, y);
+                failCount++;
+                break;
+            }
+        }
+    }
+
+    printf("damage replay: %llu of %llu pixels blitted (%.1f%%)\n",
+            blitPixels, fullPixels, blitPixels * 100.0 / fullPixels);
+    CHECK(blitPixels * 10 < fullPixels);
+}
+
+int main()
+{
+    testRects();
+    testHash();
+    testReplay();
+
+    if (failCount != 0) {
+        printf("ExynosG2DDamage_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+
+    printf("ExynosG2DDamage_test: pass\n");
+    return 0;
+}
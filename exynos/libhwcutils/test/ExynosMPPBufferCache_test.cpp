@@ -0,0 +1,175 @@
+/*
+ * Host test of the MPP destination buffer cache selection rules
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ExynosMPPBufferCache.h"
+
+#define TEST_CACHE_NUM      4
+#define TEST_FORMAT_RGB     1
+#define TEST_FORMAT_YUV     2
+#define TEST_USAGE          0x100
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+/* only compared against NULL, any distinct address will do */
+static native_handle_t handles[TEST_CACHE_NUM];
+
+static void setEntry(struct mpp_cached_buffer *cache, int i, int format, int w, int h, nsecs_t lastUsed)
+{
+    cache[i].handle = &handles[i];
+    cache[i].usage = TEST_USAGE;
+    cache[i].format = format;
+    cache[i].stride = w;
+    cache[i].vstride = h;
+    cache[i].fence = -1;
+    cache[i].lastUsed = lastUsed;
+}
+
+static void clearCache(struct mpp_cached_buffer *cache)
+{
+    memset(cache, 0, sizeof(struct mpp_cached_buffer) * TEST_CACHE_NUM);
+    for (int i = 0; i < TEST_CACHE_NUM; i++)
+        cache[i].fence = -1;
+}
+
+static void testFind()
+{
+    struct mpp_cached_buffer cache[TEST_CACHE_NUM];
+
+    clearCache(cache);
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 640, 480, TEST_FORMAT_RGB, TEST_USAGE) < 0);
+
+    setEntry(cache, 0, TEST_FORMAT_RGB, 1920, 1152, 0);
+    setEntry(cache, 1, TEST_FORMAT_RGB, 768, 512, 0);
+    setEntry(cache, 2, TEST_FORMAT_YUV, 640, 512, 0);
+    setEntry(cache, 3, TEST_FORMAT_RGB, 640, 384, 0);
+
+    /* smallest buffer of the right format that is big enough */
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 640, 480, TEST_FORMAT_RGB, TEST_USAGE) == 1);
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 640, 480, TEST_FORMAT_YUV, TEST_USAGE) == 2);
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 600, 360, TEST_FORMAT_RGB, TEST_USAGE) == 3);
+
+    /* other usage never matches */
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 640, 480, TEST_FORMAT_RGB, TEST_USAGE | 1) < 0);
+
+    /* too narrow or too short, and the big one is more than twice the size */
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 800, 300, TEST_FORMAT_RGB, TEST_USAGE) < 0);
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 2000, 100, TEST_FORMAT_RGB, TEST_USAGE) < 0);
+
+    /* a display sized buffer is not wasted on a thumbnail */
+    cache[1].handle = NULL;
+    cache[3].handle = NULL;
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 320, 240, TEST_FORMAT_RGB, TEST_USAGE) < 0);
+    CHECK(mppBufferCacheFind(cache, TEST_CACHE_NUM, 1280, 1080, TEST_FORMAT_RGB, TEST_USAGE) == 0);
+}
+
+static void testSlot()
+{
+    struct mpp_cached_buffer cache[TEST_CACHE_NUM];
+
+    clearCache(cache);
+    CHECK(mppBufferCacheSlot(cache, TEST_CACHE_NUM) == 0);
+
+    setEntry(cache, 0, TEST_FORMAT_RGB, 640, 480, 300);
+    setEntry(cache, 1, TEST_FORMAT_RGB, 640, 480, 100);
+    CHECK(mppBufferCacheSlot(cache, TEST_CACHE_NUM) == 2);
+
+    /* full: the least recently used entry is replaced */
+    setEntry(cache, 2, TEST_FORMAT_RGB, 640, 480, 200);
+    setEntry(cache, 3, TEST_FORMAT_RGB, 640, 480, 400);
+    CHECK(mppBufferCacheSlot(cache, TEST_CACHE_NUM) == 1);
+}
+
+static void testExpired()
+{
+    struct mpp_cached_buffer cache[TEST_CACHE_NUM];
+    nsecs_t now = ms2ns(5000);
+
+    clearCache(cache);
+    CHECK(!mppBufferCacheExpired(cache[0], now));
+
+    setEntry(cache, 0, TEST_FORMAT_RGB, 640, 480, now - MPP_BUFFER_CACHE_TIMEOUT);
+    setEntry(cache, 1, TEST_FORMAT_RGB, 640, 480, now - MPP_BUFFER_CACHE_TIMEOUT - 1);
+    CHECK(!mppBufferCacheExpired(cache[0], now));
+    CHECK(mppBufferCacheExpired(cache[1], now));
+}
+
+static void testAllocSize()
+{
+    int w = 721, h = 480;
+
+    mppBufferCacheAllocSize(false, &w, &h);
+    CHECK(w == 768);
+    CHECK(h == 512);
+
+    w = 721;
+    h = 480;
+    mppBufferCacheAllocSize(true, &w, &h);
+    CHECK(w == 721);
+    CHECK(h == 480);
+}
+
+/* a resize animation allocates once and then keeps fitting the same buffer */
+static void testResizeReplay()
+{
+    struct mpp_cached_buffer cache[TEST_CACHE_NUM];
+    int allocCount = 0, reuseCount = 0;
+    int held = -1;
+
+    clearCache(cache);
+
+    for (int step = 0; step < 60; step++) {
+        int w = 600 + step;
+        int h = 340 + step / 2;
+        int idx;
+
+        /* reconfiguration hands the current buffer back first */
+        if (held >= 0)
+            cache[held].handle = &handles[held];
+
+        idx = mppBufferCacheFind(cache, TEST_CACHE_NUM, w, h, TEST_FORMAT_RGB, TEST_USAGE);
+        if (idx >= 0) {
+            reuseCount++;
+        } else {
+            idx = mppBufferCacheSlot(cache, TEST_CACHE_NUM);
+            mppBufferCacheAllocSize(false, &w, &h);
+            setEntry(cache, idx, TEST_FORMAT_RGB, w, h, step);
+            allocCount++;
+        }
+        cache[idx].handle = NULL;
+        held = idx;
+    }
+
+    printf("resize replay: %d allocations, %d reuses\n", allocCount, reuseCount);
+    CHECK(allocCount == 2);
+    CHECK(reuseCount == 58);
+}
+
+int main()
+{
+    testFind();
+    testSlot();
+    testExpired();
+    testAllocSize();
+    testResizeReplay();
+
+    if (failCount != 0) {
+        printf("ExynosMPPBufferCache_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+
+    printf("ExynosMPPBufferCache_test: pass\n");
+    return 0;
+}
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#define LOG_TAG "ExynosOMXPlugin"
+
 #include "Exynos_OMX_Plugin.h"
 
 #include <dlfcn.h>
@@ -51,6 +53,7 @@ ExynosOMXPlugin::ExynosOMXPlugin()
 
         (*mInit)();
 
+        buildComponentTable();
     }
 }
 
@@ -63,6 +66,28 @@ ExynosOMXPlugin::~ExynosOMXPlugin() {
     }
 }
 
+void ExynosOMXPlugin::buildComponentTable() {
+    char name[OMX_MAX_STRINGNAME_SIZE];
+
+    for (OMX_U32 index = 0;
+         (*mComponentNameEnum)(name, sizeof(name), index) == OMX_ErrorNone;
+         ++index) {
+        ComponentInfo info;
+
+        info.mName = name;
+        OMX_ERRORTYPE err = queryRolesOfComponent(name, &info.mRoles);
+        if (err != OMX_ErrorNone) {
+            /* still listed, so a lookup by name does not fail on it */
+            ALOGW("%s: roles of %s unavailable (0x%x), listed without roles",
+                  __FUNCTION__, name, err);
+            info.mRoles.clear();
+        }
+
+        mComponentIndex.add(info.mName, mComponents.size());
+        mComponents.push(info);
+    }
+}
+
 OMX_ERRORTYPE ExynosOMXPlugin::makeComponentInstance(
         const char *name,
         const OMX_CALLBACKTYPE *callbacks,
@@ -95,7 +120,13 @@ OMX_ERRORTYPE ExynosOMXPlugin::enumerateComponents(
         return OMX_ErrorUndefined;
     }
 
-    return (*mComponentNameEnum)(name, size, index);
+    if (index >= mComponents.size()) {
+        return OMX_ErrorNoMore;
+    }
+
+    snprintf(name, size, "%s", mComponents[index].mName.string());
+
+    return OMX_ErrorNone;
 }
 
 OMX_ERRORTYPE ExynosOMXPlugin::getRolesOfComponent(
@@ -107,6 +138,21 @@ OMX_ERRORTYPE ExynosOMXPlugin::getRolesOfComponent(
         return OMX_ErrorUndefined;
     }
 
+    ssize_t index = mComponentIndex.indexOfKey(String8(name));
+    if (index < 0) {
+        return OMX_ErrorComponentNotFound;
+    }
+
+    *roles = mComponents[mComponentIndex.valueAt(index)].mRoles;
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE ExynosOMXPlugin::queryRolesOfComponent(
+        const char *name,
+        Vector<String8> *roles) {
+    roles->clear();
+
     OMX_U32 numRoles;
     OMX_ERRORTYPE err = (*mGetRolesOfComponentHandle)(
             const_cast<OMX_STRING>(name), &numRoles, NULL);
@@ -20,6 +20,10 @@
 
 #include <media/hardware/OMXPluginBase.h>
 
+#include <utils/KeyedVector.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
 namespace android {
 
 struct ExynosOMXPlugin : public OMXPluginBase {
@@ -67,6 +71,28 @@ private:
     FreeHandleFunc mFreeHandle;
     GetRolesOfComponentFunc mGetRolesOfComponentHandle;
 
+    /*
+     * Component names and roles never change once the core is loaded, so
+     * they are read once in the constructor. The table is not modified after
+     * that, which lets the queries run without a lock. A component whose
+     * roles cannot be read is kept with an empty role list. Profiles, levels
+     * and color formats are not probed and nothing is persisted: the plugin
+     * API has no query for them, and probing would load the MFC firmware at
+     * startup.
+     */
+    struct ComponentInfo {
+        String8 mName;
+        Vector<String8> mRoles;
+    };
+
+    Vector<ComponentInfo> mComponents;
+    KeyedVector<String8, size_t> mComponentIndex;
+
+    void buildComponentTable();
+    OMX_ERRORTYPE queryRolesOfComponent(
+            const char *name,
+            Vector<String8> *roles);
+
     ExynosOMXPlugin(const ExynosOMXPlugin &);
     ExynosOMXPlugin &operator=(const ExynosOMXPlugin &);
 };
@@ -34,6 +34,7 @@
 #include <errno.h>
 #include <ctype.h>
 #include <string.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
@@ -95,6 +96,33 @@ static struct media_link *__media_entity_add_link(struct media_entity *entity)
     return &entity->links[entity->num_links++];
 }
 
+static int __media_add_link_desc(struct media_device *media, struct media_link_desc *link)
+{
+    struct media_link *fwdlink;
+    struct media_link *backlink;
+    struct media_entity *source;
+    struct media_entity *sink;
+
+    source = exynos_media_get_entity_by_id(media, link->source.entity);
+    sink = exynos_media_get_entity_by_id(media, link->sink.entity);
+    if (source == NULL || sink == NULL)
+        return -EINVAL;
+
+    fwdlink = __media_entity_add_link(source);
+    fwdlink->source = &source->pads[link->source.index];
+    fwdlink->sink = &sink->pads[link->sink.index];
+    fwdlink->flags = link->flags;
+
+    backlink = __media_entity_add_link(sink);
+    backlink->source = &source->pads[link->source.index];
+    backlink->sink = &sink->pads[link->sink.index];
+    backlink->flags = link->flags;
+
+    fwdlink->twin = backlink;
+    backlink->twin = fwdlink;
+
+    return 0;
+}
 
 static int __media_enum_links(struct media_device *media)
 {
@@ -126,33 +154,14 @@ static int __media_enum_links(struct media_device *media)
 
         for (i = 0; i < entity->info.links; ++i) {
             struct media_link_desc *link = &links.links[i];
-            struct media_link *fwdlink;
-            struct media_link *backlink;
-            struct media_entity *source;
-            struct media_entity *sink;
-
-            source = exynos_media_get_entity_by_id(media, link->source.entity);
-            sink = exynos_media_get_entity_by_id(media, link->sink.entity);
-            if (source == NULL || sink == NULL) {
+
+            if (__media_add_link_desc(media, link) < 0) {
                 ALOGE("WARNING entity %u link %u from %u/%u to %u/%u is invalid!",
                       id, i, link->source.entity,
                       link->source.index,
                       link->sink.entity,
                       link->sink.index);
                 ret = -EINVAL;
-            } else {
-                fwdlink = __media_entity_add_link(source);
-                fwdlink->source = &source->pads[link->source.index];
-                fwdlink->sink = &sink->pads[link->sink.index];
-                fwdlink->flags = link->flags;
-
-                backlink = __media_entity_add_link(sink);
-                backlink->source = &source->pads[link->source.index];
-                backlink->sink = &sink->pads[link->sink.index];
-                backlink->flags = link->flags;
-
-                fwdlink->twin = backlink;
-                backlink->twin = fwdlink;
             }
         }
 
@@ -266,6 +275,428 @@ static int __media_enum_entities(struct media_device *media)
     return ret;
 }
 
+/*
+ * Topology cache
+ *
+ * A full enumeration costs two ioctls per entity plus a sysfs lookup and a
+ * mknod per device node, and the camera and HDMI paths reopen the media
+ * device on every mode or sensor switch. The first open of a media device
+ * keeps a snapshot of its entities, pads and device node names. Later opens
+ * of the same node revalidate the snapshot with a few ioctls, build the
+ * entities from memory and only enumerate links. Link state can be changed by
+ * any other process or media_device, so it is never cached. The snapshot also
+ * carries hash indexes for looking entities up by name and id.
+ *
+ * Every open still gets a private media_device. struct media_device is part of
+ * the public interface, so the snapshot an open uses is kept in a side table
+ * instead of in the device itself.
+ */
+struct media_topology_entity {
+    struct media_entity_desc info;
+    char devname[32];
+    struct media_pad_desc *pads;
+};
+
+struct media_topology {
+    struct media_topology *next;
+    char filename[64];
+    dev_t rdev;
+    struct media_device_info info;
+    unsigned int refcount;
+    int stale;
+
+    struct media_topology_entity *entities;
+    unsigned int entities_count;
+
+    /* open addressing, entity index + 1, 0 is an empty bucket */
+    unsigned int hash_size;
+    unsigned int *name_hash;
+    unsigned int *id_hash;
+};
+
+struct media_topology_user {
+    struct media_topology_user *next;
+    struct media_device *media;
+    struct media_topology *topo;
+};
+
+static pthread_mutex_t __media_topology_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct media_topology *__media_topology_list = NULL;
+static struct media_topology_user *__media_topology_users = NULL;
+
+static unsigned int __media_hash_name(const char *name, size_t length)
+{
+    unsigned int hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < length && name[i] != '\0'; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static inline unsigned int __media_hash_id(__u32 id)
+{
+    return id * 2654435761u;
+}
+
+static void __media_topology_free(struct media_topology *topo)
+{
+    unsigned int i;
+
+    for (i = 0; i < topo->entities_count; i++)
+        free(topo->entities[i].pads);
+
+    free(topo->entities);
+    free(topo->name_hash);
+    free(topo->id_hash);
+    free(topo);
+}
+
+static int __media_topology_index(struct media_topology *topo)
+{
+    unsigned int mask;
+    unsigned int h;
+    unsigned int i;
+
+    topo->hash_size = 16;
+    while (topo->hash_size < topo->entities_count * 2)
+        topo->hash_size <<= 1;
+    mask = topo->hash_size - 1;
+
+    topo->name_hash = (unsigned int *)calloc(topo->hash_size, sizeof(unsigned int));
+    topo->id_hash = (unsigned int *)calloc(topo->hash_size, sizeof(unsigned int));
+    if (topo->name_hash == NULL || topo->id_hash == NULL)
+        return -ENOMEM;
+
+    for (i = 0; i < topo->entities_count; i++) {
+        struct media_entity_desc *info = &topo->entities[i].info;
+
+        h = __media_hash_name(info->name, sizeof(info->name)) & mask;
+        while (topo->name_hash[h] != 0)
+            h = (h + 1) & mask;
+        topo->name_hash[h] = i + 1;
+
+        h = __media_hash_id(info->id) & mask;
+        while (topo->id_hash[h] != 0)
+            h = (h + 1) & mask;
+        topo->id_hash[h] = i + 1;
+    }
+
+    return 0;
+}
+
+/* Snapshot used by @a media, NULL if it was enumerated without one */
+static struct media_topology *__media_topology_of(struct media_device *media)
+{
+    struct media_topology_user *user;
+    struct media_topology *topo = NULL;
+
+    pthread_mutex_lock(&__media_topology_lock);
+
+    for (user = __media_topology_users; user != NULL; user = user->next) {
+        if (user->media == media) {
+            topo = user->topo;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&__media_topology_lock);
+
+    return topo;
+}
+
+/* Called with __media_topology_lock held */
+static int __media_topology_bind(struct media_topology *topo, struct media_device *media)
+{
+    struct media_topology_user *user;
+
+    user = (struct media_topology_user *)malloc(sizeof(*user));
+    if (user == NULL)
+        return -ENOMEM;
+
+    user->media = media;
+    user->topo = topo;
+    user->next = __media_topology_users;
+    __media_topology_users = user;
+    topo->refcount++;
+
+    return 0;
+}
+
+static struct media_entity *__media_topology_find_name(struct media_topology *topo,
+        struct media_device *media, const char *name, size_t length)
+{
+    unsigned int mask = topo->hash_size - 1;
+    size_t len = strnlen(name, length);
+    unsigned int h;
+
+    for (h = __media_hash_name(name, len) & mask; topo->name_hash[h] != 0; h = (h + 1) & mask) {
+        struct media_entity *entity = &media->entities[topo->name_hash[h] - 1];
+
+        if (strnlen(entity->info.name, sizeof(entity->info.name)) == len &&
+            memcmp(entity->info.name, name, len) == 0)
+            return entity;
+    }
+
+    return NULL;
+}
+
+static struct media_entity *__media_topology_find_id(struct media_topology *topo,
+        struct media_device *media, __u32 id)
+{
+    unsigned int mask = topo->hash_size - 1;
+    unsigned int h;
+
+    for (h = __media_hash_id(id) & mask; topo->id_hash[h] != 0; h = (h + 1) & mask) {
+        struct media_entity *entity = &media->entities[topo->id_hash[h] - 1];
+
+        if (entity->info.id == id)
+            return entity;
+    }
+
+    return NULL;
+}
+
+static struct media_topology *__media_topology_create(const char *filename,
+        struct media_device *media, dev_t rdev, struct media_device_info *info)
+{
+    struct media_topology *topo;
+    unsigned int i, j;
+
+    topo = (struct media_topology *)calloc(1, sizeof(struct media_topology));
+    if (topo == NULL)
+        return NULL;
+
+    strncpy(topo->filename, filename, sizeof(topo->filename) - 1);
+    topo->rdev = rdev;
+    topo->info = *info;
+
+    topo->entities = (struct media_topology_entity *)calloc(media->entities_count,
+                                            sizeof(struct media_topology_entity));
+    if (topo->entities == NULL)
+        goto err;
+    topo->entities_count = media->entities_count;
+
+    for (i = 0; i < media->entities_count; i++) {
+        struct media_entity *entity = &media->entities[i];
+        struct media_topology_entity *t = &topo->entities[i];
+
+        t->info = entity->info;
+        memcpy(t->devname, entity->devname, sizeof(t->devname));
+
+        t->pads = (struct media_pad_desc *)calloc(entity->info.pads + 1, sizeof(struct media_pad_desc));
+        if (t->pads == NULL)
+            goto err;
+
+        for (j = 0; j < entity->info.pads; j++) {
+            t->pads[j].entity = entity->info.id;
+            t->pads[j].index = entity->pads[j].index;
+            t->pads[j].flags = entity->pads[j].flags;
+        }
+    }
+
+    if (__media_topology_index(topo) < 0)
+        goto err;
+
+    return topo;
+
+err:
+    __media_topology_free(topo);
+    return NULL;
+}
+
+static int __media_topology_build(struct media_topology *topo, struct media_device *media)
+{
+    unsigned int i, j;
+
+    media->entities = (struct media_entity *)calloc(topo->entities_count, sizeof(struct media_entity));
+    if (media->entities == NULL)
+        return -ENOMEM;
+    media->entities_count = topo->entities_count;
+
+    for (i = 0; i < topo->entities_count; i++)
+        media->entities[i].fd = -1;
+
+    for (i = 0; i < topo->entities_count; i++) {
+        struct media_entity *entity = &media->entities[i];
+        struct media_topology_entity *t = &topo->entities[i];
+
+        entity->media = media;
+        entity->info = t->info;
+        memcpy(entity->devname, t->devname, sizeof(entity->devname));
+
+        entity->max_links = entity->info.pads + entity->info.links;
+        entity->pads = (struct media_pad*)malloc(entity->info.pads * sizeof(*entity->pads));
+        entity->links = (struct media_link*)malloc(entity->max_links * sizeof(*entity->links));
+        if (entity->pads == NULL || entity->links == NULL)
+            return -ENOMEM;
+
+        for (j = 0; j < entity->info.pads; j++) {
+            entity->pads[j].entity = entity;
+            entity->pads[j].index = t->pads[j].index;
+            entity->pads[j].flags = t->pads[j].flags;
+        }
+    }
+
+    /* link flags are whatever the kernel says now, not what they were */
+    return __media_enum_links(media);
+}
+
+/* Check that nothing was (un)registered since the snapshot was taken */
+static int __media_topology_valid(struct media_topology *topo, int fd)
+{
+    struct media_device_info info;
+    struct media_entity_desc desc;
+    struct media_entity_desc *last;
+
+    if (topo->entities_count == 0)
+        return 0;
+
+    memset(&info, 0, sizeof(info));
+    if (ioctl(fd, MEDIA_IOC_DEVICE_INFO, &info) < 0 ||
+        memcmp(&info, &topo->info, sizeof(info)) != 0)
+        return 0;
+
+    last = &topo->entities[topo->entities_count - 1].info;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.id = last->id;
+    if (ioctl(fd, MEDIA_IOC_ENUM_ENTITIES, &desc) < 0 ||
+        memcmp(&desc, last, sizeof(desc)) != 0)
+        return 0;
+
+    memset(&desc, 0, sizeof(desc));
+    desc.id = last->id | MEDIA_ENT_ID_FLAG_NEXT;
+    if (ioctl(fd, MEDIA_IOC_ENUM_ENTITIES, &desc) == 0 || errno != EINVAL)
+        return 0;
+
+    return 1;
+}
+
+static void __media_topology_unlink(struct media_topology *topo)
+{
+    struct media_topology **prev;
+
+    for (prev = &__media_topology_list; *prev != NULL; prev = &(*prev)->next) {
+        if (*prev == topo) {
+            *prev = topo->next;
+            break;
+        }
+    }
+
+    topo->stale = 1;
+    if (topo->refcount == 0)
+        __media_topology_free(topo);
+}
+
+static struct media_topology *__media_topology_lookup(const char *filename, dev_t rdev)
+{
+    struct media_topology *topo;
+
+    for (topo = __media_topology_list; topo != NULL; topo = topo->next) {
+        if (topo->rdev == rdev &&
+            strncmp(topo->filename, filename, sizeof(topo->filename)) == 0)
+            return topo;
+    }
+
+    return NULL;
+}
+
+/*
+ * Build @a media from the cached snapshot.
+ * Returns 0 on a cache hit, 1 if the graph has to be enumerated, or a
+ * negative error code.
+ */
+static int __media_topology_attach(const char *filename, struct media_device *media)
+{
+    struct media_topology *topo;
+    struct stat st;
+    int ret = 1;
+
+    if (fstat(media->fd, &st) < 0)
+        return 1;
+
+    pthread_mutex_lock(&__media_topology_lock);
+
+    topo = __media_topology_lookup(filename, st.st_rdev);
+    if (topo != NULL) {
+        if (__media_topology_valid(topo, media->fd)) {
+            ret = __media_topology_bind(topo, media);
+        } else {
+            ALOGD("%s: topology of %s changed", __func__, filename);
+            __media_topology_unlink(topo);
+            topo = NULL;
+        }
+    }
+
+    pthread_mutex_unlock(&__media_topology_lock);
+
+    /* the reference keeps the snapshot alive, and it is never modified */
+    if (topo != NULL && ret == 0)
+        ret = __media_topology_build(topo, media);
+
+    return ret;
+}
+
+static void __media_topology_register(const char *filename, struct media_device *media)
+{
+    struct media_topology *topo;
+    struct media_topology *old;
+    struct media_device_info info;
+    struct stat st;
+
+    if (fstat(media->fd, &st) < 0)
+        return;
+
+    /* without device info there is nothing to revalidate against */
+    memset(&info, 0, sizeof(info));
+    if (ioctl(media->fd, MEDIA_IOC_DEVICE_INFO, &info) < 0)
+        return;
+
+    topo = __media_topology_create(filename, media, st.st_rdev, &info);
+    if (topo == NULL)
+        return;
+
+    pthread_mutex_lock(&__media_topology_lock);
+
+    old = __media_topology_lookup(filename, st.st_rdev);
+    if (old != NULL)
+        __media_topology_unlink(old);
+
+    topo->next = __media_topology_list;
+    __media_topology_list = topo;
+    if (__media_topology_bind(topo, media) < 0)
+        ALOGD("%s: %s is cached but not indexed", __func__, filename);
+
+    pthread_mutex_unlock(&__media_topology_lock);
+}
+
+static void __media_topology_release(struct media_device *media)
+{
+    struct media_topology_user **prev;
+    struct media_topology_user *user;
+
+    pthread_mutex_lock(&__media_topology_lock);
+
+    for (prev = &__media_topology_users; *prev != NULL; prev = &(*prev)->next) {
+        user = *prev;
+        if (user->media != media)
+            continue;
+
+        *prev = user->next;
+        user->topo->refcount--;
+        if (user->topo->stale && user->topo->refcount == 0)
+            __media_topology_free(user->topo);
+        free(user);
+        break;
+    }
+
+    pthread_mutex_unlock(&__media_topology_lock);
+}
+
 static struct media_device *__media_open_debug(
         const char *filename,
         void (*debug_handler)(void *, ...),
@@ -292,6 +723,18 @@ static struct media_device *__media_open_debug(
         return NULL;
     }
 
+    ret = __media_topology_attach(filename, media);
+    if (ret < 0) {
+        ALOGE("Unable to build cached topology for device %s (%s)", filename, strerror(-ret));
+        exynos_media_close(media);
+        return NULL;
+    }
+
+    if (ret == 0) {
+        ALOGD("%s: Found %u entities (cached)", __func__, media->entities_count);
+        return media;
+    }
+
     ALOGD("%s: media->fd: %d", __func__, media->fd);
     ret = __media_enum_entities(media);
 
@@ -311,6 +754,8 @@ static struct media_device *__media_open_debug(
         return NULL;
     }
 
+    __media_topology_register(filename, media);
+
     return media;
 }
 
@@ -319,7 +764,8 @@ static struct media_device *__media_open_debug(
  * @param filename - name (including path) of the device node.
  *
  * Open the media device referenced by @a filename and enumerate entities, pads and
- * links.
+ * links. The graph is enumerated once per device node and process; later opens
+ * revalidate and reuse that snapshot.
  *
  * @return A pointer to a newly allocated media_device structure instance on
  * success and NULL on failure. The returned pointer must be freed with
@@ -354,6 +800,9 @@ void exynos_media_close(struct media_device *media)
     }
 
     free(media->entities);
+
+    __media_topology_release(media);
+
     free(media);
 }
 
@@ -403,6 +852,15 @@ struct media_entity *exynos_media_get_entity_by_name(struct media_device *media,
 {
     unsigned int i;
     struct media_entity *entity;
+    struct media_topology *topo = __media_topology_of(media);
+
+    if (topo != NULL) {
+        entity = __media_topology_find_name(topo, media, name, length);
+
+        /* a name shorter than @a length must match exactly anyway */
+        if (entity != NULL || strnlen(name, length) < length)
+            return entity;
+    }
 
     for (i = 0; i < media->entities_count; ++i) {
         entity = &media->entities[i];
@@ -427,6 +885,10 @@ struct media_entity *exynos_media_get_entity_by_id(struct media_device *media,
                         __u32 id)
 {
     unsigned int i;
+    struct media_topology *topo = __media_topology_of(media);
+
+    if (topo != NULL)
+        return __media_topology_find_id(topo, media, id);
 
     for (i = 0; i < media->entities_count; ++i) {
         struct media_entity *entity = &media->entities[i];
@@ -872,6 +872,7 @@ static ExynosVideoErrorType MFC_Encoder_Set_FrameType(
 {
     ExynosVideoEncContext *pCtx = (ExynosVideoEncContext *)pHandle;
     ExynosVideoErrorType   ret  = VIDEO_ERROR_NONE;
+    int                    forceType;
 
     if (pCtx == NULL) {
         ALOGE("%s: Video context info must be supplied", __func__);
@@ -879,7 +880,20 @@ static ExynosVideoErrorType MFC_Encoder_Set_FrameType(
         goto EXIT;
     }
 
-    if (exynos_v4l2_s_ctrl(pCtx->hEnc, V4L2_CID_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE, frameType) != 0) {
+    /* the control has its own numbering */
+    switch (frameType) {
+    case VIDEO_FRAME_I:
+        forceType = V4L2_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE_I_FRAME;
+        break;
+    case VIDEO_FRAME_SKIPPED:
+        forceType = V4L2_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE_NOT_CODED;
+        break;
+    default:
+        forceType = V4L2_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE_DISABLED;
+        break;
+    }
+
+    if (exynos_v4l2_s_ctrl(pCtx->hEnc, V4L2_CID_MPEG_MFC51_VIDEO_FORCE_FRAME_TYPE, forceType) != 0) {
         ALOGE("%s: Failed to s_ctrl", __func__);
         ret = VIDEO_ERROR_APIFAIL;
         goto EXIT;
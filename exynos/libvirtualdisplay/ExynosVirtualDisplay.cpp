@@ -38,8 +38,6 @@ ExynosVirtualDisplay::ExynosVirtualDisplay(struct exynos5_hwc_composer_device_1_
     mPrevDisplayFrame.top = 0;
     mPrevDisplayFrame.right = 0;
     mPrevDisplayFrame.bottom = 0;
-
-    mPrevFbHandle = NULL;
 }
 
 ExynosVirtualDisplay::~ExynosVirtualDisplay()
@@ -276,6 +274,9 @@ int ExynosVirtualDisplay::set(hwc_display_contents_1_t* contents)
         }
     }
 
+    /* the secure path copies the framebuffer target only when its input changed */
+    bool fbChanged = !updateLayerSignatures(contents, 0, contents->numHwLayers - 1, 0);
+
     if (target_layer) {
         int ret = 0;
         ExynosMPPModule &gsc = *mMPPs[0];
@@ -292,12 +293,8 @@ int ExynosVirtualDisplay::set(hwc_display_contents_1_t* contents)
                 contents->outbufAcquireFenceFd = -1;
             }
         } else if (overlay_layer && mPrevCompositionType == COMPOSITION_MIXED) {
-            void *newFbHandle = NULL;
-            if (fb_layer)
-                newFbHandle = (void *)fb_layer->handle;
-
             if (isLayerResized(overlay_layer) ||
-                (!isLayerFullSize(overlay_layer) && fb_layer && (mPrevFbHandle != newFbHandle))) {
+                (!isLayerFullSize(overlay_layer) && fb_layer && fbChanged)) {
                 memset(mDstHandles, 0x0, sizeof(int) * MAX_BUFFER_COUNT);
             }
 
@@ -332,13 +329,11 @@ int ExynosVirtualDisplay::set(hwc_display_contents_1_t* contents)
                     unsigned long srcAddr = getMappedAddrFBTarget(targetBufferHandle->fd);
                     private_handle_t *secureHandle = private_handle_t::dynamicCast(mPhysicallyLinearBuffer);
 
-                    if (mPrevFbHandle != newFbHandle) {
-                        ALOGV("Buffer of fb layer is changed, number_of_fb %d, newFbHandle 0x%x, target_layer->handle 0x%x",
-                            number_of_fb, newFbHandle, target_layer->handle);
-                        mPrevFbHandle = newFbHandle;
+                    if (fbChanged) {
+                        ALOGV("fb layers changed, number_of_fb %d, target_layer->handle 0x%x",
+                            number_of_fb, target_layer->handle);
                         if (srcAddr && mPhysicallyLinearBufferAddr) {
                             memcpy((void *)mPhysicallyLinearBufferAddr, (void *)srcAddr, mWidth * mHeight * 4);
-                            mPrevFbHandle = newFbHandle;
                         } else {
                             ALOGE("can't memcpy for secure G2D input buffer");
                         }
@@ -69,7 +69,6 @@ class ExynosVirtualDisplay : public ExynosDisplay {
 
         void* mDstHandles[MAX_BUFFER_COUNT];
         hwc_rect_t mPrevDisplayFrame;
-        void* mPrevFbHandle;
 };
 
 #endif
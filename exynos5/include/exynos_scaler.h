@@ -114,6 +114,72 @@ int exynos_sc_destroy(void *handle);
  */
 int exynos_sc_convert(void *handle);
 
+/*!
+ * Start a streaming session
+ *
+ * Both edges keep streaming and the negotiated format and buffers are
+ * reused between frames. Formats, rotation and buffer count are applied
+ * again only when they change. A change of format, rotation or flip stops
+ * and renegotiates both edges, so it is refused while frames are queued.
+ * exynos_sc_convert() processes one frame without stopping the scaler
+ * while a session is active.
+ *
+ * \ingroup exynos_scaler
+ *
+ * \param handle
+ *   libscaler handle[in]
+ *
+ * \param num_buffers
+ *   number of frames which can be queued at once, 1 to 8[in]
+ *
+ * \return
+ *   error code
+ */
+int exynos_sc_begin_session(void *handle, int num_buffers);
+
+/*!
+ * Queue a conversion of the current source and destination addresses
+ * without waiting for it. Fails if num_buffers frames are in flight.
+ *
+ * \ingroup exynos_scaler
+ *
+ * \param handle
+ *   libscaler handle[in]
+ *
+ * \return
+ *   error code
+ */
+int exynos_sc_queue_frame(void *handle);
+
+/*!
+ * Wait for the oldest queued conversion to complete
+ *
+ * \ingroup exynos_scaler
+ *
+ * \param handle
+ *   libscaler handle[in]
+ *
+ * \param timeout_ms
+ *   timeout in milliseconds, 0 to poll and -1 to wait forever[in]
+ *
+ * \return
+ *   0 if the frame is done, 1 on timeout, -1 on error
+ */
+int exynos_sc_wait_frame(void *handle, int timeout_ms);
+
+/*!
+ * Stop a streaming session, waits for all queued conversions
+ *
+ * \ingroup exynos_scaler
+ *
+ * \param handle
+ *   libscaler handle[in]
+ *
+ * \return
+ *   error code
+ */
+int exynos_sc_end_session(void *handle);
+
 /*!
  * Set source format.
  *
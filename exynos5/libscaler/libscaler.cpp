@@ -227,6 +227,52 @@ int exynos_sc_convert(void *handle)
     return sc->Start();
 }
 
+int exynos_sc_begin_session(void *handle, int num_buffers)
+{
+    CScaler *sc = GetScaler(handle);
+    if (!sc)
+        return -1;
+
+    return sc->BeginSession(num_buffers);
+}
+
+int exynos_sc_queue_frame(void *handle)
+{
+    CScaler *sc = GetScaler(handle);
+    if (!sc)
+        return -1;
+
+    if (!sc->InSession()) {
+        SC_LOGE("No streaming session is started (handle %p)", handle);
+        return -1;
+    }
+
+    return sc->QueueFrame();
+}
+
+int exynos_sc_wait_frame(void *handle, int timeout_ms)
+{
+    CScaler *sc = GetScaler(handle);
+    if (!sc)
+        return -1;
+
+    return sc->WaitFrame(timeout_ms);
+}
+
+int exynos_sc_end_session(void *handle)
+{
+    CScaler *sc = GetScaler(handle);
+    if (!sc)
+        return -1;
+
+    if (sc->EndSession()) {
+        SC_LOGE("Failed to stop Scaler (handle %p)", handle);
+        return -1;
+    }
+
+    return 0;
+}
+
 void *exynos_sc_create_exclusive(
         int dev_num,
         int allow_drm
@@ -4,6 +4,7 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <poll.h>
 #include "ExynosMutex.h"
 
 #define SC_SRC_BUFTYPE V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE
@@ -14,13 +15,13 @@ public:
     enum SC_EDGE { SC_SRC = 0, SC_DST = 1, SC_NUM_EDGES};
     enum { SC_MAX_PLANES = SC_NUM_OF_PLANES };
     enum { SC_MAX_NODENAME = 14 };
+    enum { SC_MAX_SESSION_BUFFERS = 8 };
 
 private:
     enum SC_FLAG {
         SCF_BUF_FRESH = 0,
         SCF_STREAMING,
         SCF_REQBUFS,
-        SCF_QBUF,
         SCF_CACHEABLE,
         SCF_DRM,
         SCF_PREMULTIPLIED,
@@ -36,6 +37,7 @@ private:
         SCF_ROTATE_90 = SCF_ROTATE_SHIFT,
         SCF_ROTATE_180,
         SCF_NONBLOCKING,
+        SCF_SESSION,
         // rotation by 270 is combination of SCF_ROTATE_90 SCF_ROTATE_180
     };
 
@@ -57,6 +59,17 @@ private:
         unsigned long flags;
     } m_Frame;
 
+    // Buffers requested with REQBUFS and queued to the driver per edge.
+    // Only a streaming session uses more than one buffer.
+    struct BufferInfo {
+        int requested;              // count passed to REQBUFS
+        int count;                  // count granted by the driver
+        enum v4l2_memory memory;    // memory type of the granted buffers
+        int queued;                 // buffers queued and not dequeued yet
+        int next_index;             // index of the buffer to queue next
+    } m_Buffers[SC_NUM_EDGES];
+    int m_nSessionBuffers;
+
     int m_fdScaler;
     char m_cszNode[SC_MAX_NODENAME]; // /dev/videoXX
     int m_iInstance;
@@ -121,6 +134,13 @@ public:
     int Stop();
     int Start(); // Blocking mode
 
+    // Streaming session: both edges stay streaming between frames
+    int BeginSession(int num_buffers);
+    int EndSession();
+    bool InSession() { return IsSet(SCF_SESSION); }
+    int QueueFrame();
+    int WaitFrame(int timeout_ms);
+
     // H/W Control
     int SetCtrl();
     int SetFormat();
@@ -131,6 +151,8 @@ public:
     int DQBuf();
     int DQBuf(SC_EDGE edge);
 
+    int GetQueueIndex(SC_EDGE edge);
+
     // Parameter Extraction
     void SetImgFormat(
         SC_EDGE edge,
@@ -187,6 +209,9 @@ void CScaler::Initialize(int instance, bool nonblock)
 
         m_Frame.edge[SC_SRC].fdAcquireFence = -1;
         m_Frame.edge[SC_DST].fdAcquireFence = -1;
+
+        memset(m_Buffers, 0, sizeof(m_Buffers));
+        m_nSessionBuffers = 1;
     }
 }
 
@@ -225,6 +250,14 @@ int CScaler::Start()
 {
     int ret;
 
+    if (InSession()) {
+        ret = QueueFrame();
+        if (ret)
+            return ret;
+
+        return WaitFrame(-1);
+    }
+
     ret = SetCtrl();
     if (ret)
         return ret;
@@ -285,7 +318,10 @@ int CScaler::SetCtrl()
 
 int CScaler::ResetDevice(SC_EDGE edge)
 {
-    DQBuf(static_cast<SC_EDGE>(edge));
+    while (m_Buffers[edge].queued > 0) {
+        if (DQBuf(static_cast<SC_EDGE>(edge)))
+            break;
+    }
 
     if (IsSet(SCF_STREAMING, edge)) {
         if (exynos_v4l2_streamoff(m_fdScaler, m_Frame.edge[edge].type) < 0 ) {
@@ -295,18 +331,24 @@ int CScaler::ResetDevice(SC_EDGE edge)
         ClearFlag(SCF_STREAMING, edge);
     }
 
+    // STREAMOFF returns all buffers which could not be dequeued
+    m_Buffers[edge].queued = 0;
+    m_Buffers[edge].next_index = 0;
+
     SC_LOGD("VIDIC_STREAMOFF is successful for the %s", m_cszEdgeName[edge]);
 
     if (IsSet(SCF_REQBUFS, edge)) {
         v4l2_requestbuffers reqbufs;
         memset(&reqbufs, 0, sizeof(reqbufs));
         reqbufs.type = m_Frame.edge[edge].type;
-        reqbufs.memory = m_Frame.edge[edge].memory;
+        reqbufs.memory = m_Buffers[edge].memory;
         if (exynos_v4l2_reqbufs(m_fdScaler, &reqbufs) < 0 ) {
             SC_LOGERR("Failed to REQBUFS(0) for the %s", m_cszEdgeName[edge]);
             return -1;
         }
 
+        m_Buffers[edge].requested = 0;
+        m_Buffers[edge].count = 0;
         ClearFlag(SCF_REQBUFS, edge);
     }
 
@@ -385,14 +427,16 @@ int CScaler::QBuf()
             return -1;
         }
 
-        DQBuf(static_cast<SC_EDGE>(edge));
+        int index = GetQueueIndex(static_cast<SC_EDGE>(edge));
+        if (index < 0)
+            return -1;
 
         memset(&buffer, 0, sizeof(buffer));
         memset(&planes, 0, sizeof(planes));
 
         buffer.type   = m_Frame.edge[edge].type;
         buffer.memory = m_Frame.edge[edge].memory;
-        buffer.index  = 0;
+        buffer.index  = index;
         buffer.length = m_Frame.edge[edge].out_num_planes;
 
         buffer.m.planes = planes;
@@ -412,7 +456,8 @@ int CScaler::QBuf()
             return -1;
         }
 
-        SetFlag(SCF_QBUF, edge);
+        m_Buffers[edge].queued++;
+        m_Buffers[edge].next_index = (index + 1) % m_Buffers[edge].count;
 
         SC_LOGD("Successfully QBUF for the %s", m_cszEdgeName[edge]);
     }
@@ -433,14 +478,16 @@ int CScaler::QBuf(int pfdReleaseFence[SC_NUM_EDGES])
             return -1;
         }
 
-        DQBuf(static_cast<SC_EDGE>(edge));
+        int index = GetQueueIndex(static_cast<SC_EDGE>(edge));
+        if (index < 0)
+            return -1;
 
         memset(&buffer, 0, sizeof(buffer));
         memset(&planes, 0, sizeof(planes));
 
         buffer.type   = m_Frame.edge[edge].type;
         buffer.memory = m_Frame.edge[edge].memory;
-        buffer.index  = 0;
+        buffer.index  = index;
         buffer.length = m_Frame.edge[edge].out_num_planes;
         buffer.flags    = V4L2_BUF_FLAG_USE_SYNC;
         buffer.reserved = m_Frame.edge[edge].fdAcquireFence;
@@ -462,7 +509,8 @@ int CScaler::QBuf(int pfdReleaseFence[SC_NUM_EDGES])
             return -1;
         }
 
-        SetFlag(SCF_QBUF, edge);
+        m_Buffers[edge].queued++;
+        m_Buffers[edge].next_index = (index + 1) % m_Buffers[edge].count;
 
         if (m_Frame.edge[edge].fdAcquireFence >= 0) {
             close(m_Frame.edge[edge].fdAcquireFence);
@@ -482,21 +530,40 @@ int CScaler::ReqBufs()
 
     for (int edge = 0; edge < SC_NUM_EDGES; edge++) {
         if (IsSet(SCF_REQBUFS, edge)) {
-            SC_LOGD("Skipping REQBUFS for the %s since it is already done", m_cszEdgeName[edge]);
-            continue;
+            if ((m_Buffers[edge].requested == m_nSessionBuffers) &&
+                    (m_Buffers[edge].memory == m_Frame.edge[edge].memory)) {
+                SC_LOGD("Skipping REQBUFS for the %s since it is already done", m_cszEdgeName[edge]);
+                continue;
+            }
+
+            // buffer count or memory type changed
+            if (ResetDevice(static_cast<SC_EDGE>(edge)) != 0) {
+                SC_LOGE("Failed to release buffers of the %s", m_cszEdgeName[edge]);
+                return -1;
+            }
         }
 
         memset(&reqbufs, 0, sizeof(reqbufs));
 
         reqbufs.type    = m_Frame.edge[edge].type;
         reqbufs.memory  = m_Frame.edge[edge].memory;
-        reqbufs.count   = 1;
+        reqbufs.count   = m_nSessionBuffers;
 
         if (exynos_v4l2_reqbufs(m_fdScaler, &reqbufs) < 0) {
             SC_LOGERR("Failed to REQBUFS for the %s", m_cszEdgeName[edge]);
             return -1;
         }
 
+        if (reqbufs.count < 1) {
+            SC_LOGE("No buffer is granted for the %s", m_cszEdgeName[edge]);
+            return -1;
+        }
+
+        m_Buffers[edge].requested = m_nSessionBuffers;
+        m_Buffers[edge].count = reqbufs.count;
+        m_Buffers[edge].memory = m_Frame.edge[edge].memory;
+        m_Buffers[edge].queued = 0;
+        m_Buffers[edge].next_index = 0;
         SetFlag(SCF_REQBUFS, edge);
 
         SC_LOGD("Successfully REQBUFS for the %s", m_cszEdgeName[edge]);
@@ -517,8 +584,20 @@ void CScaler::SetImgFormat(
         unsigned int mode_drm,
         unsigned int premultiplied)
 {
-    m_Frame.edge[edge].type = (edge == SC_SRC) ? SC_SRC_BUFTYPE : SC_DST_BUFTYPE;
-
+    v4l2_buf_type type = (edge == SC_SRC) ? SC_SRC_BUFTYPE : SC_DST_BUFTYPE;
+
+    // S_FMT and S_CROP require to stop streaming, avoid them if nothing changed
+    if ((m_Frame.edge[edge].type != type) ||
+            (m_Frame.edge[edge].color_format != v4l2_colorformat) ||
+            (m_Frame.edge[edge].width != width) ||
+            (m_Frame.edge[edge].height != height) ||
+            (m_Frame.edge[edge].crop_left != crop_left) ||
+            (m_Frame.edge[edge].crop_top != crop_top) ||
+            (m_Frame.edge[edge].crop_width != crop_width) ||
+            (m_Frame.edge[edge].crop_height != crop_height))
+        SetFlag(SCF_BUF_FRESH, edge);
+
+    m_Frame.edge[edge].type = type;
     m_Frame.edge[edge].color_format = v4l2_colorformat;
     m_Frame.edge[edge].width = width;
     m_Frame.edge[edge].height = height;
@@ -540,8 +619,6 @@ void CScaler::SetImgFormat(
         SetFlag(SCF_DRM, edge);
     else
         ClearFlag(SCF_DRM, edge);
-
-    SetFlag(SCF_BUF_FRESH, edge);
 }
 
 bool CScaler::SetRotate(int rot, int flip_h, int flip_v)
@@ -551,6 +628,8 @@ bool CScaler::SetRotate(int rot, int flip_h, int flip_v)
         return false;
     }
 
+    unsigned long oldflags = m_Frame.flags;
+
     SetRotDegree(rot);
 
     if (flip_h)
@@ -563,7 +642,9 @@ bool CScaler::SetRotate(int rot, int flip_h, int flip_v)
     else
         ClearFlag(SCF_HFLIP);
 
-    SetFlag(SCF_ROTATION_FRESH);
+    unsigned long rotflags = SCF_ROTATE_MASK | (1 << SCF_VFLIP) | (1 << SCF_HFLIP);
+    if ((oldflags ^ m_Frame.flags) & rotflags)
+        SetFlag(SCF_ROTATION_FRESH);
 
     return true;
 }
@@ -594,7 +675,7 @@ int CScaler::StreamOn()
 
 int CScaler::DQBuf(SC_EDGE edge)
 {
-    if (!IsSet(SCF_QBUF, edge))
+    if (m_Buffers[edge].queued == 0)
         return 0;
 
     v4l2_buffer buffer;
@@ -617,13 +698,13 @@ int CScaler::DQBuf(SC_EDGE edge)
         return -1;
     }
 
+    m_Buffers[edge].queued--;
+
     if (buffer.flags & V4L2_BUF_FLAG_ERROR) {
         SC_LOGE("Error occurred while processing streaming data");
         return -1;
     }
 
-    ClearFlag(SCF_QBUF, edge);
-
     SC_LOGD("Successfully VIDIOC_DQBUF for the %s", m_cszEdgeName[edge]);
 
     return 0;
@@ -637,3 +718,114 @@ int CScaler::DQBuf()
     }
     return 0;
 }
+
+int CScaler::GetQueueIndex(SC_EDGE edge)
+{
+    // Without a session the only buffer is reused for every frame
+    if (!InSession())
+        DQBuf(edge);
+
+    if (m_Buffers[edge].queued >= m_Buffers[edge].count) {
+        SC_LOGE("All %d buffers of the %s are in flight; wait for a frame first",
+                m_Buffers[edge].count, m_cszEdgeName[edge]);
+        return -1;
+    }
+
+    return m_Buffers[edge].next_index;
+}
+
+int CScaler::BeginSession(int num_buffers)
+{
+    if ((num_buffers < 1) || (num_buffers > SC_MAX_SESSION_BUFFERS)) {
+        SC_LOGE("Invalid number of session buffers %d", num_buffers);
+        return -1;
+    }
+
+    // REQBUFS is issued again by the first frame if the count changes
+    m_nSessionBuffers = num_buffers;
+    SetFlag(SCF_SESSION);
+
+    SC_LOGD("Streaming session with %d buffers is started", num_buffers);
+
+    return 0;
+}
+
+int CScaler::EndSession()
+{
+    if (!InSession())
+        return 0;
+
+    ClearFlag(SCF_SESSION);
+    m_nSessionBuffers = 1;
+
+    return Stop();
+}
+
+int CScaler::QueueFrame()
+{
+    int ret;
+
+    // Rotation, flip and formats cannot change under streaming queues, so
+    // the session is stopped and renegotiated once nothing is in flight
+    if (IsSet(SCF_ROTATION_FRESH) ||
+            IsSet(SCF_BUF_FRESH, SC_SRC) || IsSet(SCF_BUF_FRESH, SC_DST)) {
+        if ((m_Buffers[SC_SRC].queued > 0) || (m_Buffers[SC_DST].queued > 0)) {
+            SC_LOGE("Wait for the queued frames before changing rotation, flip or format");
+            return -1;
+        }
+
+        ret = Stop();
+        if (ret)
+            return ret;
+    }
+
+    ret = SetCtrl();
+    if (ret)
+        return ret;
+
+    ret = SetFormat();
+    if (ret)
+        return ret;
+
+    ret = ReqBufs();
+    if (ret)
+        return ret;
+
+    ret = QBuf();
+    if (ret)
+        return ret;
+
+    return StreamOn();
+}
+
+int CScaler::WaitFrame(int timeout_ms)
+{
+    if ((m_Buffers[SC_SRC].queued == 0) && (m_Buffers[SC_DST].queued == 0)) {
+        SC_LOGE("No frame is queued");
+        return -1;
+    }
+
+    if (timeout_ms >= 0) {
+        struct pollfd pfd;
+
+        // POLLOUT for a processed source and POLLIN for a filled destination
+        pfd.fd = m_fdScaler;
+        pfd.events = (m_Buffers[SC_DST].queued > 0) ? POLLIN : POLLOUT;
+        pfd.revents = 0;
+
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret < 0) {
+            SC_LOGERR("Failed to poll '%s'", m_cszNode);
+            return -1;
+        }
+        if (ret == 0)
+            return 1;
+
+        if (pfd.revents & POLLERR) {
+            SC_LOGE("Error occurred while waiting for a frame");
+            return -1;
+        }
+    }
+
+    return DQBuf();
+}
@@ -30,6 +30,10 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "MobiCoreDriverApi.h"
 #include "tlTeeKeymaster_Api.h"
@@ -41,106 +45,462 @@
 static const uint32_t gDeviceId = MC_DEVICE_ID_DEFAULT;
 static const mcUuid_t gUuid = TEE_KEYMASTER_TL_UUID;
 
+/* Session is closed once nobody used it for this long */
+#define TEE_SESSION_IDLE_TIMEOUT_MS  5000
+
+/* Bulk buffer mapped once per session, requests are copied into it */
+#define TEE_STAGING_SIZE             (16 * 1024)
+#define TEE_STAGING_ALIGN            8
+
+/* Most buffers a single command maps */
+#define TEE_BUFFER_MAX               3
+
+typedef enum {
+    TEE_BUFFER_IN  = 0,
+    TEE_BUFFER_OUT = 1
+} teeBufferDir_t;
+
 /**
- * TEE_Open
+ * Buffer handed to the trustlet. Small buffers live in the session staging
+ * area, anything that does not fit is mapped on its own with mcMap.
+ */
+typedef struct {
+    void            *sVirtualAddr;  /* address as seen by the trustlet */
+    void            *buf;           /* caller buffer */
+    uint32_t        len;
+    teeBufferDir_t  dir;
+    bool            mapped;
+    bool            staged;
+    uint8_t         *stagingAddr;
+    mcBulkMap_t     mapInfo;
+} teeBuffer_t;
+
+/**
+ * Persistent session to the TEE Keymaster trustlet, shared by all callers.
  *
- * Open session to the TEE Keymaster trustlet
+ * lock guards the open state and the reference count, cmdLock serializes the
+ * use of the single TCI buffer and the staging area. The session is opened by
+ * the first caller and closed by the idle thread once refCount stayed zero for
+ * TEE_SESSION_IDLE_TIMEOUT_MS.
+ */
+typedef struct {
+    pthread_mutex_t     lock;
+    pthread_mutex_t     cmdLock;
+
+    bool                opened;
+    bool                invalid;
+    bool                idleThreadRunning;
+    uint32_t            refCount;
+    uint64_t            lastUseMs;
+
+    mcSessionHandle_t   sessionHandle;
+    tciMessage_ptr      pTci;
+
+    uint8_t             *staging;
+    mcBulkMap_t         stagingMap;
+    uint32_t            stagingUsed;
+
+    teeBuffer_t         *buffers[TEE_BUFFER_MAX];
+    uint32_t            numBuffers;
+} teeSession_t;
+
+static teeSession_t gSession = {
+    .lock    = PTHREAD_MUTEX_INITIALIZER,
+    .cmdLock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+#define TEE_BUFFER_INITIALIZER  { NULL, NULL, 0, TEE_BUFFER_IN, false, false, NULL, { NULL, 0 } }
+
+
+static uint64_t TEE_GetTimeMs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+/**
+ * TEE_SessionDestroy
  *
- * @param  pSessionHandle  [out] Return pointer to the session handle
+ * Tear down the trustlet session, called with gSession.lock held
  */
-static tciMessage_ptr TEE_Open(
-    mcSessionHandle_t *pSessionHandle
+static void TEE_SessionDestroy(
+    teeSession_t *pSession
 ){
-    tciMessage_ptr pTci = NULL;
-    mcResult_t     mcRet;
+    mcResult_t    mcRet;
 
-    do
+    if (!pSession->opened)
+        return;
+
+    if (pSession->staging)
     {
+        mcRet = mcUnmap(&pSession->sessionHandle, pSession->staging, &pSession->stagingMap);
+        if (MC_DRV_OK != mcRet)
+            LOG_E("TEE_SessionDestroy(): mcUnmap returned: %d\n", mcRet);
+    }
+
+    mcRet = mcCloseSession(&pSession->sessionHandle);
+    if (MC_DRV_OK != mcRet)
+        LOG_E("TEE_SessionDestroy(): mcCloseSession returned: %d\n", mcRet);
+
+    if (pSession->staging)
+        mcFreeWsm(gDeviceId, pSession->staging);
+    if (pSession->pTci)
+        mcFreeWsm(gDeviceId, (uint8_t *)pSession->pTci);
+
+    mcRet = mcCloseDevice(gDeviceId);
+    if (MC_DRV_OK != mcRet)
+        LOG_E("TEE_SessionDestroy(): mcCloseDevice returned: %d\n", mcRet);
+
+    pSession->staging = NULL;
+    pSession->pTci = NULL;
+    pSession->stagingUsed = 0;
+    pSession->opened = false;
+    pSession->invalid = false;
+}
 
-        /* Validate session handle */
-        if (!pSessionHandle)
-        {
-            LOG_E("TEE_Open(): Invalid session handle\n");
-            break;
-        }
 
+/**
+ * TEE_SessionCreate
+ *
+ * Open the trustlet session and map the staging area, called with
+ * gSession.lock held
+ */
+static bool TEE_SessionCreate(
+    teeSession_t *pSession
+){
+    mcResult_t     mcRet;
+    bool           deviceOpened = false;
+
+    do
+    {
         /* Initialize session handle data */
-        memset(pSessionHandle, 0, sizeof(mcSessionHandle_t));
+        memset(&pSession->sessionHandle, 0, sizeof(mcSessionHandle_t));
+        pSession->pTci = NULL;
+        pSession->staging = NULL;
 
         /* Open MobiCore device */
         mcRet = mcOpenDevice(gDeviceId);
         if (MC_DRV_OK != mcRet)
         {
-            LOG_E("TEE_Open(): mcOpenDevice returned: %d\n", mcRet);
+            LOG_E("TEE_SessionCreate(): mcOpenDevice returned: %d\n", mcRet);
             break;
         }
+        deviceOpened = true;
 
         /* Allocating WSM for TCI */
-        mcRet = mcMallocWsm(gDeviceId, 0, sizeof(tciMessage_t), (uint8_t **) &pTci, 0);
+        mcRet = mcMallocWsm(gDeviceId, 0, sizeof(tciMessage_t), (uint8_t **) &pSession->pTci, 0);
         if (MC_DRV_OK != mcRet)
         {
-            LOG_E("TEE_Open(): mcMallocWsm returned: %d\n", mcRet);
+            LOG_E("TEE_SessionCreate(): mcMallocWsm returned: %d\n", mcRet);
+            pSession->pTci = NULL;
             break;
         }
 
         /* Open session the TEE Keymaster trustlet */
-        pSessionHandle->deviceId = gDeviceId;
-        mcRet = mcOpenSession(pSessionHandle,
+        pSession->sessionHandle.deviceId = gDeviceId;
+        mcRet = mcOpenSession(&pSession->sessionHandle,
                               &gUuid,
-                              (uint8_t *) pTci,
+                              (uint8_t *) pSession->pTci,
                               (uint32_t) sizeof(tciMessage_t));
         if (MC_DRV_OK != mcRet)
         {
-            LOG_E("TEE_Open(): mcOpenSession returned: %d\n", mcRet);
+            LOG_E("TEE_SessionCreate(): mcOpenSession returned: %d\n", mcRet);
+            break;
+        }
+
+        pSession->opened = true;
+        pSession->invalid = false;
+        pSession->stagingUsed = 0;
+
+        /* Staging area is optional, buffers fall back to mcMap without it */
+        mcRet = mcMallocWsm(gDeviceId, 0, TEE_STAGING_SIZE, &pSession->staging, 0);
+        if (MC_DRV_OK != mcRet)
+        {
+            LOG_W("TEE_SessionCreate(): staging mcMallocWsm returned: %d\n", mcRet);
+            pSession->staging = NULL;
+            break;
+        }
+
+        mcRet = mcMap(&pSession->sessionHandle, pSession->staging, TEE_STAGING_SIZE, &pSession->stagingMap);
+        if (MC_DRV_OK != mcRet)
+        {
+            LOG_W("TEE_SessionCreate(): staging mcMap returned: %d\n", mcRet);
+            mcFreeWsm(gDeviceId, pSession->staging);
+            pSession->staging = NULL;
             break;
         }
 
     } while (false);
 
-    return pTci;
+    if (!pSession->opened)
+    {
+        if (pSession->pTci)
+            mcFreeWsm(gDeviceId, (uint8_t *)pSession->pTci);
+        pSession->pTci = NULL;
+
+        if (deviceOpened)
+            mcCloseDevice(gDeviceId);
+    }
+
+    return pSession->opened;
 }
 
 
 /**
- * TEE_Close
- *
- * Close session to the TEE Keymaster trustlet
+ * TEE_SessionIdleThread
  *
- * @param  sessionHandle  [in] Session handle
+ * Close the session once it has not been used for TEE_SESSION_IDLE_TIMEOUT_MS
  */
-static void TEE_Close(
-    mcSessionHandle_t *pSessionHandle
+static void *TEE_SessionIdleThread(
+    void *arg
 ){
-    teeResult_t   ret = TEE_ERR_NONE;
-    mcResult_t    mcRet;
+    teeSession_t *pSession = (teeSession_t *)arg;
+    uint64_t      now;
+    uint64_t      sleepMs = TEE_SESSION_IDLE_TIMEOUT_MS;
 
-    do {
+    for (;;)
+    {
+        usleep(sleepMs * 1000);
+
+        pthread_mutex_lock(&pSession->lock);
+
+        if (!pSession->opened)
+            break;
 
-        /* Validate session handle */
-        if (!pSessionHandle)
+        now = TEE_GetTimeMs();
+        if (pSession->refCount == 0 &&
+            TEE_SESSION_IDLE_TIMEOUT_MS <= now - pSession->lastUseMs)
         {
-            LOG_E("TEE_Close(): Invalid session handle\n");
+            LOG_I("TEE_SessionIdleThread(): closing idle session\n");
+            TEE_SessionDestroy(pSession);
             break;
         }
 
-        /* Close session */
-        mcRet = mcCloseSession(pSessionHandle);
-        if (MC_DRV_OK != mcRet)
+        if (pSession->refCount != 0)
+            sleepMs = TEE_SESSION_IDLE_TIMEOUT_MS;
+        else
+            sleepMs = TEE_SESSION_IDLE_TIMEOUT_MS - (now - pSession->lastUseMs);
+
+        pthread_mutex_unlock(&pSession->lock);
+    }
+
+    pSession->idleThreadRunning = false;
+    pthread_mutex_unlock(&pSession->lock);
+
+    return NULL;
+}
+
+
+/**
+ * TEE_Open
+ *
+ * Take a reference on the session to the TEE Keymaster trustlet, opening it
+ * if needed, and claim its TCI buffer for one command
+ *
+ * @param  ppSession  [out] Return pointer to the session
+ */
+static tciMessage_ptr TEE_Open(
+    teeSession_t **ppSession
+){
+    teeSession_t   *pSession = &gSession;
+    tciMessage_ptr pTci = NULL;
+    pthread_attr_t attr;
+    pthread_t      thread;
+
+    do
+    {
+        /* Validate session pointer */
+        if (!ppSession)
         {
-            LOG_E("TEE_Close(): mcCloseSession returned: %d\n", mcRet);
-            ret = TEE_ERR_SESSION;
+            LOG_E("TEE_Open(): Invalid session pointer\n");
             break;
         }
+        *ppSession = NULL;
 
-        /* Close MobiCore device */
-        mcRet = mcCloseDevice(gDeviceId);
-        if (MC_DRV_OK != mcRet)
+        pthread_mutex_lock(&pSession->lock);
+
+        if (!pSession->opened && !TEE_SessionCreate(pSession))
+        {
+            pthread_mutex_unlock(&pSession->lock);
+            break;
+        }
+
+        if (!pSession->idleThreadRunning)
         {
-            LOG_E("TEE_Close(): mcCloseDevice returned: %d\n", mcRet);
-            ret = TEE_ERR_MC_DEVICE;
+            pthread_attr_init(&attr);
+            pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+            if (pthread_create(&thread, &attr, TEE_SessionIdleThread, pSession) == 0)
+                pSession->idleThreadRunning = true;
+            else
+                LOG_W("TEE_Open(): idle thread create failed, session kept open\n");
+            pthread_attr_destroy(&attr);
         }
 
+        pSession->refCount++;
+
+        pthread_mutex_unlock(&pSession->lock);
+
+        /* One command at a time owns the TCI and the staging area */
+        pthread_mutex_lock(&pSession->cmdLock);
+        pSession->stagingUsed = 0;
+        pSession->numBuffers = 0;
+
+        *ppSession = pSession;
+        pTci = pSession->pTci;
+
     } while (false);
+
+    return pTci;
+}
+
+
+/**
+ * TEE_MapBuffer
+ *
+ * Make a caller buffer visible to the trustlet. Input buffers are copied into
+ * the staging area, output buffers get their space there and are copied back
+ * by TEE_UnmapBuffer. Buffers that do not fit are mapped with mcMap.
+ *
+ * @param  pSession  [in]  Session from TEE_Open
+ * @param  buf       [in]  Caller buffer
+ * @param  len       [in]  Buffer length
+ * @param  pBuffer   [out] Buffer description for the TCI
+ * @param  dir       [in]  TEE_BUFFER_IN or TEE_BUFFER_OUT
+ */
+static mcResult_t TEE_MapBuffer(
+    teeSession_t    *pSession,
+    void            *buf,
+    uint32_t        len,
+    teeBuffer_t     *pBuffer,
+    teeBufferDir_t  dir
+){
+    mcResult_t  mcRet = MC_DRV_OK;
+    uint32_t    offset;
+
+    if (pSession->numBuffers >= TEE_BUFFER_MAX)
+        return MC_DRV_ERR_INVALID_PARAMETER;
+
+    pBuffer->buf = buf;
+    pBuffer->len = len;
+    pBuffer->dir = dir;
+    pBuffer->staged = false;
+    pBuffer->mapped = false;
+
+    offset = (pSession->stagingUsed + TEE_STAGING_ALIGN - 1) & ~(TEE_STAGING_ALIGN - 1);
+
+    if (pSession->staging && len <= TEE_STAGING_SIZE && offset <= TEE_STAGING_SIZE - len)
+    {
+        pBuffer->stagingAddr = pSession->staging + offset;
+        pBuffer->sVirtualAddr = (uint8_t *)pSession->stagingMap.sVirtualAddr + offset;
+        pBuffer->staged = true;
+        pSession->stagingUsed = offset + len;
+
+        if (TEE_BUFFER_IN == dir)
+            memcpy(pBuffer->stagingAddr, buf, len);
+        else
+            memset(pBuffer->stagingAddr, 0, len);
+    }
+    else
+    {
+        mcRet = mcMap(&pSession->sessionHandle, buf, len, &pBuffer->mapInfo);
+        if (MC_DRV_OK != mcRet)
+            return mcRet;
+
+        pBuffer->sVirtualAddr = pBuffer->mapInfo.sVirtualAddr;
+    }
+
+    pBuffer->mapped = true;
+    pSession->buffers[pSession->numBuffers++] = pBuffer;
+
+    return mcRet;
+}
+
+
+/**
+ * TEE_UnmapBuffer
+ *
+ * Copy an output buffer back to the caller and release its mapping
+ *
+ * @param  pSession  [in] Session from TEE_Open
+ * @param  pBuffer   [in] Buffer from TEE_MapBuffer
+ */
+static mcResult_t TEE_UnmapBuffer(
+    teeSession_t  *pSession,
+    teeBuffer_t   *pBuffer
+){
+    mcResult_t  mcRet = MC_DRV_OK;
+
+    if (!pBuffer->mapped)
+        return MC_DRV_OK;
+
+    pBuffer->mapped = false;
+
+    if (pBuffer->staged)
+    {
+        if (TEE_BUFFER_OUT == pBuffer->dir)
+            memcpy(pBuffer->buf, pBuffer->stagingAddr, pBuffer->len);
+    }
+    else
+    {
+        mcRet = mcUnmap(&pSession->sessionHandle, pBuffer->buf, &pBuffer->mapInfo);
+    }
+
+    return mcRet;
+}
+
+
+/**
+ * TEE_Close
+ *
+ * Release the TCI buffer and drop the reference taken by TEE_Open. Buffers an
+ * aborted command left mapped are released here, the staging area is wiped
+ * so no key material stays behind.
+ *
+ * @param  pSession  [in] Session from TEE_Open
+ * @param  ret       [in] Result of the command
+ */
+static void TEE_Close(
+    teeSession_t  *pSession,
+    teeResult_t   ret
+){
+    uint32_t      i;
+
+    /* Validate session */
+    if (!pSession)
+        return;
+
+    for (i = 0; i < pSession->numBuffers; i++)
+    {
+        if (pSession->buffers[i]->mapped && !pSession->buffers[i]->staged)
+            mcUnmap(&pSession->sessionHandle, pSession->buffers[i]->buf,
+                    &pSession->buffers[i]->mapInfo);
+        pSession->buffers[i]->mapped = false;
+    }
+    pSession->numBuffers = 0;
+
+    if (pSession->stagingUsed)
+        memset(pSession->staging, 0, pSession->stagingUsed);
+    pSession->stagingUsed = 0;
+
+    pthread_mutex_unlock(&pSession->cmdLock);
+
+    pthread_mutex_lock(&pSession->lock);
+
+    /* A lost notification leaves the trustlet state unknown, start over */
+    if (TEE_ERR_NOTIFICATION == ret)
+        pSession->invalid = true;
+
+    pSession->refCount--;
+    pSession->lastUseMs = TEE_GetTimeMs();
+
+    if (pSession->invalid && pSession->refCount == 0)
+        TEE_SessionDestroy(pSession);
+
+    pthread_mutex_unlock(&pSession->lock);
 }
 
 
@@ -166,21 +526,21 @@ teeResult_t TEE_RSAGenerateKeyPair(
 ){
     teeResult_t         ret = TEE_ERR_NONE;
     tciMessage_ptr      pTci = NULL;
-    mcSessionHandle_t   sessionHandle;
-    mcBulkMap_t         mapInfo;
+    teeSession_t        *pSession = NULL;
+    teeBuffer_t         mapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t          mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, keyData, keyDataLength, &mapInfo);
+        mcRet = TEE_MapBuffer(pSession, keyData, keyDataLength, &mapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -195,7 +555,7 @@ teeResult_t TEE_RSAGenerateKeyPair(
         pTci->rsagenkey.exponent    = exponent;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -203,14 +563,14 @@ teeResult_t TEE_RSAGenerateKeyPair(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, keyData, &mapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &mapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -231,7 +591,7 @@ teeResult_t TEE_RSAGenerateKeyPair(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -261,35 +621,35 @@ teeResult_t TEE_RSASign(
 ){
     teeResult_t        ret = TEE_ERR_NONE;
     tciMessage_ptr     pTci = NULL;
-    mcSessionHandle_t  sessionHandle;
-    mcBulkMap_t        keyMapInfo;
-    mcBulkMap_t        plainMapInfo;
-    mcBulkMap_t        signatureMapInfo;
+    teeSession_t       *pSession = NULL;
+    teeBuffer_t        keyMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        plainMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        signatureMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t         mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)plainData, plainDataLength, &plainMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)plainData, plainDataLength, &plainMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)signatureData, *signatureDataLength, &signatureMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)signatureData, *signatureDataLength, &signatureMapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -309,7 +669,7 @@ teeResult_t TEE_RSASign(
         pTci->rsasign.algorithm = algorithm;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -317,28 +677,28 @@ teeResult_t TEE_RSASign(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)plainData, &plainMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &plainMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)signatureData, &signatureMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &signatureMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -359,7 +719,7 @@ teeResult_t TEE_RSASign(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -391,35 +751,35 @@ teeResult_t TEE_RSAVerify(
 ){
     teeResult_t        ret = TEE_ERR_NONE;
     tciMessage_ptr     pTci = NULL;
-    mcSessionHandle_t  sessionHandle;
-    mcBulkMap_t        keyMapInfo;
-    mcBulkMap_t        plainMapInfo;
-    mcBulkMap_t        signatureMapInfo;
+    teeSession_t       *pSession = NULL;
+    teeBuffer_t        keyMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        plainMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        signatureMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t         mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)plainData, plainDataLength, &plainMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)plainData, plainDataLength, &plainMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)signatureData, signatureDataLength, &signatureMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)signatureData, signatureDataLength, &signatureMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -440,7 +800,7 @@ teeResult_t TEE_RSAVerify(
         pTci->rsaverify.validity = false;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -448,28 +808,28 @@ teeResult_t TEE_RSAVerify(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)plainData, &plainMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &plainMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)signatureData, &signatureMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &signatureMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -489,7 +849,7 @@ teeResult_t TEE_RSAVerify(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -512,21 +872,21 @@ teeResult_t TEE_HMACKeyGenerate(
 ){
     teeResult_t        ret = TEE_ERR_NONE;
     tciMessage_ptr     pTci = NULL;
-    mcSessionHandle_t  sessionHandle;
-    mcBulkMap_t        keyMapInfo;
+    teeSession_t       *pSession = NULL;
+    teeBuffer_t        keyMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t         mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -538,7 +898,7 @@ teeResult_t TEE_HMACKeyGenerate(
         pTci->hmacgenkey.keydatalen = keyDataLength;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -546,14 +906,14 @@ teeResult_t TEE_HMACKeyGenerate(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -573,7 +933,7 @@ teeResult_t TEE_HMACKeyGenerate(
     }while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -602,35 +962,35 @@ teeResult_t TEE_HMACSign(
 ){
     teeResult_t        ret = TEE_ERR_NONE;
     tciMessage_ptr     pTci = NULL;
-    mcSessionHandle_t  sessionHandle;
-    mcBulkMap_t        keyMapInfo;
-    mcBulkMap_t        plainMapInfo;
-    mcBulkMap_t        signatureMapInfo;
+    teeSession_t       *pSession = NULL;
+    teeBuffer_t        keyMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        plainMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        signatureMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t         mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)plainData, plainDataLength, &plainMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)plainData, plainDataLength, &plainMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)signatureData, *signatureDataLength, &signatureMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)signatureData, *signatureDataLength, &signatureMapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -650,7 +1010,7 @@ teeResult_t TEE_HMACSign(
         pTci->hmacsign.digest = digest;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -658,28 +1018,28 @@ teeResult_t TEE_HMACSign(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)plainData, &plainMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &plainMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)signatureData, &signatureMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &signatureMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -700,7 +1060,7 @@ teeResult_t TEE_HMACSign(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -730,35 +1090,35 @@ teeResult_t TEE_HMACVerify(
 ){
     teeResult_t        ret = TEE_ERR_NONE;
     tciMessage_ptr     pTci = NULL;
-    mcSessionHandle_t  sessionHandle;
-    mcBulkMap_t        keyMapInfo;
-    mcBulkMap_t        plainMapInfo;
-    mcBulkMap_t        signatureMapInfo;
+    teeSession_t       *pSession = NULL;
+    teeBuffer_t        keyMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        plainMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t        signatureMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t         mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)plainData, plainDataLength, &plainMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)plainData, plainDataLength, &plainMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)signatureData, signatureDataLength, &signatureMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)signatureData, signatureDataLength, &signatureMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -779,7 +1139,7 @@ teeResult_t TEE_HMACVerify(
         pTci->hmacverify.validity = false;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -787,28 +1147,28 @@ teeResult_t TEE_HMACVerify(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)plainData, &plainMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &plainMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)signatureData, &signatureMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &signatureMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -828,7 +1188,7 @@ teeResult_t TEE_HMACVerify(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -867,28 +1227,28 @@ teeResult_t TEE_KeyImport(
 ){
     teeResult_t         ret = TEE_ERR_NONE;
     tciMessage_ptr      pTci = NULL;
-    mcSessionHandle_t   sessionHandle;
-    mcBulkMap_t         keyMapInfo;
-    mcBulkMap_t         soMapInfo;
+    teeSession_t        *pSession = NULL;
+    teeBuffer_t         keyMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t         soMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t          mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)soData, *soDataLength, &soMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)soData, *soDataLength, &soMapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -902,7 +1262,7 @@ teeResult_t TEE_KeyImport(
         pTci->keyimport.sodatalen      = *soDataLength;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -910,21 +1270,21 @@ teeResult_t TEE_KeyImport(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)soData, &soMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &soMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -945,7 +1305,7 @@ teeResult_t TEE_KeyImport(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -972,35 +1332,35 @@ teeResult_t TEE_GetPubKey(
 ){
     teeResult_t         ret = TEE_ERR_NONE;
     tciMessage_ptr      pTci = NULL;
-    mcSessionHandle_t   sessionHandle;
-    mcBulkMap_t         keyMapInfo;
-    mcBulkMap_t         modMapInfo;
-    mcBulkMap_t         expMapInfo;
+    teeSession_t        *pSession = NULL;
+    teeBuffer_t         keyMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t         modMapInfo = TEE_BUFFER_INITIALIZER;
+    teeBuffer_t         expMapInfo = TEE_BUFFER_INITIALIZER;
     mcResult_t          mcRet;
 
     do {
 
         /* Open session to the trustlet */
-        pTci = TEE_Open(&sessionHandle);
+        pTci = TEE_Open(&pSession);
         if (!pTci) {
             ret = TEE_ERR_MEMORY;
             break;
         }
 
         /* Map memory to the secure world */
-        mcRet = mcMap(&sessionHandle, (void*)keyData, keyDataLength, &keyMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)keyData, keyDataLength, &keyMapInfo, TEE_BUFFER_IN);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)modulus, *modulusLength, &modMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)modulus, *modulusLength, &modMapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcMap(&sessionHandle, (void*)exponent, *exponentLength, &expMapInfo);
+        mcRet = TEE_MapBuffer(pSession, (void*)exponent, *exponentLength, &expMapInfo, TEE_BUFFER_OUT);
         if (MC_DRV_OK != mcRet) {
             ret = TEE_ERR_MAP;
             break;
@@ -1016,7 +1376,7 @@ teeResult_t TEE_GetPubKey(
         pTci->getpubkey.exponentlen    = *exponentLength;
 
         /* Notify the trustlet */
-        mcRet = mcNotify(&sessionHandle);
+        mcRet = mcNotify(&pSession->sessionHandle);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_NOTIFICATION;
@@ -1024,28 +1384,28 @@ teeResult_t TEE_GetPubKey(
         }
 
         /* Wait for response from the trustlet */
-        if (MC_DRV_OK != mcWaitNotification(&sessionHandle, MC_INFINITE_TIMEOUT))
+        if (MC_DRV_OK != mcWaitNotification(&pSession->sessionHandle, MC_INFINITE_TIMEOUT))
         {
             ret = TEE_ERR_NOTIFICATION;
             break;
         }
 
         /* Unmap memory */
-        mcRet = mcUnmap(&sessionHandle, (void*)keyData, &keyMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &keyMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)modulus, &modMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &modMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
             break;
         }
 
-        mcRet = mcUnmap(&sessionHandle, (void*)exponent, &expMapInfo);
+        mcRet = TEE_UnmapBuffer(pSession, &expMapInfo);
         if (MC_DRV_OK != mcRet)
         {
             ret = TEE_ERR_MAP;
@@ -1067,7 +1427,7 @@ teeResult_t TEE_GetPubKey(
     } while (false);
 
     /* Close session to the trustlet */
-    TEE_Close(&sessionHandle);
+    TEE_Close(pSession, ret);
 
     return ret;
 }
@@ -155,6 +155,16 @@ size_t Connection::readData(void *buffer, uint32_t len, int32_t timeout)
 }
 
 
+//------------------------------------------------------------------------------
+size_t Connection::peekData(void *buffer, uint32_t len)
+{
+    assert(NULL != buffer);
+    assert(socketDescriptor != -1);
+
+    return recv(socketDescriptor, buffer, len, MSG_PEEK | MSG_DONTWAIT);
+}
+
+
 //------------------------------------------------------------------------------
 size_t Connection::writeData(void *buffer, uint32_t len)
 {
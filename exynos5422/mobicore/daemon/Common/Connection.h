@@ -96,6 +96,17 @@ public:
      */
     virtual size_t readData(void *buffer, uint32_t len);
 
+    /**
+     * Read bytes from the connection without removing them and without
+     * waiting for data.
+     *
+     * @param buffer    Pointer to destination buffer.
+     * @param len       Number of bytes to read.
+     * @return Number of bytes available, up to len.
+     * @return -1 if no data is available or recv() failed.
+     */
+    virtual size_t peekData(void *buffer, uint32_t len);
+
     /**
      * Write bytes to the connection.
      *
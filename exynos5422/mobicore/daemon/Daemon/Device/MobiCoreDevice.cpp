@@ -77,6 +77,19 @@ TrustletSession *MobiCoreDevice::getTrustletSession(uint32_t sessionId)
 }
 
 
+//------------------------------------------------------------------------------
+bool MobiCoreDevice::hasTrustletSession(uint32_t sessionId)
+{
+    bool found;
+
+    sessionListMutex.lock();
+    found = (getTrustletSession(sessionId) != NULL);
+    sessionListMutex.unlock();
+
+    return found;
+}
+
+
 void MobiCoreDevice::cleanSessionBuffers(TrustletSession *session)
 {
     CWsm_ptr pWsm = session->popBulkBuff();
@@ -94,7 +107,9 @@ void MobiCoreDevice::removeTrustletSession(uint32_t sessionId)
             ++session) {
         if ((*session)->sessionId == sessionId) {
             cleanSessionBuffers(*session);
+            sessionListMutex.lock();
             trustletSessions.erase(session);
+            sessionListMutex.unlock();
             return;
         }
     }
@@ -327,7 +342,9 @@ mcResult_t MobiCoreDevice::openSession(
         pRspOpenSessionPayload->deviceSessionId = (uint32_t)trustletSession;
         pRspOpenSessionPayload->sessionMagic = trustletSession->sessionMagic;
 
+        sessionListMutex.lock();
         trustletSessions.push_back(trustletSession);
+        sessionListMutex.unlock();
 
         trustletSession->addBulkBuff(new CWsm((void *)pLoadDataOpenSession->offs, pLoadDataOpenSession->len, handle, 0));
 
@@ -626,9 +643,12 @@ mcResult_t MobiCoreDevice::getMobiCoreVersion(
 
         pRspGetMobiCoreVersionPayload->versionInfo = mcpMessage->rspGetMobiCoreVersion.versionInfo;
 
-        // Store MobiCore info for future reference.
-        mcVersionInfo = new mcVersionInfo_t();
-        *mcVersionInfo = pRspGetMobiCoreVersionPayload->versionInfo;
+        // Store MobiCore info for future reference. The pointer is published
+        // last as it is read without mcpMutex by the fast path.
+        mcVersionInfo_t *versionInfo = new mcVersionInfo_t();
+        *versionInfo = pRspGetMobiCoreVersionPayload->versionInfo;
+        __sync_synchronize();
+        mcVersionInfo = versionInfo;
         return MC_DRV_OK;
     }
 }
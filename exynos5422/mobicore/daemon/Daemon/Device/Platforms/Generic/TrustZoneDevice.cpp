@@ -243,8 +243,7 @@ void TrustZoneDevice::notify(
     // Check if it is MCP session - handle openSession() command
     if (sessionId != SID_MCP) {
         // Check if session ID exists to avoid flooding of nq by clients
-        TrustletSession *ts = getTrustletSession(sessionId);
-        if (ts == NULL) {
+        if (!hasTrustletSession(sessionId)) {
             LOG_E("no session with id=%d", sessionId);
             return;
         }
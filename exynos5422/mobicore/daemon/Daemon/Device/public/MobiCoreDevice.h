@@ -48,6 +48,7 @@
 
 #include "Connection.h"
 #include "CWsm.h"
+#include "CMutex.h"
 
 #include "ExcDevice.h"
 #include "DeviceScheduler.h"
@@ -83,6 +84,7 @@ protected:
     CSemaphore          mcpSessionNotification; /**< Semaphore to synchronize incoming notifications for the MCP session */
 
     trustletSessionList_t trustletSessions; /**< Available Trustlet Sessions */
+    CMutex              sessionListMutex; /**< Guards trustletSessions changes against hasTrustletSession() */
     mcVersionInfo_t     *mcVersionInfo; /**< MobiCore version info. */
     bool                mcFault; /**< Signal RTM fault */
     bool                mciReused; /**< Signal restart of Daemon. */
@@ -119,6 +121,11 @@ public:
 
     TrustletSession *getTrustletSession(uint32_t sessionId);
 
+    /**
+     * Check if a session exists, safe to call without mcpMutex.
+     */
+    bool hasTrustletSession(uint32_t sessionId);
+
     void cleanSessionBuffers(TrustletSession *session);
     void removeTrustletSession(uint32_t sessionId);
 
@@ -159,6 +166,10 @@ public:
         return mcFault;
     }
 
+    bool hasMobiCoreVersion() {
+        return mcVersionInfo != NULL;
+    }
+
     void queueUnknownNotification(notification_t notification);
 
     virtual void dumpMobicoreStatus(void) = 0;
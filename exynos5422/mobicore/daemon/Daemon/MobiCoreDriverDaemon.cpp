@@ -201,7 +201,9 @@ void MobiCoreDriverDaemon::dropConnection(
     if (device != NULL) {
         LOG_I("dropConnection(): closing still open device.");
         // A connection has been found and has to be closed
+        mcpMutex.lock();
         device->close(connection);
+        mcpMutex.unlock();
     }
 }
 
@@ -414,14 +416,14 @@ void MobiCoreDriverDaemon::processOpenSession(
     MobiCoreDevice  *device = (MobiCoreDevice *) (connection->connectionData);
     CHECK_DEVICE(device, connection);
 
-    // Get service blob from registry
-    regObject_t *regObj = mcRegistryGetServiceBlob(&(cmdOpenSession.uuid));
+    // Get service blob from registry, it stays cached for further sessions
+    regObject_t *regObj = mcRegistryMapServiceBlob(&(cmdOpenSession.uuid));
     if (NULL == regObj) {
         writeResult(connection, MC_DRV_ERR_TRUSTLET_NOT_FOUND);
         return;
     }
     if (regObj->len == 0) {
-        free(regObj);
+        mcRegistryUnmapServiceBlob(regObj);
         writeResult(connection, MC_DRV_ERR_TRUSTLET_NOT_FOUND);
         return;
     }
@@ -430,6 +432,7 @@ void MobiCoreDriverDaemon::processOpenSession(
     CWsm_ptr pWsm = device->registerWsmL2((addr_t)(regObj->value), regObj->len, 0);
     if (pWsm == NULL) {
         LOG_E("allocating WSM for Trustlet failed");
+        mcRegistryUnmapServiceBlob(regObj);
         writeResult(connection, MC_DRV_ERR_DAEMON_KMOD_ERROR);
         return;
     }
@@ -453,12 +456,13 @@ void MobiCoreDriverDaemon::processOpenSession(
     // This will also destroy the WSM object.
     if (!device->unregisterWsmL2(pWsm)) {
         // TODO-2012-07-02-haenellu: Can this ever happen? And if so, we should assert(), also TL might still be running.
+        mcRegistryUnmapServiceBlob(regObj);
         writeResult(connection, MC_DRV_ERR_DAEMON_KMOD_ERROR);
         return;
     }
 
-    // Free memory occupied by Trustlet data
-    free(regObj);
+    // Release Trustlet data, the mapping is kept in the registry cache
+    mcRegistryUnmapServiceBlob(regObj);
 
     if (ret != MC_DRV_OK) {
         LOG_E("Service could not be loaded.");
@@ -692,13 +696,50 @@ void MobiCoreDriverDaemon::processGetMobiCoreVersion(
 }
 
 
+//------------------------------------------------------------------------------
+bool MobiCoreDriverDaemon::isFastPathCommand(
+    uint32_t commandId
+)
+{
+    switch (commandId) {
+    case MC_DRV_CMD_NOTIFY:
+    case MC_DRV_CMD_GET_VERSION:
+        return true;
+    case MC_DRV_CMD_GET_MOBICORE_VERSION:
+        // Only answered from the cache once it has been fetched via MCP
+        return mobiCoreDevice->hasMobiCoreVersion();
+    default:
+        return false;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+bool MobiCoreDriverDaemon::isFastConnection(
+    Connection *connection
+)
+{
+    mcDrvCommandHeader_t mcDrvCommandHeader;
+
+    // Only look at the header, handleConnection() reads it again
+    ssize_t rlen = connection->peekData(
+                       &(mcDrvCommandHeader),
+                       sizeof(mcDrvCommandHeader));
+    if (rlen != sizeof(mcDrvCommandHeader)) {
+        return false;
+    }
+
+    return isFastPathCommand(mcDrvCommandHeader.commandId);
+}
+
+
 //------------------------------------------------------------------------------
 bool MobiCoreDriverDaemon::handleConnection(
     Connection *connection
 )
 {
     bool ret = false;
-    static CMutex mutex;
+    bool fastPath = false;
 
     /* In case of RTM fault do not try to signal anything to MobiCore
      * just answer NO to all incoming connections! */
@@ -706,8 +747,7 @@ bool MobiCoreDriverDaemon::handleConnection(
         return false;
     }
 
-    mutex.lock();
-    LOG_I("handleConnection()==== %p", connection);
+    LOG_V("handleConnection()==== %p", connection);
     do {
         // Read header
         mcDrvCommandHeader_t mcDrvCommandHeader;
@@ -733,6 +773,13 @@ bool MobiCoreDriverDaemon::handleConnection(
         }
         ret = true;
 
+        // Commands using the MCP channel share one message buffer and are
+        // processed one at a time, all others run concurrently.
+        fastPath = isFastPathCommand(mcDrvCommandHeader.commandId);
+        if (!fastPath) {
+            mcpMutex.lock();
+        }
+
         switch (mcDrvCommandHeader.commandId) {
             //-----------------------------------------
         case MC_DRV_CMD_OPEN_DEVICE:
@@ -783,9 +830,12 @@ bool MobiCoreDriverDaemon::handleConnection(
             ret = false;
             break;
         }
+
+        if (!fastPath) {
+            mcpMutex.unlock();
+        }
     } while (0);
-    mutex.unlock();
-    LOG_I("handleConnection()<-------");
+    LOG_V("handleConnection()<-------");
 
     return ret;
 }
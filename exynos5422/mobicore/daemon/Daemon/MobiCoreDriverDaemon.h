@@ -38,6 +38,7 @@
 #include "Server/public/Server.h"
 
 #include "MobiCoreDevice.h"
+#include "CMutex.h"
 #include <string>
 #include <list>
 
@@ -102,6 +103,10 @@ public:
         Connection *connection
     );
 
+    bool isFastConnection(
+        Connection *connection
+    );
+
     void run(
         void
     );
@@ -123,6 +128,20 @@ private:
     driverResourcesList_t driverResources;
     /**< List of servers processing connections */
     Server *servers[MAX_SERVERS];
+    /**< Serializes commands using the MCP channel or changing sessions */
+    CMutex mcpMutex;
+
+    /**
+     * Check if a command may run concurrently to MCP commands.
+     * Notifications and version queries do not use the shared MCP message
+     * buffer and must not wait behind a long session open.
+     *
+     * @param commandId Command identifier from the command header.
+     * @return true if the command does not need mcpMutex.
+     */
+    bool isFastPathCommand(
+        uint32_t commandId
+    );
 
     size_t writeResult(
         Connection  *connection,
@@ -36,17 +36,52 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/epoll.h>
 
 //#define LOG_VERBOSE
 #include "log.h"
 
+//------------------------------------------------------------------------------
+ServerWorker::ServerWorker(
+    Server *server,
+    bool fast
+) : server(server), fast(fast)
+{
+}
+
+
+//------------------------------------------------------------------------------
+void ServerWorker::run(
+    void
+)
+{
+    for (;;) {
+        Connection *connection = server->dequeueConnection(fast);
+
+        // A NULL entry is queued for every worker when the server shuts down
+        if (connection == NULL) {
+            break;
+        }
+
+        server->processConnection(connection);
+    }
+}
+
+
 //------------------------------------------------------------------------------
 Server::Server(
     ConnectionHandler *connectionHandler,
     const char *localAddr
-) : socketAddr(localAddr)
+) : serverSock(-1), socketAddr(localAddr), epollFd(-1)
 {
     this->connectionHandler = connectionHandler;
+
+    for (int i = 0; i < SERVER_WORKER_NUM; i++) {
+        workers[i] = NULL;
+    }
+    for (int i = 0; i < SERVER_FAST_WORKER_NUM; i++) {
+        fastWorkers[i] = NULL;
+    }
 }
 
 
@@ -83,109 +118,58 @@ void Server::run(
             break;
         }
 
-        LOG_I("\n********* successfully initialized Daemon *********\n");
+        epollFd = epoll_create(SERVER_MAX_EVENTS);
+        if (epollFd < 0) {
+            LOG_ERRNO("epoll_create");
+            break;
+        }
 
-        for (;;) {
-            fd_set fdReadSockets;
-
-            // Clear FD for select()
-            FD_ZERO(&fdReadSockets);
-
-            // Select server socket descriptor
-            FD_SET(serverSock, &fdReadSockets);
-            int maxSocketDescriptor = serverSock;
-
-            // Select socket descriptor of all connections
-            for (connectionIterator_t iterator = peerConnections.begin();
-                    iterator != peerConnections.end();
-                    ++iterator) {
-                Connection *connection = (*iterator);
-                int peerSocket = connection->socketDescriptor;
-                FD_SET(peerSocket, &fdReadSockets);
-                if (peerSocket > maxSocketDescriptor) {
-                    maxSocketDescriptor = peerSocket;
-                }
-            }
+        // The server socket is the only descriptor registered without a
+        // connection object and it stays armed all the time.
+        struct epoll_event event;
+        memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, serverSock, &event) < 0) {
+            LOG_ERRNO("epoll_ctl");
+            break;
+        }
 
-            // Wait for activities, select() returns the number of sockets
-            // which require processing
-            LOG_V(" Server: waiting on sockets");
-            int numSockets = select(
-                                 maxSocketDescriptor + 1,
-                                 &fdReadSockets,
-                                 NULL, NULL, NULL);
-
-            // Check if select failed
-            if (numSockets < 0) {
-                LOG_ERRNO("select");
-                break;
-            }
+        startWorkers();
 
-            // actually, this should not happen.
-            if (0 == numSockets) {
-                LOG_W(" Server: select() returned 0, spurious event?.");
-                continue;
-            }
+        LOG_I("\n********* successfully initialized Daemon *********\n");
 
-            LOG_V(" Server: events on %d socket(s).", numSockets);
-
-            // Check if a new client connected to the server socket
-            if (FD_ISSET(serverSock, &fdReadSockets)) {
-                do {
-                    LOG_V(" Server: new connection attempt.");
-                    numSockets--;
-
-                    struct sockaddr_un clientAddr;
-                    socklen_t clientSockLen = sizeof(clientAddr);
-                    int clientSock = accept(
-                                         serverSock,
-                                         (struct sockaddr *) &clientAddr,
-                                         &clientSockLen);
-
-                    if (clientSock <= 0) {
-                        LOG_ERRNO("accept");
-                        break;
-                    }
-
-                    Connection *connection = new Connection(clientSock, &clientAddr);
-                    peerConnections.push_back(connection);
-                    LOG_I(" Server: new socket connection established and start listening.");
-                } while (false);
-
-                // we can ignore any errors from accepting a new connection.
-                // If this fail, the client has to deal with it, we are done
-                // and nothing has changed.
-            }
+        for (;;) {
+            struct epoll_event events[SERVER_MAX_EVENTS];
 
-            // Handle traffic on existing client connections
-            connectionIterator_t iterator = peerConnections.begin();
-            while ( (iterator != peerConnections.end())
-                    && (numSockets > 0) ) {
-                Connection *connection = (*iterator);
-                int peerSocket = connection->socketDescriptor;
+            LOG_V(" Server: waiting on sockets");
+            int numEvents = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, -1);
 
-                if (!FD_ISSET(peerSocket, &fdReadSockets)) {
-                    ++iterator;
+            if (numEvents < 0) {
+                if (errno == EINTR) {
                     continue;
                 }
+                LOG_ERRNO("epoll_wait");
+                break;
+            }
 
-                numSockets--;
-
-                // the connection will be terminated if command processing
-                // fails
-                if (!connectionHandler->handleConnection(connection)) {
-                    LOG_I(" Server: dropping connection.");
+            LOG_V(" Server: events on %d socket(s).", numEvents);
 
-                    //Inform the driver
-                    connectionHandler->dropConnection(connection);
+            for (int i = 0; i < numEvents; i++) {
+                Connection *connection = (Connection *) events[i].data.ptr;
 
-                    // Remove connection from list
-                    delete connection;
-                    iterator = peerConnections.erase(iterator);
+                // Check if a new client connected to the server socket
+                if (connection == NULL) {
+                    acceptConnection();
                     continue;
                 }
 
-                ++iterator;
+                // The connection stays disarmed until a worker has processed
+                // the command, hangups are detected by the worker as well.
+                // Fast commands get their own worker so that they are not
+                // stuck behind slow ones filling up the pool.
+                enqueueConnection(connection,
+                                  connectionHandler->isFastConnection(connection));
             }
         }
 
@@ -195,6 +179,210 @@ void Server::run(
 }
 
 
+//------------------------------------------------------------------------------
+void Server::acceptConnection(
+    void
+)
+{
+    LOG_V(" Server: new connection attempt.");
+
+    struct sockaddr_un clientAddr;
+    socklen_t clientSockLen = sizeof(clientAddr);
+    int clientSock = accept(
+                         serverSock,
+                         (struct sockaddr *) &clientAddr,
+                         &clientSockLen);
+
+    // we can ignore any errors from accepting a new connection.
+    // If this fail, the client has to deal with it, we are done
+    // and nothing has changed.
+    if (clientSock <= 0) {
+        LOG_ERRNO("accept");
+        return;
+    }
+
+    Connection *connection = new Connection(clientSock, &clientAddr);
+
+    connectionsMutex.lock();
+    peerConnections.push_back(connection);
+    if (!armConnection(connection, EPOLL_CTL_ADD)) {
+        peerConnections.pop_back();
+        connectionsMutex.unlock();
+        delete connection;
+        return;
+    }
+    connectionsMutex.unlock();
+
+    LOG_I(" Server: new socket connection established and start listening.");
+}
+
+
+//------------------------------------------------------------------------------
+bool Server::armConnection(
+    Connection *connection,
+    int op
+)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = connection;
+
+    if (epoll_ctl(epollFd, op, connection->socketDescriptor, &event) < 0) {
+        LOG_ERRNO("epoll_ctl");
+        return false;
+    }
+    return true;
+}
+
+
+//------------------------------------------------------------------------------
+void Server::startWorkers(
+    void
+)
+{
+    for (int i = 0; i < SERVER_WORKER_NUM; i++) {
+        workers[i] = new ServerWorker(this, false);
+        workers[i]->start();
+    }
+    for (int i = 0; i < SERVER_FAST_WORKER_NUM; i++) {
+        fastWorkers[i] = new ServerWorker(this, true);
+        fastWorkers[i]->start();
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void Server::stopWorkers(
+    void
+)
+{
+    for (int i = 0; i < SERVER_WORKER_NUM; i++) {
+        if (workers[i] != NULL) {
+            enqueueConnection(NULL, false);
+        }
+    }
+    for (int i = 0; i < SERVER_FAST_WORKER_NUM; i++) {
+        if (fastWorkers[i] != NULL) {
+            enqueueConnection(NULL, true);
+        }
+    }
+
+    for (int i = 0; i < SERVER_WORKER_NUM; i++) {
+        if (workers[i] != NULL) {
+            workers[i]->join();
+            delete workers[i];
+            workers[i] = NULL;
+        }
+    }
+    for (int i = 0; i < SERVER_FAST_WORKER_NUM; i++) {
+        if (fastWorkers[i] != NULL) {
+            fastWorkers[i]->join();
+            delete fastWorkers[i];
+            fastWorkers[i] = NULL;
+        }
+    }
+}
+
+
+//------------------------------------------------------------------------------
+void Server::enqueueConnection(
+    Connection *connection,
+    bool fast
+)
+{
+    if (fast) {
+        fastQueueMutex.lock();
+        fastQueue.push_back(connection);
+        fastQueueMutex.unlock();
+
+        fastQueueSem.signal();
+        return;
+    }
+
+    workQueueMutex.lock();
+    workQueue.push_back(connection);
+    workQueueMutex.unlock();
+
+    workQueueSem.signal();
+}
+
+
+//------------------------------------------------------------------------------
+Connection *Server::dequeueConnection(
+    bool fast
+)
+{
+    Connection *connection;
+
+    if (fast) {
+        fastQueueSem.wait();
+
+        fastQueueMutex.lock();
+        connection = fastQueue.front();
+        fastQueue.pop_front();
+        fastQueueMutex.unlock();
+
+        return connection;
+    }
+
+    workQueueSem.wait();
+
+    workQueueMutex.lock();
+    connection = workQueue.front();
+    workQueue.pop_front();
+    workQueueMutex.unlock();
+
+    return connection;
+}
+
+
+//------------------------------------------------------------------------------
+void Server::processConnection(
+    Connection *connection
+)
+{
+    // the connection will be terminated if command processing
+    // fails
+    bool keep = connectionHandler->handleConnection(connection);
+
+    connectionsMutex.lock();
+
+    connectionIterator_t iterator = peerConnections.begin();
+    while (iterator != peerConnections.end()) {
+        if ((*iterator) == connection) {
+            break;
+        }
+        ++iterator;
+    }
+
+    // The connection has been detached while processing the command, it
+    // now belongs to someone else and must not be touched any more.
+    if (iterator == peerConnections.end()) {
+        connectionsMutex.unlock();
+        return;
+    }
+
+    if (keep && armConnection(connection, EPOLL_CTL_MOD)) {
+        connectionsMutex.unlock();
+        return;
+    }
+
+    // Remove connection from list
+    peerConnections.erase(iterator);
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->socketDescriptor, NULL);
+    connectionsMutex.unlock();
+
+    LOG_I(" Server: dropping connection.");
+
+    // Inform the driver, outside of the list lock as it may talk to MobiCore
+    connectionHandler->dropConnection(connection);
+
+    delete connection;
+}
+
+
 //------------------------------------------------------------------------------
 void Server::detachConnection(
     Connection *connection
@@ -202,16 +390,19 @@ void Server::detachConnection(
 {
     LOG_V(" Stopping to listen on notification socket.");
 
+    connectionsMutex.lock();
     for (connectionIterator_t iterator = peerConnections.begin();
             iterator != peerConnections.end();
             ++iterator) {
         Connection *tmpConnection = (*iterator);
         if (tmpConnection == connection) {
             peerConnections.erase(iterator);
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->socketDescriptor, NULL);
             LOG_I(" Stopped listening on notification socket.");
             break;
         }
     }
+    connectionsMutex.unlock();
 }
 
 
@@ -220,6 +411,12 @@ Server::~Server(
     void
 )
 {
+    stopWorkers();
+
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+
     // Shut down the server socket
     close(serverSock);
 
@@ -52,6 +52,20 @@ public:
         Connection *connection
     ) = 0;
 
+    /**
+     * Check if the pending command of a connection is a fast one.
+     * Called from the event loop of the server before the command is read,
+     * so it must not block or consume any data.
+     *
+     * @param [in] connection Reference to the connection which has data to process.
+     * @return true if the command does not wait behind slow commands.
+     */
+    virtual bool isFastConnection(
+        Connection *connection
+    ) {
+        return false;
+    };
+
     /**
      * Connection has been closed.
      * The connection handler shall clean up all resources associated with the given connection.
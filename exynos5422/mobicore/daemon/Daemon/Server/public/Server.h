@@ -6,7 +6,13 @@
  *
  * Handles incoming socket connections from clients using the MobiCore driver.
  *
- * Iterative socket server using UNIX domain stream protocol.
+ * Event driven socket server using UNIX domain stream protocol. A single
+ * thread waits on all sockets with epoll and hands connections with pending
+ * commands to a small pool of worker threads. A connection is armed with
+ * EPOLLONESHOT, so at most one command per connection is in flight and the
+ * commands of a client are processed in the order they were sent.
+ * Commands the connection handler reports as fast are handed to a worker of
+ * their own, so they never wait behind slow commands occupying the pool.
  *
  * <!-- Copyright Giesecke & Devrient GmbH 2009 - 2012 -->
  *
@@ -43,13 +49,49 @@
 #include <string>
 #include <cstdio>
 #include <vector>
+#include <list>
 #include "CThread.h"
+#include "CMutex.h"
+#include "CSemaphore.h"
 #include "ConnectionHandler.h"
 
 /** Number of incoming connections that can be queued.
  * Additional clients will generate the error ECONNREFUSED. */
 #define LISTEN_QUEUE_LEN    (16)
 
+/** Number of threads processing client commands. */
+#define SERVER_WORKER_NUM   (4)
+
+/** Number of threads processing only fast client commands. */
+#define SERVER_FAST_WORKER_NUM  (1)
+
+/** Maximum number of events fetched with one epoll_wait() call. */
+#define SERVER_MAX_EVENTS   (16)
+
+class Server;
+
+/**
+ * Worker thread of the socket server.
+ * Takes connections with pending data from the server queue and lets the
+ * connection handler process one command of it.
+ */
+class ServerWorker: public CThread
+{
+
+public:
+    ServerWorker(
+        Server *server,
+        bool fast
+    );
+
+    virtual void run(
+    );
+
+private:
+    Server *server; /**< Server owning the work queue */
+    bool fast; /**< Takes connections from the fast queue */
+};
+
 
 class Server: public CThread
 {
@@ -93,6 +135,28 @@ public:
         Connection *connection
     );
 
+    /**
+     * Take the next connection with pending data from a work queue.
+     * Blocks until a connection is available.
+     *
+     * @param fast Take it from the queue of fast commands.
+     * @return Connection to process or NULL if the worker has to exit.
+     */
+    Connection *dequeueConnection(
+        bool fast
+    );
+
+    /**
+     * Process one command of a connection and hand it back to the event loop.
+     * The connection is armed again if it is still attached to the server,
+     * otherwise it is dropped or left to its new owner.
+     *
+     * @param connection The connection object with pending data.
+     */
+    void processConnection(
+        Connection *connection
+    );
+
 protected:
     int serverSock;
     string socketAddr;
@@ -100,6 +164,40 @@ protected:
 
 private:
     connectionList_t    peerConnections; /**< Connections to devices */
+    CMutex              connectionsMutex; /**< Guards peerConnections */
+    int                 epollFd; /**< Event descriptor watching all sockets */
+
+    std::list<Connection *> workQueue; /**< Connections waiting for a worker */
+    CMutex              workQueueMutex; /**< Guards workQueue */
+    CSemaphore          workQueueSem; /**< Counts entries of workQueue */
+    ServerWorker        *workers[SERVER_WORKER_NUM]; /**< Command processing threads */
+
+    std::list<Connection *> fastQueue; /**< Connections with a fast command */
+    CMutex              fastQueueMutex; /**< Guards fastQueue */
+    CSemaphore          fastQueueSem; /**< Counts entries of fastQueue */
+    ServerWorker        *fastWorkers[SERVER_FAST_WORKER_NUM]; /**< Fast command threads */
+
+    void startWorkers(
+        void
+    );
+
+    void stopWorkers(
+        void
+    );
+
+    void enqueueConnection(
+        Connection *connection,
+        bool fast
+    );
+
+    bool armConnection(
+        Connection *connection,
+        int op
+    );
+
+    void acceptConnection(
+        void
+    );
 
 };
 
@@ -53,6 +53,11 @@ extern "C" {
     /** Maximum size of a trustlet in bytes. */
 #define MAX_TL_SIZE     (1 * 1024 * 1024)
 
+    /** Default size limit of the service blob cache in bytes. */
+#ifndef MC_REGISTRY_BLOB_CACHE_SIZE
+#define MC_REGISTRY_BLOB_CACHE_SIZE     (4 * 1024 * 1024)
+#endif
+
 //-----------------------------------------------------------------
 
     /** Stores an authentication token in registry.
@@ -169,6 +174,33 @@ extern "C" {
      */
     regObject_t *mcRegistryGetDriverBlob(const char *driverFilename);
 
+    /** Returns a memory mapped registry object for a given service.
+     * Objects are kept in an LRU cache keyed by UUID and are reused as long as
+     * the trustlet binary and its containers are unchanged (device, inode,
+     * mtime and size). The value is page aligned and can be shared with the
+     * secure world without copying.
+     * @param uuid service UUID
+     * @return Registry object or NULL on failure.
+     * @note The registry object must not be modified and has to be released
+     * with mcRegistryUnmapServiceBlob().
+     */
+    regObject_t *mcRegistryMapServiceBlob(const mcUuid_t *uuid);
+
+    /** Releases a registry object returned by mcRegistryMapServiceBlob().
+     * @param regobj Registry object.
+     */
+    void mcRegistryUnmapServiceBlob(regObject_t *regobj);
+
+    /** Sets the size limit of the service blob cache, 0 disables caching.
+     * @param maxSize Size limit in bytes.
+     */
+    void mcRegistrySetBlobCacheSize(uint32_t maxSize);
+
+    /** Drops all service blobs from the cache. Blobs still in use are
+     * unmapped when they are released.
+     */
+    void mcRegistryFlushBlobCache(void);
+
 #ifdef __cplusplus
 }
 #endif
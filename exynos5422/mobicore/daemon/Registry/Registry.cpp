@@ -36,8 +36,14 @@
 #include <dirent.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
 #include <assert.h>
 #include <string>
+#include <list>
 #include <cstring>
 #include <cstddef>
 #include "mcLoadFormat.h"
@@ -80,6 +86,47 @@ static const string uint32ToString(mcSpid_t spid);
 static const string byteArrayToString(const void *bytes, size_t elems);
 static bool doesDirExist(const char *path);
 
+//------------------------------------------------------------------------------
+// Service blob cache
+//------------------------------------------------------------------------------
+
+/** Registry files a cached service blob has been built from. */
+typedef enum {
+    REG_STAMP_TL_BIN = 0,
+    REG_STAMP_TL_CONT,
+    REG_STAMP_SP_CONT,
+    REG_STAMP_ROOT_CONT,
+    REG_STAMP_MAX
+} regStampIndex_t;
+
+/** Identity of a registry file, a cached blob is valid while it matches. */
+typedef struct {
+    dev_t   dev;
+    ino_t   ino;
+    time_t  mtime;
+    off_t   size;
+} regFileStamp_t;
+
+/** Cached service blob. Lives in a private mapping of the trustlet file. */
+typedef struct {
+    mcUuid_t        uuid;
+    void            *base;      /**< Start of the mapping, holds a back pointer to the entry */
+    size_t          mapLen;     /**< Length of the whole mapping */
+    regObject_t     *regobj;    /**< Registry object handed out, value is page aligned */
+    mcSpid_t        spid;       /**< Parent SP of a SP trustlet */
+    uint32_t        numStamps;
+    regFileStamp_t  stamps[REG_STAMP_MAX];
+    uint32_t        refCount;   /**< Number of users holding regobj */
+    bool            cached;     /**< Entry is in the LRU list */
+} regCacheEntry_t;
+
+typedef list<regCacheEntry_t *> regCacheList_t;
+
+static regCacheList_t blobCache; /**< Most recently used entry first */
+static size_t blobCacheSize = 0;
+static size_t blobCacheMaxSize = MC_REGISTRY_BLOB_CACHE_SIZE;
+static pthread_mutex_t blobCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+
 //------------------------------------------------------------------------------
 mcResult_t mcRegistryStoreAuthToken(
     const mcSoAuthTokenCont_t *so
@@ -575,6 +622,70 @@ mcResult_t mcRegistryCleanupRoot(void)
 }
 
 
+//------------------------------------------------------------------------------
+static mcResult_t fillServiceContainers(
+    const mcUuid_t *uuid,
+    regObject_t *regobj,
+    size_t tlSize,
+    mcSpid_t *pSpid
+)
+{
+    // Goto end of the registry object and fill in tl container, sp container,
+    // and root container from back to front.
+    uint8_t *p = regobj->value + regobj->len;
+    mcResult_t ret;
+    do {
+        char *msg;
+
+        // Fill in TL container.
+        p -= sizeof(mcSoTltCont_t);
+        mcSoTltCont_t *soTlt = (mcSoTltCont_t *)p;
+        if (MC_DRV_OK != (ret = mcRegistryReadTrustletCon(uuid, soTlt))) {
+            break;
+        }
+        mcTltCont_t *tltCont = &soTlt->cont;
+        if (!checkVersionOkDataObjectCONTAINER(tltCont->version, &msg)) {
+            LOG_E("Tlt container %s", msg);
+            ret = MC_DRV_ERR_CONTAINER_VERSION;
+            break;
+        }
+
+        // Fill in SP container.
+        mcSpid_t spid = tltCont->parent;
+        *pSpid = spid;
+        p -= sizeof(mcSoSpCont_t);
+        mcSoSpCont_t *soSp = (mcSoSpCont_t *)p;
+        if (MC_DRV_OK != (ret = mcRegistryReadSp(spid, soSp))) {
+            break;
+        }
+        mcSpCont_t *spCont = &soSp->cont;
+        if (!checkVersionOkDataObjectCONTAINER(spCont->version, &msg)) {
+            LOG_E("SP container %s", msg);
+            ret = MC_DRV_ERR_CONTAINER_VERSION;
+            break;
+        }
+
+        // Fill in root container.
+        p -= sizeof(mcSoRootCont_t);
+        mcSoRootCont_t *soRoot = (mcSoRootCont_t *)p;
+        if (MC_DRV_OK != (ret = mcRegistryReadRoot(soRoot))) {
+            break;
+        }
+        mcRootCont_t *rootCont = &soRoot->cont;
+        if (!checkVersionOkDataObjectCONTAINER(rootCont->version, &msg)) {
+            LOG_E("Root container %s", msg);
+            ret = MC_DRV_ERR_CONTAINER_VERSION;
+            break;
+        }
+
+        // Ensure order of elements in registry object value.
+        assert(p - tlSize - sizeof(regObject_t) == (uint8_t *)regobj);
+    } while (false);
+
+    return ret;
+}
+
+
 //------------------------------------------------------------------------------
 regObject_t *mcRegistryGetServiceBlob(
     const mcUuid_t *uuid
@@ -684,55 +795,8 @@ regObject_t *mcRegistryGetServiceBlob(
         //
         //    /------------------ regobj->header.len ---------------------/
 
-        uint8_t *p = regobj->value + regobj->len;
-        mcResult_t ret;
-        do {
-            char *msg;
-
-            // Fill in TL container.
-            p -= sizeof(mcSoTltCont_t);
-            mcSoTltCont_t *soTlt = (mcSoTltCont_t *)p;
-            if (MC_DRV_OK != (ret = mcRegistryReadTrustletCon(uuid, soTlt))) {
-                break;
-            }
-            mcTltCont_t *tltCont = &soTlt->cont;
-            if (!checkVersionOkDataObjectCONTAINER(tltCont->version, &msg)) {
-                LOG_E("Tlt container %s", msg);
-                ret = MC_DRV_ERR_CONTAINER_VERSION;
-                break;
-            }
-
-            // Fill in SP container.
-            mcSpid_t spid = tltCont->parent;
-            p -= sizeof(mcSoSpCont_t);
-            mcSoSpCont_t *soSp = (mcSoSpCont_t *)p;
-            if (MC_DRV_OK != (ret = mcRegistryReadSp(spid, soSp))) {
-                break;
-            }
-            mcSpCont_t *spCont = &soSp->cont;
-            if (!checkVersionOkDataObjectCONTAINER(spCont->version, &msg)) {
-                LOG_E("SP container %s", msg);
-                ret = MC_DRV_ERR_CONTAINER_VERSION;
-                break;
-            }
-
-            // Fill in root container.
-            p -= sizeof(mcSoRootCont_t);
-            mcSoRootCont_t *soRoot = (mcSoRootCont_t *)p;
-            if (MC_DRV_OK != (ret = mcRegistryReadRoot(soRoot))) {
-                break;
-            }
-            mcRootCont_t *rootCont = &soRoot->cont;
-            if (!checkVersionOkDataObjectCONTAINER(rootCont->version, &msg)) {
-                LOG_E("Root container %s", msg);
-                ret = MC_DRV_ERR_CONTAINER_VERSION;
-                break;
-            }
-
-            // Ensure order of elements in registry object value.
-            assert(p - tlSize - sizeof(regObject_t) == (uint8_t *)regobj);
-        } while (false);
-
+        mcSpid_t spid;
+        mcResult_t ret = fillServiceContainers(uuid, regobj, tlSize, &spid);
         if (MC_DRV_OK != ret) {
             LOG_E("mcRegistryGetServiceBlob() failed: Error code: %d", ret);
             free(regobj);
@@ -821,6 +885,342 @@ regObject_t *mcRegistryGetDriverBlob(
     return regobj;
 }
 
+//------------------------------------------------------------------------------
+static bool getFileStamp(
+    const string &path,
+    regFileStamp_t *stamp
+)
+{
+    struct stat st;
+
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp->dev = st.st_dev;
+    stamp->ino = st.st_ino;
+    stamp->mtime = st.st_mtime;
+    stamp->size = st.st_size;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static const string getStampFilePath(
+    const regCacheEntry_t *entry,
+    uint32_t index
+)
+{
+    switch (index) {
+    case REG_STAMP_TL_BIN:
+        return getTlBinFilePath(&entry->uuid);
+    case REG_STAMP_TL_CONT:
+        return getTlContFilePath(&entry->uuid);
+    case REG_STAMP_SP_CONT:
+        return getSpContFilePath(entry->spid);
+    default:
+        return getRootContFilePath();
+    }
+}
+
+//------------------------------------------------------------------------------
+static bool isCacheEntryValid(
+    const regCacheEntry_t *entry
+)
+{
+    for (uint32_t i = 0; i < entry->numStamps; i++) {
+        regFileStamp_t stamp;
+
+        if (!getFileStamp(getStampFilePath(entry, i), &stamp)) {
+            return false;
+        }
+        if ((stamp.dev != entry->stamps[i].dev)
+                || (stamp.ino != entry->stamps[i].ino)
+                || (stamp.mtime != entry->stamps[i].mtime)
+                || (stamp.size != entry->stamps[i].size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static void unmapCacheEntry(
+    regCacheEntry_t *entry
+)
+{
+    munmap(entry->base, entry->mapLen);
+    delete entry;
+}
+
+//------------------------------------------------------------------------------
+/**
+ * Map a service blob into memory.
+ * The mapping starts with one header page which holds a pointer back to the
+ * cache entry and ends with the regObject_t length field, so that the value
+ * of the registry object starts page aligned. The trustlet file is mapped
+ * privately right behind it and, for SP trustlets, the containers are
+ * appended after the trustlet like in mcRegistryGetServiceBlob().
+ *
+ * Trustlet binaries are expected to be replaced by a new file, not rewritten
+ * in place, as truncating a mapped file invalidates the mapped pages.
+ */
+static regCacheEntry_t *mapServiceBlob(
+    const mcUuid_t *uuid
+)
+{
+    string tlBinFilePath = getTlBinFilePath(uuid);
+    LOG_I(" Mapping %s", tlBinFilePath.c_str());
+
+    int fd = open(tlBinFilePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_E("Cannot open %s", tlBinFilePath.c_str());
+        return NULL;
+    }
+
+    regCacheEntry_t *entry = NULL;
+    uint8_t *base = (uint8_t *)MAP_FAILED;
+    size_t mapLen = 0;
+
+    do {
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            LOG_E("Cannot stat %s", tlBinFilePath.c_str());
+            break;
+        }
+
+        // Determine and check service blob size.
+        size_t tlSize = st.st_size;
+        if ((MAX_TL_SIZE < tlSize) || (tlSize < sizeof(mclfHeaderV2_t))) {
+            LOG_E("mcRegistryMapServiceBlob() failed: invalid service blob size: %d", (int)tlSize);
+            break;
+        }
+
+        // Check TL magic value, header version and get service type.
+        mclfHeaderV2_t header;
+        if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)) {
+            LOG_E("Cannot read %s", tlBinFilePath.c_str());
+            break;
+        }
+        if (header.intro.magic != MC_SERVICE_HEADER_MAGIC_BE) {
+            LOG_E("mcRegistryMapServiceBlob() failed: wrong header magic value: %d", header.intro.magic);
+            break;
+        }
+        char *msg;
+        if (!checkVersionOkDataObjectMCLF(header.intro.version, &msg)) {
+            LOG_E("%s", msg);
+            break;
+        }
+
+        serviceType_t serviceType = header.serviceType;
+        size_t regObjValueSize;
+        if (SERVICE_TYPE_DRIVER == serviceType || SERVICE_TYPE_SYSTEM_TRUSTLET == serviceType) {
+            regObjValueSize = tlSize;
+        } else if (SERVICE_TYPE_SP_TRUSTLET == serviceType) {
+            regObjValueSize = tlSize + sizeof(mcSoContainerPath_t);
+        } else {
+            LOG_E("mcRegistryMapServiceBlob() failed: Unsupported service type %u", serviceType);
+            break;
+        }
+
+        // Reserve header page and value, then map the trustlet over the
+        // beginning of the value.
+        size_t pageSize = sysconf(_SC_PAGESIZE);
+        mapLen = pageSize + ((regObjValueSize + pageSize - 1) & ~(pageSize - 1));
+        base = (uint8_t *)mmap(NULL, mapLen, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            LOG_ERRNO("mmap");
+            break;
+        }
+        if (mmap(base + pageSize, tlSize, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+            LOG_ERRNO("mmap");
+            break;
+        }
+
+        entry = new regCacheEntry_t;
+        memset(entry, 0, sizeof(*entry));
+        entry->uuid = *uuid;
+        entry->base = base;
+        entry->mapLen = mapLen;
+        entry->regobj = (regObject_t *)(base + pageSize - sizeof(regObject_t));
+        entry->regobj->len = regObjValueSize;
+        *(regCacheEntry_t **)base = entry;
+
+        entry->stamps[REG_STAMP_TL_BIN].dev = st.st_dev;
+        entry->stamps[REG_STAMP_TL_BIN].ino = st.st_ino;
+        entry->stamps[REG_STAMP_TL_BIN].mtime = st.st_mtime;
+        entry->stamps[REG_STAMP_TL_BIN].size = st.st_size;
+        entry->numStamps = REG_STAMP_TL_BIN + 1;
+
+        if (SERVICE_TYPE_SP_TRUSTLET == serviceType) {
+            mcResult_t ret = fillServiceContainers(uuid, entry->regobj, tlSize, &entry->spid);
+            if (MC_DRV_OK != ret) {
+                LOG_E("mcRegistryMapServiceBlob() failed: Error code: %d", ret);
+                delete entry;
+                entry = NULL;
+                break;
+            }
+            for (uint32_t i = REG_STAMP_TL_CONT; i < REG_STAMP_MAX; i++) {
+                if (!getFileStamp(getStampFilePath(entry, i), &entry->stamps[i])) {
+                    break;
+                }
+                entry->numStamps = i + 1;
+            }
+            if (entry->numStamps != REG_STAMP_MAX) {
+                LOG_E("mcRegistryMapServiceBlob() failed: containers changed while loading");
+                delete entry;
+                entry = NULL;
+                break;
+            }
+        }
+    } while (false);
+
+    close(fd);
+
+    if ((entry == NULL) && (base != MAP_FAILED)) {
+        munmap(base, mapLen);
+    }
+
+    return entry;
+}
+
+//------------------------------------------------------------------------------
+/** Evict least recently used blobs nobody holds until the cache fits. */
+static void trimBlobCache(
+    size_t maxSize
+)
+{
+    regCacheList_t::iterator iterator = blobCache.end();
+
+    while ((blobCacheSize > maxSize) && (iterator != blobCache.begin())) {
+        --iterator;
+        regCacheEntry_t *entry = *iterator;
+        if (entry->refCount != 0) {
+            continue;
+        }
+        blobCacheSize -= entry->mapLen;
+        iterator = blobCache.erase(iterator);
+        unmapCacheEntry(entry);
+    }
+}
+
+//------------------------------------------------------------------------------
+/** Take an entry out of the cache, it is unmapped once the last user released it. */
+static void removeCacheEntry(
+    regCacheList_t::iterator iterator
+)
+{
+    regCacheEntry_t *entry = *iterator;
+
+    blobCacheSize -= entry->mapLen;
+    entry->cached = false;
+    blobCache.erase(iterator);
+    if (entry->refCount == 0) {
+        unmapCacheEntry(entry);
+    }
+}
+
+//------------------------------------------------------------------------------
+regObject_t *mcRegistryMapServiceBlob(
+    const mcUuid_t *uuid
+)
+{
+    regCacheEntry_t *entry = NULL;
+
+    // Ensure that a UUID is provided.
+    if (NULL == uuid) {
+        LOG_E("No UUID given");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&blobCacheMutex);
+
+    for (regCacheList_t::iterator iterator = blobCache.begin();
+            iterator != blobCache.end();
+            ++iterator) {
+        if (memcmp(&(*iterator)->uuid, uuid, sizeof(*uuid)) != 0) {
+            continue;
+        }
+        if (isCacheEntryValid(*iterator)) {
+            entry = *iterator;
+            blobCache.splice(blobCache.begin(), blobCache, iterator);
+        } else {
+            LOG_I(" Cached service blob is outdated");
+            removeCacheEntry(iterator);
+        }
+        break;
+    }
+
+    if (entry == NULL) {
+        entry = mapServiceBlob(uuid);
+        if ((entry != NULL) && (entry->mapLen <= blobCacheMaxSize)) {
+            entry->cached = true;
+            blobCache.push_front(entry);
+            blobCacheSize += entry->mapLen;
+            trimBlobCache(blobCacheMaxSize);
+        }
+    }
+
+    if (entry != NULL) {
+        entry->refCount++;
+    }
+
+    pthread_mutex_unlock(&blobCacheMutex);
+
+    return (entry != NULL) ? entry->regobj : NULL;
+}
+
+//------------------------------------------------------------------------------
+void mcRegistryUnmapServiceBlob(
+    regObject_t *regobj
+)
+{
+    if (NULL == regobj) {
+        return;
+    }
+
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    uint8_t *base = (uint8_t *)regobj + sizeof(regObject_t) - pageSize;
+    regCacheEntry_t *entry = *(regCacheEntry_t **)base;
+
+    pthread_mutex_lock(&blobCacheMutex);
+
+    assert(entry->regobj == regobj);
+    assert(entry->refCount > 0);
+
+    entry->refCount--;
+    if (entry->refCount == 0) {
+        if (!entry->cached) {
+            unmapCacheEntry(entry);
+        } else {
+            trimBlobCache(blobCacheMaxSize);
+        }
+    }
+
+    pthread_mutex_unlock(&blobCacheMutex);
+}
+
+//------------------------------------------------------------------------------
+void mcRegistrySetBlobCacheSize(
+    uint32_t maxSize
+)
+{
+    pthread_mutex_lock(&blobCacheMutex);
+    blobCacheMaxSize = maxSize;
+    trimBlobCache(blobCacheMaxSize);
+    pthread_mutex_unlock(&blobCacheMutex);
+}
+
+//------------------------------------------------------------------------------
+void mcRegistryFlushBlobCache(void)
+{
+    pthread_mutex_lock(&blobCacheMutex);
+    while (!blobCache.empty()) {
+        removeCacheEntry(blobCache.begin());
+    }
+    pthread_mutex_unlock(&blobCacheMutex);
+}
+
 //------------------------------------------------------------------------------
 static const string getRegistryPath()
 {
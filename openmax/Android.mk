@@ -34,10 +34,12 @@ ifeq ($(BOARD_USE_ALP_AUDIO), true)
 endif
 
 include $(EXYNOS_OMX_TOP)/osal/Android.mk
+include $(EXYNOS_OMX_TOP)/osal/test/Android.mk
 include $(EXYNOS_OMX_TOP)/core/Android.mk
 
 include $(EXYNOS_OMX_COMPONENT)/common/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/dec/Android.mk
+include $(EXYNOS_OMX_COMPONENT)/video/dec/test/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/dec/h264/Android.mk
 include $(EXYNOS_OMX_COMPONENT)/video/dec/mpeg4/Android.mk
 ifeq ($(TARGET_BOARD_PLATFORM),exynos5)
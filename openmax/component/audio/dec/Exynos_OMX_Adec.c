@@ -101,6 +101,7 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = temp_bufferHeader;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ASSIGNED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(temp_bufferHeader, OMX_BUFFERHEADERTYPE);
             temp_bufferHeader->pBuffer        = pBuffer;
@@ -200,6 +201,7 @@ OMX_ERRORTYPE Exynos_OMX_AllocateBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = temp_bufferHeader;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ALLOCATED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(temp_bufferHeader, OMX_BUFFERHEADERTYPE);
             temp_bufferHeader->pBuffer        = temp_buffer;
@@ -402,6 +404,7 @@ OMX_ERRORTYPE Exynos_InputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
         }
 
         bufferHeader->nFilledLen = 0;
+        Exynos_OMX_ClearBufferInOMX(exynosOMXInputPort, bufferHeader);
         pExynosComponent->pCallbacks->EmptyBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
     }
 
@@ -460,7 +463,7 @@ OMX_ERRORTYPE Exynos_InputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompon
             dataBuffer->nFlags = dataBuffer->bufferHeader->nFlags;
             dataBuffer->timeStamp = dataBuffer->bufferHeader->nTimeStamp;
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
 
             if (dataBuffer->allocSize <= dataBuffer->dataLen)
                 Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "Input Buffer Full, Check input buffer size! allocSize:%d, dataLen:%d", dataBuffer->allocSize, dataBuffer->dataLen);
@@ -506,6 +509,7 @@ OMX_ERRORTYPE Exynos_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
                             bufferHeader->nFlags, NULL);
         }
 
+        Exynos_OMX_ClearBufferInOMX(exynosOMXOutputPort, bufferHeader);
         pExynosComponent->pCallbacks->FillBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
     }
 
@@ -567,7 +571,7 @@ OMX_ERRORTYPE Exynos_OutputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompo
             pExynosPort->processData.multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE] = dataBuffer->bufferHeader->pBuffer;
             pExynosPort->processData.allocSize = dataBuffer->bufferHeader->nAllocLen;
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
         }
         Exynos_OSAL_MutexUnlock(dataBuffer->bufferMutex);
         ret = OMX_ErrorNone;
@@ -886,12 +890,14 @@ OMX_ERRORTYPE Exynos_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 por
             bufferHeader->nFilledLen = 0;
 
             if (portIndex == OUTPUT_PORT_INDEX) {
+                Exynos_OMX_ClearBufferInOMX(pExynosPort, bufferHeader);
                 pExynosComponent->pCallbacks->FillBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
             } else {
+                Exynos_OMX_ClearBufferInOMX(pExynosPort, bufferHeader);
                 pExynosComponent->pCallbacks->EmptyBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
             }
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
             message = NULL;
         }
     }
@@ -1373,14 +1379,17 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Create(OMX_HANDLETYPE hComponent)
     OMX_COMPONENTTYPE     *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OSAL_THREAD_ATTR  threadAttr;
 
     FunctionIn();
 
     pAudioDec->bExitBufferProcessThread = OMX_FALSE;
 
-    ret = Exynos_OSAL_ThreadCreate(&pAudioDec->hBufferProcessThread,
+    Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_BUFFER_PROCESS, &threadAttr);
+    ret = Exynos_OSAL_ThreadCreateWithAttr(&pAudioDec->hBufferProcessThread,
                  Exynos_OMX_BufferProcessThread,
-                 pOMXComponent);
+                 pOMXComponent,
+                 &threadAttr);
 
 EXIT:
     FunctionOut();
@@ -100,6 +100,7 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = temp_bufferHeader;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ASSIGNED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(temp_bufferHeader, OMX_BUFFERHEADERTYPE);
             temp_bufferHeader->pBuffer        = pBuffer;
@@ -199,6 +200,7 @@ OMX_ERRORTYPE Exynos_OMX_AllocateBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = temp_bufferHeader;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ALLOCATED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(temp_bufferHeader, OMX_BUFFERHEADERTYPE);
             temp_bufferHeader->pBuffer        = temp_buffer;
@@ -401,13 +403,14 @@ OMX_ERRORTYPE Exynos_InputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
         }
 
         bufferHeader->nFilledLen = 0;
+        Exynos_OMX_ClearBufferInOMX(exynosOMXInputPort, bufferHeader);
         pExynosComponent->pCallbacks->EmptyBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
     }
 
     if ((pExynosComponent->currentState == OMX_StatePause) &&
         ((!CHECK_PORT_BEING_FLUSHED(exynosOMXInputPort) && !CHECK_PORT_BEING_FLUSHED(exynosOMXOutputPort)))) {
-        Exynos_OSAL_SignalWait(pExynosComponent->pauseEvent, DEF_MAX_WAIT_TIME);
-        Exynos_OSAL_SignalReset(pExynosComponent->pauseEvent);
+        Exynos_OSAL_SignalWait(exynosOMXInputPort->pauseEvent, DEF_MAX_WAIT_TIME);
+        Exynos_OSAL_SignalReset(exynosOMXInputPort->pauseEvent);
     }
 
     dataBuffer->dataValid     = OMX_FALSE;
@@ -459,7 +462,7 @@ OMX_ERRORTYPE Exynos_InputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompon
             dataBuffer->nFlags = dataBuffer->bufferHeader->nFlags;
             dataBuffer->timeStamp = dataBuffer->bufferHeader->nTimeStamp;
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
 
             if (dataBuffer->allocSize <= dataBuffer->dataLen)
                 Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "Input Buffer Full, Check input buffer size! allocSize:%d, dataLen:%d", dataBuffer->allocSize, dataBuffer->dataLen);
@@ -505,13 +508,14 @@ OMX_ERRORTYPE Exynos_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
                             bufferHeader->nFlags, NULL);
         }
 
+        Exynos_OMX_ClearBufferInOMX(exynosOMXOutputPort, bufferHeader);
         pExynosComponent->pCallbacks->FillBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
     }
 
     if ((pExynosComponent->currentState == OMX_StatePause) &&
         ((!CHECK_PORT_BEING_FLUSHED(exynosOMXInputPort) && !CHECK_PORT_BEING_FLUSHED(exynosOMXOutputPort)))) {
-        Exynos_OSAL_SignalWait(pExynosComponent->pauseEvent, DEF_MAX_WAIT_TIME);
-        Exynos_OSAL_SignalReset(pExynosComponent->pauseEvent);
+        Exynos_OSAL_SignalWait(exynosOMXOutputPort->pauseEvent, DEF_MAX_WAIT_TIME);
+        Exynos_OSAL_SignalReset(exynosOMXOutputPort->pauseEvent);
     }
 
     /* reset dataBuffer */
@@ -566,7 +570,7 @@ OMX_ERRORTYPE Exynos_OutputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompo
             pExynosPort->processData.multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE] = dataBuffer->bufferHeader->pBuffer;
             pExynosPort->processData.allocSize = dataBuffer->bufferHeader->nAllocLen;
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
         }
         Exynos_OSAL_MutexUnlock(dataBuffer->bufferMutex);
         ret = OMX_ErrorNone;
@@ -759,40 +763,245 @@ EXIT:
     return ret;
 }
 
-OMX_ERRORTYPE Exynos_OMX_BufferProcess(OMX_HANDLETYPE hComponent)
+OMX_U32 Exynos_Seiren_RecvPCM(u32 hSeirenHandle, audio_mem_info_t *pOutputMemPool, EXYNOS_OMX_DATA *pOutputData)
+{
+    audio_mem_info_t pcm_mem_info = *pOutputMemPool;
+    OMX_U8          *pOutputBuffer = pOutputData->multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE];
+    OMX_U32          pcmSize = 0;
+
+    FunctionIn();
+
+    pOutputData->dataLen = 0;
+
+    if ((pOutputBuffer != NULL) && (pOutputData->allocSize >= pOutputMemPool->mem_size)) {
+        /* zero-copy: Seiren writes PCM straight into the OMX output buffer */
+        pcm_mem_info.virt_addr = pOutputBuffer;
+        ADec_RecvPCM(hSeirenHandle, &pcm_mem_info);
+        if ((OMX_S32)pcm_mem_info.data_size > 0)
+            pcmSize = pcm_mem_info.data_size;
+    } else {
+        /* output buffer can not hold a whole pool block, bounce through the pool */
+        ADec_RecvPCM(hSeirenHandle, &pcm_mem_info);
+        if ((OMX_S32)pcm_mem_info.data_size > 0) {
+            pcmSize = pcm_mem_info.data_size;
+            if (pcmSize > pOutputData->allocSize) {
+                Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "PCM(%d) is larger than output buffer(%d)", pcmSize, pOutputData->allocSize);
+                pcmSize = pOutputData->allocSize;
+            }
+            if (pOutputBuffer != NULL)
+                Exynos_OSAL_Memcpy(pOutputBuffer, pcm_mem_info.virt_addr, pcmSize);
+            else
+                pcmSize = 0;
+        }
+    }
+
+    pOutputData->dataLen = pcmSize;
+
+    FunctionOut();
+
+    return pcmSize;
+}
+
+static void Exynos_Wait_ProcessPause(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nPortIndex)
+{
+    EXYNOS_OMX_BASEPORT *exynosOMXInputPort  = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+    EXYNOS_OMX_BASEPORT *exynosOMXOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+
+    FunctionIn();
+
+    if (((pExynosComponent->currentState == OMX_StatePause) ||
+        (pExynosComponent->currentState == OMX_StateIdle) ||
+        (pExynosComponent->transientState == EXYNOS_OMX_TransStateLoadedToIdle) ||
+        (pExynosComponent->transientState == EXYNOS_OMX_TransStateExecutingToIdle)) &&
+        (pExynosComponent->transientState != EXYNOS_OMX_TransStateIdleToLoaded) &&
+        ((!CHECK_PORT_BEING_FLUSHED(exynosOMXInputPort) && !CHECK_PORT_BEING_FLUSHED(exynosOMXOutputPort)))) {
+        Exynos_OSAL_SignalWait(pExynosComponent->pExynosPort[nPortIndex].pauseEvent, DEF_MAX_WAIT_TIME);
+        Exynos_OSAL_SignalReset(pExynosComponent->pExynosPort[nPortIndex].pauseEvent);
+    }
+
+    FunctionOut();
+
+    return;
+}
+
+/*
+ * Seiren returns PCM in the order the stream was sent, so every buffer that
+ * decodes to PCM queues its timestamp and every PCM buffer takes the oldest
+ * one. Codec config and EOS-only buffers only wake the PCM thread.
+ */
+static void Exynos_Seiren_StreamSent(EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec, OMX_TICKS timeStamp, OMX_U32 nFlags, OMX_U32 dataLen)
+{
+    SEIREN_SUBMIT_INFO *pSubmit = NULL;
+
+    Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+
+    if ((dataLen > 0) && !(nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+        if (pAudioDec->nSubmitCount == SEIREN_SUBMIT_QUEUE_NUM) {
+            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "%s: submit queue full, dropping %lld", __FUNCTION__,
+                            pAudioDec->submitQueue[pAudioDec->nSubmitHead].timeStamp);
+            pAudioDec->nSubmitHead = (pAudioDec->nSubmitHead + 1) % SEIREN_SUBMIT_QUEUE_NUM;
+            pAudioDec->nSubmitCount--;
+        }
+        pSubmit = &pAudioDec->submitQueue[(pAudioDec->nSubmitHead + pAudioDec->nSubmitCount) % SEIREN_SUBMIT_QUEUE_NUM];
+        pSubmit->timeStamp = timeStamp;
+        pSubmit->nFlags = nFlags & (~OMX_BUFFERFLAG_EOS);
+        pAudioDec->nSubmitCount++;
+    }
+
+    if (nFlags & OMX_BUFFERFLAG_EOS)
+        pAudioDec->bEOSDraining = OMX_TRUE;
+    pAudioDec->nStreamSent++;
+
+    Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+
+    Exynos_OSAL_SignalSet(pAudioDec->hStreamEvent);
+}
+
+static void Exynos_Seiren_TakeSubmit(EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec, EXYNOS_OMX_DATA *pOutputData)
+{
+    OMX_U32 nEOS = pOutputData->nFlags & OMX_BUFFERFLAG_EOS;
+
+    Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+
+    if ((pOutputData->dataLen > 0) && (pAudioDec->nSubmitCount > 0)) {
+        pAudioDec->lastSubmit = pAudioDec->submitQueue[pAudioDec->nSubmitHead];
+        pAudioDec->nSubmitHead = (pAudioDec->nSubmitHead + 1) % SEIREN_SUBMIT_QUEUE_NUM;
+        pAudioDec->nSubmitCount--;
+    }
+
+    pOutputData->timeStamp = pAudioDec->lastSubmit.timeStamp;
+    pOutputData->nFlags = pAudioDec->lastSubmit.nFlags | nEOS;
+
+    if (nEOS) {
+        /* everything sent before the EOS is out */
+        pAudioDec->nSubmitCount = 0;
+        pAudioDec->bEOSDraining = OMX_FALSE;
+    }
+
+    Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+}
+
+static void Exynos_Seiren_ResetSubmit(EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec)
+{
+    Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+    pAudioDec->nSubmitHead = 0;
+    pAudioDec->nSubmitCount = 0;
+    pAudioDec->lastSubmit.timeStamp = 0;
+    pAudioDec->lastSubmit.nFlags = 0;
+    pAudioDec->bEOSDraining = OMX_FALSE;
+    Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+}
+
+/*
+ * Block until more stream is sent. The event is reset before the checks, so
+ * a send, flush or exit that races with them still wakes the wait. Seiren
+ * has no event for the end of an EOS drain, its status is polled instead.
+ */
+static void Exynos_Seiren_WaitStream(EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec)
+{
+    OMX_U32  nWaitTime = DEF_MAX_WAIT_TIME;
+    OMX_BOOL bWait = OMX_FALSE;
+
+    Exynos_OSAL_SignalReset(pAudioDec->hStreamEvent);
+
+    Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+    if ((pAudioDec->nStreamSeen == pAudioDec->nStreamSent) &&
+        (pAudioDec->bExitBufferProcessThread == OMX_FALSE))
+        bWait = OMX_TRUE;
+    if (pAudioDec->bEOSDraining == OMX_TRUE)
+        nWaitTime = SEIREN_RETRY_WAIT_TIME;
+    Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+
+    if (bWait == OMX_TRUE)
+        Exynos_OSAL_SignalWait(pAudioDec->hStreamEvent, nWaitTime);
+}
+
+OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
 {
     OMX_ERRORTYPE             ret = OMX_ErrorNone;
     OMX_COMPONENTTYPE        *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
     EXYNOS_OMX_BASEPORT      *exynosInputPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
-    EXYNOS_OMX_BASEPORT      *exynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
     EXYNOS_OMX_DATABUFFER    *inputUseBuffer = &exynosInputPort->way.port1WayDataBuffer.dataBuffer;
-    EXYNOS_OMX_DATABUFFER    *outputUseBuffer = &exynosOutputPort->way.port1WayDataBuffer.dataBuffer;
     EXYNOS_OMX_DATA          *inputData = &exynosInputPort->processData;
-    EXYNOS_OMX_DATA          *outputData = &exynosOutputPort->processData;
-    OMX_U32                   copySize = 0;
+    OMX_TICKS                 submitTimeStamp = 0;
+    OMX_U32                   submitFlags = 0;
+    OMX_U32                   submitLen = 0;
+    OMX_BOOL                  bDraining = OMX_FALSE;
 
     pExynosComponent->reInputData = OMX_FALSE;
 
     FunctionIn();
 
     while (!pAudioDec->bExitBufferProcessThread) {
-        Exynos_OSAL_SleepMillisec(0);
-
-        if (((pExynosComponent->currentState == OMX_StatePause) ||
-            (pExynosComponent->currentState == OMX_StateIdle) ||
-            (pExynosComponent->transientState == EXYNOS_OMX_TransStateLoadedToIdle) ||
-            (pExynosComponent->transientState == EXYNOS_OMX_TransStateExecutingToIdle)) &&
-            (pExynosComponent->transientState != EXYNOS_OMX_TransStateIdleToLoaded)&&
-            ((!CHECK_PORT_BEING_FLUSHED(exynosInputPort) && !CHECK_PORT_BEING_FLUSHED(exynosOutputPort)))) {
-            Exynos_OSAL_SignalWait(pExynosComponent->pauseEvent, DEF_MAX_WAIT_TIME);
-            Exynos_OSAL_SignalReset(pExynosComponent->pauseEvent);
-        }
+        Exynos_Wait_ProcessPause(pExynosComponent, INPUT_PORT_INDEX);
 
         while ((Exynos_Check_BufferProcess_State(pExynosComponent)) && (!pAudioDec->bExitBufferProcessThread)) {
-            Exynos_OSAL_SleepMillisec(0);
+            if (pExynosComponent->reInputData == OMX_FALSE) {
+                Exynos_OSAL_MutexLock(inputUseBuffer->bufferMutex);
+                if ((Exynos_Preprocessor_InputData(pOMXComponent) == OMX_FALSE) &&
+                    (!CHECK_PORT_BEING_FLUSHED(exynosInputPort))) {
+                        Exynos_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
+                        ret = Exynos_InputBufferGetQueue(pExynosComponent);
+                        break;
+                }
 
+                Exynos_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
+            }
+
+            Exynos_OSAL_MutexLock(inputUseBuffer->bufferMutex);
+            submitTimeStamp = inputData->timeStamp;
+            submitFlags = inputData->nFlags;
+            submitLen = inputData->dataLen;
+            ret = pAudioDec->exynos_codec_srcInputProcess(pOMXComponent, inputData);
+            Exynos_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
+
+            if (ret == (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet) {
+                /* hold this frame back until the previous EOS is drained */
+                pExynosComponent->reInputData = OMX_TRUE;
+                Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+                bDraining = pAudioDec->bEOSDraining;
+                Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+                /* otherwise a port is being reconfigured, nothing signals its end */
+                Exynos_OSAL_SignalWait(pAudioDec->hDrainEvent,
+                    (bDraining == OMX_TRUE) ? DEF_MAX_WAIT_TIME : SEIREN_RETRY_WAIT_TIME);
+                Exynos_OSAL_SignalReset(pAudioDec->hDrainEvent);
+                continue;
+            }
+
+            pExynosComponent->reInputData = OMX_FALSE;
+            if (ret == OMX_ErrorNone)
+                Exynos_Seiren_StreamSent(pAudioDec, submitTimeStamp, submitFlags, submitLen);
+        }
+    }
+
+EXIT:
+
+    FunctionOut();
+
+    return ret;
+}
+
+OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent)
+{
+    OMX_ERRORTYPE             ret = OMX_ErrorNone;
+    OMX_COMPONENTTYPE        *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_BASEPORT      *exynosInputPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+    EXYNOS_OMX_BASEPORT      *exynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+    EXYNOS_OMX_DATABUFFER    *outputUseBuffer = &exynosOutputPort->way.port1WayDataBuffer.dataBuffer;
+    EXYNOS_OMX_DATA          *outputData = &exynosOutputPort->processData;
+    OMX_BOOL                  bPCMReturned = OMX_FALSE;
+    OMX_BOOL                  bEOSReturned = OMX_FALSE;
+
+    FunctionIn();
+
+    while (!pAudioDec->bExitBufferProcessThread) {
+        Exynos_Wait_ProcessPause(pExynosComponent, OUTPUT_PORT_INDEX);
+
+        while ((Exynos_Check_BufferProcess_State(pExynosComponent)) && (!pAudioDec->bExitBufferProcessThread)) {
             Exynos_OSAL_MutexLock(outputUseBuffer->bufferMutex);
             if ((outputUseBuffer->dataValid != OMX_TRUE) &&
                 (!CHECK_PORT_BEING_FLUSHED(exynosOutputPort))) {
@@ -807,32 +1016,33 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess(OMX_HANDLETYPE hComponent)
                 Exynos_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
             }
 
-            if (pExynosComponent->reInputData == OMX_FALSE) {
-                Exynos_OSAL_MutexLock(inputUseBuffer->bufferMutex);
-                if ((Exynos_Preprocessor_InputData(pOMXComponent) == OMX_FALSE) &&
-                    (!CHECK_PORT_BEING_FLUSHED(exynosInputPort))) {
-                        Exynos_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
-                        ret = Exynos_InputBufferGetQueue(pExynosComponent);
-                        break;
-                }
-
-                Exynos_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
+            Exynos_OSAL_MutexLock(outputUseBuffer->bufferMutex);
+            if (outputUseBuffer->dataValid != OMX_TRUE) {
+                /* being flushed, there is no buffer to receive PCM into */
+                Exynos_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
+                break;
             }
 
-            Exynos_OSAL_MutexLock(inputUseBuffer->bufferMutex);
-            Exynos_OSAL_MutexLock(outputUseBuffer->bufferMutex);
-            ret = pAudioDec->exynos_codec_bufferProcess(pOMXComponent, inputData, outputData);
-            Exynos_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
-            Exynos_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
+            Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+            pAudioDec->nStreamSeen = pAudioDec->nStreamSent;
+            Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
 
-            if (ret == (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet)
-                pExynosComponent->reInputData = OMX_TRUE;
-            else
-                pExynosComponent->reInputData = OMX_FALSE;
+            outputData->timeStamp = 0;
+            outputData->nFlags = 0;
+            ret = pAudioDec->exynos_codec_dstOutputProcess(pOMXComponent, outputData);
+            Exynos_Seiren_TakeSubmit(pAudioDec, outputData);
+
+            bEOSReturned = (outputData->nFlags & OMX_BUFFERFLAG_EOS) ? OMX_TRUE : OMX_FALSE;
+            bPCMReturned = ((outputData->dataLen > 0) || (bEOSReturned == OMX_TRUE)) ? OMX_TRUE : OMX_FALSE;
 
-            Exynos_OSAL_MutexLock(outputUseBuffer->bufferMutex);
             Exynos_Postprocess_OutputData(pOMXComponent);
             Exynos_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
+
+            if (bEOSReturned == OMX_TRUE)
+                Exynos_OSAL_SignalSet(pAudioDec->hDrainEvent);
+
+            if (bPCMReturned == OMX_FALSE)
+                Exynos_Seiren_WaitStream(pAudioDec);
         }
     }
 
@@ -889,12 +1099,14 @@ OMX_ERRORTYPE Exynos_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 por
             bufferHeader->nFilledLen = 0;
 
             if (portIndex == OUTPUT_PORT_INDEX) {
+                Exynos_OMX_ClearBufferInOMX(pExynosPort, bufferHeader);
                 pExynosComponent->pCallbacks->FillBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
             } else {
+                Exynos_OMX_ClearBufferInOMX(pExynosPort, bufferHeader);
                 pExynosComponent->pCallbacks->EmptyBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
             }
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
             message = NULL;
         }
     }
@@ -957,7 +1169,7 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
     pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
 
-    Exynos_OSAL_SignalSet(pExynosComponent->pauseEvent);
+    Exynos_OSAL_SignalSet(pExynosComponent->pExynosPort[nPortIndex].pauseEvent);
 
     pExynosPort = &pExynosComponent->pExynosPort[nPortIndex];
     Exynos_OMX_GetFlushBuffer(pExynosPort, &flushPortBuffer);
@@ -970,7 +1182,7 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
 
     if (bEvent == OMX_TRUE && ret == OMX_ErrorNone) {
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "bEVENT!!!!!!OMX_FLUSH_SEIREN");
-        pAudioDec->exynos_codec_flushSeiren(pOMXComponent, nPortIndex);
+        pAudioDec->exynos_codec_flushSeiren(pOMXComponent, (nPortIndex == INPUT_PORT_INDEX) ? PORT_IN : PORT_OUT);
         pExynosComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
                             pExynosComponent->callbackData,
                             OMX_EventCmdComplete,
@@ -985,7 +1197,10 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
         pExynosComponent->getAllDelayBuffer = OMX_FALSE;
         pExynosComponent->bSaveFlagEOS = OMX_FALSE;
         pExynosComponent->reInputData = OMX_FALSE;
+        Exynos_Seiren_ResetSubmit(pAudioDec);
+        Exynos_OSAL_SignalSet(pAudioDec->hDrainEvent);
     }
+    Exynos_OSAL_SignalSet(pAudioDec->hStreamEvent);
 
 EXIT:
     if ((ret != OMX_ErrorNone) && (pOMXComponent != NULL) && (pExynosComponent != NULL)) {
@@ -1341,12 +1556,10 @@ EXIT:
     return ret;
 }
 
-static OMX_ERRORTYPE Exynos_OMX_BufferProcessThread(OMX_PTR threadData)
+static OMX_ERRORTYPE Exynos_OMX_SrcInputProcessThread(OMX_PTR threadData)
 {
     OMX_ERRORTYPE          ret = OMX_ErrorNone;
     OMX_COMPONENTTYPE     *pOMXComponent = NULL;
-    EXYNOS_OMX_BASECOMPONENT *pSECComponent = NULL;
-    EXYNOS_OMX_MESSAGE       *message = NULL;
 
     FunctionIn();
 
@@ -1359,8 +1572,33 @@ static OMX_ERRORTYPE Exynos_OMX_BufferProcessThread(OMX_PTR threadData)
     if (ret != OMX_ErrorNone) {
         goto EXIT;
     }
-    pSECComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
-    Exynos_OMX_BufferProcess(pOMXComponent);
+    Exynos_OMX_SrcInputBufferProcess(pOMXComponent);
+
+    Exynos_OSAL_ThreadExit(NULL);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
+static OMX_ERRORTYPE Exynos_OMX_DstOutputProcessThread(OMX_PTR threadData)
+{
+    OMX_ERRORTYPE          ret = OMX_ErrorNone;
+    OMX_COMPONENTTYPE     *pOMXComponent = NULL;
+
+    FunctionIn();
+
+    if (threadData == NULL) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+    pOMXComponent = (OMX_COMPONENTTYPE *)threadData;
+    ret = Exynos_OMX_Check_SizeVersion(pOMXComponent, sizeof(OMX_COMPONENTTYPE));
+    if (ret != OMX_ErrorNone) {
+        goto EXIT;
+    }
+    Exynos_OMX_DstOutputBufferProcess(pOMXComponent);
 
     Exynos_OSAL_ThreadExit(NULL);
 
@@ -1376,14 +1614,29 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Create(OMX_HANDLETYPE hComponent)
     OMX_COMPONENTTYPE     *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OSAL_THREAD_ATTR  threadAttr;
 
     FunctionIn();
 
     pAudioDec->bExitBufferProcessThread = OMX_FALSE;
-
-    ret = Exynos_OSAL_ThreadCreate(&pAudioDec->hBufferProcessThread,
-                 Exynos_OMX_BufferProcessThread,
-                 pOMXComponent);
+    Exynos_Seiren_ResetSubmit(pAudioDec);
+    pAudioDec->nStreamSent = 0;
+    pAudioDec->nStreamSeen = 0;
+    Exynos_OSAL_SignalReset(pAudioDec->hStreamEvent);
+    Exynos_OSAL_SignalReset(pAudioDec->hDrainEvent);
+
+    Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_DST_OUTPUT, &threadAttr);
+    ret = Exynos_OSAL_ThreadCreateWithAttr(&pAudioDec->hDstOutputThread,
+                 Exynos_OMX_DstOutputProcessThread,
+                 pOMXComponent,
+                 &threadAttr);
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_SRC_INPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pAudioDec->hSrcInputThread,
+                     Exynos_OMX_SrcInputProcessThread,
+                     pOMXComponent,
+                     &threadAttr);
+    }
 
 EXIT:
     FunctionOut();
@@ -1398,21 +1651,26 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Terminate(OMX_HANDLETYPE hComponent)
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
     OMX_S32                countValue = 0;
-    unsigned int           i = 0;
 
     FunctionIn();
 
     pAudioDec->bExitBufferProcessThread = OMX_TRUE;
 
-    for (i = 0; i < ALL_PORT_NUM; i++) {
-        Exynos_OSAL_Get_SemaphoreCount(pExynosComponent->pExynosPort[i].bufferSemID, &countValue);
-        if (countValue == 0)
-            Exynos_OSAL_SemaphorePost(pExynosComponent->pExynosPort[i].bufferSemID);
-    }
-
-    Exynos_OSAL_SignalSet(pExynosComponent->pauseEvent);
-    Exynos_OSAL_ThreadTerminate(pAudioDec->hBufferProcessThread);
-    pAudioDec->hBufferProcessThread = NULL;
+    Exynos_OSAL_Get_SemaphoreCount(pExynosComponent->pExynosPort[INPUT_PORT_INDEX].bufferSemID, &countValue);
+    if (countValue == 0)
+        Exynos_OSAL_SemaphorePost(pExynosComponent->pExynosPort[INPUT_PORT_INDEX].bufferSemID);
+    Exynos_OSAL_SignalSet(pExynosComponent->pExynosPort[INPUT_PORT_INDEX].pauseEvent);
+    Exynos_OSAL_SignalSet(pAudioDec->hDrainEvent);
+    Exynos_OSAL_ThreadTerminate(pAudioDec->hSrcInputThread);
+    pAudioDec->hSrcInputThread = NULL;
+
+    Exynos_OSAL_Get_SemaphoreCount(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].bufferSemID, &countValue);
+    if (countValue == 0)
+        Exynos_OSAL_SemaphorePost(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].bufferSemID);
+    Exynos_OSAL_SignalSet(pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX].pauseEvent);
+    Exynos_OSAL_SignalSet(pAudioDec->hStreamEvent);
+    Exynos_OSAL_ThreadTerminate(pAudioDec->hDstOutputThread);
+    pAudioDec->hDstOutputThread = NULL;
 
 EXIT:
     FunctionOut();
@@ -1465,9 +1723,21 @@ OMX_ERRORTYPE Exynos_OMX_AudioDecodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
     }
 
     Exynos_OSAL_Memset(pAudioDec, 0, sizeof(EXYNOS_OMX_AUDIODEC_COMPONENT));
+    if ((Exynos_OSAL_MutexCreate(&pAudioDec->hSeirenMutex) != OMX_ErrorNone) ||
+        (Exynos_OSAL_SignalCreate(&pAudioDec->hStreamEvent) != OMX_ErrorNone) ||
+        (Exynos_OSAL_SignalCreate(&pAudioDec->hDrainEvent) != OMX_ErrorNone)) {
+        Exynos_OSAL_SignalTerminate(pAudioDec->hStreamEvent);
+        Exynos_OSAL_MutexTerminate(pAudioDec->hSeirenMutex);
+        Exynos_OSAL_Free(pAudioDec);
+        Exynos_OMX_BaseComponent_Destructor(pOMXComponent);
+        ret = OMX_ErrorInsufficientResources;
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "OMX_ErrorInsufficientResources, Line:%d", __LINE__);
+        goto EXIT;
+    }
+
     pExynosComponent->hComponentHandle = (OMX_HANDLETYPE)pAudioDec;
     pExynosComponent->bSaveFlagEOS = OMX_FALSE;
-    pExynosComponent->bMultiThreadProcess = OMX_FALSE;
+    pExynosComponent->bMultiThreadProcess = OMX_TRUE;
 
     /* Input port */
     pExynosPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
@@ -1541,6 +1811,9 @@ OMX_ERRORTYPE Exynos_OMX_AudioDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hCompo
     pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
 
     pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    Exynos_OSAL_SignalTerminate(pAudioDec->hDrainEvent);
+    Exynos_OSAL_SignalTerminate(pAudioDec->hStreamEvent);
+    Exynos_OSAL_MutexTerminate(pAudioDec->hSeirenMutex);
     Exynos_OSAL_Free(pAudioDec);
     pExynosComponent->hComponentHandle = pAudioDec = NULL;
 
@@ -50,6 +50,21 @@
 
 #define AUDIO_DATA_PLANE                    0
 
+/*
+ * Retry period where neither Seiren nor the port code has an event to wait
+ * on: the EOS drain status, and an EOS held back while a port is disabled.
+ */
+#define SEIREN_RETRY_WAIT_TIME              10
+
+/* stream buffers sent to Seiren whose PCM has not come back yet */
+#define SEIREN_SUBMIT_QUEUE_NUM             32
+
+typedef struct _SEIREN_SUBMIT_INFO
+{
+    OMX_TICKS timeStamp;
+    OMX_U32   nFlags;
+} SEIREN_SUBMIT_INFO;
+
 typedef struct _SRP_DEC_INPUT_BUFFER
 {
     void *PhyAddr;      // physical address
@@ -69,9 +84,23 @@ typedef struct _EXYNOS_OMX_AUDIODEC_COMPONENT
 
     /* Buffer Process */
     OMX_BOOL       bExitBufferProcessThread;
-    OMX_HANDLETYPE hBufferProcessThread;
-
-    OMX_ERRORTYPE (*exynos_codec_bufferProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData, EXYNOS_OMX_DATA *pOutputData);
+    OMX_HANDLETYPE hSrcInputThread;
+    OMX_HANDLETYPE hDstOutputThread;
+
+    /* Pipeline between stream submission and PCM retrieval */
+    OMX_HANDLETYPE hSeirenMutex;    /* guards the codec state shared by both threads */
+    OMX_HANDLETYPE hStreamEvent;    /* stream or EOS was sent to Seiren */
+    OMX_HANDLETYPE hDrainEvent;     /* EOS was drained out of Seiren */
+    SEIREN_SUBMIT_INFO submitQueue[SEIREN_SUBMIT_QUEUE_NUM];   /* FIFO, one per PCM buffer owed */
+    OMX_U32        nSubmitHead;
+    OMX_U32        nSubmitCount;
+    SEIREN_SUBMIT_INFO lastSubmit;  /* given to PCM that outruns the queue */
+    OMX_U32        nStreamSent;     /* buffers sent to Seiren */
+    OMX_U32        nStreamSeen;     /* nStreamSent before the PCM thread's last read */
+    OMX_BOOL       bEOSDraining;
+
+    OMX_ERRORTYPE (*exynos_codec_srcInputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData);
+    OMX_ERRORTYPE (*exynos_codec_dstOutputProcess) (OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pOutputData);
     OMX_ERRORTYPE (*exynos_codec_flushSeiren) (OMX_COMPONENTTYPE *pOMXComponent, SEIREN_PORTTYPE type);
 
     int (*exynos_checkInputFrame)(OMX_U8 *pInputStream, OMX_U32 buffSize, OMX_U32 flag, OMX_BOOL bPreviousFrameEOF, OMX_BOOL *pbEndOfFrame);
@@ -111,7 +140,8 @@ OMX_ERRORTYPE Exynos_OMX_ComponentTunnelRequest(
     OMX_IN OMX_HANDLETYPE  hTunneledComp,
     OMX_IN OMX_U32         nTunneledPort,
     OMX_INOUT OMX_TUNNELSETUPTYPE *pTunnelSetup);
-OMX_ERRORTYPE Exynos_OMX_BufferProcess(OMX_HANDLETYPE hComponent);
+OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent);
+OMX_ERRORTYPE Exynos_OMX_DstOutputBufferProcess(OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_AudioDecodeGetParameter(
     OMX_IN OMX_HANDLETYPE hComponent,
     OMX_IN OMX_INDEXTYPE  nParamIndex,
@@ -135,6 +165,7 @@ OMX_ERRORTYPE Exynos_OMX_AudioDecodeGetExtensionIndex(
 OMX_ERRORTYPE Exynos_OMX_AudioDecodeComponentInit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE Exynos_OMX_AudioDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_BOOL Exynos_Check_BufferProcess_State(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+OMX_U32 Exynos_Seiren_RecvPCM(u32 hSeirenHandle, audio_mem_info_t *pOutputMemPool, EXYNOS_OMX_DATA *pOutputData);
 
 #ifdef __cplusplus
 }
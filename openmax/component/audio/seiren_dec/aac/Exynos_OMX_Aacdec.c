@@ -34,6 +34,7 @@
 #include "Exynos_OMX_Adec.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
+#include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_Thread.h"
 #include "library_register.h"
 #include "Exynos_OMX_Aacdec.h"
@@ -490,169 +491,152 @@ EXIT:
     return ret;
 }
 
-OMX_ERRORTYPE Exynos_Seiren_Aac_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData, EXYNOS_OMX_DATA *pOutputData)
+OMX_ERRORTYPE Exynos_Seiren_Aac_Send_Stream(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData)
 {
     OMX_ERRORTYPE                  ret = OMX_ErrorNone;
     EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
     EXYNOS_AAC_HANDLE             *pAacDec = (EXYNOS_AAC_HANDLE *)pAudioDec->hCodecHandle;
     int                            returnCodec = 0;
-    unsigned long                  isSeirenStopped = 0;
-    OMX_BOOL                       isSeirenIbufOverflow = OMX_FALSE;
+    OMX_BOOL                       bSeirenSendEOS = OMX_FALSE;
+    unsigned char                 *pt = NULL;
 
     u32 fd = pAacDec->hSeirenAacHandle.hSeirenHandle;
     audio_mem_info_t input_mem_pool = pAacDec->hSeirenAacHandle.input_mem_pool;
-    audio_mem_info_t output_mem_pool = pAacDec->hSeirenAacHandle.output_mem_pool;
-    unsigned long sample_rate, channels;
     int consumed_size = 0;
-    sample_rate = channels = 0;
 
     FunctionIn();
 
-#ifdef Seiren_DUMP_TO_FILE
-    if (pExynosComponent->reInputData == OMX_FALSE) {
-        fwrite(pInputData->multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE], pInputData->dataLen, 1, inFile);
+    /* Hold new stream back until all the PCM of the previous EOS is returned */
+    Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+    bSeirenSendEOS = pAacDec->hSeirenAacHandle.bSeirenSendEOS;
+    Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+    if (bSeirenSendEOS == OMX_TRUE) {
+        ret = (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet;
+        goto EXIT;
     }
-#endif
 
-    /* Save timestamp and flags of input data */
-    pOutputData->timeStamp = pInputData->timeStamp;
-    pOutputData->nFlags = pInputData->nFlags & (~OMX_BUFFERFLAG_EOS);
+#ifdef Seiren_DUMP_TO_FILE
+    fwrite(pInputData->multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE], pInputData->dataLen, 1, inFile);
+#endif
 
     /* Decoding aac frames by Seiren */
-    if (pExynosComponent->getAllDelayBuffer == OMX_FALSE) {
-        input_mem_pool.data_size = pInputData->dataLen;
-        char* pt = input_mem_pool.virt_addr;
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "\e[1;33m %02X %02X %02X %02X %02X %02X %lld \e[0m", *pt,*(pt+1),*(pt+2),*(pt+3),*(pt+4), *(pt+5), pInputData->timeStamp);
-
-        if (pInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) {
-            ADec_ConfigSignal(fd);
-            unsigned char sample_rate_index = ((*(pt+1)) >> 7 & 0x01) |
-                                              ((*pt)     << 1 & 0x0e);
-            unsigned char num_of_channel = ((*(pt+1)) >> 3 & 0x07);
-            Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "index %x ", sample_rate_index);
-            ADec_SetParams(fd, PCM_PARAM_SAMPLE_RATE, aac_sample_rates[sample_rate_index]);
-            ADec_SetParams(fd, PCM_PARAM_NUM_OF_CH, num_of_channel);
-            ADec_SendStream(fd, &input_mem_pool, &consumed_size);
-            goto EXIT;
-        }
-        returnCodec = ADec_SendStream(fd, &input_mem_pool, &consumed_size);
+    input_mem_pool.data_size = pInputData->dataLen;
+    pt = (unsigned char*)input_mem_pool.virt_addr;
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "\e[1;33m %02X %02X %02X %02X %02X %02X %lld \e[0m", *pt,*(pt+1),*(pt+2),*(pt+3),*(pt+4), *(pt+5), pInputData->timeStamp);
 
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "ProcessedSize : %d    return : %d", consumed_size, returnCodec);
-        if (pInputData->nFlags & OMX_BUFFERFLAG_EOS)
-            Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "EOS!!");
-        if (returnCodec >= 0) {
-            if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-                ADec_SendEOS(fd);
-                pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_TRUE;
-            }
-        } else if (returnCodec < 0) {
-            ret = OMX_ErrorCodecDecode;
-            goto EXIT;
-        }
+    if (pInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) {
+        ADec_ConfigSignal(fd);
+        unsigned char sample_rate_index = ((*(pt+1)) >> 7 & 0x01) |
+                                          ((*pt)     << 1 & 0x0e);
+        unsigned char num_of_channel = ((*(pt+1)) >> 3 & 0x07);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "index %x ", sample_rate_index);
+        ADec_SetParams(fd, PCM_PARAM_SAMPLE_RATE, aac_sample_rates[sample_rate_index]);
+        ADec_SetParams(fd, PCM_PARAM_NUM_OF_CH, num_of_channel);
+        ADec_SendStream(fd, &input_mem_pool, &consumed_size);
+        goto EXIT;
     }
+    returnCodec = ADec_SendStream(fd, &input_mem_pool, &consumed_size);
 
-    if (pAacDec->hSeirenAacHandle.bConfiguredSeiren == OMX_FALSE) {
-        if ((pInputData->dataLen <= 0) && (pInputData->nFlags & OMX_BUFFERFLAG_EOS)) {
-            pOutputData->nFlags |= OMX_BUFFERFLAG_EOS;
-            pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_FALSE;
-            ret = OMX_ErrorNone;
-            goto EXIT;
-        }
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "ProcessedSize : %d    return : %d", consumed_size, returnCodec);
+    if (returnCodec < 0) {
+        ret = OMX_ErrorCodecDecode;
+        goto EXIT;
+    }
 
-        ADec_GetParams(fd, PCM_PARAM_SAMPLE_RATE, &sample_rate);
-        ADec_GetParams(fd, PCM_PARAM_NUM_OF_CH, &channels);
+    if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "EOS!!");
+        ADec_SendEOS(fd);
+        Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+        pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_TRUE;
+        Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+    }
 
-        if (returnCodec < 0) {
-            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "Seiren_ADec_GetParams failed: %d", returnCodec);
-            ret = OMX_ErrorHardware;
-            goto EXIT;
-        }
+EXIT:
+    FunctionOut();
 
-        if (!sample_rate || !channels) {
-            if (pAacDec->hSeirenAacHandle.bSeirenSendEOS == OMX_TRUE) {
-                pOutputData->dataLen = 0;
-                pExynosComponent->getAllDelayBuffer = OMX_TRUE;
-            } else {
-                pExynosComponent->getAllDelayBuffer = OMX_FALSE;
-            }
-            ret = OMX_ErrorNone;
-            goto EXIT;//
-        }
+    return ret;
+}
 
-        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "numChannels(%d), samplingRate(%d)",
-            channels, sample_rate);
-
-        if (pAacDec->pcmParam.nChannels != channels ||
-            pAacDec->pcmParam.nSamplingRate != sample_rate) {
-            /* Change channel count and sampling rate information */
-            pAacDec->pcmParam.nChannels = channels;
-            pAacDec->pcmParam.nSamplingRate = sample_rate;
-
-            /* Send Port Settings changed call back */
-            (*(pExynosComponent->pCallbacks->EventHandler))
-                  (pOMXComponent,
-                   pExynosComponent->callbackData,
-                   OMX_EventPortSettingsChanged, /* The command was completed */
-                   OMX_DirOutput, /* This is the port index */
-                   0,
-                   NULL);
-        }
+OMX_ERRORTYPE Exynos_Seiren_Aac_Recv_PCM(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pOutputData)
+{
+    OMX_ERRORTYPE                  ret = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_AUDIODEC_COMPONENT *pAudioDec = (EXYNOS_OMX_AUDIODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_AAC_HANDLE             *pAacDec = (EXYNOS_AAC_HANDLE *)pAudioDec->hCodecHandle;
+    int                            returnCodec = 0;
+    unsigned long                  isSeirenStopped = 0;
+    OMX_BOOL                       bSeirenSendEOS = OMX_FALSE;
+
+    u32 fd = pAacDec->hSeirenAacHandle.hSeirenHandle;
+    unsigned long sample_rate, channels;
+    sample_rate = channels = 0;
+
+    FunctionIn();
 
-        pAacDec->hSeirenAacHandle.bConfiguredSeiren = OMX_TRUE;
+    pOutputData->dataLen = 0;
 
-        if (pAacDec->hSeirenAacHandle.bSeirenSendEOS == OMX_TRUE) {
-            pOutputData->dataLen = 0;
-            pExynosComponent->getAllDelayBuffer = OMX_TRUE;
-            ret = OMX_ErrorInputDataDecodeYet;
-        } else {
-            pExynosComponent->getAllDelayBuffer = OMX_FALSE;
+    Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+    bSeirenSendEOS = pAacDec->hSeirenAacHandle.bSeirenSendEOS;
+    Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+
+    if (pAacDec->hSeirenAacHandle.bConfiguredSeiren == OMX_FALSE) {
+        ADec_GetParams(fd, PCM_PARAM_SAMPLE_RATE, &sample_rate);
+        ADec_GetParams(fd, PCM_PARAM_NUM_OF_CH, &channels);
+        if (sample_rate && channels) {
+            Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "numChannels(%d), samplingRate(%d)",
+                channels, sample_rate);
+
+            if (pAacDec->pcmParam.nChannels != channels ||
+                pAacDec->pcmParam.nSamplingRate != sample_rate) {
+                /* Change channel count and sampling rate information */
+                pAacDec->pcmParam.nChannels = channels;
+                pAacDec->pcmParam.nSamplingRate = sample_rate;
+
+                /* Send Port Settings changed call back */
+                (*(pExynosComponent->pCallbacks->EventHandler))
+                      (pOMXComponent,
+                       pExynosComponent->callbackData,
+                       OMX_EventPortSettingsChanged, /* The command was completed */
+                       OMX_DirOutput, /* This is the port index */
+                       0,
+                       NULL);
+            }
+
+            pAacDec->hSeirenAacHandle.bConfiguredSeiren = OMX_TRUE;
             ret = OMX_ErrorNone;
+            goto EXIT;
         }
-        goto EXIT;
-    }
-
-    /* Get decoded data from Seiren */
-    ADec_RecvPCM(fd, &output_mem_pool);
-    if (output_mem_pool.data_size > 0) {
-        pOutputData->dataLen = output_mem_pool.data_size;
-        Exynos_OSAL_Memcpy(pOutputData->multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE],
-                           output_mem_pool.virt_addr, output_mem_pool.data_size);
     } else {
-        pOutputData->dataLen = 0;
-    }
+        /* Get decoded data from Seiren */
+        Exynos_Seiren_RecvPCM(fd, &pAacDec->hSeirenAacHandle.output_mem_pool, pOutputData);
 
 #ifdef Seiren_DUMP_TO_FILE
-    if (pOutputData->dataLen > 0)
-        fwrite(pOutputData->multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE], pOutputData->dataLen, 1, outFile);
+        if (pOutputData->dataLen > 0)
+            fwrite(pOutputData->multiPlaneBuffer.dataBuffer[AUDIO_DATA_PLANE], pOutputData->dataLen, 1, outFile);
 #endif
+    }
 
     /* Delay EOS signal until all the PCM is returned from the Seiren driver. */
-    if (pAacDec->hSeirenAacHandle.bSeirenSendEOS == OMX_TRUE) {
-        if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-            returnCodec = ADec_GetParams(fd, ADEC_PARAM_GET_OUTPUT_STATUS, &isSeirenStopped);
-            if (returnCodec != 0)
-                Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "Fail Seiren_STOP_EOS_STATE");
-            if (isSeirenStopped == 1) {
-                pOutputData->nFlags |= OMX_BUFFERFLAG_EOS;
-                pExynosComponent->getAllDelayBuffer = OMX_FALSE;
-                pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_FALSE; /* for repeating one song */
-                ret = OMX_ErrorNone;
-            } else {
-                pExynosComponent->getAllDelayBuffer = OMX_TRUE;
-                ret = OMX_ErrorInputDataDecodeYet;
-            }
-        } else { /* Flush after EOS */
-            pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_FALSE;
+    if (bSeirenSendEOS == OMX_TRUE) {
+        returnCodec = ADec_GetParams(fd, ADEC_PARAM_GET_OUTPUT_STATUS, &isSeirenStopped);
+        if (returnCodec != 0)
+            Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "Fail Seiren_STOP_EOS_STATE");
+        if (isSeirenStopped == 1) {
+            pOutputData->nFlags |= OMX_BUFFERFLAG_EOS;
+            Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+            pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_FALSE; /* for repeating one song */
+            Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
         }
     }
+
 EXIT:
     FunctionOut();
 
     return ret;
 }
 
-OMX_ERRORTYPE Exynos_Seiren_AacDec_bufferProcess(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData, EXYNOS_OMX_DATA *pOutputData)
+OMX_ERRORTYPE Exynos_Seiren_AacDec_srcInputProcess(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pInputData)
 {
     OMX_ERRORTYPE             ret = OMX_ErrorNone;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
@@ -664,7 +648,7 @@ OMX_ERRORTYPE Exynos_Seiren_AacDec_bufferProcess(OMX_COMPONENTTYPE *pOMXComponen
     if ((!CHECK_PORT_ENABLED(pInputPort)) || (!CHECK_PORT_ENABLED(pOutputPort)) ||
             (!CHECK_PORT_POPULATED(pInputPort)) || (!CHECK_PORT_POPULATED(pOutputPort))) {
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS)
-            ret = OMX_ErrorInputDataDecodeYet;
+            ret = (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet;
         else
             ret = OMX_ErrorNone;
 
@@ -672,35 +656,68 @@ OMX_ERRORTYPE Exynos_Seiren_AacDec_bufferProcess(OMX_COMPONENTTYPE *pOMXComponen
     }
     if (OMX_FALSE == Exynos_Check_BufferProcess_State(pExynosComponent)) {
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS)
-            ret = OMX_ErrorInputDataDecodeYet;
+            ret = (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet;
         else
             ret = OMX_ErrorNone;
 
         goto EXIT;
     }
 
-    ret = Exynos_Seiren_Aac_Decode_Block(pOMXComponent, pInputData, pOutputData);
+    ret = Exynos_Seiren_Aac_Send_Stream(pOMXComponent, pInputData);
+
+    if (ret == (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet)
+        goto EXIT;
 
     if (ret != OMX_ErrorNone) {
-        if (ret == (OMX_ERRORTYPE)OMX_ErrorInputDataDecodeYet) {
-            pOutputData->usedDataLen = 0;
-            pOutputData->remainDataLen = pOutputData->dataLen;
-        } else {
-            pExynosComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
-                                                    pExynosComponent->callbackData,
-                                                    OMX_EventError, ret, 0, NULL);
-        }
-    } else {
-        pInputData->usedDataLen += pInputData->dataLen;
-        pInputData->remainDataLen = pInputData->dataLen - pInputData->usedDataLen;
-        pInputData->dataLen -= pInputData->usedDataLen;
-        pInputData->usedDataLen = 0;
+        pExynosComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
+                                                pExynosComponent->callbackData,
+                                                OMX_EventError, ret, 0, NULL);
+    }
+
+    pInputData->usedDataLen += pInputData->dataLen;
+    pInputData->remainDataLen = pInputData->dataLen - pInputData->usedDataLen;
+    pInputData->dataLen -= pInputData->usedDataLen;
+    pInputData->usedDataLen = 0;
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
 
-        pOutputData->usedDataLen = 0;
-        pOutputData->remainDataLen = pOutputData->dataLen;
+OMX_ERRORTYPE Exynos_Seiren_AacDec_dstOutputProcess(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pOutputData)
+{
+    OMX_ERRORTYPE             ret = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_BASEPORT      *pInputPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+    EXYNOS_OMX_BASEPORT      *pOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+
+    FunctionIn();
+
+    pOutputData->dataLen = 0;
+
+    if ((!CHECK_PORT_ENABLED(pInputPort)) || (!CHECK_PORT_ENABLED(pOutputPort)) ||
+            (!CHECK_PORT_POPULATED(pInputPort)) || (!CHECK_PORT_POPULATED(pOutputPort))) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+    if (OMX_FALSE == Exynos_Check_BufferProcess_State(pExynosComponent)) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
+    ret = Exynos_Seiren_Aac_Recv_PCM(pOMXComponent, pOutputData);
+
+    if (ret != OMX_ErrorNone) {
+        pExynosComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
+                                                pExynosComponent->callbackData,
+                                                OMX_EventError, ret, 0, NULL);
     }
 
 EXIT:
+    pOutputData->usedDataLen = 0;
+    pOutputData->remainDataLen = pOutputData->dataLen;
+
     FunctionOut();
 
     return ret;
@@ -714,6 +731,14 @@ OMX_ERRORTYPE Exynos_Seiren_AacDec_flushSeiren(OMX_COMPONENTTYPE *pOMXComponent,
     EXYNOS_AAC_HANDLE             *pAacDec = (EXYNOS_AAC_HANDLE *)pAudioDec->hCodecHandle;
 
     int fd = pAacDec->hSeirenAacHandle.hSeirenHandle;
+
+    if (type == PORT_IN) {
+        /* the stream behind a pending EOS is gone, do not wait for it to drain */
+        Exynos_OSAL_MutexLock(pAudioDec->hSeirenMutex);
+        pAacDec->hSeirenAacHandle.bSeirenSendEOS = OMX_FALSE;
+        Exynos_OSAL_MutexUnlock(pAudioDec->hSeirenMutex);
+    }
+
     return ADec_Flush(fd, type);
 }
 
@@ -884,7 +909,8 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
     /* ToDo: Change the function name associated with a specific codec */
     pExynosComponent->exynos_codec_componentInit      = &Exynos_Seiren_AacDec_Init;
     pExynosComponent->exynos_codec_componentTerminate = &Exynos_Seiren_AacDec_Terminate;
-    pAudioDec->exynos_codec_bufferProcess = &Exynos_Seiren_AacDec_bufferProcess;
+    pAudioDec->exynos_codec_srcInputProcess  = &Exynos_Seiren_AacDec_srcInputProcess;
+    pAudioDec->exynos_codec_dstOutputProcess = &Exynos_Seiren_AacDec_dstOutputProcess;
     pAudioDec->exynos_codec_flushSeiren = &Exynos_Seiren_AacDec_flushSeiren;
     pAudioDec->exynos_checkInputFrame = NULL;
 
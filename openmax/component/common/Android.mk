@@ -11,6 +11,14 @@ LOCAL_MODULE := libExynosOMX_Basecomponent
 
 LOCAL_CFLAGS :=
 
+ifeq ($(BOARD_USE_OMX_LATENCY_TRACE), true)
+LOCAL_CFLAGS += -DUSE_LATENCY_TRACE
+endif
+
+ifneq ($(BOARD_OMX_BIG_CPU_MASK),)
+LOCAL_CFLAGS += -DEXYNOS_OMX_BIG_CPU_MASK=$(BOARD_OMX_BIG_CPU_MASK)
+endif
+
 LOCAL_STATIC_LIBRARIES := libExynosOMX_OSAL
 LOCAL_SHARED_LIBRARIES := libcutils libutils
 
@@ -35,6 +35,7 @@
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
+#include "Exynos_OSAL_Latency.h"
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OMX_Resourcemanager.h"
@@ -46,6 +47,10 @@
 //#define EXYNOS_TRACE_ON
 #include "Exynos_OSAL_Log.h"
 
+#ifdef USE_LATENCY_TRACE
+#define LATENCY_TRACE_ENTRY_NUM   4096
+#define LATENCY_TRACE_DUMP_DIR    "/data/local/tmp"
+#endif
 
 /* Change CHECK_SIZE_VERSION Macro */
 OMX_ERRORTYPE Exynos_OMX_Check_SizeVersion(OMX_PTR header, OMX_U32 size)
@@ -300,7 +305,7 @@ OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(OMX_COMPONENTTYPE *pOMXComponent, OMX
                     while (Exynos_OSAL_GetElemNum(&pExynosPort->bufferQ) > 0) {
                         message = (EXYNOS_OMX_MESSAGE *)Exynos_OSAL_Dequeue(&pExynosPort->bufferQ);
                         if (message != NULL)
-                            Exynos_OSAL_Free(message);
+                            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
                     }
                     ret = pExynosComponent->exynos_FreeTunnelBuffer(pExynosPort, i);
                     if (OMX_ErrorNone != ret) {
@@ -313,7 +318,7 @@ OMX_ERRORTYPE Exynos_OMX_ComponentStateSet(OMX_COMPONENTTYPE *pOMXComponent, OMX
                         while (Exynos_OSAL_GetElemNum(&pExynosPort->bufferQ) > 0) {
                             message = (EXYNOS_OMX_MESSAGE *)Exynos_OSAL_Dequeue(&pExynosPort->bufferQ);
                             if (message != NULL)
-                                Exynos_OSAL_Free(message);
+                                Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
                         }
                         pExynosPort->portDefinition.bPopulated = OMX_FALSE;
                     }
@@ -977,7 +982,7 @@ OMX_ERRORTYPE Exynos_OMX_GetParameter(
         goto EXIT;
     }
 
-    switch (nParamIndex) {
+    switch ((int)nParamIndex) {
     case OMX_IndexParamAudioInit:
     case OMX_IndexParamVideoInit:
     case OMX_IndexParamImageInit:
@@ -1028,6 +1033,18 @@ OMX_ERRORTYPE Exynos_OMX_GetParameter(
         compPriority->nGroupPriority = pExynosComponent->compPriority.nGroupPriority;
     }
         break;
+    case OMX_IndexVendorSessionType:
+    {
+        EXYNOS_OMX_PARAM_SESSIONTYPE *pSessionType = (EXYNOS_OMX_PARAM_SESSIONTYPE *)ComponentParameterStructure;
+
+        ret = Exynos_OMX_Check_SizeVersion(pSessionType, sizeof(EXYNOS_OMX_PARAM_SESSIONTYPE));
+        if (ret != OMX_ErrorNone) {
+            goto EXIT;
+        }
+
+        pSessionType->eSessionType = pExynosComponent->eSessionType;
+    }
+        break;
 
     case OMX_IndexParamCompBufferSupplier:
     {
@@ -1127,7 +1144,7 @@ OMX_ERRORTYPE Exynos_OMX_SetParameter(
         goto EXIT;
     }
 
-    switch (nIndex) {
+    switch ((int)nIndex) {
     case OMX_IndexParamAudioInit:
     case OMX_IndexParamVideoInit:
     case OMX_IndexParamImageInit:
@@ -1202,6 +1219,30 @@ OMX_ERRORTYPE Exynos_OMX_SetParameter(
         pExynosComponent->compPriority.nGroupPriority = compPriority->nGroupPriority;
     }
         break;
+    case OMX_IndexVendorSessionType:
+    {
+        EXYNOS_OMX_PARAM_SESSIONTYPE *pSessionType = (EXYNOS_OMX_PARAM_SESSIONTYPE *)ComponentParameterStructure;
+
+        /* thread policies are picked when the buffer process threads are created */
+        if ((pExynosComponent->currentState != OMX_StateLoaded) &&
+            (pExynosComponent->currentState != OMX_StateWaitForResources)) {
+            ret = OMX_ErrorIncorrectStateOperation;
+            goto EXIT;
+        }
+
+        ret = Exynos_OMX_Check_SizeVersion(pSessionType, sizeof(EXYNOS_OMX_PARAM_SESSIONTYPE));
+        if (ret != OMX_ErrorNone) {
+            goto EXIT;
+        }
+
+        if (pSessionType->eSessionType >= EXYNOS_OMX_SESSION_MAX) {
+            ret = OMX_ErrorBadParameter;
+            goto EXIT;
+        }
+
+        pExynosComponent->eSessionType = pSessionType->eSessionType;
+    }
+        break;
     case OMX_IndexParamCompBufferSupplier:
     {
         OMX_PARAM_BUFFERSUPPLIERTYPE *bufferSupplier = (OMX_PARAM_BUFFERSUPPLIERTYPE *)ComponentParameterStructure;
@@ -1425,6 +1466,12 @@ OMX_ERRORTYPE Exynos_OMX_GetExtensionIndex(
         goto EXIT;
     }
 
+    if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_PARAM_SESSION_TYPE) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexVendorSessionType;
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
     ret = OMX_ErrorBadParameter;
 
 EXIT:
@@ -1494,6 +1541,113 @@ OMX_ERRORTYPE Exynos_OMX_UseEGLImage(
     return OMX_ErrorNotImplemented;
 }
 
+/* cpus used for latency critical threads in realtime sessions, 0 : no affinity */
+#ifndef EXYNOS_OMX_BIG_CPU_MASK
+#define EXYNOS_OMX_BIG_CPU_MASK 0
+#endif
+
+typedef struct _EXYNOS_OMX_THREAD_POLICY
+{
+    const char                *szName;
+    EXYNOS_OSAL_THREAD_POLICY  ePolicy;
+    OMX_S32                    nPriority;
+    OMX_S32                    nNice;       /* also the fallback when SCHED_FIFO is denied */
+    OMX_BOOL                   bBigCore;
+} EXYNOS_OMX_THREAD_POLICY;
+
+#define POLICY_OTHER(name, nice)            { name, EXYNOS_OSAL_THREAD_POLICY_OTHER, 0, nice, OMX_FALSE }
+#define POLICY_FIFO(name, prio, nice)       { name, EXYNOS_OSAL_THREAD_POLICY_FIFO, prio, nice, OMX_TRUE }
+
+/* [session][role], nice -10 : ANDROID_PRIORITY_VIDEO, -16 : ANDROID_PRIORITY_AUDIO, -19 : ANDROID_PRIORITY_URGENT_AUDIO */
+static const EXYNOS_OMX_THREAD_POLICY videoDecPolicy[EXYNOS_OMX_SESSION_MAX][EXYNOS_OMX_THREAD_ROLE_MAX] = {
+    {   /* EXYNOS_OMX_SESSION_PLAYBACK */
+        POLICY_OTHER("vdec_src_in",  -10),
+        POLICY_OTHER("vdec_src_out", -10),
+        POLICY_OTHER("vdec_dst_in",  -10),
+        POLICY_OTHER("vdec_dst_out", -10),
+        POLICY_OTHER("vdec_process", -10),
+    },
+    {   /* EXYNOS_OMX_SESSION_REALTIME : decoded frames go to display as soon as possible */
+        POLICY_OTHER("vdec_src_in",  -16),
+        POLICY_OTHER("vdec_src_out", -16),
+        POLICY_OTHER("vdec_dst_in",  -16),
+        POLICY_FIFO ("vdec_dst_out", 2, -19),
+        POLICY_OTHER("vdec_process", -16),
+    },
+};
+
+static const EXYNOS_OMX_THREAD_POLICY videoEncPolicy[EXYNOS_OMX_SESSION_MAX][EXYNOS_OMX_THREAD_ROLE_MAX] = {
+    {   /* EXYNOS_OMX_SESSION_PLAYBACK */
+        POLICY_OTHER("venc_src_in",  -10),
+        POLICY_OTHER("venc_src_out", -10),
+        POLICY_OTHER("venc_dst_in",  -10),
+        POLICY_OTHER("venc_dst_out", -10),
+        POLICY_OTHER("venc_process", -10),
+    },
+    {   /* EXYNOS_OMX_SESSION_REALTIME : camera frames enter the encoder without waiting */
+        POLICY_FIFO ("venc_src_in",  2, -19),
+        POLICY_OTHER("venc_src_out", -16),
+        POLICY_OTHER("venc_dst_in",  -16),
+        POLICY_OTHER("venc_dst_out", -16),
+        POLICY_OTHER("venc_process", -16),
+    },
+};
+
+static const EXYNOS_OMX_THREAD_POLICY audioDecPolicy[EXYNOS_OMX_SESSION_MAX][EXYNOS_OMX_THREAD_ROLE_MAX] = {
+    {   /* EXYNOS_OMX_SESSION_PLAYBACK */
+        POLICY_OTHER("adec_src_in",  -16),
+        POLICY_OTHER("adec_src_out", -16),
+        POLICY_OTHER("adec_dst_in",  -16),
+        POLICY_OTHER("adec_dst_out", -16),
+        POLICY_OTHER("adec_process", -16),
+    },
+    {   /* EXYNOS_OMX_SESSION_REALTIME */
+        POLICY_OTHER("adec_src_in",  -19),
+        POLICY_OTHER("adec_src_out", -19),
+        POLICY_OTHER("adec_dst_in",  -19),
+        POLICY_OTHER("adec_dst_out", -19),
+        POLICY_FIFO ("adec_process", 3, -19),
+    },
+};
+
+void Exynos_OMX_GetThreadAttr(
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent,
+    EXYNOS_OMX_THREAD_ROLE    eRole,
+    EXYNOS_OSAL_THREAD_ATTR  *pAttr)
+{
+    const EXYNOS_OMX_THREAD_POLICY *pPolicy = NULL;
+    EXYNOS_OMX_SESSION_TYPE         eSession = pExynosComponent->eSessionType;
+
+    if (eSession >= EXYNOS_OMX_SESSION_MAX)
+        eSession = EXYNOS_OMX_SESSION_PLAYBACK;
+    if (eRole >= EXYNOS_OMX_THREAD_ROLE_MAX)
+        eRole = EXYNOS_OMX_THREAD_BUFFER_PROCESS;
+
+    switch (pExynosComponent->codecType) {
+    case HW_VIDEO_ENC_CODEC:
+        pPolicy = &videoEncPolicy[eSession][eRole];
+        break;
+    case HW_AUDIO_DEC_CODEC:
+    case HW_AUDIO_ENC_CODEC:
+        pPolicy = &audioDecPolicy[eSession][eRole];
+        break;
+    case HW_VIDEO_DEC_CODEC:
+    default:
+        pPolicy = &videoDecPolicy[eSession][eRole];
+        break;
+    }
+
+    Exynos_OSAL_Memset(pAttr, 0, sizeof(EXYNOS_OSAL_THREAD_ATTR));
+    Exynos_OSAL_Strncpy(pAttr->szName, (OMX_PTR)pPolicy->szName, sizeof(pAttr->szName) - 1);
+    pAttr->ePolicy   = pPolicy->ePolicy;
+    pAttr->nPriority = pPolicy->nPriority;
+    pAttr->nNice     = pPolicy->nNice;
+    pAttr->nCpuMask  = (pPolicy->bBigCore == OMX_TRUE) ? EXYNOS_OMX_BIG_CPU_MASK : 0;
+
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "%s: %s policy:%d prio:%d nice:%d cpu:0x%x",
+                    __FUNCTION__, pAttr->szName, pAttr->ePolicy, pAttr->nPriority, pAttr->nNice, pAttr->nCpuMask);
+}
+
 OMX_ERRORTYPE Exynos_OMX_BaseComponent_Constructor(
     OMX_IN OMX_HANDLETYPE hComponent)
 {
@@ -1548,6 +1702,16 @@ OMX_ERRORTYPE Exynos_OMX_BaseComponent_Constructor(
 
     pExynosComponent->bMultiThreadProcess = OMX_FALSE;
 
+    ret = Exynos_OSAL_LatencyCreate(&pExynosComponent->hLatency, ALL_PORT_NUM);
+    if (ret != OMX_ErrorNone) {
+        ret = OMX_ErrorInsufficientResources;
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "OMX_ErrorInsufficientResources, Line:%d", __LINE__);
+        goto EXIT;
+    }
+#ifdef USE_LATENCY_TRACE
+    Exynos_OSAL_LatencyTraceEnable(pExynosComponent->hLatency, LATENCY_TRACE_ENTRY_NUM);
+#endif
+
     pOMXComponent->GetComponentVersion = &Exynos_OMX_GetComponentVersion;
     pOMXComponent->SendCommand         = &Exynos_OMX_SendCommand;
     pOMXComponent->GetState            = &Exynos_OMX_GetState;
@@ -1596,6 +1760,15 @@ OMX_ERRORTYPE Exynos_OMX_BaseComponent_Destructor(
     Exynos_OSAL_ThreadTerminate(pExynosComponent->hMessageHandler);
     pExynosComponent->hMessageHandler = NULL;
 
+    if (pExynosComponent->hLatency != NULL) {
+        Exynos_OSAL_LatencyPrint(pExynosComponent->hLatency, pExynosComponent->componentName);
+#ifdef USE_LATENCY_TRACE
+        Exynos_OSAL_LatencyTraceDump(pExynosComponent->hLatency, LATENCY_TRACE_DUMP_DIR, pExynosComponent->componentName);
+#endif
+        Exynos_OSAL_LatencyTerminate(pExynosComponent->hLatency);
+        pExynosComponent->hLatency = NULL;
+    }
+
     Exynos_OSAL_SignalTerminate(pExynosComponent->abendStateEvent);
     pExynosComponent->abendStateEvent = NULL;
     Exynos_OSAL_MutexTerminate(pExynosComponent->compMutex);
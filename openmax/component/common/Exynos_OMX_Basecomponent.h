@@ -31,16 +31,9 @@
 #include "Exynos_OMX_Def.h"
 #include "OMX_Component.h"
 #include "Exynos_OSAL_Queue.h"
+#include "Exynos_OSAL_Thread.h"
 #include "Exynos_OMX_Baseport.h"
 
-
-typedef struct _EXYNOS_OMX_MESSAGE
-{
-    OMX_U32 messageType;
-    OMX_U32 messageParam;
-    OMX_PTR pCmdData;
-} EXYNOS_OMX_MESSAGE;
-
 /* for Check TimeStamp after Seek */
 typedef struct _EXYNOS_OMX_TIMESTAMP
 {
@@ -50,6 +43,17 @@ typedef struct _EXYNOS_OMX_TIMESTAMP
     OMX_U32   nStartFlags;
 } EXYNOS_OMX_TIMESTAMP;
 
+/* buffer process threads, used to look up the scheduling policy */
+typedef enum _EXYNOS_OMX_THREAD_ROLE
+{
+    EXYNOS_OMX_THREAD_SRC_INPUT = 0,
+    EXYNOS_OMX_THREAD_SRC_OUTPUT,
+    EXYNOS_OMX_THREAD_DST_INPUT,
+    EXYNOS_OMX_THREAD_DST_OUTPUT,
+    EXYNOS_OMX_THREAD_BUFFER_PROCESS,   /* single thread model (audio) */
+    EXYNOS_OMX_THREAD_ROLE_MAX,
+} EXYNOS_OMX_THREAD_ROLE;
+
 typedef struct _EXYNOS_OMX_BASECOMPONENT
 {
     OMX_STRING                  componentName;
@@ -63,6 +67,7 @@ typedef struct _EXYNOS_OMX_BASECOMPONENT
 
     EXYNOS_CODEC_TYPE           codecType;
     EXYNOS_OMX_PRIORITYMGMTTYPE compPriority;
+    EXYNOS_OMX_SESSION_TYPE     eSessionType;
     OMX_MARKTYPE                propagateMarkType;
     OMX_HANDLETYPE              compMutex;
 
@@ -101,6 +106,9 @@ typedef struct _EXYNOS_OMX_BASECOMPONENT
     /* Check for Old & New OMX Process type switch */
     OMX_BOOL bMultiThreadProcess;
 
+    /* per-port latency histogram */
+    OMX_HANDLETYPE              hLatency;
+
     OMX_ERRORTYPE (*exynos_codec_componentInit)(OMX_COMPONENTTYPE *pOMXComponent);
     OMX_ERRORTYPE (*exynos_codec_componentTerminate)(OMX_COMPONENTTYPE *pOMXComponent);
 
@@ -144,6 +152,7 @@ extern "C" {
 #endif
 
     OMX_ERRORTYPE Exynos_OMX_Check_SizeVersion(OMX_PTR header, OMX_U32 size);
+    void Exynos_OMX_GetThreadAttr(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, EXYNOS_OMX_THREAD_ROLE eRole, EXYNOS_OSAL_THREAD_ATTR *pAttr);
 
 
 #ifdef __cplusplus
@@ -33,6 +33,7 @@
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
+#include "Exynos_OSAL_Latency.h"
 
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Basecomponent.h"
@@ -44,21 +45,86 @@
 #include "Exynos_OSAL_Log.h"
 
 
-OMX_ERRORTYPE Exynos_OMX_InputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent, OMX_BUFFERHEADERTYPE* bufferHeader)
+/*
+ * Maps a buffer header to its extendBufferHeader index. A hit in the per port
+ * hash is confirmed against the header pointer, so a stale or colliding entry
+ * only costs the linear scan that then refreshes it. Called with hPortMutex
+ * held.
+ */
+static OMX_BOOL Exynos_OMX_FindBufferIndex(
+    EXYNOS_OMX_BASEPORT  *pExynosPort,
+    OMX_BUFFERHEADERTYPE *bufferHeader,
+    OMX_U32               nBufferNum,
+    OMX_U32              *pIndex)
 {
-    OMX_ERRORTYPE             ret = OMX_ErrorNone;
-    EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
-    EXYNOS_OMX_BASEPORT      *pExynosPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
-    OMX_U32                   i = 0;
+    unsigned long key = (unsigned long)bufferHeader;
+    OMX_U32       hash = 0;
+    OMX_U32       i = 0;
 
-    Exynos_OSAL_MutexLock(pExynosPort->hPortMutex);
-    for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
+    if (bufferHeader == NULL)
+        return OMX_FALSE;
+
+    key ^= key >> 10;
+    hash = (OMX_U32)(key >> 4) & (BUFFER_INDEX_HASH_SIZE - 1);
+
+    i = pExynosPort->bufferIndexHash[hash];
+    if ((i > 0) && (i <= nBufferNum) &&
+        (pExynosPort->extendBufferHeader[i - 1].OMXBufferHeader == bufferHeader)) {
+        *pIndex = i - 1;
+        return OMX_TRUE;
+    }
+
+    for (i = 0; i < nBufferNum; i++) {
         if (bufferHeader == pExynosPort->extendBufferHeader[i].OMXBufferHeader) {
-            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
-            break;
+            pExynosPort->bufferIndexHash[hash] = (OMX_U8)(i + 1);
+            *pIndex = i;
+            return OMX_TRUE;
         }
     }
+
+    return OMX_FALSE;
+}
+
+/* the client owns @bufferHeader again and may queue it with ETB/FTB */
+void Exynos_OMX_ClearBufferInOMX(EXYNOS_OMX_BASEPORT *pExynosPort, OMX_BUFFERHEADERTYPE *bufferHeader)
+{
+    OMX_U32 i = 0;
+
+    Exynos_OSAL_MutexLock(pExynosPort->hPortMutex);
+    if (Exynos_OMX_FindBufferIndex(pExynosPort, bufferHeader, MAX_BUFFER_NUM, &i) == OMX_TRUE)
+        pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
     Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
+}
+
+/*
+ * bufferQ messages live in the extendBufferHeader slot of their buffer, only
+ * messages from outside that array were allocated and need freeing.
+ */
+void Exynos_OMX_ReleaseBufferMessage(EXYNOS_OMX_BASEPORT *pExynosPort, EXYNOS_OMX_MESSAGE *message)
+{
+    unsigned long base = (unsigned long)pExynosPort->extendBufferHeader;
+    unsigned long addr = (unsigned long)message;
+
+    if (message == NULL)
+        return;
+
+    if ((base != 0) &&
+        (addr >= base) &&
+        (addr < base + (sizeof(EXYNOS_OMX_BUFFERHEADERTYPE) * MAX_BUFFER_NUM)))
+        return;
+
+    Exynos_OSAL_Free(message);
+}
+
+OMX_ERRORTYPE Exynos_OMX_InputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent, OMX_BUFFERHEADERTYPE* bufferHeader)
+{
+    OMX_ERRORTYPE             ret = OMX_ErrorNone;
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_BASEPORT      *pExynosPort = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+
+    Exynos_OMX_ClearBufferInOMX(pExynosPort, bufferHeader);
+
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_ETB_EBD, (OMX_U64)(unsigned long)bufferHeader);
 
     if ((bufferHeader != NULL) && (bufferHeader->pBuffer != NULL))
         pExynosComponent->pCallbacks->EmptyBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
@@ -71,16 +137,10 @@ OMX_ERRORTYPE Exynos_OMX_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent, OM
     OMX_ERRORTYPE             ret = OMX_ErrorNone;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_BASEPORT      *pExynosPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
-    OMX_U32                   i = 0;
 
-    Exynos_OSAL_MutexLock(pExynosPort->hPortMutex);
-    for (i = 0; i < MAX_BUFFER_NUM; i++) {
-        if (bufferHeader == pExynosPort->extendBufferHeader[i].OMXBufferHeader) {
-            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
-            break;
-        }
-    }
-    Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
+    Exynos_OMX_ClearBufferInOMX(pExynosPort, bufferHeader);
+
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, OUTPUT_PORT_INDEX, LATENCY_STAGE_FTB_FBD, (OMX_U64)(unsigned long)bufferHeader);
 
     if ((bufferHeader != NULL) && (bufferHeader->pBuffer != NULL))
         pExynosComponent->pCallbacks->FillBufferDone(pOMXComponent, pExynosComponent->callbackData, bufferHeader);
@@ -251,7 +311,7 @@ OMX_ERRORTYPE Exynos_OMX_DisablePort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 p
         if (CHECK_PORT_BUFFER_SUPPLIER(pExynosPort)) {
             while (Exynos_OSAL_GetElemNum(&pExynosPort->bufferQ) > 0) {
                 message = (EXYNOS_OMX_MESSAGE*)Exynos_OSAL_Dequeue(&pExynosPort->bufferQ);
-                Exynos_OSAL_Free(message);
+                Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
             }
         }
         pExynosPort->portDefinition.bPopulated = OMX_FALSE;
@@ -402,26 +462,24 @@ OMX_ERRORTYPE Exynos_OMX_EmptyThisBuffer(
     }
 
     Exynos_OSAL_MutexLock(pExynosPort->hPortMutex);
-    for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
-        if (pBuffer == pExynosPort->extendBufferHeader[i].OMXBufferHeader) {
-            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_TRUE;
-            findBuffer = OMX_TRUE;
-            break;
-        }
-    }
-
+    findBuffer = Exynos_OMX_FindBufferIndex(pExynosPort, pBuffer, pExynosPort->portDefinition.nBufferCountActual, &i);
     if (findBuffer == OMX_FALSE) {
         ret = OMX_ErrorBadParameter;
         Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
         goto EXIT;
     }
-
-    message = Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_MESSAGE));
-    if (message == NULL) {
-        ret = OMX_ErrorInsufficientResources;
+    /* queued twice without being returned in between */
+    if (pExynosPort->extendBufferHeader[i].bBufferInOMX == OMX_TRUE) {
+        ret = OMX_ErrorIncorrectStateOperation;
         Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
         goto EXIT;
     }
+    pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_TRUE;
+
+    /* a buffer is queued at most once until it is returned, so its own slot is free */
+    message = &pExynosPort->extendBufferHeader[i].bufferMessage;
+    Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_ETB_EBD, (OMX_U64)(unsigned long)pBuffer);
+
     message->messageType = EXYNOS_OMX_CommandEmptyBuffer;
     message->messageParam = (OMX_U32) i;
     message->pCmdData = (OMX_PTR)pBuffer;
@@ -429,6 +487,7 @@ OMX_ERRORTYPE Exynos_OMX_EmptyThisBuffer(
     ret = Exynos_OSAL_Queue(&pExynosPort->bufferQ, (void *)message);
     if (ret != 0) {
         ret = OMX_ErrorUndefined;
+        pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
         Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
         goto EXIT;
     }
@@ -507,26 +566,24 @@ OMX_ERRORTYPE Exynos_OMX_FillThisBuffer(
     }
 
     Exynos_OSAL_MutexLock(pExynosPort->hPortMutex);
-    for (i = 0; i < MAX_BUFFER_NUM; i++) {
-        if (pBuffer == pExynosPort->extendBufferHeader[i].OMXBufferHeader) {
-            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_TRUE;
-            findBuffer = OMX_TRUE;
-            break;
-        }
-    }
-
+    findBuffer = Exynos_OMX_FindBufferIndex(pExynosPort, pBuffer, MAX_BUFFER_NUM, &i);
     if (findBuffer == OMX_FALSE) {
         ret = OMX_ErrorBadParameter;
         Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
         goto EXIT;
     }
-
-    message = Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_MESSAGE));
-    if (message == NULL) {
-        ret = OMX_ErrorInsufficientResources;
+    /* queued twice without being returned in between */
+    if (pExynosPort->extendBufferHeader[i].bBufferInOMX == OMX_TRUE) {
+        ret = OMX_ErrorIncorrectStateOperation;
         Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
         goto EXIT;
     }
+    pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_TRUE;
+
+    /* a buffer is queued at most once until it is returned, so its own slot is free */
+    message = &pExynosPort->extendBufferHeader[i].bufferMessage;
+    Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, OUTPUT_PORT_INDEX, LATENCY_STAGE_FTB_FBD, (OMX_U64)(unsigned long)pBuffer);
+
     message->messageType = EXYNOS_OMX_CommandFillBuffer;
     message->messageParam = (OMX_U32) i;
     message->pCmdData = (OMX_PTR)pBuffer;
@@ -534,6 +591,7 @@ OMX_ERRORTYPE Exynos_OMX_FillThisBuffer(
     ret = Exynos_OSAL_Queue(&pExynosPort->bufferQ, (void *)message);
     if (ret != 0) {
         ret = OMX_ErrorUndefined;
+        pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
         Exynos_OSAL_MutexUnlock(pExynosPort->hPortMutex);
         goto EXIT;
     }
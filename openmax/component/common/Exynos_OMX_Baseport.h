@@ -42,12 +42,22 @@
 
 #define MAX_BUFFER_NUM          40
 
+/* header pointer -> extendBufferHeader index, must be a power of 2 above MAX_BUFFER_NUM */
+#define BUFFER_INDEX_HASH_SIZE  64
+
 #define INPUT_PORT_INDEX    0
 #define OUTPUT_PORT_INDEX   1
 #define ALL_PORT_INDEX     -1
 #define ALL_PORT_NUM        2
 
 
+typedef struct _EXYNOS_OMX_MESSAGE
+{
+    OMX_U32 messageType;
+    OMX_U32 messageParam;
+    OMX_PTR pCmdData;
+} EXYNOS_OMX_MESSAGE;
+
 typedef struct _EXYNOS_OMX_BUFFERHEADERTYPE
 {
     OMX_BUFFERHEADERTYPE *OMXBufferHeader;
@@ -55,6 +65,7 @@ typedef struct _EXYNOS_OMX_BUFFERHEADERTYPE
     OMX_HANDLETYPE        ANBHandle;
     void                 *pYUVBuf[MAX_BUFFER_PLANE];
     int                   buf_fd[MAX_BUFFER_PLANE];
+    EXYNOS_OMX_MESSAGE    bufferMessage;    /* queued to bufferQ by ETB/FTB */
 } EXYNOS_OMX_BUFFERHEADERTYPE;
 
 typedef struct _EXYNOS_OMX_DATABUFFER
@@ -137,6 +148,7 @@ typedef enum _EXYNOS_OMX_PLANE
 typedef struct _EXYNOS_OMX_BASEPORT
 {
     EXYNOS_OMX_BUFFERHEADERTYPE   *extendBufferHeader;
+    OMX_U8                         bufferIndexHash[BUFFER_INDEX_HASH_SIZE];  /* index + 1, 0 is empty */
     OMX_U32                       *bufferStateAllocate;
     OMX_PARAM_PORTDEFINITIONTYPE   portDefinition;
     OMX_HANDLETYPE                 bufferSemID;
@@ -210,6 +222,8 @@ int Exynos_GetPlaneFromPort(EXYNOS_OMX_BASEPORT *pPort);
 OMX_ERRORTYPE Exynos_SetPlaneFromPort(EXYNOS_OMX_BASEPORT *pPort, int nPlaneNum);
 OMX_ERRORTYPE Exynos_SetPlaneToPort(EXYNOS_OMX_BASEPORT *pPort, int nPlaneNum);
 OMX_ERRORTYPE Exynos_OMX_FillThisBuffer(OMX_IN OMX_HANDLETYPE hComponent, OMX_IN OMX_BUFFERHEADERTYPE *pBuffer);
+void Exynos_OMX_ReleaseBufferMessage(EXYNOS_OMX_BASEPORT *pExynosPort, EXYNOS_OMX_MESSAGE *message);
+void Exynos_OMX_ClearBufferInOMX(EXYNOS_OMX_BASEPORT *pExynosPort, OMX_BUFFERHEADERTYPE *bufferHeader);
 
 #ifdef __cplusplus
 };
@@ -33,12 +33,14 @@
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_ETC.h"
+#include "Exynos_OSAL_Latency.h"
 
 #ifdef USE_ANB
 #include "Exynos_OSAL_Android.h"
@@ -406,6 +408,7 @@ OMX_BOOL Exynos_CSC_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
     OMX_U32                        copySize         = 0;
     DECODE_CODEC_EXTRA_BUFFERINFO *pBufferInfo      = NULL;
     OMX_COLOR_FORMATTYPE           eColorFormat     = exynosOutputPort->portDefinition.format.video.eColorFormat;
+    OMX_U64                        cscStartTime     = 0;
 
     FunctionIn();
 
@@ -570,7 +573,9 @@ OMX_BOOL Exynos_CSC_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
         pVideoDec->csc_handle,  /* handle */
         pYUVBuf,
         csc_memType);           /* YUV Addr or FD */
+    cscStartTime = Exynos_OSAL_GetMonotonicTime();
     cscRet = csc_convert(pVideoDec->csc_handle);
+    Exynos_OSAL_LatencyRecord(pExynosComponent->hLatency, OUTPUT_PORT_INDEX, LATENCY_STAGE_CSC, cscStartTime);
     if (cscRet != CSC_ErrorNone)
         ret = OMX_FALSE;
     else
@@ -698,6 +703,43 @@ EXIT:
     return ret;
 }
 
+/* non-reference frames before the seek target are never displayed, skip them before decoding */
+static OMX_BOOL Exynos_CheckSeekSkip(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *pSrcInputData)
+{
+    EXYNOS_OMX_BASECOMPONENT      *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+
+    /*
+     * secure input can not be parsed, and decoding timestamps say nothing
+     * about whether the frame is shown before the target
+     */
+    if ((pVideoDec->bSeekTarget != OMX_TRUE) ||
+        (pVideoDec->bDTSMode == OMX_TRUE) ||
+        (pVideoDec->bDRMPlayerMode == OMX_TRUE) ||
+        (pVideoDec->exynos_checkNonRefFrame == NULL))
+        return OMX_FALSE;
+
+    if ((pSrcInputData->dataLen == 0) ||
+        (pSrcInputData->timeStamp >= pVideoDec->nSeekTargetTimeStamp) ||
+        (pSrcInputData->nFlags & (OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_CODECCONFIG)))
+        return OMX_FALSE;
+
+    /* the first frame after a flush anchors the start timestamp check */
+    if ((pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE) &&
+        (pExynosComponent->checkTimeStamp.startTimeStamp == pSrcInputData->timeStamp))
+        return OMX_FALSE;
+
+    if (pVideoDec->exynos_checkNonRefFrame(pSrcInputData->multiPlaneBuffer.dataBuffer[0],
+                                           pSrcInputData->dataLen) != OMX_TRUE)
+        return OMX_FALSE;
+
+    pVideoDec->nSeekSkipCount++;
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "skip non-reference frame %lld us before seek target %lld us",
+                    pSrcInputData->timeStamp, pVideoDec->nSeekTargetTimeStamp);
+
+    return OMX_TRUE;
+}
+
 OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA *dstOutputData)
 {
     OMX_BOOL                   ret = OMX_FALSE;
@@ -731,6 +773,20 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
     }
 
     if (outputUseBuffer->dataValid == OMX_TRUE) {
+        pBufferInfo = (DECODE_CODEC_EXTRA_BUFFERINFO *)dstOutputData->extInfo;
+        if ((pBufferInfo->bTimestampMiss == OMX_TRUE) &&
+            ((dstOutputData->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)) {
+            Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "drop frame without timestamp");
+            pBufferInfo->bTimestampMiss = OMX_FALSE;
+            if (exynosOutputPort->bufferProcessType & BUFFER_SHARE) {
+                Exynos_OMX_ClearBufferInOMX(exynosOutputPort, outputUseBuffer->bufferHeader);
+                Exynos_OMX_FillThisBuffer(pOMXComponent, outputUseBuffer->bufferHeader);
+            }
+
+            ret = OMX_TRUE;
+            goto EXIT;
+        }
+
         if ((pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE) &&
             ((dstOutputData->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)) {
             if ((pExynosComponent->checkTimeStamp.startTimeStamp == dstOutputData->timeStamp) &&
@@ -747,8 +803,10 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                     pExynosComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
                 } else {
                     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "drop frame after seeking", pExynosComponent);
-                    if (exynosOutputPort->bufferProcessType & BUFFER_SHARE)
+                    if (exynosOutputPort->bufferProcessType & BUFFER_SHARE) {
+                        Exynos_OMX_ClearBufferInOMX(exynosOutputPort, outputUseBuffer->bufferHeader);
                         Exynos_OMX_FillThisBuffer(pOMXComponent, outputUseBuffer->bufferHeader);
+                    }
 
                     ret = OMX_TRUE;
                     goto EXIT;
@@ -760,6 +818,29 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
             goto EXIT;
         }
 
+        if ((pVideoDec->bSeekTarget == OMX_TRUE) &&
+            ((dstOutputData->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)) {
+            if (dstOutputData->timeStamp < pVideoDec->nSeekTargetTimeStamp) {
+                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "drop frame %lld us before seek target", dstOutputData->timeStamp);
+                pVideoDec->nSeekDropCount++;
+                if (exynosOutputPort->bufferProcessType & BUFFER_SHARE) {
+                    Exynos_OMX_ClearBufferInOMX(exynosOutputPort, outputUseBuffer->bufferHeader);
+                    Exynos_OMX_FillThisBuffer(pOMXComponent, outputUseBuffer->bufferHeader);
+                }
+
+                ret = OMX_TRUE;
+                goto EXIT;
+            }
+            pVideoDec->bSeekTarget = OMX_FALSE;
+        }
+
+        if (pVideoDec->nSeekStartTime != 0) {
+            Exynos_OSAL_Log(EXYNOS_LOG_INFO, "seek to first frame %lld us, skipped(%d) dropped(%d)",
+                            (OMX_S64)(Exynos_OSAL_GetMonotonicTime() - pVideoDec->nSeekStartTime),
+                            pVideoDec->nSeekSkipCount, pVideoDec->nSeekDropCount);
+            pVideoDec->nSeekStartTime = 0;
+        }
+
         if (exynosOutputPort->bufferProcessType & BUFFER_COPY) {
             if ((dstOutputData->remainDataLen <= (outputUseBuffer->allocSize - outputUseBuffer->dataLen)) &&
                 (!CHECK_PORT_BEING_FLUSHED(exynosOutputPort))) {
@@ -808,8 +889,10 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                 ((outputUseBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) ||
                 (CHECK_PORT_BEING_FLUSHED(exynosOutputPort)))
                 Exynos_OutputBufferReturn(pOMXComponent, outputUseBuffer);
-            else
+            else {
+                Exynos_OMX_ClearBufferInOMX(exynosOutputPort, outputUseBuffer->bufferHeader);
                 Exynos_OMX_FillThisBuffer(pOMXComponent, outputUseBuffer->bufferHeader);
+            }
         }
     } else {
         ret = OMX_FALSE;
@@ -885,6 +968,24 @@ OMX_ERRORTYPE Exynos_OMX_SrcInputBufferProcess(OMX_HANDLETYPE hComponent)
                 }
             }
 
+            if (((EXYNOS_OMX_ERRORTYPE)ret != OMX_ErrorInputDataDecodeYet) &&
+                (Exynos_CheckSeekSkip(pOMXComponent, pSrcInputData) == OMX_TRUE)) {
+                if (exynosInputPort->bufferProcessType & BUFFER_COPY) {
+                    OMX_PTR codecBuffer;
+                    codecBuffer = pSrcInputData->pPrivate;
+                    if (codecBuffer != NULL)
+                        Exynos_CodecBufferEnQueue(pExynosComponent, INPUT_PORT_INDEX, codecBuffer);
+                }
+
+                if (exynosInputPort->bufferProcessType & BUFFER_SHARE) {
+                    Exynos_OMX_InputBufferReturn(pOMXComponent, pSrcInputData->bufferHeader);
+                }
+
+                Exynos_ResetCodecData(pSrcInputData);
+                Exynos_OSAL_MutexUnlock(srcInputUseBuffer->bufferMutex);
+                continue;
+            }
+
             ret = pVideoDec->exynos_codec_srcInputProcess(pOMXComponent, pSrcInputData);
             if ((EXYNOS_OMX_ERRORTYPE)ret == OMX_ErrorCorruptedFrame) {
                 if (exynosInputPort->bufferProcessType & BUFFER_COPY) {
@@ -1269,26 +1370,38 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Create(OMX_HANDLETYPE hComponent)
     OMX_COMPONENTTYPE     *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_VIDEODEC_COMPONENT *pVideoDec = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OSAL_THREAD_ATTR  threadAttr;
 
     FunctionIn();
 
     pVideoDec->bExitBufferProcessThread = OMX_FALSE;
 
-    ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hDstOutputThread,
+    Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_DST_OUTPUT, &threadAttr);
+    ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoDec->hDstOutputThread,
                  Exynos_OMX_DstOutputProcessThread,
-                 pOMXComponent);
-    if (ret == OMX_ErrorNone)
-        ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hSrcOutputThread,
+                 pOMXComponent,
+                 &threadAttr);
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_SRC_OUTPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoDec->hSrcOutputThread,
                      Exynos_OMX_SrcOutputProcessThread,
-                     pOMXComponent);
-    if (ret == OMX_ErrorNone)
-        ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hDstInputThread,
+                     pOMXComponent,
+                     &threadAttr);
+    }
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_DST_INPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoDec->hDstInputThread,
                      Exynos_OMX_DstInputProcessThread,
-                     pOMXComponent);
-    if (ret == OMX_ErrorNone)
-        ret = Exynos_OSAL_ThreadCreate(&pVideoDec->hSrcInputThread,
+                     pOMXComponent,
+                     &threadAttr);
+    }
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_SRC_INPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoDec->hSrcInputThread,
                      Exynos_OMX_SrcInputProcessThread,
-                     pOMXComponent);
+                     pOMXComponent,
+                     &threadAttr);
+    }
 
 EXIT:
     FunctionOut();
@@ -1402,6 +1515,16 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
     pVideoDec->nQosRatio    = 0;
     pExynosComponent->hComponentHandle = (OMX_HANDLETYPE)pVideoDec;
 
+    ret = Exynos_OMX_VdecTimestampInit(&pVideoDec->timestampMap);
+    if (ret != OMX_ErrorNone) {
+        Exynos_OSAL_Free(pVideoDec);
+        pExynosComponent->hComponentHandle = NULL;
+        Exynos_OMX_Port_Destructor(pOMXComponent);
+        Exynos_OMX_BaseComponent_Destructor(pOMXComponent);
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "OMX_ErrorInsufficientResources, Line:%d", __LINE__);
+        goto EXIT;
+    }
+
     pExynosComponent->bSaveFlagEOS = OMX_FALSE;
     pExynosComponent->bBehaviorEOS = OMX_FALSE;
     pExynosComponent->bMultiThreadProcess = OMX_TRUE;
@@ -1546,6 +1669,8 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hCompo
     Exynos_OSAL_RefANB_Terminate(pVideoDec->hRefHandle);
 #endif
 
+    Exynos_OMX_VdecTimestampDeinit(&pVideoDec->timestampMap);
+
     Exynos_OSAL_Free(pVideoDec);
     pExynosComponent->hComponentHandle = pVideoDec = NULL;
 
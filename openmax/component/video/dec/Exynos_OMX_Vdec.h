@@ -94,8 +94,38 @@ typedef struct _DECODE_CODEC_EXTRA_BUFFERINFO
     OMX_U32                imageHeight;
     OMX_COLOR_FORMATTYPE   ColorFormat;
     PrivateDataShareBuffer PDSB;
+    OMX_BOOL               bTimestampMiss;  /* no input is known for the frame, it is not displayed */
 } DECODE_CODEC_EXTRA_BUFFERINFO;
 
+/* frame tags handed to the MFC run over 0 .. MAX_TIMESTAMP_TAG - 1 */
+#define MAX_TIMESTAMP_TAG           2048
+#define TIMESTAMP_MAP_INITIAL_SIZE  64
+#define TIMESTAMP_MAP_MAX_SIZE      (MAX_TIMESTAMP_TAG / 2)
+
+typedef struct _EXYNOS_OMX_VIDEODEC_TIMESTAMP
+{
+    OMX_S32   nTag;             /* -1 when the slot is empty */
+    OMX_BOOL  bConsumed;        /* looked up by an output frame */
+    OMX_TICKS timeStamp;
+    OMX_U32   nFlags;
+} EXYNOS_OMX_VIDEODEC_TIMESTAMP;
+
+typedef struct _EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP
+{
+    OMX_HANDLETYPE hLock;
+
+    EXYNOS_OMX_VIDEODEC_TIMESTAMP *pEntry;
+    OMX_U32  nSize;             /* power of 2, slot is tag & (nSize - 1) */
+    OMX_S32  nLastOutputTag;    /* -1 until the first hit */
+
+    /* statistics, cleared on flush */
+    OMX_U32  nInsert;
+    OMX_U32  nHit;
+    OMX_U32  nMiss;
+    OMX_U32  nGrow;
+    OMX_U32  nEvict;
+} EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP;
+
 typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
 {
     OMX_HANDLETYPE hCodecHandle;
@@ -123,6 +153,17 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
     /* For Reconfiguration DPB */
     OMX_BOOL bReconfigDPB;
 
+    /* frame tag -> input timestamp and flags */
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP timestampMap;
+
+    /* For Fast Seek */
+    OMX_BOOL  bSeekFlush;           /* client flush, output buffers stay registered */
+    OMX_BOOL  bSeekTarget;
+    OMX_TICKS nSeekTargetTimeStamp;
+    OMX_U64   nSeekStartTime;       /* flush time, for seek to first frame latency */
+    OMX_U32   nSeekSkipCount;       /* non-reference frames not sent to the codec */
+    OMX_U32   nSeekDropCount;       /* decoded frames dropped before the target */
+
     /* For Ref Cnt handling about graphic buffer */
     OMX_HANDLETYPE hRefHandle;
 
@@ -142,6 +183,7 @@ typedef struct _EXYNOS_OMX_VIDEODEC_COMPONENT
 
     int (*exynos_checkInputFrame) (OMX_U8 *pInputStream, OMX_U32 buffSize, OMX_U32 flag,
                                    OMX_BOOL bPreviousFrameEOF, OMX_BOOL *pbEndOfFrame);
+    OMX_BOOL (*exynos_checkNonRefFrame) (OMX_U8 *pInputStream, OMX_U32 streamSize);
     OMX_ERRORTYPE (*exynos_codec_getCodecInputPrivateData) (OMX_PTR codecBuffer, OMX_PTR *addr, OMX_U32 *size);
     OMX_ERRORTYPE (*exynos_codec_getCodecOutputPrivateData) (OMX_PTR codecBuffer, OMX_PTR addr[], OMX_U32 size[]);
 
@@ -31,12 +31,14 @@
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_SharedMemory.h"
+#include "Exynos_OSAL_Latency.h"
 
 #ifdef USE_ANB
 #include "Exynos_OSAL_Android.h"
@@ -134,6 +136,7 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
         for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
             if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
                 pExynosPort->extendBufferHeader[i].OMXBufferHeader = temp_bufferHeader;
+                pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
                 pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ASSIGNED | HEADER_STATE_ALLOCATED);
                 INIT_SET_SIZE_VERSION(temp_bufferHeader, OMX_BUFFERHEADERTYPE);
                 temp_bufferHeader->pBuffer        = pBuffer;
@@ -249,6 +252,7 @@ OMX_ERRORTYPE Exynos_OMX_AllocateBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = temp_bufferHeader;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->extendBufferHeader[i].buf_fd[0] = temp_buffer_fd;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ALLOCATED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(temp_bufferHeader, OMX_BUFFERHEADERTYPE);
@@ -476,7 +480,7 @@ OMX_ERRORTYPE Exynos_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 por
                 Exynos_OMX_InputBufferReturn(pOMXComponent, bufferHeader);
             }
         }
-        Exynos_OSAL_Free(message);
+        Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
         message = NULL;
     }
 
@@ -617,9 +621,14 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
         }
     }
 
+    /* a client flush is a seek unless the DPB is being reconfigured */
+    if ((bEvent == OMX_TRUE) && (pVideoDec->bReconfigDPB == OMX_FALSE))
+        pVideoDec->bSeekFlush = OMX_TRUE;
+
     pVideoDec->exynos_codec_bufferProcessRun(pOMXComponent, nPortIndex);
     Exynos_OSAL_MutexLock(flushPortBuffer[0]->bufferMutex);
     pVideoDec->exynos_codec_stop(pOMXComponent, nPortIndex);
+    pVideoDec->bSeekFlush = OMX_FALSE;
     Exynos_OSAL_MutexLock(flushPortBuffer[1]->bufferMutex);
     ret = Exynos_OMX_FlushPort(pOMXComponent, nPortIndex);
     if (pVideoDec->bReconfigDPB == OMX_TRUE)
@@ -632,12 +641,18 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 n
         if (nPortIndex == INPUT_PORT_INDEX) {
             pExynosComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
             pExynosComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
-            Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-            Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+            Exynos_OSAL_LatencyCancel(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC);
+            Exynos_OMX_VdecTimestampReset(&pVideoDec->timestampMap);
             pExynosComponent->getAllDelayBuffer = OMX_FALSE;
             pExynosComponent->bSaveFlagEOS = OMX_FALSE;
             pExynosComponent->bBehaviorEOS = OMX_FALSE;
             pExynosComponent->reInputData = OMX_FALSE;
+
+            if (bEvent == OMX_TRUE) {
+                pVideoDec->nSeekStartTime = Exynos_OSAL_GetMonotonicTime();
+                pVideoDec->nSeekSkipCount = 0;
+                pVideoDec->nSeekDropCount = 0;
+            }
         }
 
         pExynosComponent->pExynosPort[nPortIndex].bIsPortFlushed = OMX_FALSE;
@@ -736,7 +751,7 @@ OMX_ERRORTYPE Exynos_InputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompon
                 goto EXIT;
             }
             if (message->messageType == EXYNOS_OMX_CommandFakeBuffer) {
-                Exynos_OSAL_Free(message);
+                Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
                 ret = OMX_ErrorCodecFlush;
                 goto EXIT;
             }
@@ -750,7 +765,7 @@ OMX_ERRORTYPE Exynos_InputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompon
             inputUseBuffer->nFlags        = inputUseBuffer->bufferHeader->nFlags;
             inputUseBuffer->timeStamp     = inputUseBuffer->bufferHeader->nTimeStamp;
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
 
             if (inputUseBuffer->allocSize <= inputUseBuffer->dataLen)
                 Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "Input Buffer Full, Check input buffer size! allocSize:%d, dataLen:%d", inputUseBuffer->allocSize, inputUseBuffer->dataLen);
@@ -843,7 +858,7 @@ OMX_ERRORTYPE Exynos_OutputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompo
                 goto EXIT;
             }
             if (message->messageType == EXYNOS_OMX_CommandFakeBuffer) {
-                Exynos_OSAL_Free(message);
+                Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
                 ret = OMX_ErrorCodecFlush;
                 goto EXIT;
             }
@@ -865,7 +880,7 @@ OMX_ERRORTYPE Exynos_OutputBufferGetQueue(EXYNOS_OMX_BASECOMPONENT *pExynosCompo
             }
 */
 
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
         }
         ret = OMX_ErrorNone;
     }
@@ -897,13 +912,13 @@ OMX_BUFFERHEADERTYPE *Exynos_OutputBufferGetQueue_Direct(EXYNOS_OMX_BASECOMPONEN
             goto EXIT;
         }
         if (message->messageType == EXYNOS_OMX_CommandFakeBuffer) {
-            Exynos_OSAL_Free(message);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
             retBuffer = NULL;
             goto EXIT;
         }
 
         retBuffer  = (OMX_BUFFERHEADERTYPE *)(message->pCmdData);
-        Exynos_OSAL_Free(message);
+        Exynos_OMX_ReleaseBufferMessage(pExynosPort, message);
     }
 
 EXIT:
@@ -1528,6 +1543,33 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeSetConfig(
     }
         break;
 #endif
+    case OMX_IndexConfigSeekTarget:
+    {
+        EXYNOS_OMX_VIDEODEC_COMPONENT      *pVideoDec   = (EXYNOS_OMX_VIDEODEC_COMPONENT *)pExynosComponent->hComponentHandle;
+        EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET *pSeekTarget = (EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET *)pComponentConfigStructure;
+        OMX_HANDLETYPE                      pInputMutex = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pSeekTarget, sizeof(EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pSeekTarget->nPortIndex != INPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        /* the input thread checks the target under this mutex */
+        pInputMutex = pExynosComponent->pExynosPort[INPUT_PORT_INDEX].way.port2WayDataBuffer.inputDataBuffer.bufferMutex;
+        Exynos_OSAL_MutexLock(pInputMutex);
+        pVideoDec->nSeekTargetTimeStamp = pSeekTarget->nTargetTimeStamp;
+        pVideoDec->bSeekTarget = pSeekTarget->bEnable;
+        Exynos_OSAL_MutexUnlock(pInputMutex);
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "seek target %lld us, enable: %d",
+                        pSeekTarget->nTargetTimeStamp, pSeekTarget->bEnable);
+
+        ret = OMX_ErrorNone;
+    }
+        break;
     default:
         ret = Exynos_OMX_SetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -1639,6 +1681,12 @@ OMX_ERRORTYPE Exynos_OMX_VideoDecodeGetExtensionIndex(
         goto EXIT;
     }
 
+    if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_CONFIG_SEEK_TARGET) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexConfigSeekTarget;
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
 #ifdef USE_STOREMETADATA
     if (Exynos_OSAL_Strcmp(cParameterName, EXYNOS_INDEX_PARAM_STORE_METADATA_BUFFER) == 0) {
         *pIndexType = (OMX_INDEXTYPE) OMX_IndexParamStoreMetaDataBuffer;
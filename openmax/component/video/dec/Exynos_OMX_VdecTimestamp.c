@@ -0,0 +1,266 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OMX_VdecTimestamp.c
+ * @brief       frame tag to timestamp map for the MFC decoders
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+/*
+ * Every input buffer gets a frame tag that the MFC hands back with the
+ * picture decoded from it. Tags are sequential, so the entry for a tag sits
+ * in slot tag & (nSize - 1) and both insert and lookup are a single index.
+ * An entry stays until its slot is needed again. If the old entry has not
+ * been looked up yet and is still close to the frames being displayed, the
+ * table doubles instead of overwriting it. That is what keeps deep reorder
+ * and bursts of small input buffers from losing timestamps. Entries far
+ * behind the last displayed frame come from buffers that never produced a
+ * picture (headers, dropped frames) and are simply replaced.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Exynos_OMX_Macros.h"
+#include "Exynos_OMX_Vdec.h"
+#include "Exynos_OMX_VdecTimestamp.h"
+#include "Exynos_OSAL_Memory.h"
+#include "Exynos_OSAL_Mutex.h"
+
+#undef  EXYNOS_LOG_TAG
+#define EXYNOS_LOG_TAG    "EXYNOS_VIDEO_DEC_TS"
+#define EXYNOS_LOG_OFF
+//#define EXYNOS_TRACE_ON
+#include "Exynos_OSAL_Log.h"
+
+static void Exynos_Timestamp_Clear(EXYNOS_OMX_VIDEODEC_TIMESTAMP *pEntry, OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+
+    for (i = 0; i < nSize; i++) {
+        pEntry[i].nTag = -1;
+        pEntry[i].bConsumed = OMX_FALSE;
+    }
+}
+
+/* a pending entry this far behind the displayed frames will never be asked for */
+static OMX_BOOL Exynos_Timestamp_IsStale(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap, OMX_S32 nTag)
+{
+    OMX_U32 nDistance = 0;
+
+    if (pMap->nLastOutputTag < 0)
+        return OMX_FALSE;
+
+    nDistance = (OMX_U32)(pMap->nLastOutputTag - nTag) & (MAX_TIMESTAMP_TAG - 1);
+    if (nDistance >= (MAX_TIMESTAMP_TAG / 2))
+        return OMX_FALSE;   /* newer than the last output */
+
+    return (nDistance >= (pMap->nSize / 2)) ? OMX_TRUE : OMX_FALSE;
+}
+
+static OMX_ERRORTYPE Exynos_Timestamp_Grow(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMP *pNewEntry = NULL;
+    OMX_U32                        nNewSize = pMap->nSize * 2;
+    OMX_U32                        i = 0;
+
+    if (nNewSize > TIMESTAMP_MAP_MAX_SIZE)
+        return OMX_ErrorInsufficientResources;
+
+    pNewEntry = (EXYNOS_OMX_VIDEODEC_TIMESTAMP *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_VIDEODEC_TIMESTAMP) * nNewSize);
+    if (pNewEntry == NULL)
+        return OMX_ErrorInsufficientResources;
+
+    Exynos_Timestamp_Clear(pNewEntry, nNewSize);
+
+    /* distinct slots modulo nSize stay distinct modulo 2 * nSize */
+    for (i = 0; i < pMap->nSize; i++) {
+        if (pMap->pEntry[i].nTag >= 0)
+            pNewEntry[pMap->pEntry[i].nTag & (nNewSize - 1)] = pMap->pEntry[i];
+    }
+
+    Exynos_OSAL_Free(pMap->pEntry);
+    pMap->pEntry = pNewEntry;
+    pMap->nSize = nNewSize;
+    pMap->nGrow++;
+
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "%s: timestamp map grown to %d entries", __FUNCTION__, nNewSize);
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE Exynos_OMX_VdecTimestampInit(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap)
+{
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+
+    FunctionIn();
+
+    Exynos_OSAL_Memset(pMap, 0, sizeof(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP));
+
+    ret = Exynos_OSAL_MutexCreate(&pMap->hLock);
+    if (ret != OMX_ErrorNone)
+        goto EXIT;
+
+    pMap->pEntry = (EXYNOS_OMX_VIDEODEC_TIMESTAMP *)Exynos_OSAL_Malloc(sizeof(EXYNOS_OMX_VIDEODEC_TIMESTAMP) * TIMESTAMP_MAP_INITIAL_SIZE);
+    if (pMap->pEntry == NULL) {
+        Exynos_OSAL_MutexTerminate(pMap->hLock);
+        pMap->hLock = NULL;
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+
+    pMap->nSize = TIMESTAMP_MAP_INITIAL_SIZE;
+    Exynos_Timestamp_Clear(pMap->pEntry, pMap->nSize);
+    pMap->nLastOutputTag = -1;
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
+void Exynos_OMX_VdecTimestampDeinit(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap)
+{
+    FunctionIn();
+
+    if (pMap->pEntry != NULL) {
+        Exynos_OSAL_Free(pMap->pEntry);
+        pMap->pEntry = NULL;
+    }
+    pMap->nSize = 0;
+
+    if (pMap->hLock != NULL) {
+        Exynos_OSAL_MutexTerminate(pMap->hLock);
+        pMap->hLock = NULL;
+    }
+
+    FunctionOut();
+
+    return;
+}
+
+/* flush: no tag handed out before this can come back */
+void Exynos_OMX_VdecTimestampReset(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap)
+{
+    if (pMap->pEntry == NULL)
+        return;
+
+    Exynos_OSAL_MutexLock(pMap->hLock);
+
+    if ((pMap->nMiss > 0) || (pMap->nEvict > 0))
+        Exynos_OSAL_Log(EXYNOS_LOG_INFO, "timestamp map: insert(%d) hit(%d) miss(%d) grow(%d) evict(%d) size(%d)",
+                        pMap->nInsert, pMap->nHit, pMap->nMiss, pMap->nGrow, pMap->nEvict, pMap->nSize);
+
+    Exynos_Timestamp_Clear(pMap->pEntry, pMap->nSize);
+    pMap->nLastOutputTag = -1;
+    pMap->nInsert = 0;
+    pMap->nHit = 0;
+    pMap->nMiss = 0;
+    pMap->nGrow = 0;
+    pMap->nEvict = 0;
+
+    Exynos_OSAL_MutexUnlock(pMap->hLock);
+
+    return;
+}
+
+void Exynos_OMX_VdecTimestampInsert(
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap,
+    OMX_S32                           nTag,
+    OMX_TICKS                         timeStamp,
+    OMX_U32                           nFlags)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMP *pEntry = NULL;
+
+    if ((pMap->pEntry == NULL) || (nTag < 0) || (nTag >= MAX_TIMESTAMP_TAG))
+        return;
+
+    Exynos_OSAL_MutexLock(pMap->hLock);
+
+    while (1) {
+        pEntry = &pMap->pEntry[nTag & (pMap->nSize - 1)];
+
+        if ((pEntry->nTag < 0) ||
+            (pEntry->nTag == nTag) ||
+            (pEntry->bConsumed == OMX_TRUE))
+            break;
+
+        if (Exynos_Timestamp_IsStale(pMap, pEntry->nTag) == OMX_TRUE)
+            break;
+
+        if (Exynos_Timestamp_Grow(pMap) != OMX_ErrorNone) {
+            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "%s: tag %d overwrites pending tag %d", __FUNCTION__, nTag, pEntry->nTag);
+            pMap->nEvict++;
+            break;
+        }
+    }
+
+    pEntry->nTag = nTag;
+    pEntry->bConsumed = OMX_FALSE;
+    pEntry->timeStamp = timeStamp;
+    pEntry->nFlags = nFlags;
+    pMap->nInsert++;
+
+    Exynos_OSAL_MutexUnlock(pMap->hLock);
+
+    return;
+}
+
+/* on a miss the outputs are cleared, the caller decides how to recover */
+OMX_BOOL Exynos_OMX_VdecTimestampLookup(
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap,
+    OMX_S32                           nTag,
+    OMX_TICKS                        *pTimeStamp,
+    OMX_U32                          *pFlags)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMP *pEntry = NULL;
+    OMX_BOOL                       bFound = OMX_FALSE;
+
+    *pTimeStamp = 0;
+    *pFlags = 0;
+
+    if (pMap->pEntry == NULL)
+        return OMX_FALSE;
+
+    Exynos_OSAL_MutexLock(pMap->hLock);
+
+    if ((nTag >= 0) && (nTag < MAX_TIMESTAMP_TAG)) {
+        pEntry = &pMap->pEntry[nTag & (pMap->nSize - 1)];
+        if (pEntry->nTag == nTag) {
+            *pTimeStamp = pEntry->timeStamp;
+            *pFlags = pEntry->nFlags;
+            pEntry->bConsumed = OMX_TRUE;
+            pMap->nLastOutputTag = nTag;
+            bFound = OMX_TRUE;
+        }
+    }
+
+    if (bFound == OMX_TRUE) {
+        pMap->nHit++;
+    } else {
+        pMap->nMiss++;
+        Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "%s: no timestamp for tag %d", __FUNCTION__, nTag);
+    }
+
+    Exynos_OSAL_MutexUnlock(pMap->hLock);
+
+    return bFound;
+}
@@ -0,0 +1,48 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OMX_VdecTimestamp.h
+ * @brief       frame tag to timestamp map for the MFC decoders
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+#ifndef EXYNOS_OMX_VIDEO_DECODE_TIMESTAMP
+#define EXYNOS_OMX_VIDEO_DECODE_TIMESTAMP
+
+#include "OMX_Component.h"
+#include "Exynos_OMX_Def.h"
+#include "Exynos_OMX_Vdec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OMX_ERRORTYPE Exynos_OMX_VdecTimestampInit(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap);
+void Exynos_OMX_VdecTimestampDeinit(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap);
+void Exynos_OMX_VdecTimestampReset(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap);
+void Exynos_OMX_VdecTimestampInsert(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap, OMX_S32 nTag, OMX_TICKS timeStamp, OMX_U32 nFlags);
+OMX_BOOL Exynos_OMX_VdecTimestampLookup(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap, OMX_S32 nTag, OMX_TICKS *pTimeStamp, OMX_U32 *pFlags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -33,6 +33,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -41,6 +42,7 @@
 #include "ExynosVideoApi.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 /* To use CSC_METHOD_HW in EXYNOS OMX, gralloc should allocate physical memory using FIMC */
 /* It means GRALLOC_USAGE_HW_FIMC1 should be set on Native Window usage */
@@ -245,6 +247,30 @@ static OMX_BOOL Check_H264_StartCode(
     }
 }
 
+/* nal_ref_idc of the first slice, zero means no later picture refers to it */
+static OMX_BOOL Check_H264_NonRefFrame(
+    OMX_U8 *pInputStream,
+    OMX_U32 streamSize)
+{
+    OMX_U32 i = 0;
+    OMX_U8  nalType = 0;
+
+    for (i = 0; (i + 3) < streamSize; i++) {
+        if ((pInputStream[i] != 0x00) ||
+            (pInputStream[i + 1] != 0x00) ||
+            (pInputStream[i + 2] != 0x01))
+            continue;
+
+        nalType = pInputStream[i + 3] & 0x1F;
+        if ((nalType == 1) || (nalType == 5))
+            return ((pInputStream[i + 3] & 0x60) == 0x00) ? OMX_TRUE : OMX_FALSE;
+
+        i += 2;
+    }
+
+    return OMX_FALSE;
+}
+
 OMX_BOOL CheckFormatHWSupport(
     EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
     OMX_COLOR_FORMATTYPE         eColorFormat)
@@ -533,8 +559,10 @@ OMX_ERRORTYPE H264CodecStop(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex
 
         pOutbufOps->Stop(hMFCHandle);
 
+        /* on a seek the same buffers come back, keep their registration */
         if ((pOutputPort->bufferProcessType & BUFFER_SHARE) &&
-            (pOutputPort->bDynamicDPBMode == OMX_TRUE))
+            (pOutputPort->bDynamicDPBMode == OMX_TRUE) &&
+            (pVideoDec->bSeekFlush == OMX_FALSE))
             pOutbufOps->Clear_RegisteredBuffer(hMFCHandle);
     }
 
@@ -1875,8 +1903,7 @@ OMX_ERRORTYPE Exynos_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pH264Dec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pH264Dec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+    Exynos_OMX_VdecTimestampReset(&pVideoDec->timestampMap);
     pH264Dec->hMFCH264Handle.indexTimestamp = 0;
     pH264Dec->hMFCH264Handle.outputIndexTimestamp = 0;
 
@@ -2009,12 +2036,15 @@ OMX_ERRORTYPE Exynos_H264Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
     if (((pVideoDec->bDRMPlayerMode == OMX_TRUE) ||
             ((bInStartCode = Check_H264_StartCode(pSrcInputData->multiPlaneBuffer.dataBuffer[0], oneFrameSize)) == OMX_TRUE)) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pH264Dec->hMFCH264Handle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pH264Dec->hMFCH264Handle.indexTimestamp] = pSrcInputData->nFlags;
+        Exynos_OMX_VdecTimestampInsert(&pVideoDec->timestampMap, pH264Dec->hMFCH264Handle.indexTimestamp,
+                                       pSrcInputData->timeStamp, pSrcInputData->nFlags);
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pH264Dec->hMFCH264Handle.indexTimestamp, pSrcInputData->nFlags);
         pDecOps->Set_FrameTag(hMFCHandle, pH264Dec->hMFCH264Handle.indexTimestamp);
+        if ((pSrcInputData->dataLen > 0) &&
+            ((pSrcInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) != OMX_BUFFERFLAG_CODECCONFIG))
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pH264Dec->hMFCH264Handle.indexTimestamp);
         pH264Dec->hMFCH264Handle.indexTimestamp++;
-        pH264Dec->hMFCH264Handle.indexTimestamp %= MAX_TIMESTAMP;
+        pH264Dec->hMFCH264Handle.indexTimestamp %= MAX_TIMESTAMP_TAG;
 #ifdef USE_QOS_CTRL
         if ((pVideoDec->bQosChanged == OMX_TRUE) &&
             (pDecOps->Set_QosRatio != NULL)) {
@@ -2315,7 +2345,7 @@ OMX_ERRORTYPE Exynos_H264Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
     }
 
     pH264Dec->hMFCH264Handle.outputIndexTimestamp++;
-    pH264Dec->hMFCH264Handle.outputIndexTimestamp %= MAX_TIMESTAMP;
+    pH264Dec->hMFCH264Handle.outputIndexTimestamp %= MAX_TIMESTAMP_TAG;
 
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     nPlaneCnt = Exynos_GetPlaneFromPort(pExynosOutputPort);
@@ -2354,19 +2384,22 @@ OMX_ERRORTYPE Exynos_H264Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
     pBufferInfo->imageHeight = bufferGeometry->nFrameHeight;
     pBufferInfo->ColorFormat = Exynos_OSAL_Video2OMXFormat((int)bufferGeometry->eColorFormat);
     Exynos_OSAL_Memcpy(&pBufferInfo->PDSB, &pVideoBuffer->PDSB, sizeof(PrivateDataShareBuffer));
+    pBufferInfo->bTimestampMiss = OMX_FALSE;
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                       &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
             (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
             if (indexTimestamp == INDEX_AFTER_EOS) {
                 pDstOutputData->timeStamp = 0x00;
                 pDstOutputData->nFlags = 0x00;
             } else {
-                pDstOutputData->timeStamp = pExynosComponent->timeStamp[pH264Dec->hMFCH264Handle.outputIndexTimestamp];
-                pDstOutputData->nFlags = pExynosComponent->nFlags[pH264Dec->hMFCH264Handle.outputIndexTimestamp];
-                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
+                /* a neighbour's timestamp would be out of order, the frame is dropped */
+                Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for out indexTimestamp: %d, frame dropped", indexTimestamp);
+                pBufferInfo->bTimestampMiss = OMX_TRUE;
             }
         } else {
             pDstOutputData->timeStamp = 0x00;
@@ -2380,16 +2413,19 @@ OMX_ERRORTYPE Exynos_H264Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         if (pVideoDec->bDTSMode == OMX_TRUE) {
             if ((pVideoBuffer->frameType == VIDEO_FRAME_I) ||
                 ((pVideoBuffer->frameType == VIDEO_FRAME_OTHERS) &&
-                    ((pExynosComponent->nFlags[indexTimestamp] & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
+                    ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
                 (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE))
                 pH264Dec->hMFCH264Handle.outputIndexTimestamp = indexTimestamp;
-            else
+            else {
                 indexTimestamp = pH264Dec->hMFCH264Handle.outputIndexTimestamp;
+                if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                                   &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for reordered indexTimestamp: %d, frame dropped", indexTimestamp);
+                    pBufferInfo->bTimestampMiss = OMX_TRUE;
+                }
+            }
         }
 
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
 
@@ -2754,6 +2790,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
     pVideoDec->exynos_codec_enqueueAllBuffer = &H264CodecEnQueueAllBuffer;
 
     pVideoDec->exynos_checkInputFrame                 = &Check_H264_Frame;
+    pVideoDec->exynos_checkNonRefFrame                = &Check_H264_NonRefFrame;
     pVideoDec->exynos_codec_getCodecInputPrivateData  = &GetCodecInputPrivateData;
     pVideoDec->exynos_codec_getCodecOutputPrivateData = &GetCodecOutputPrivateData;
     pVideoDec->exynos_codec_reconfigAllBuffers        = &H264CodecReconfigAllBuffers;
@@ -34,6 +34,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -42,6 +43,7 @@
 #include "ExynosVideoApi.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 #ifdef USE_ANB
 #include "Exynos_OSAL_Android.h"
@@ -501,8 +503,10 @@ OMX_ERRORTYPE HevcCodecStop(
 
         pOutbufOps->Stop(hMFCHandle);
 
+        /* on a seek the same buffers come back, keep their registration */
         if ((pOutputPort->bufferProcessType & BUFFER_SHARE) &&
-            (pOutputPort->bDynamicDPBMode == OMX_TRUE))
+            (pOutputPort->bDynamicDPBMode == OMX_TRUE) &&
+            (pVideoDec->bSeekFlush == OMX_FALSE))
             pOutbufOps->Clear_RegisteredBuffer(hMFCHandle);
     }
 
@@ -1920,8 +1924,7 @@ OMX_ERRORTYPE Exynos_HevcDec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pHevcDec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pHevcDec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+    Exynos_OMX_VdecTimestampReset(&pVideoDec->timestampMap);
     pHevcDec->hMFCHevcHandle.indexTimestamp = 0;
     pHevcDec->hMFCHevcHandle.outputIndexTimestamp = 0;
 
@@ -2037,14 +2040,17 @@ OMX_ERRORTYPE Exynos_HevcDec_SrcIn(
 
     if (((bInStartCode = Check_HEVC_StartCode(pSrcInputData->multiPlaneBuffer.dataBuffer[0], oneFrameSize)) == OMX_TRUE) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pHevcDec->hMFCHevcHandle.indexTimestamp]    = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pHevcDec->hMFCHevcHandle.indexTimestamp]       = pSrcInputData->nFlags;
+        Exynos_OMX_VdecTimestampInsert(&pVideoDec->timestampMap, pHevcDec->hMFCHevcHandle.indexTimestamp,
+                                       pSrcInputData->timeStamp, pSrcInputData->nFlags);
 
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pHevcDec->hMFCHevcHandle.indexTimestamp, pSrcInputData->nFlags);
         pDecOps->Set_FrameTag(hMFCHandle, pHevcDec->hMFCHevcHandle.indexTimestamp);
+        if ((pSrcInputData->dataLen > 0) &&
+            ((pSrcInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) != OMX_BUFFERFLAG_CODECCONFIG))
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pHevcDec->hMFCHevcHandle.indexTimestamp);
 
         pHevcDec->hMFCHevcHandle.indexTimestamp++;
-        pHevcDec->hMFCHevcHandle.indexTimestamp %= MAX_TIMESTAMP;
+        pHevcDec->hMFCHevcHandle.indexTimestamp %= MAX_TIMESTAMP_TAG;
 #ifdef USE_QOS_CTRL
         if ((pVideoDec->bQosChanged == OMX_TRUE) &&
             (pDecOps->Set_QosRatio != NULL)) {
@@ -2352,7 +2358,7 @@ OMX_ERRORTYPE Exynos_HevcDec_DstOut(
     }
 
     pHevcDec->hMFCHevcHandle.outputIndexTimestamp++;
-    pHevcDec->hMFCHevcHandle.outputIndexTimestamp %= MAX_TIMESTAMP;
+    pHevcDec->hMFCHevcHandle.outputIndexTimestamp %= MAX_TIMESTAMP_TAG;
 
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     nPlaneCnt = Exynos_GetPlaneFromPort(pExynosOutputPort);
@@ -2392,19 +2398,22 @@ OMX_ERRORTYPE Exynos_HevcDec_DstOut(
     pBufferInfo->imageHeight = bufferGeometry->nFrameHeight;
     pBufferInfo->ColorFormat = Exynos_OSAL_Video2OMXFormat((int)bufferGeometry->eColorFormat);
     Exynos_OSAL_Memcpy(&pBufferInfo->PDSB, &pVideoBuffer->PDSB, sizeof(PrivateDataShareBuffer));
+    pBufferInfo->bTimestampMiss = OMX_FALSE;
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                       &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
             (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
             if (indexTimestamp == INDEX_AFTER_EOS) {
                 pDstOutputData->timeStamp = 0x00;
                 pDstOutputData->nFlags = 0x00;
             } else {
-                pDstOutputData->timeStamp = pExynosComponent->timeStamp[pHevcDec->hMFCHevcHandle.outputIndexTimestamp];
-                pDstOutputData->nFlags = pExynosComponent->nFlags[pHevcDec->hMFCHevcHandle.outputIndexTimestamp];
-                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
+                /* a neighbour's timestamp would be out of order, the frame is dropped */
+                Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for out indexTimestamp: %d, frame dropped", indexTimestamp);
+                pBufferInfo->bTimestampMiss = OMX_TRUE;
             }
         } else {
             pDstOutputData->timeStamp = 0x00;
@@ -2418,16 +2427,19 @@ OMX_ERRORTYPE Exynos_HevcDec_DstOut(
         if (pVideoDec->bDTSMode == OMX_TRUE) {
             if ((pVideoBuffer->frameType == VIDEO_FRAME_I) ||
                 ((pVideoBuffer->frameType == VIDEO_FRAME_OTHERS) &&
-                    ((pExynosComponent->nFlags[indexTimestamp] & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
+                    ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
                 (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE))
                pHevcDec->hMFCHevcHandle.outputIndexTimestamp = indexTimestamp;
-            else
-               indexTimestamp = pHevcDec->hMFCHevcHandle.outputIndexTimestamp;
+            else {
+                indexTimestamp = pHevcDec->hMFCHevcHandle.outputIndexTimestamp;
+                if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                                   &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for reordered indexTimestamp: %d, frame dropped", indexTimestamp);
+                    pBufferInfo->bTimestampMiss = OMX_TRUE;
+                }
+            }
         }
 
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
 
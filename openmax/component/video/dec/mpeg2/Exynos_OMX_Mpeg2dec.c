@@ -33,6 +33,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -41,6 +42,7 @@
 #include "ExynosVideoApi.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 /* To use CSC_METHOD_HW in EXYNOS OMX, gralloc should allocate physical memory using FIMC */
 /* It means GRALLOC_USAGE_HW_FIMC1 should be set on Native Window usage */
@@ -132,6 +134,29 @@ static OMX_BOOL Check_Mpeg2_StartCode(
     return OMX_TRUE;
 }
 
+/* B pictures are never used as a reference */
+static OMX_BOOL Check_Mpeg2_NonRefFrame(
+    OMX_U8     *pInputStream,
+    OMX_U32     streamSize)
+{
+    OMX_U32 i = 0;
+
+    for (i = 0; (i + 5) < streamSize; i++) {
+        if ((pInputStream[i] != 0x00) ||
+            (pInputStream[i + 1] != 0x00) ||
+            (pInputStream[i + 2] != 0x01))
+            continue;
+
+        /* picture_start_code, picture_coding_type follows the 10 bit temporal_reference */
+        if (pInputStream[i + 3] == 0x00)
+            return (((pInputStream[i + 5] >> 3) & 0x07) == 0x03) ? OMX_TRUE : OMX_FALSE;
+
+        i += 2;
+    }
+
+    return OMX_FALSE;
+}
+
 OMX_BOOL CheckFormatHWSupport(
     EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
     OMX_COLOR_FORMATTYPE         eColorFormat)
@@ -408,8 +433,10 @@ OMX_ERRORTYPE Mpeg2CodecStop(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortInde
 
         pOutbufOps->Stop(hMFCHandle);
 
+        /* on a seek the same buffers come back, keep their registration */
         if ((pOutputPort->bufferProcessType & BUFFER_SHARE) &&
-            (pOutputPort->bDynamicDPBMode == OMX_TRUE))
+            (pOutputPort->bDynamicDPBMode == OMX_TRUE) &&
+            (pVideoDec->bSeekFlush == OMX_FALSE))
             pOutbufOps->Clear_RegisteredBuffer(hMFCHandle);
     }
 
@@ -1617,8 +1644,7 @@ OMX_ERRORTYPE Exynos_Mpeg2Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pMpeg2Dec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pMpeg2Dec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+    Exynos_OMX_VdecTimestampReset(&pVideoDec->timestampMap);
     pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp = 0;
     pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp = 0;
 
@@ -1743,12 +1769,15 @@ OMX_ERRORTYPE Exynos_Mpeg2Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
 
     if (((bInStartCode = Check_Mpeg2_StartCode(pSrcInputData->multiPlaneBuffer.dataBuffer[0], oneFrameSize)) == OMX_TRUE) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp] = pSrcInputData->nFlags;
+        Exynos_OMX_VdecTimestampInsert(&pVideoDec->timestampMap, pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp,
+                                       pSrcInputData->timeStamp, pSrcInputData->nFlags);
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp, pSrcInputData->nFlags);
         pDecOps->Set_FrameTag(hMFCHandle, pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp);
+        if ((pSrcInputData->dataLen > 0) &&
+            ((pSrcInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) != OMX_BUFFERFLAG_CODECCONFIG))
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp);
         pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp++;
-        pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp %= MAX_TIMESTAMP;
+        pMpeg2Dec->hMFCMpeg2Handle.indexTimestamp %= MAX_TIMESTAMP_TAG;
 #ifdef USE_QOS_CTRL
         if ((pVideoDec->bQosChanged == OMX_TRUE) &&
             (pDecOps->Set_QosRatio != NULL)) {
@@ -2030,7 +2059,7 @@ OMX_ERRORTYPE Exynos_Mpeg2Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
     }
 
     pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp++;
-    pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp %= MAX_TIMESTAMP;
+    pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp %= MAX_TIMESTAMP_TAG;
 
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     nPlaneCnt = Exynos_GetPlaneFromPort(pExynosOutputPort);
@@ -2069,19 +2098,22 @@ OMX_ERRORTYPE Exynos_Mpeg2Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
     pBufferInfo->imageHeight = bufferGeometry->nFrameHeight;
     pBufferInfo->ColorFormat = Exynos_OSAL_Video2OMXFormat((int)bufferGeometry->eColorFormat);
     Exynos_OSAL_Memcpy(&pBufferInfo->PDSB, &pVideoBuffer->PDSB, sizeof(PrivateDataShareBuffer));
+    pBufferInfo->bTimestampMiss = OMX_FALSE;
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                       &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
             (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
             if (indexTimestamp == INDEX_AFTER_EOS) {
                 pDstOutputData->timeStamp = 0x00;
                 pDstOutputData->nFlags = 0x00;
             } else {
-                pDstOutputData->timeStamp = pExynosComponent->timeStamp[pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp];
-                pDstOutputData->nFlags = pExynosComponent->nFlags[pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp];
-                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
+                /* a neighbour's timestamp would be out of order, the frame is dropped */
+                Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for out indexTimestamp: %d, frame dropped", indexTimestamp);
+                pBufferInfo->bTimestampMiss = OMX_TRUE;
             }
         } else {
             pDstOutputData->timeStamp = 0x00;
@@ -2095,16 +2127,19 @@ OMX_ERRORTYPE Exynos_Mpeg2Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
         if (pVideoDec->bDTSMode == OMX_TRUE) {
             if ((pVideoBuffer->frameType == VIDEO_FRAME_I) ||
                 ((pVideoBuffer->frameType == VIDEO_FRAME_OTHERS) &&
-                    ((pExynosComponent->nFlags[indexTimestamp] & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
+                    ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
                 (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE))
                 pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp = indexTimestamp;
-            else
+            else {
                 indexTimestamp = pMpeg2Dec->hMFCMpeg2Handle.outputIndexTimestamp;
+                if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                                   &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for reordered indexTimestamp: %d, frame dropped", indexTimestamp);
+                    pBufferInfo->bTimestampMiss = OMX_TRUE;
+                }
+            }
         }
 
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
 
@@ -2458,6 +2493,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(
     pVideoDec->exynos_codec_enqueueAllBuffer = &Mpeg2CodecEnQueueAllBuffer;
 
     pVideoDec->exynos_checkInputFrame                 = &Check_Mpeg2_Frame;
+    pVideoDec->exynos_checkNonRefFrame                = &Check_Mpeg2_NonRefFrame;
     pVideoDec->exynos_codec_getCodecInputPrivateData  = &GetCodecInputPrivateData;
     pVideoDec->exynos_codec_getCodecOutputPrivateData = &GetCodecOutputPrivateData;
     pVideoDec->exynos_codec_reconfigAllBuffers        = &Mpeg2CodecReconfigAllBuffers;
@@ -34,6 +34,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -42,6 +43,7 @@
 #include "ExynosVideoApi.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 /* To use CSC_METHOD_HW in EXYNOS OMX, gralloc should allocate physical memory using FIMC */
 /* It means GRALLOC_USAGE_HW_FIMC1 should be set on Native Window usage */
@@ -349,6 +351,32 @@ static OMX_BOOL Check_Stream_StartCode(
     }
 }
 
+/* B-VOPs are never used as a reference */
+static OMX_BOOL Check_Mpeg4_NonRefFrame(
+    OMX_U8    *pInputStream,
+    OMX_U32    streamSize)
+{
+    OMX_U32 i = 0;
+
+    if (gbFIMV1)
+        return OMX_FALSE;
+
+    for (i = 0; (i + 4) < streamSize; i++) {
+        if ((pInputStream[i] != 0x00) ||
+            (pInputStream[i + 1] != 0x00) ||
+            (pInputStream[i + 2] != 0x01))
+            continue;
+
+        /* vop_start_code, vop_coding_type is in the top two bits */
+        if (pInputStream[i + 3] == 0xB6)
+            return ((pInputStream[i + 4] >> 6) == 0x02) ? OMX_TRUE : OMX_FALSE;
+
+        i += 2;
+    }
+
+    return OMX_FALSE;
+}
+
 OMX_BOOL CheckFormatHWSupport(
     EXYNOS_OMX_BASECOMPONENT    *pExynosComponent,
     OMX_COLOR_FORMATTYPE         eColorFormat)
@@ -625,8 +653,10 @@ OMX_ERRORTYPE Mpeg4CodecStop(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortInde
 
         pOutbufOps->Stop(hMFCHandle);
 
+        /* on a seek the same buffers come back, keep their registration */
         if ((pOutputPort->bufferProcessType & BUFFER_SHARE) &&
-            (pOutputPort->bDynamicDPBMode == OMX_TRUE))
+            (pOutputPort->bDynamicDPBMode == OMX_TRUE) &&
+            (pVideoDec->bSeekFlush == OMX_FALSE))
             pOutbufOps->Clear_RegisteredBuffer(hMFCHandle);
     }
 
@@ -1976,8 +2006,7 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pMpeg4Dec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pMpeg4Dec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+    Exynos_OMX_VdecTimestampReset(&pVideoDec->timestampMap);
     pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp = 0;
     pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp = 0;
 
@@ -2102,12 +2131,15 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
 
     if (((bInStartCode = Check_Stream_StartCode(pSrcInputData->multiPlaneBuffer.dataBuffer[0], oneFrameSize, pMpeg4Dec->hMFCMpeg4Handle.codecType)) == OMX_TRUE) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->nFlags;
+        Exynos_OMX_VdecTimestampInsert(&pVideoDec->timestampMap, pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp,
+                                       pSrcInputData->timeStamp, pSrcInputData->nFlags);
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp, pSrcInputData->nFlags);
         pDecOps->Set_FrameTag(hMFCHandle, pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp);
+        if ((pSrcInputData->dataLen > 0) &&
+            ((pSrcInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) != OMX_BUFFERFLAG_CODECCONFIG))
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp);
         pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp++;
-        pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp %= MAX_TIMESTAMP;
+        pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp %= MAX_TIMESTAMP_TAG;
 #ifdef USE_QOS_CTRL
         if ((pVideoDec->bQosChanged == OMX_TRUE) &&
             (pDecOps->Set_QosRatio != NULL)) {
@@ -2389,7 +2421,7 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
     }
 
     pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp++;
-    pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp %= MAX_TIMESTAMP;
+    pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp %= MAX_TIMESTAMP_TAG;
 
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     nPlaneCnt = Exynos_GetPlaneFromPort(pExynosOutputPort);
@@ -2428,19 +2460,22 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
     pBufferInfo->imageHeight = bufferGeometry->nFrameHeight;
     pBufferInfo->ColorFormat = Exynos_OSAL_Video2OMXFormat((int)bufferGeometry->eColorFormat);
     Exynos_OSAL_Memcpy(&pBufferInfo->PDSB, &pVideoBuffer->PDSB, sizeof(PrivateDataShareBuffer));
+    pBufferInfo->bTimestampMiss = OMX_FALSE;
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                       &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
             (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
             if (indexTimestamp == INDEX_AFTER_EOS) {
                 pDstOutputData->timeStamp = 0x00;
                 pDstOutputData->nFlags = 0x00;
             } else {
-                pDstOutputData->timeStamp = pExynosComponent->timeStamp[pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp];
-                pDstOutputData->nFlags = pExynosComponent->nFlags[pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp];
-                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
+                /* a neighbour's timestamp would be out of order, the frame is dropped */
+                Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for out indexTimestamp: %d, frame dropped", indexTimestamp);
+                pBufferInfo->bTimestampMiss = OMX_TRUE;
             }
         } else {
             pDstOutputData->timeStamp = 0x00;
@@ -2454,16 +2489,19 @@ OMX_ERRORTYPE Exynos_Mpeg4Dec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
         if (pVideoDec->bDTSMode == OMX_TRUE) {
             if ((pVideoBuffer->frameType == VIDEO_FRAME_I) ||
                 ((pVideoBuffer->frameType == VIDEO_FRAME_OTHERS) &&
-                    ((pExynosComponent->nFlags[indexTimestamp] & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
+                    ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
                 (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE))
                 pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp = indexTimestamp;
-            else
+            else {
                 indexTimestamp = pMpeg4Dec->hMFCMpeg4Handle.outputIndexTimestamp;
+                if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                                   &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for reordered indexTimestamp: %d, frame dropped", indexTimestamp);
+                    pBufferInfo->bTimestampMiss = OMX_TRUE;
+                }
+            }
         }
 
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
 
@@ -2837,10 +2875,12 @@ OSCL_EXPORT_REF OMX_ERRORTYPE Exynos_OMX_ComponentInit(OMX_HANDLETYPE hComponent
     pVideoDec->exynos_codec_bufferProcessRun = &Mpeg4CodecOutputBufferProcessRun;
     pVideoDec->exynos_codec_enqueueAllBuffer = &Mpeg4CodecEnQueueAllBuffer;
 
-    if (codecType == CODEC_TYPE_MPEG4)
+    if (codecType == CODEC_TYPE_MPEG4) {
         pVideoDec->exynos_checkInputFrame = &Check_Mpeg4_Frame;
-    else
+        pVideoDec->exynos_checkNonRefFrame = &Check_Mpeg4_NonRefFrame;
+    } else {
         pVideoDec->exynos_checkInputFrame = &Check_H263_Frame;
+    }
 
     pVideoDec->exynos_codec_getCodecInputPrivateData  = &GetCodecInputPrivateData;
     pVideoDec->exynos_codec_getCodecOutputPrivateData = &GetCodecOutputPrivateData;
@@ -0,0 +1,31 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+	Exynos_OMX_VdecTimestamp_test.c \
+	../Exynos_OMX_VdecTimestamp.c \
+	../../../../osal/Exynos_OSAL_Mutex.c \
+	../../../../osal/Exynos_OSAL_Memory.c \
+	../../../../osal/Exynos_OSAL_Log.c
+
+LOCAL_MODULE := Exynos_OMX_VdecTimestamp_test
+
+LOCAL_CFLAGS :=
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lpthread -lrt
+
+LOCAL_C_INCLUDES := \
+	$(EXYNOS_OMX_INC)/khronos \
+	$(EXYNOS_OMX_INC)/exynos \
+	$(EXYNOS_OMX_TOP)/osal \
+	$(EXYNOS_OMX_TOP)/core \
+	$(EXYNOS_OMX_COMPONENT)/common \
+	$(EXYNOS_OMX_COMPONENT)/video/dec \
+	$(EXYNOS_VIDEO_CODEC)/include \
+	$(TOP)/hardware/samsung_slsi/exynos/include \
+	$(TOP)/hardware/samsung_slsi/$(TARGET_BOARD_PLATFORM)/include
+
+include $(BUILD_HOST_EXECUTABLE)
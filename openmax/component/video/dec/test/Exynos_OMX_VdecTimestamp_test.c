@@ -0,0 +1,217 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OMX_VdecTimestamp_test.c
+ * @brief       host test of the decoder frame tag to timestamp map
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Exynos_OMX_VdecTimestamp.h"
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+#define TEST_TIMESTAMP(tag) ((OMX_TICKS)(tag) * 33333)
+
+static OMX_BOOL Lookup(EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP *pMap, OMX_S32 nTag, OMX_TICKS *pTimeStamp, OMX_U32 *pFlags)
+{
+    return Exynos_OMX_VdecTimestampLookup(pMap, nTag, pTimeStamp, pFlags);
+}
+
+static void TestInsertLookup(void)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP map;
+    OMX_TICKS timeStamp = 0;
+    OMX_U32   nFlags = 0;
+    OMX_S32   i = 0;
+
+    CHECK(Exynos_OMX_VdecTimestampInit(&map) == OMX_ErrorNone);
+
+    for (i = 0; i < 10; i++)
+        Exynos_OMX_VdecTimestampInsert(&map, i, TEST_TIMESTAMP(i), (i == 9) ? OMX_BUFFERFLAG_EOS : 0);
+
+    /* out of order, as a B frame stream displays them */
+    CHECK(Lookup(&map, 0, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(0));
+    CHECK(Lookup(&map, 3, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(3));
+    CHECK(Lookup(&map, 1, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(1));
+    CHECK(nFlags == 0);
+    CHECK(Lookup(&map, 9, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(nFlags == OMX_BUFFERFLAG_EOS);
+
+    /* a tag is kept until its slot is reused, DTS reorder looks it up twice */
+    CHECK(Lookup(&map, 3, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(3));
+
+    CHECK(map.nHit == 5);
+    CHECK(map.nMiss == 0);
+    CHECK(map.nGrow == 0);
+
+    Exynos_OMX_VdecTimestampDeinit(&map);
+}
+
+/* a miss clears the outputs, so a caller never sees another frame's timestamp */
+static void TestMiss(void)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP map;
+    OMX_TICKS timeStamp = 12345;
+    OMX_U32   nFlags = 0x10;
+
+    CHECK(Exynos_OMX_VdecTimestampInit(&map) == OMX_ErrorNone);
+
+    Exynos_OMX_VdecTimestampInsert(&map, 4, TEST_TIMESTAMP(4), 0);
+
+    CHECK(Lookup(&map, 5, &timeStamp, &nFlags) == OMX_FALSE);
+    CHECK(timeStamp == 0);
+    CHECK(nFlags == 0);
+    CHECK(Lookup(&map, -1, &timeStamp, &nFlags) == OMX_FALSE);
+    CHECK(Lookup(&map, MAX_TIMESTAMP_TAG, &timeStamp, &nFlags) == OMX_FALSE);
+
+    /* tag 4 + initial size lands on the same slot and must not answer for 4 */
+    Exynos_OMX_VdecTimestampInsert(&map, 4 + TIMESTAMP_MAP_INITIAL_SIZE, TEST_TIMESTAMP(100), 0);
+    CHECK(Lookup(&map, 4, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(4));
+    CHECK(Lookup(&map, 4 + TIMESTAMP_MAP_INITIAL_SIZE, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(100));
+
+    CHECK(map.nMiss == 3);
+
+    Exynos_OMX_VdecTimestampDeinit(&map);
+}
+
+/* more pending frames than the initial size: the map grows instead of losing them */
+static void TestGrow(void)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP map;
+    OMX_TICKS timeStamp = 0;
+    OMX_U32   nFlags = 0;
+    OMX_S32   nCount = TIMESTAMP_MAP_INITIAL_SIZE * 3;
+    OMX_S32   i = 0;
+
+    CHECK(Exynos_OMX_VdecTimestampInit(&map) == OMX_ErrorNone);
+
+    for (i = 0; i < nCount; i++)
+        Exynos_OMX_VdecTimestampInsert(&map, i, TEST_TIMESTAMP(i), 0);
+
+    CHECK(map.nSize >= (OMX_U32)nCount);
+    CHECK(map.nGrow > 0);
+    CHECK(map.nEvict == 0);
+
+    for (i = nCount - 1; i >= 0; i--) {
+        CHECK(Lookup(&map, i, &timeStamp, &nFlags) == OMX_TRUE);
+        CHECK(timeStamp == TEST_TIMESTAMP(i));
+    }
+
+    Exynos_OMX_VdecTimestampDeinit(&map);
+}
+
+/* tags that never produced a picture are replaced once output has moved past them */
+static void TestStale(void)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP map;
+    OMX_TICKS timeStamp = 0;
+    OMX_U32   nFlags = 0;
+    OMX_S32   nTag = 0;
+
+    CHECK(Exynos_OMX_VdecTimestampInit(&map) == OMX_ErrorNone);
+
+    /* tag 0 is a header buffer, never displayed */
+    Exynos_OMX_VdecTimestampInsert(&map, 0, TEST_TIMESTAMP(0), OMX_BUFFERFLAG_CODECCONFIG);
+
+    /* steady playback with one frame in flight, wrapping the tag space */
+    for (nTag = 1; nTag < (MAX_TIMESTAMP_TAG * 2); nTag++) {
+        OMX_S32 nWrapped = nTag & (MAX_TIMESTAMP_TAG - 1);
+
+        Exynos_OMX_VdecTimestampInsert(&map, nWrapped, TEST_TIMESTAMP(nTag), 0);
+        CHECK(Lookup(&map, nWrapped, &timeStamp, &nFlags) == OMX_TRUE);
+        CHECK(timeStamp == TEST_TIMESTAMP(nTag));
+    }
+
+    CHECK(map.nSize == TIMESTAMP_MAP_INITIAL_SIZE);
+    CHECK(map.nGrow == 0);
+    CHECK(map.nEvict == 0);
+
+    Exynos_OMX_VdecTimestampDeinit(&map);
+}
+
+/* after a flush no old tag may answer */
+static void TestReset(void)
+{
+    EXYNOS_OMX_VIDEODEC_TIMESTAMPMAP map;
+    OMX_TICKS timeStamp = 0;
+    OMX_U32   nFlags = 0;
+    OMX_S32   i = 0;
+
+    CHECK(Exynos_OMX_VdecTimestampInit(&map) == OMX_ErrorNone);
+
+    for (i = 0; i < 8; i++)
+        Exynos_OMX_VdecTimestampInsert(&map, i, TEST_TIMESTAMP(i), 0);
+    CHECK(Lookup(&map, 2, &timeStamp, &nFlags) == OMX_TRUE);
+
+    Exynos_OMX_VdecTimestampReset(&map);
+
+    CHECK(map.nLastOutputTag == -1);
+    CHECK(map.nHit == 0);
+    for (i = 0; i < 8; i++)
+        CHECK(Lookup(&map, i, &timeStamp, &nFlags) == OMX_FALSE);
+
+    Exynos_OMX_VdecTimestampInsert(&map, 2, TEST_TIMESTAMP(200), 0);
+    CHECK(Lookup(&map, 2, &timeStamp, &nFlags) == OMX_TRUE);
+    CHECK(timeStamp == TEST_TIMESTAMP(200));
+
+    Exynos_OMX_VdecTimestampDeinit(&map);
+
+    /* a torn down map answers nothing and does not crash */
+    CHECK(Lookup(&map, 2, &timeStamp, &nFlags) == OMX_FALSE);
+    Exynos_OMX_VdecTimestampInsert(&map, 2, TEST_TIMESTAMP(2), 0);
+    Exynos_OMX_VdecTimestampReset(&map);
+}
+
+int main(void)
+{
+    TestInsertLookup();
+    TestMiss();
+    TestGrow();
+    TestStale();
+    TestReset();
+
+    if (failCount != 0) {
+        printf("Exynos_OMX_VdecTimestamp_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+
+    printf("Exynos_OMX_VdecTimestamp_test: pass\n");
+    return 0;
+}
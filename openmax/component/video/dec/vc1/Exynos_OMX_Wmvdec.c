@@ -36,6 +36,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Vdec.h"
 #include "Exynos_OMX_VdecControl.h"
+#include "Exynos_OMX_VdecTimestamp.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -44,6 +45,7 @@
 #include "ExynosVideoApi.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 /* To use CSC_METHOD_HW in EXYNOS OMX, gralloc should allocate physical memory using FIMC */
 /* It means GRALLOC_USAGE_HW_FIMC1 should be set on Native Window usage */
@@ -651,8 +653,10 @@ OMX_ERRORTYPE WmvCodecStop(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex)
 
         pOutbufOps->Stop(hMFCHandle);
 
+        /* on a seek the same buffers come back, keep their registration */
         if ((pOutputPort->bufferProcessType & BUFFER_SHARE) &&
-            (pOutputPort->bDynamicDPBMode == OMX_TRUE))
+            (pOutputPort->bDynamicDPBMode == OMX_TRUE) &&
+            (pVideoDec->bSeekFlush == OMX_FALSE))
             pOutbufOps->Clear_RegisteredBuffer(hMFCHandle);
     }
 
@@ -1851,8 +1855,7 @@ OMX_ERRORTYPE Exynos_WmvDec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pWmvDec->bDestinationStart = OMX_FALSE;
     Exynos_OSAL_SignalCreate(&pWmvDec->hDestinationStartEvent);
 
-    Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
-    Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
+    Exynos_OMX_VdecTimestampReset(&pVideoDec->timestampMap);
     pWmvDec->hMFCWmvHandle.indexTimestamp = 0;
     pWmvDec->hMFCWmvHandle.outputIndexTimestamp = 0;
     /* Default WMV codec format is set as VC1*/
@@ -2004,12 +2007,15 @@ OMX_ERRORTYPE Exynos_WmvDec_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_D
 
     if ((bStartCode == OMX_TRUE) ||
         ((pSrcInputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) {
-        pExynosComponent->timeStamp[pWmvDec->hMFCWmvHandle.indexTimestamp] = pSrcInputData->timeStamp;
-        pExynosComponent->nFlags[pWmvDec->hMFCWmvHandle.indexTimestamp] = pSrcInputData->nFlags;
+        Exynos_OMX_VdecTimestampInsert(&pVideoDec->timestampMap, pWmvDec->hMFCWmvHandle.indexTimestamp,
+                                       pSrcInputData->timeStamp, pSrcInputData->nFlags);
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pWmvDec->hMFCWmvHandle.indexTimestamp, pSrcInputData->nFlags);
         pDecOps->Set_FrameTag(hMFCHandle, pWmvDec->hMFCWmvHandle.indexTimestamp);
+        if ((pSrcInputData->dataLen > 0) &&
+            ((pSrcInputData->nFlags & OMX_BUFFERFLAG_CODECCONFIG) != OMX_BUFFERFLAG_CODECCONFIG))
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pWmvDec->hMFCWmvHandle.indexTimestamp);
         pWmvDec->hMFCWmvHandle.indexTimestamp++;
-        pWmvDec->hMFCWmvHandle.indexTimestamp %= MAX_TIMESTAMP;
+        pWmvDec->hMFCWmvHandle.indexTimestamp %= MAX_TIMESTAMP_TAG;
 #ifdef USE_QOS_CTRL
         if ((pVideoDec->bQosChanged == OMX_TRUE) &&
             (pDecOps->Set_QosRatio != NULL)) {
@@ -2292,7 +2298,7 @@ OMX_ERRORTYPE Exynos_WmvDec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
     }
 
     pWmvDec->hMFCWmvHandle.outputIndexTimestamp++;
-    pWmvDec->hMFCWmvHandle.outputIndexTimestamp %= MAX_TIMESTAMP;
+    pWmvDec->hMFCWmvHandle.outputIndexTimestamp %= MAX_TIMESTAMP_TAG;
 
     pDstOutputData->allocSize = pDstOutputData->dataLen = 0;
     nPlaneCnt = Exynos_GetPlaneFromPort(pExynosOutputPort);
@@ -2331,19 +2337,22 @@ OMX_ERRORTYPE Exynos_WmvDec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
     pBufferInfo->imageHeight = bufferGeometry->nFrameHeight;
     pBufferInfo->ColorFormat = Exynos_OSAL_Video2OMXFormat((int)bufferGeometry->eColorFormat);
     Exynos_OSAL_Memcpy(&pBufferInfo->PDSB, &pVideoBuffer->PDSB, sizeof(PrivateDataShareBuffer));
+    pBufferInfo->bTimestampMiss = OMX_FALSE;
 
     indexTimestamp = pDecOps->Get_FrameTag(hMFCHandle);
+    Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
     Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "out indexTimestamp: %d", indexTimestamp);
-    if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
+    if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                       &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
         if ((pExynosComponent->checkTimeStamp.needSetStartTimeStamp != OMX_TRUE) &&
             (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp != OMX_TRUE)) {
             if (indexTimestamp == INDEX_AFTER_EOS) {
                 pDstOutputData->timeStamp = 0x00;
                 pDstOutputData->nFlags = 0x00;
             } else {
-                pDstOutputData->timeStamp = pExynosComponent->timeStamp[pWmvDec->hMFCWmvHandle.outputIndexTimestamp];
-                pDstOutputData->nFlags = pExynosComponent->nFlags[pWmvDec->hMFCWmvHandle.outputIndexTimestamp];
-                Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "missing out indexTimestamp: %d", indexTimestamp);
+                /* a neighbour's timestamp would be out of order, the frame is dropped */
+                Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for out indexTimestamp: %d, frame dropped", indexTimestamp);
+                pBufferInfo->bTimestampMiss = OMX_TRUE;
             }
         } else {
             pDstOutputData->timeStamp = 0x00;
@@ -2357,16 +2366,19 @@ OMX_ERRORTYPE Exynos_WmvDec_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
         if (pVideoDec->bDTSMode == OMX_TRUE) {
             if ((pVideoBuffer->frameType == VIDEO_FRAME_I) ||
                 ((pVideoBuffer->frameType == VIDEO_FRAME_OTHERS) &&
-                    ((pExynosComponent->nFlags[indexTimestamp] & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
+                    ((pDstOutputData->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS)) ||
                 (pExynosComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE))
                 pWmvDec->hMFCWmvHandle.outputIndexTimestamp = indexTimestamp;
-            else
+            else {
                 indexTimestamp = pWmvDec->hMFCWmvHandle.outputIndexTimestamp;
+                if (Exynos_OMX_VdecTimestampLookup(&pVideoDec->timestampMap, indexTimestamp,
+                                                   &pDstOutputData->timeStamp, &pDstOutputData->nFlags) != OMX_TRUE) {
+                    Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "no timestamp for reordered indexTimestamp: %d, frame dropped", indexTimestamp);
+                    pBufferInfo->bTimestampMiss = OMX_TRUE;
+                }
+            }
         }
 
-        pDstOutputData->timeStamp = pExynosComponent->timeStamp[indexTimestamp];
-        pDstOutputData->nFlags = pExynosComponent->nFlags[indexTimestamp];
-
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "timestamp %lld us (%.2f secs), indexTimestamp: %d, nFlags: 0x%x", pDstOutputData->timeStamp, pDstOutputData->timeStamp / 1E6, indexTimestamp, pDstOutputData->nFlags);
     }
 
@@ -3,6 +3,7 @@ include $(CLEAR_VARS)
 
 LOCAL_SRC_FILES := \
 	Exynos_OMX_VencControl.c \
+	Exynos_OMX_VencRateControl.c \
 	Exynos_OMX_Venc.c
 
 LOCAL_MODULE := libExynosOMX_Venc
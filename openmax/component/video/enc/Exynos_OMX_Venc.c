@@ -32,12 +32,14 @@
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
+#include "Exynos_OMX_VencRateControl.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_ETC.h"
+#include "Exynos_OSAL_Latency.h"
 #include "ExynosVideoApi.h"
 #include "csc.h"
 
@@ -363,6 +365,7 @@ OMX_BOOL Exynos_CSC_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
     CODEC_ENC_BUFFER              *codecInputBuffer = (CODEC_ENC_BUFFER *)srcInputData->pPrivate;
     OMX_COLOR_FORMATTYPE           eColorFormat     = exynosInputPort->portDefinition.format.video.eColorFormat;
     OMX_COLOR_FORMATTYPE           inputColorFormat = OMX_COLOR_FormatUnused;
+    OMX_U64                        cscStartTime     = 0;
 
     FunctionIn();
 
@@ -581,7 +584,9 @@ OMX_BOOL Exynos_CSC_InputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_DATA
         pVideoEnc->csc_handle,  /* handle */
         pDstBuf,
         csc_memType);           /* YUV Addr or FD */
+    cscStartTime = Exynos_OSAL_GetMonotonicTime();
     cscRet = csc_convert(pVideoEnc->csc_handle);
+    Exynos_OSAL_LatencyRecord(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CSC, cscStartTime);
     if (cscRet != CSC_ErrorNone)
         ret = OMX_FALSE;
     else
@@ -885,6 +890,7 @@ OMX_BOOL Exynos_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_
                     Exynos_OSAL_SetDataLengthToMetaData(outputUseBuffer->bufferHeader->pBuffer, outputUseBuffer->remainDataLen);
                 Exynos_OutputBufferReturn(pOMXComponent, outputUseBuffer);
             } else {
+                Exynos_OMX_ClearBufferInOMX(exynosOutputPort, outputUseBuffer->bufferHeader);
                 Exynos_OMX_FillThisBuffer(pOMXComponent, outputUseBuffer->bufferHeader);
             }
         }
@@ -1427,26 +1433,38 @@ OMX_ERRORTYPE Exynos_OMX_BufferProcess_Create(OMX_HANDLETYPE hComponent)
     OMX_COMPONENTTYPE     *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
     EXYNOS_OMX_BASECOMPONENT *pExynosComponent = (EXYNOS_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
     EXYNOS_OMX_VIDEOENC_COMPONENT *pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OSAL_THREAD_ATTR  threadAttr;
 
     FunctionIn();
 
     pVideoEnc->bExitBufferProcessThread = OMX_FALSE;
 
-    ret = Exynos_OSAL_ThreadCreate(&pVideoEnc->hDstOutputThread,
+    Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_DST_OUTPUT, &threadAttr);
+    ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoEnc->hDstOutputThread,
                  Exynos_OMX_DstOutputProcessThread,
-                 pOMXComponent);
-    if (ret == OMX_ErrorNone)
-        ret = Exynos_OSAL_ThreadCreate(&pVideoEnc->hSrcOutputThread,
+                 pOMXComponent,
+                 &threadAttr);
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_SRC_OUTPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoEnc->hSrcOutputThread,
                      Exynos_OMX_SrcOutputProcessThread,
-                     pOMXComponent);
-    if (ret == OMX_ErrorNone)
-        ret = Exynos_OSAL_ThreadCreate(&pVideoEnc->hDstInputThread,
+                     pOMXComponent,
+                     &threadAttr);
+    }
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_DST_INPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoEnc->hDstInputThread,
                      Exynos_OMX_DstInputProcessThread,
-                     pOMXComponent);
-    if (ret == OMX_ErrorNone)
-        ret = Exynos_OSAL_ThreadCreate(&pVideoEnc->hSrcInputThread,
+                     pOMXComponent,
+                     &threadAttr);
+    }
+    if (ret == OMX_ErrorNone) {
+        Exynos_OMX_GetThreadAttr(pExynosComponent, EXYNOS_OMX_THREAD_SRC_INPUT, &threadAttr);
+        ret = Exynos_OSAL_ThreadCreateWithAttr(&pVideoEnc->hSrcInputThread,
                      Exynos_OMX_SrcInputProcessThread,
-                     pOMXComponent);
+                     pOMXComponent,
+                     &threadAttr);
+    }
 
 EXIT:
     FunctionOut();
@@ -1571,6 +1589,16 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeComponentInit(OMX_IN OMX_HANDLETYPE hCompone
     pVideoEnc->quantization.nQpP = 5; // P frame quantization parameter
     pVideoEnc->quantization.nQpB = 5; // B frame quantization parameter
 
+    ret = Exynos_OMX_VencRateControlInit(pExynosComponent);
+    if (ret != OMX_ErrorNone) {
+        Exynos_OSAL_Free(pVideoEnc);
+        pExynosComponent->hComponentHandle = NULL;
+        Exynos_OMX_Port_Destructor(pOMXComponent);
+        Exynos_OMX_BaseComponent_Destructor(pOMXComponent);
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "OMX_Error, Line:%d", __LINE__);
+        goto EXIT;
+    }
+
     pExynosComponent->bMultiThreadProcess = OMX_TRUE;
 
     /* Input port */
@@ -1699,6 +1727,8 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeComponentDeinit(OMX_IN OMX_HANDLETYPE hCompo
 
     pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
 
+    Exynos_OMX_VencRateControlDeinit(pExynosComponent);
+
     Exynos_OSAL_Free(pVideoEnc);
     pExynosComponent->hComponentHandle = pVideoEnc = NULL;
 
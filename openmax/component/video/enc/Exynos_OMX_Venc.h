@@ -85,6 +85,27 @@ typedef struct _CODEC_ENC_BUFFER
     int             dataSize;                     /* total data length */
 } CODEC_ENC_BUFFER;
 
+typedef struct _EXYNOS_OMX_VIDEOENC_RATECONTROL
+{
+    OMX_HANDLETYPE hLock;
+
+    OMX_BOOL bEnable;
+    OMX_U32  nVbvSizeMs;
+    OMX_U32  nMaxSkipFrames;
+
+    OMX_S64  nVbvFullness;      /* bits */
+    OMX_U32  nSkipFrames;       /* consecutive frames skipped so far */
+
+    /* what the codec was told last, 0 means unknown */
+    OMX_U32  nCodecBitrate;
+    OMX_U32  nCodecMinQP;
+    OMX_U32  nCodecMaxQP;
+
+    /* per frame hints from OMX_IndexConfigVideoFrameQP */
+    OMX_U32  nFrameQP;
+    OMX_BOOL bFrameSkip;
+} EXYNOS_OMX_VIDEOENC_RATECONTROL;
+
 typedef struct _EXYNOS_OMX_VIDEOENC_COMPONENT
 {
     OMX_HANDLETYPE hCodecHandle;
@@ -114,6 +135,7 @@ typedef struct _EXYNOS_OMX_VIDEOENC_COMPONENT
     OMX_VIDEO_QPRANGETYPE            qpRange;
     OMX_VIDEO_PARAM_QUANTIZATIONTYPE quantization;
     OMX_VIDEO_PARAM_INTRAREFRESHTYPE intraRefresh;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL  rateControl;
 
     OMX_BOOL bFirstInput;
     OMX_BOOL bFirstOutput;
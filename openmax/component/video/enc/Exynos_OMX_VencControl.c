@@ -31,12 +31,14 @@
 #include "Exynos_OSAL_Event.h"
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
+#include "Exynos_OMX_VencRateControl.h"
 #include "Exynos_OMX_Basecomponent.h"
 #include "Exynos_OSAL_Thread.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Mutex.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_SharedMemory.h"
+#include "Exynos_OSAL_Latency.h"
 
 #ifdef USE_METADATABUFFERTYPE
 #include "Exynos_OSAL_Android.h"
@@ -109,6 +111,7 @@ OMX_ERRORTYPE Exynos_OMX_UseBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = pTempBufferHdr;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ASSIGNED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(pTempBufferHdr, OMX_BUFFERHEADERTYPE);
             pTempBufferHdr->pBuffer        = pBuffer;
@@ -246,6 +249,7 @@ OMX_ERRORTYPE Exynos_OMX_AllocateBuffer(
     for (i = 0; i < pExynosPort->portDefinition.nBufferCountActual; i++) {
         if (pExynosPort->bufferStateAllocate[i] == BUFFER_STATE_FREE) {
             pExynosPort->extendBufferHeader[i].OMXBufferHeader = pTempBufferHdr;
+            pExynosPort->extendBufferHeader[i].bBufferInOMX = OMX_FALSE;
             pExynosPort->extendBufferHeader[i].buf_fd[0] = fdTempBuffer;
             pExynosPort->bufferStateAllocate[i] = (BUFFER_STATE_ALLOCATED | HEADER_STATE_ALLOCATED);
             INIT_SET_SIZE_VERSION(pTempBufferHdr, OMX_BUFFERHEADERTYPE);
@@ -523,7 +527,7 @@ OMX_ERRORTYPE Exynos_OMX_FlushPort(
                 Exynos_OMX_InputBufferReturn(pOMXComponent, pBufferHdr);
             }
         }
-        Exynos_OSAL_Free(pMessage);
+        Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
         pMessage = NULL;
     }
 
@@ -703,6 +707,7 @@ OMX_ERRORTYPE Exynos_OMX_BufferFlush(
         if (nPortIndex == INPUT_PORT_INDEX) {
             pExynosComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
             pExynosComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
+            Exynos_OSAL_LatencyCancel(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC);
             Exynos_OSAL_Memset(pExynosComponent->timeStamp, -19771003, sizeof(OMX_TICKS) * MAX_TIMESTAMP);
             Exynos_OSAL_Memset(pExynosComponent->nFlags, 0, sizeof(OMX_U32) * MAX_FLAGS);
             pExynosComponent->getAllDelayBuffer = OMX_FALSE;
@@ -829,7 +834,7 @@ OMX_ERRORTYPE Exynos_InputBufferGetQueue(
                 goto EXIT;
             }
             if (pMessage->messageType == EXYNOS_OMX_CommandFakeBuffer) {
-                Exynos_OSAL_Free(pMessage);
+                Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
                 ret = OMX_ErrorCodecFlush;
                 goto EXIT;
             }
@@ -843,7 +848,7 @@ OMX_ERRORTYPE Exynos_InputBufferGetQueue(
             pDataBuffer->nFlags        = pDataBuffer->bufferHeader->nFlags;
             pDataBuffer->timeStamp     = pDataBuffer->bufferHeader->nTimeStamp;
 
-            Exynos_OSAL_Free(pMessage);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
 
             if (pDataBuffer->allocSize <= pDataBuffer->dataLen)
                 Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "Input Buffer Full, Check input buffer size! allocSize:%d, dataLen:%d", pDataBuffer->allocSize, pDataBuffer->dataLen);
@@ -958,7 +963,7 @@ OMX_ERRORTYPE Exynos_OutputBufferGetQueue(
                 goto EXIT;
             }
             if (pMessage->messageType == EXYNOS_OMX_CommandFakeBuffer) {
-                Exynos_OSAL_Free(pMessage);
+                Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
                 ret = OMX_ErrorCodecFlush;
                 goto EXIT;
             }
@@ -979,7 +984,7 @@ OMX_ERRORTYPE Exynos_OutputBufferGetQueue(
                 pExynosPort->processData.allocSize  = pDataBuffer->bufferHeader->nAllocLen;
             }
 */
-            Exynos_OSAL_Free(pMessage);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
         }
         ret = OMX_ErrorNone;
     }
@@ -1017,13 +1022,13 @@ OMX_BUFFERHEADERTYPE *Exynos_OutputBufferGetQueue_Direct(
             goto EXIT;
         }
         if (pMessage->messageType == EXYNOS_OMX_CommandFakeBuffer) {
-            Exynos_OSAL_Free(pMessage);
+            Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
             pBufferHdr = NULL;
             goto EXIT;
         }
 
         pBufferHdr  = (OMX_BUFFERHEADERTYPE *)(pMessage->pCmdData);
-        Exynos_OSAL_Free(pMessage);
+        Exynos_OMX_ReleaseBufferMessage(pExynosPort, pMessage);
     }
 
 EXIT:
@@ -1767,6 +1772,50 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeGetConfig(
         pQpRange->videoMaxQP = pVideoEnc->qpRange.videoMaxQP;
     }
         break;
+    case OMX_IndexConfigVideoRateControl:
+    {
+        EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL *pConfigRC  = (EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL *)pComponentConfigStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT       *pVideoEnc  = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pConfigRC, sizeof(EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pConfigRC->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        Exynos_OSAL_MutexLock(pVideoEnc->rateControl.hLock);
+        pConfigRC->bEnable        = pVideoEnc->rateControl.bEnable;
+        pConfigRC->nVbvSizeMs     = pVideoEnc->rateControl.nVbvSizeMs;
+        pConfigRC->nMaxSkipFrames = pVideoEnc->rateControl.nMaxSkipFrames;
+        Exynos_OSAL_MutexUnlock(pVideoEnc->rateControl.hLock);
+        pConfigRC->nVbvFullness   = Exynos_OMX_VencRateControlFullness(pExynosComponent);
+    }
+        break;
+    case OMX_IndexConfigVideoFrameQP:
+    {
+        EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP *pFrameQP  = (EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP *)pComponentConfigStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pFrameQP, sizeof(EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pFrameQP->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        Exynos_OSAL_MutexLock(pVideoEnc->rateControl.hLock);
+        pFrameQP->nQP   = pVideoEnc->rateControl.nFrameQP;
+        pFrameQP->bSkip = pVideoEnc->rateControl.bFrameSkip;
+        Exynos_OSAL_MutexUnlock(pVideoEnc->rateControl.hLock);
+    }
+        break;
     default:
     {
         ret = Exynos_OMX_GetConfig(hComponent, nParamIndex, pComponentConfigStructure);
@@ -1907,6 +1956,73 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeSetConfig(
         pVideoEnc->qpRange.videoMaxQP = pQpRange->videoMaxQP;
     }
         break;
+    case OMX_IndexConfigVideoRateControl:
+    {
+        EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL *pConfigRC    = (EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL *)pComponentConfigStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT       *pVideoEnc    = NULL;
+        EXYNOS_OMX_VIDEOENC_RATECONTROL     *pRateControl = NULL;
+        OMX_BOOL                             bWasEnabled  = OMX_FALSE;
+
+        ret = Exynos_OMX_Check_SizeVersion(pConfigRC, sizeof(EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pConfigRC->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        if (((pConfigRC->nVbvSizeMs != 0) &&
+             ((pConfigRC->nVbvSizeMs < RATECONTROL_MIN_VBV_SIZE_MS) ||
+              (pConfigRC->nVbvSizeMs > RATECONTROL_MAX_VBV_SIZE_MS))) ||
+            (pConfigRC->nMaxSkipFrames > RATECONTROL_MAX_SKIP_FRAMES)) {
+            ret = OMX_ErrorBadParameter;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        pRateControl = &pVideoEnc->rateControl;
+
+        Exynos_OSAL_MutexLock(pRateControl->hLock);
+        bWasEnabled = pRateControl->bEnable;
+        pRateControl->bEnable        = pConfigRC->bEnable;
+        pRateControl->nVbvSizeMs     = (pConfigRC->nVbvSizeMs != 0) ? pConfigRC->nVbvSizeMs : RATECONTROL_DEFAULT_VBV_SIZE_MS;
+        pRateControl->nMaxSkipFrames = pConfigRC->nMaxSkipFrames;
+        Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+
+        if ((bWasEnabled == OMX_FALSE) && (pConfigRC->bEnable == OMX_TRUE))
+            Exynos_OMX_VencRateControlReset(pExynosComponent);
+    }
+        break;
+    case OMX_IndexConfigVideoFrameQP:
+    {
+        EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP *pFrameQP     = (EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP *)pComponentConfigStructure;
+        EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc    = NULL;
+        EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl = NULL;
+
+        ret = Exynos_OMX_Check_SizeVersion(pFrameQP, sizeof(EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP));
+        if (ret != OMX_ErrorNone)
+            goto EXIT;
+
+        if (pFrameQP->nPortIndex != OUTPUT_PORT_INDEX) {
+            ret = OMX_ErrorBadPortIndex;
+            goto EXIT;
+        }
+
+        if (Exynos_OMX_VencRateControlCheckQP(pExynosComponent, pFrameQP->nQP) != OMX_TRUE) {
+            ret = OMX_ErrorBadParameter;
+            goto EXIT;
+        }
+
+        pVideoEnc = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+        pRateControl = &pVideoEnc->rateControl;
+
+        Exynos_OSAL_MutexLock(pRateControl->hLock);
+        pRateControl->nFrameQP   = pFrameQP->nQP;
+        pRateControl->bFrameSkip = pFrameQP->bSkip;
+        Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+    }
+        break;
     default:
     {
         ret = Exynos_OMX_SetConfig(hComponent, nParamIndex, pComponentConfigStructure);
@@ -1997,6 +2113,18 @@ OMX_ERRORTYPE Exynos_OMX_VideoEncodeGetExtensionIndex(
         goto EXIT;
     }
 
+    if (Exynos_OSAL_Strcmp(szParamName, EXYNOS_INDEX_CONFIG_VIDEO_RATECONTROL) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexConfigVideoRateControl;
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
+    if (Exynos_OSAL_Strcmp(szParamName, EXYNOS_INDEX_CONFIG_VIDEO_FRAMEQP) == 0) {
+        *pIndexType = (OMX_INDEXTYPE) OMX_IndexConfigVideoFrameQP;
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
     ret = Exynos_OMX_GetExtensionIndex(hComponent, szParamName, pIndexType);
 
 EXIT:
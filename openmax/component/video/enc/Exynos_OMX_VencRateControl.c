@@ -0,0 +1,312 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OMX_VencRateControl.c
+ * @brief       host side rate control for the MFC encoders
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+/*
+ * The MFC rate control only sees its own GOP window, so a burst of large
+ * frames on a low latency link shows up as delay long before the firmware
+ * reacts. This keeps a leaky bucket of the bits actually produced against the
+ * port bitrate and, per input frame, pulls the codec bitrate down, raises the
+ * QP floor and finally skips frames as the bucket fills. The same hook applies
+ * the one shot QP and skip hints given through OMX_IndexConfigVideoFrameQP.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Exynos_OMX_Macros.h"
+#include "Exynos_OMX_Venc.h"
+#include "Exynos_OMX_VencRateControl.h"
+#include "Exynos_OSAL_Mutex.h"
+
+#define EXYNOS_LOG_TAG    "EXYNOS_VIDEO_ENC_RC"
+#define EXYNOS_LOG_OFF
+//#define EXYNOS_TRACE_ON
+#include "Exynos_OSAL_Log.h"
+
+/* fullness, in percent of the virtual buffer, where each action starts */
+#define RATECONTROL_BITRATE_LEVEL   50
+#define RATECONTROL_QP_LEVEL        75
+#define RATECONTROL_SKIP_LEVEL      100
+
+/* bitrate changes smaller than 1/20 of the target are not worth an ioctl */
+#define RATECONTROL_BITRATE_STEP    20
+
+static OMX_S64 Exynos_RateControl_VbvSize(
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl,
+    OMX_U32                          nTargetBitrate)
+{
+    return ((OMX_S64)nTargetBitrate * pRateControl->nVbvSizeMs) / 1000;
+}
+
+static OMX_U32 Exynos_RateControl_Level(
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl,
+    OMX_U32                          nTargetBitrate)
+{
+    OMX_S64 nVbvSize = Exynos_RateControl_VbvSize(pRateControl, nTargetBitrate);
+
+    if (nVbvSize <= 0)
+        return 0;
+
+    return (OMX_U32)((pRateControl->nVbvFullness * 100) / nVbvSize);
+}
+
+OMX_ERRORTYPE Exynos_OMX_VencRateControlInit(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc    = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl = &pVideoEnc->rateControl;
+
+    Exynos_OSAL_Memset(pRateControl, 0, sizeof(EXYNOS_OMX_VIDEOENC_RATECONTROL));
+    pRateControl->bEnable    = OMX_FALSE;
+    pRateControl->nVbvSizeMs = RATECONTROL_DEFAULT_VBV_SIZE_MS;
+
+    return Exynos_OSAL_MutexCreate(&pRateControl->hLock);
+}
+
+void Exynos_OMX_VencRateControlDeinit(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc    = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl = &pVideoEnc->rateControl;
+
+    if (pRateControl->hLock != NULL) {
+        Exynos_OSAL_MutexTerminate(pRateControl->hLock);
+        pRateControl->hLock = NULL;
+    }
+}
+
+/* start over with an empty virtual buffer, called when rate control is enabled */
+void Exynos_OMX_VencRateControlReset(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc    = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl = &pVideoEnc->rateControl;
+
+    Exynos_OSAL_MutexLock(pRateControl->hLock);
+    pRateControl->nVbvFullness = 0;
+    pRateControl->nSkipFrames  = 0;
+    Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+}
+
+/* the codec was reconfigured behind our back, send everything again */
+void Exynos_OMX_VencRateControlInvalidate(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc    = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl = &pVideoEnc->rateControl;
+
+    Exynos_OSAL_MutexLock(pRateControl->hLock);
+    pRateControl->nCodecBitrate = 0;
+    pRateControl->nCodecMinQP   = 0;
+    pRateControl->nCodecMaxQP   = 0;
+    Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+}
+
+/* called for every input frame before it is queued to the codec */
+void Exynos_OMX_VencRateControlApply(
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent,
+    ExynosVideoEncOps        *pEncOps,
+    void                     *hMFCHandle)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc         = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl      = &pVideoEnc->rateControl;
+    EXYNOS_OMX_BASEPORT             *pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+
+    OMX_U32  nTargetBitrate = pExynosOutputPort->portDefinition.format.video.nBitrate;
+    OMX_U32  nUserMinQP     = pVideoEnc->qpRange.videoMinQP;
+    OMX_U32  nUserMaxQP     = pVideoEnc->qpRange.videoMaxQP;
+    OMX_U32  nBitrate       = nTargetBitrate;
+    OMX_U32  nMinQP         = nUserMinQP;
+    OMX_U32  nMaxQP         = nUserMaxQP;
+    OMX_U32  nLevel         = 0;
+    OMX_U32  nStep          = 0;
+    OMX_BOOL bSkip          = OMX_FALSE;
+
+    FunctionIn();
+
+    Exynos_OSAL_MutexLock(pRateControl->hLock);
+
+    /* nothing to do while the codec runs on what the client configured */
+    if ((pRateControl->bEnable == OMX_FALSE) &&
+        (pRateControl->nFrameQP == 0) &&
+        (pRateControl->bFrameSkip == OMX_FALSE) &&
+        (pRateControl->nCodecBitrate == 0) &&
+        (pRateControl->nCodecMinQP == 0) &&
+        (pRateControl->nCodecMaxQP == 0))
+        goto EXIT;
+
+    if (pRateControl->bEnable == OMX_TRUE) {
+        nLevel = Exynos_RateControl_Level(pRateControl, nTargetBitrate);
+
+        /* take up to half of the bitrate away as the buffer fills */
+        if (nLevel > RATECONTROL_BITRATE_LEVEL) {
+            nStep = nLevel - RATECONTROL_BITRATE_LEVEL;
+            if (nStep > 50)
+                nStep = 50;
+            nBitrate = nTargetBitrate - (OMX_U32)(((OMX_U64)nTargetBitrate * nStep) / 100);
+        }
+
+        /* then move the QP floor toward the ceiling */
+        if ((nLevel > RATECONTROL_QP_LEVEL) && (nUserMaxQP > nUserMinQP)) {
+            nStep = nLevel - RATECONTROL_QP_LEVEL;
+            if (nStep > 50)
+                nStep = 50;
+            nMinQP = nUserMinQP + ((nUserMaxQP - nUserMinQP) * nStep) / 50;
+        }
+
+        /* and drop frames while it overflows */
+        if ((nLevel >= RATECONTROL_SKIP_LEVEL) &&
+            (pRateControl->nSkipFrames < pRateControl->nMaxSkipFrames))
+            bSkip = OMX_TRUE;
+    }
+
+    if (pRateControl->nFrameQP != 0) {
+        nMinQP = pRateControl->nFrameQP;
+        nMaxQP = pRateControl->nFrameQP;
+        pRateControl->nFrameQP = 0;
+    }
+
+    if (pRateControl->bFrameSkip == OMX_TRUE) {
+        bSkip = OMX_TRUE;
+        pRateControl->bFrameSkip = OMX_FALSE;
+    }
+
+    nStep = (nBitrate > pRateControl->nCodecBitrate) ?
+                (nBitrate - pRateControl->nCodecBitrate) : (pRateControl->nCodecBitrate - nBitrate);
+    if ((nBitrate != pRateControl->nCodecBitrate) &&
+        ((pRateControl->nCodecBitrate == 0) ||
+         (nBitrate == nTargetBitrate) ||
+         (nStep >= (nTargetBitrate / RATECONTROL_BITRATE_STEP)))) {
+        if (pEncOps->Set_BitRate(hMFCHandle, nBitrate) == VIDEO_ERROR_NONE)
+            pRateControl->nCodecBitrate = nBitrate;
+    }
+
+    if ((nMinQP != pRateControl->nCodecMinQP) ||
+        (nMaxQP != pRateControl->nCodecMaxQP)) {
+        if (pEncOps->Set_QpRange(hMFCHandle, nMinQP, nMaxQP) == VIDEO_ERROR_NONE) {
+            pRateControl->nCodecMinQP = nMinQP;
+            pRateControl->nCodecMaxQP = nMaxQP;
+        }
+    }
+
+    if (bSkip == OMX_TRUE) {
+        pEncOps->Set_FrameType(hMFCHandle, VIDEO_FRAME_SKIPPED);
+        pRateControl->nSkipFrames++;
+    } else {
+        pRateControl->nSkipFrames = 0;
+    }
+
+    /* back on the client's settings, stop tracking */
+    if ((pRateControl->bEnable == OMX_FALSE) &&
+        (pRateControl->nCodecBitrate == nTargetBitrate) &&
+        (pRateControl->nCodecMinQP == nUserMinQP) &&
+        (pRateControl->nCodecMaxQP == nUserMaxQP)) {
+        pRateControl->nCodecBitrate = 0;
+        pRateControl->nCodecMinQP   = 0;
+        pRateControl->nCodecMaxQP   = 0;
+    }
+
+    Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "rate control: level %d%%, bitrate %d, qp %d~%d, skip %d",
+                    nLevel, nBitrate, nMinQP, nMaxQP, bSkip);
+
+EXIT:
+    Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+
+    FunctionOut();
+
+    return;
+}
+
+/* called for every encoded frame with its size in bytes */
+void Exynos_OMX_VencRateControlUpdate(
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent,
+    OMX_U32                   nFrameSize)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc         = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl      = &pVideoEnc->rateControl;
+    EXYNOS_OMX_BASEPORT             *pExynosInputPort  = &pExynosComponent->pExynosPort[INPUT_PORT_INDEX];
+    EXYNOS_OMX_BASEPORT             *pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+
+    OMX_U32 nTargetBitrate = pExynosOutputPort->portDefinition.format.video.nBitrate;
+    OMX_U32 nFrameRate     = pExynosInputPort->portDefinition.format.video.xFramerate >> 16;
+    OMX_S64 nVbvSize       = 0;
+
+    if (nFrameRate == 0)
+        nFrameRate = 30;
+
+    Exynos_OSAL_MutexLock(pRateControl->hLock);
+
+    if (pRateControl->bEnable == OMX_FALSE) {
+        Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+        return;
+    }
+
+    /* the link drains one frame worth of target bitrate per frame */
+    pRateControl->nVbvFullness += (OMX_S64)nFrameSize * 8;
+    pRateControl->nVbvFullness -= nTargetBitrate / nFrameRate;
+    if (pRateControl->nVbvFullness < 0)
+        pRateControl->nVbvFullness = 0;
+
+    /* bound the backlog so recovery after a scene cut stays short */
+    nVbvSize = Exynos_RateControl_VbvSize(pRateControl, nTargetBitrate);
+    if (pRateControl->nVbvFullness > (nVbvSize * 2))
+        pRateControl->nVbvFullness = nVbvSize * 2;
+
+    Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+}
+
+OMX_U32 Exynos_OMX_VencRateControlFullness(EXYNOS_OMX_BASECOMPONENT *pExynosComponent)
+{
+    EXYNOS_OMX_VIDEOENC_COMPONENT   *pVideoEnc         = (EXYNOS_OMX_VIDEOENC_COMPONENT *)pExynosComponent->hComponentHandle;
+    EXYNOS_OMX_VIDEOENC_RATECONTROL *pRateControl      = &pVideoEnc->rateControl;
+    EXYNOS_OMX_BASEPORT             *pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+    OMX_U32                          nLevel            = 0;
+
+    Exynos_OSAL_MutexLock(pRateControl->hLock);
+    nLevel = Exynos_RateControl_Level(pRateControl, pExynosOutputPort->portDefinition.format.video.nBitrate);
+    Exynos_OSAL_MutexUnlock(pRateControl->hLock);
+
+    return nLevel;
+}
+
+/* nQP of a FrameQP hint, 0 is always allowed and means no hint */
+OMX_BOOL Exynos_OMX_VencRateControlCheckQP(
+    EXYNOS_OMX_BASECOMPONENT *pExynosComponent,
+    OMX_U32                   nQP)
+{
+    EXYNOS_OMX_BASEPORT *pExynosOutputPort = &pExynosComponent->pExynosPort[OUTPUT_PORT_INDEX];
+
+    if (nQP == 0)
+        return OMX_TRUE;
+
+    switch ((int)pExynosOutputPort->portDefinition.format.video.eCompressionFormat) {
+    case OMX_VIDEO_CodingAVC:
+        return (nQP <= 51) ? OMX_TRUE : OMX_FALSE;
+    case OMX_VIDEO_CodingMPEG4:
+    case OMX_VIDEO_CodingH263:
+        return (nQP <= 31) ? OMX_TRUE : OMX_FALSE;
+    case OMX_VIDEO_CodingVP8:
+        return (nQP <= 127) ? OMX_TRUE : OMX_FALSE;
+    default:
+        return OMX_FALSE;
+    }
+}
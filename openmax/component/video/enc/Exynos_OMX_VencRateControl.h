@@ -0,0 +1,57 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OMX_VencRateControl.h
+ * @brief       host side rate control for the MFC encoders
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+#ifndef EXYNOS_OMX_VIDEO_ENCODE_RATECONTROL
+#define EXYNOS_OMX_VIDEO_ENCODE_RATECONTROL
+
+#include "OMX_Component.h"
+#include "Exynos_OMX_Def.h"
+#include "Exynos_OMX_Basecomponent.h"
+#include "ExynosVideoApi.h"
+
+#define RATECONTROL_DEFAULT_VBV_SIZE_MS     500
+#define RATECONTROL_MIN_VBV_SIZE_MS         100
+#define RATECONTROL_MAX_VBV_SIZE_MS         10000
+#define RATECONTROL_MAX_SKIP_FRAMES         30
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+OMX_ERRORTYPE Exynos_OMX_VencRateControlInit(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+void Exynos_OMX_VencRateControlDeinit(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+void Exynos_OMX_VencRateControlReset(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+void Exynos_OMX_VencRateControlInvalidate(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+void Exynos_OMX_VencRateControlApply(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, ExynosVideoEncOps *pEncOps, void *hMFCHandle);
+void Exynos_OMX_VencRateControlUpdate(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nFrameSize);
+OMX_U32 Exynos_OMX_VencRateControlFullness(EXYNOS_OMX_BASECOMPONENT *pExynosComponent);
+OMX_BOOL Exynos_OMX_VencRateControlCheckQP(EXYNOS_OMX_BASECOMPONENT *pExynosComponent, OMX_U32 nQP);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
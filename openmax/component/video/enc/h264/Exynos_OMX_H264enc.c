@@ -33,6 +33,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
+#include "Exynos_OMX_VencRateControl.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -40,6 +41,7 @@
 #include "Exynos_OMX_H264enc.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 #ifdef USE_ANDROID
 #include "Exynos_OSAL_Android.h"
@@ -1839,8 +1841,12 @@ OMX_ERRORTYPE Exynos_H264Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
         ret = H264CodecDstSetup(pOMXComponent);
     }
 
+    if (pSrcInputData->dataLen > 0)
+        Exynos_OMX_VencRateControlApply(pExynosComponent, pEncOps, hMFCHandle);
+
     if (pVideoEnc->configChange == OMX_TRUE) {
         Change_H264Enc_Param(pExynosComponent);
+        Exynos_OMX_VencRateControlInvalidate(pExynosComponent);
         pVideoEnc->configChange = OMX_FALSE;
     }
 
@@ -1853,6 +1859,8 @@ OMX_ERRORTYPE Exynos_H264Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX_
         pExynosComponent->nFlags[pH264Enc->hMFCH264Handle.indexTimestamp] = pSrcInputData->nFlags;
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pH264Enc->hMFCH264Handle.indexTimestamp, pSrcInputData->nFlags);
         pEncOps->Set_FrameTag(hMFCHandle, pH264Enc->hMFCH264Handle.indexTimestamp);
+        if (pSrcInputData->dataLen > 0)
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pH264Enc->hMFCH264Handle.indexTimestamp);
         pH264Enc->hMFCH264Handle.indexTimestamp++;
         pH264Enc->hMFCH264Handle.indexTimestamp %= MAX_TIMESTAMP;
 
@@ -2135,6 +2143,7 @@ OMX_ERRORTYPE Exynos_H264Enc_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         pVideoEnc->bFirstOutput = OMX_TRUE;
     } else {
         indexTimestamp = pEncOps->Get_FrameTag(pH264Enc->hMFCH264Handle.hMFCHandle);
+        Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
         if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[pH264Enc->hMFCH264Handle.outputIndexTimestamp];
             pDstOutputData->nFlags = pExynosComponent->nFlags[pH264Enc->hMFCH264Handle.outputIndexTimestamp];
@@ -2146,6 +2155,8 @@ OMX_ERRORTYPE Exynos_H264Enc_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         pDstOutputData->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
         if (pVideoBuffer->frameType == VIDEO_FRAME_I)
             pDstOutputData->nFlags |= OMX_BUFFERFLAG_SYNCFRAME;
+
+        Exynos_OMX_VencRateControlUpdate(pExynosComponent, pDstOutputData->dataLen);
     }
 
     if ((displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) ||
@@ -33,6 +33,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
+#include "Exynos_OMX_VencRateControl.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -40,6 +41,7 @@
 #include "Exynos_OMX_Mpeg4enc.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 /* To use CSC_METHOD_HW in EXYNOS OMX, gralloc should allocate physical memory using FIMC */
 /* It means GRALLOC_USAGE_HW_FIMC1 should be set on Native Window usage */
@@ -1976,12 +1978,16 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         ret = Mpeg4CodecDstSetup(pOMXComponent);
     }
 
+    if (pSrcInputData->dataLen > 0)
+        Exynos_OMX_VencRateControlApply(pExynosComponent, pEncOps, hMFCHandle);
+
     if (pVideoEnc->configChange == OMX_TRUE) {
         if (pMpeg4Enc->hMFCMpeg4Handle.codecType == CODEC_TYPE_MPEG4)
             Change_Mpeg4Enc_Param(pExynosComponent);
         else
             Change_H263Enc_Param(pExynosComponent);
 
+        Exynos_OMX_VencRateControlInvalidate(pExynosComponent);
         pVideoEnc->configChange = OMX_FALSE;
     }
 
@@ -1994,6 +2000,8 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_SrcIn(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OMX
         pExynosComponent->nFlags[pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp] = pSrcInputData->nFlags;
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp, pSrcInputData->nFlags);
         pEncOps->Set_FrameTag(hMFCHandle, pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp);
+        if (pSrcInputData->dataLen > 0)
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp);
         pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp++;
         pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp %= MAX_TIMESTAMP;
 
@@ -2258,6 +2266,7 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
         pVideoEnc->bFirstOutput = OMX_TRUE;
     } else {
         indexTimestamp = pEncOps->Get_FrameTag(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle);
+        Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
         if ((indexTimestamp < 0) || (indexTimestamp >= MAX_TIMESTAMP)) {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[pMpeg4Enc->hMFCMpeg4Handle.outputIndexTimestamp];
             pDstOutputData->nFlags = pExynosComponent->nFlags[pMpeg4Enc->hMFCMpeg4Handle.outputIndexTimestamp];
@@ -2269,6 +2278,8 @@ OMX_ERRORTYPE Exynos_Mpeg4Enc_DstOut(OMX_COMPONENTTYPE *pOMXComponent, EXYNOS_OM
         pDstOutputData->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
         if (pVideoBuffer->frameType == VIDEO_FRAME_I)
             pDstOutputData->nFlags |= OMX_BUFFERFLAG_SYNCFRAME;
+
+        Exynos_OMX_VencRateControlUpdate(pExynosComponent, pDstOutputData->dataLen);
     }
 
     if ((displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) ||
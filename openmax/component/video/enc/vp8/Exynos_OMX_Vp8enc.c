@@ -34,6 +34,7 @@
 #include "Exynos_OMX_Baseport.h"
 #include "Exynos_OMX_Venc.h"
 #include "Exynos_OMX_VencControl.h"
+#include "Exynos_OMX_VencRateControl.h"
 #include "Exynos_OSAL_ETC.h"
 #include "Exynos_OSAL_Semaphore.h"
 #include "Exynos_OSAL_Thread.h"
@@ -41,6 +42,7 @@
 #include "Exynos_OMX_Vp8enc.h"
 #include "Exynos_OSAL_SharedMemory.h"
 #include "Exynos_OSAL_Event.h"
+#include "Exynos_OSAL_Latency.h"
 
 /* To use CSC_METHOD_HW in EXYNOS OMX, gralloc should allocate physical memory using FIMC */
 /* It means GRALLOC_USAGE_HW_FIMC1 should be set on Native Window usage */
@@ -1682,8 +1684,12 @@ OMX_ERRORTYPE Exynos_VP8Enc_SrcIn(
     if (pVp8Enc->hMFCVp8Handle.bConfiguredMFCDst == OMX_FALSE)
         ret = VP8CodecDstSetup(pOMXComponent);
 
+    if (pSrcInputData->dataLen > 0)
+        Exynos_OMX_VencRateControlApply(pExynosComponent, pEncOps, hMFCHandle);
+
     if (pVideoEnc->configChange == OMX_TRUE) {
         Change_VP8Enc_Param(pExynosComponent);
+        Exynos_OMX_VencRateControlInvalidate(pExynosComponent);
         pVideoEnc->configChange = OMX_FALSE;
     }
 
@@ -1697,6 +1703,8 @@ OMX_ERRORTYPE Exynos_VP8Enc_SrcIn(
         Exynos_OSAL_Log(EXYNOS_LOG_TRACE, "input timestamp %lld us (%.2f secs), Tag: %d, nFlags: 0x%x", pSrcInputData->timeStamp, pSrcInputData->timeStamp / 1E6, pVp8Enc->hMFCVp8Handle.indexTimestamp, pSrcInputData->nFlags);
 
         pEncOps->Set_FrameTag(hMFCHandle, pVp8Enc->hMFCVp8Handle.indexTimestamp);
+        if (pSrcInputData->dataLen > 0)
+            Exynos_OSAL_LatencyBegin(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)pVp8Enc->hMFCVp8Handle.indexTimestamp);
         pVp8Enc->hMFCVp8Handle.indexTimestamp++;
         pVp8Enc->hMFCVp8Handle.indexTimestamp %= MAX_TIMESTAMP;
 
@@ -1970,6 +1978,7 @@ OMX_ERRORTYPE Exynos_VP8Enc_DstOut(
         pVideoEnc->bFirstOutput     = OMX_TRUE;
     } else {
         indexTimestamp = pEncOps->Get_FrameTag(pVp8Enc->hMFCVp8Handle.hMFCHandle);
+        Exynos_OSAL_LatencyEnd(pExynosComponent->hLatency, INPUT_PORT_INDEX, LATENCY_STAGE_CODEC, (OMX_U64)indexTimestamp);
         if ((indexTimestamp < 0) ||
             (indexTimestamp >= MAX_TIMESTAMP)) {
             pDstOutputData->timeStamp = pExynosComponent->timeStamp[pVp8Enc->hMFCVp8Handle.outputIndexTimestamp];
@@ -1983,6 +1992,8 @@ OMX_ERRORTYPE Exynos_VP8Enc_DstOut(
 
         if (pVideoBuffer->frameType == VIDEO_FRAME_I)
             pDstOutputData->nFlags |= OMX_BUFFERFLAG_SYNCFRAME;
+
+        Exynos_OMX_VencRateControlUpdate(pExynosComponent, pDstOutputData->dataLen);
     }
 
     if ((displayStatus == VIDEO_FRAME_STATUS_CHANGE_RESOL) ||
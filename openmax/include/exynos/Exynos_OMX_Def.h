@@ -87,6 +87,8 @@ typedef enum _EXYNOS_OMX_INDEXTYPE
     OMX_IndexVendorSetDTSMode               = 0x7F000006,
 #define EXYNOS_INDEX_CONFIG_SET_QOS_RATIO "OMX.SEC.index.SetQosRatio"
     OMX_IndexVendorSetQosRatio              = 0x7F000007,
+#define EXYNOS_INDEX_PARAM_SESSION_TYPE "OMX.SEC.index.SessionType"
+    OMX_IndexVendorSessionType              = 0x7F000008,
 
     /* for Android Native Window */
 #define EXYNOS_INDEX_PARAM_ENABLE_ANB "OMX.google.android.index.enableAndroidNativeBuffers"
@@ -124,6 +126,16 @@ typedef enum _EXYNOS_OMX_INDEXTYPE
 #define EXYNOS_INDEX_CONFIG_VIDEO_QPRANGE_TYPE "OMX.SEC.indexConfig.VideoQPRange"
     OMX_IndexConfigVideoQPRange             = 0x7F000023,
 
+    /* host side rate control for low latency encoding */
+#define EXYNOS_INDEX_CONFIG_VIDEO_RATECONTROL "OMX.SEC.indexConfig.VideoRateControl"
+    OMX_IndexConfigVideoRateControl         = 0x7F000024,
+#define EXYNOS_INDEX_CONFIG_VIDEO_FRAMEQP "OMX.SEC.indexConfig.VideoFrameQP"
+    OMX_IndexConfigVideoFrameQP             = 0x7F000025,
+
+    /* decoder fast seek, frames before the target are not displayed */
+#define EXYNOS_INDEX_CONFIG_SEEK_TARGET "OMX.SEC.indexConfig.SeekTarget"
+    OMX_IndexConfigSeekTarget               = 0x7F000027,
+
 } EXYNOS_OMX_INDEXTYPE;
 
 typedef enum _EXYNOS_OMX_ERRORTYPE
@@ -432,12 +444,32 @@ typedef struct _EXYNOS_OMX_VIDEO_CONFIG_BUFFERINFO {
     OMX_S32 OMX_OUT fd;
 } EXYNOS_OMX_VIDEO_CONFIG_BUFFERINFO;
 
+typedef enum _EXYNOS_OMX_SESSION_TYPE {
+    EXYNOS_OMX_SESSION_PLAYBACK = 0,    /* playback, recording, transcoding */
+    EXYNOS_OMX_SESSION_REALTIME,        /* realtime communication (VT, WFD, VoIP) */
+    EXYNOS_OMX_SESSION_MAX,
+} EXYNOS_OMX_SESSION_TYPE;
+
+typedef struct _EXYNOS_OMX_PARAM_SESSIONTYPE {
+    OMX_U32                 nSize;
+    OMX_VERSIONTYPE         nVersion;
+    EXYNOS_OMX_SESSION_TYPE eSessionType;
+} EXYNOS_OMX_PARAM_SESSIONTYPE;
+
 typedef struct _EXYNOS_OMX_VIDEO_CONFIG_QOSINFO {
     OMX_U32         nSize;
     OMX_VERSIONTYPE nVersion;
     OMX_U32         nQosRatio;
 } EXYNOS_OMX_VIDEO_CONFIG_QOSINFO;
 
+typedef struct _EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET {
+    OMX_U32         nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32         nPortIndex;
+    OMX_BOOL        bEnable;
+    OMX_TICKS       nTargetTimeStamp;
+} EXYNOS_OMX_VIDEO_CONFIG_SEEKTARGET;
+
 #ifdef USE_VP8ENC_SUPPORT
 typedef struct OMX_VIDEO_PARAM_VP8TYPE {
     OMX_U32                     nSize;
@@ -479,6 +511,25 @@ typedef struct OMX_VIDEO_QPRANGETYPE {
     OMX_U32         videoMaxQP;
 } OMX_VIDEO_QPRANGETYPE;
 
+typedef struct _EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL {
+    OMX_U32         nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32         nPortIndex;
+    OMX_BOOL        bEnable;
+    OMX_U32         nVbvSizeMs;         /* virtual buffer size, in msec of target bitrate, 0 = default, else 100 ~ 10000 */
+    OMX_U32         nMaxSkipFrames;     /* consecutive frames that may be skipped, 0 = never skip, up to 30 */
+    OMX_U32         nVbvFullness;       /* [OUT] current fullness, in percent of nVbvSizeMs */
+} EXYNOS_OMX_VIDEO_CONFIG_RATECONTROL;
+
+/* applies to the next input frame only */
+typedef struct _EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP {
+    OMX_U32         nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32         nPortIndex;
+    OMX_U32         nQP;                /* 0 = let rate control decide, H.264 up to 51, MPEG4/H.263 up to 31, VP8 up to 127 */
+    OMX_BOOL        bSkip;              /* encode the frame as not coded */
+} EXYNOS_OMX_VIDEO_CONFIG_FRAMEQP;
+
 
 #ifndef __OMX_EXPORTS
 #define __OMX_EXPORTS
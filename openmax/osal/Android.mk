@@ -7,6 +7,7 @@ LOCAL_SRC_FILES := \
 	Exynos_OSAL_Event.c \
 	Exynos_OSAL_Queue.c \
 	Exynos_OSAL_ETC.c \
+	Exynos_OSAL_Latency.c \
 	Exynos_OSAL_Mutex.c \
 	Exynos_OSAL_Thread.c \
 	Exynos_OSAL_Memory.c \
@@ -35,6 +35,7 @@ extern "C" {
 #endif
 
 size_t Exynos_OSAL_Strcpy(OMX_PTR dest, OMX_PTR src);
+size_t Exynos_OSAL_Strncpy(OMX_PTR dest, OMX_PTR src, size_t num);
 OMX_S32 Exynos_OSAL_Strncmp(OMX_PTR str1, OMX_PTR str2, size_t num);
 OMX_S32 Exynos_OSAL_Strcmp(OMX_PTR str1, OMX_PTR str2);
 size_t Exynos_OSAL_Strcat(OMX_PTR dest, OMX_PTR src);
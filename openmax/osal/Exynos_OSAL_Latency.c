@@ -0,0 +1,616 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OSAL_Latency.c
+ * @brief       per-component, per-port latency histogram and trace
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "Exynos_OSAL_Memory.h"
+#include "Exynos_OSAL_Mutex.h"
+#include "Exynos_OSAL_Latency.h"
+
+#undef  EXYNOS_LOG_TAG
+#define EXYNOS_LOG_TAG    "Exynos_OSAL_Latency"
+#include "Exynos_OSAL_Log.h"
+
+typedef struct _EXYNOS_LATENCY_PENDING {
+    OMX_U64 nKey;
+    OMX_U64 nStartTime;     /* 0 means free */
+} EXYNOS_LATENCY_PENDING;
+
+typedef struct _EXYNOS_LATENCY_HISTOGRAM {
+    OMX_U32 nBucket[LATENCY_HISTOGRAM_BUCKETS];
+    OMX_U32 nCount;
+    OMX_U32 nMin;
+    OMX_U32 nMax;
+    OMX_U64 nSum;
+    OMX_U32 nLost;
+    OMX_U32 nPendingPos;
+    EXYNOS_LATENCY_PENDING pending[LATENCY_PENDING_NUM];
+} EXYNOS_LATENCY_HISTOGRAM;
+
+/* fixed size record, converted to JSON only when dumped */
+typedef struct _EXYNOS_LATENCY_TRACE_ENTRY {
+    OMX_U64 nStartTime;
+    OMX_U32 nDuration;
+    OMX_U16 nPortIndex;
+    OMX_U16 eStage;
+} EXYNOS_LATENCY_TRACE_ENTRY;
+
+typedef struct _EXYNOS_LATENCY {
+    OMX_HANDLETYPE              hMutex;
+    OMX_U32                     nPortNum;
+    OMX_U32                     nInstance;      /* tells trace dumps of one process apart */
+    EXYNOS_LATENCY_HISTOGRAM   *pHistogram;     /* [nPortNum][LATENCY_STAGE_MAX] */
+
+    OMX_U32                     nOverheadCount;
+    OMX_U64                     nOverheadSum;   /* nsec */
+    OMX_U32                     nOverheadMax;   /* nsec */
+
+    EXYNOS_LATENCY_TRACE_ENTRY *pTrace;
+    OMX_U32                     nTraceNum;
+    OMX_U32                     nTracePos;
+    OMX_BOOL                    bTraceWrapped;
+} EXYNOS_LATENCY;
+
+static OMX_U32 latencyInstance = 0;
+
+static const char *stageName[LATENCY_STAGE_MAX] = {
+    "ETB->EBD",
+    "FTB->FBD",
+    "CODEC",
+    "CSC",
+};
+
+static OMX_U64 GetMonotonicTimeNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((OMX_U64)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+OMX_U64 Exynos_OSAL_GetMonotonicTime(void)
+{
+    return GetMonotonicTimeNs() / 1000;
+}
+
+static OMX_U32 BucketIndex(OMX_U32 value)
+{
+    OMX_U32 msb = 0;
+    OMX_U32 idx = 0;
+
+    if (value < (1 << LATENCY_HISTOGRAM_SUB_BITS))
+        return value;
+
+    msb = 31 - __builtin_clz(value);
+    idx = ((msb - LATENCY_HISTOGRAM_SUB_BITS + 1) << LATENCY_HISTOGRAM_SUB_BITS) +
+          ((value >> (msb - LATENCY_HISTOGRAM_SUB_BITS)) & ((1 << LATENCY_HISTOGRAM_SUB_BITS) - 1));
+
+    if (idx >= LATENCY_HISTOGRAM_BUCKETS)
+        idx = LATENCY_HISTOGRAM_BUCKETS - 1;
+
+    return idx;
+}
+
+/* smallest value mapped to the bucket after idx, i.e. exclusive upper bound */
+static OMX_U64 BucketLimit(OMX_U32 idx)
+{
+    OMX_U32 next = idx + 1;
+    OMX_U32 shift = 0;
+    OMX_U32 sub = 0;
+
+    if (next < (1 << LATENCY_HISTOGRAM_SUB_BITS))
+        return next;
+
+    shift = (next >> LATENCY_HISTOGRAM_SUB_BITS) - 1;
+    sub = next & ((1 << LATENCY_HISTOGRAM_SUB_BITS) - 1);
+
+    return ((OMX_U64)((1 << LATENCY_HISTOGRAM_SUB_BITS) + sub)) << shift;
+}
+
+static EXYNOS_LATENCY_HISTOGRAM *GetHistogram(EXYNOS_LATENCY *pLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage)
+{
+    if ((pLatency == NULL) ||
+        (nPortIndex >= pLatency->nPortNum) ||
+        (eStage >= LATENCY_STAGE_MAX))
+        return NULL;
+
+    return &pLatency->pHistogram[(nPortIndex * LATENCY_STAGE_MAX) + eStage];
+}
+
+static void ResetHistogram(EXYNOS_LATENCY_HISTOGRAM *pHistogram)
+{
+    Exynos_OSAL_Memset(pHistogram, 0, sizeof(EXYNOS_LATENCY_HISTOGRAM));
+    pHistogram->nMin = 0xFFFFFFFF;
+}
+
+/* must be called with hMutex held, nStartNs is when the caller entered */
+static void AddOverhead(EXYNOS_LATENCY *pLatency, OMX_U64 nStartNs)
+{
+    OMX_U64 diff = GetMonotonicTimeNs() - nStartNs;
+    OMX_U32 value = (diff > 0xFFFFFFFF) ? 0xFFFFFFFF : (OMX_U32)diff;
+
+    pLatency->nOverheadCount++;
+    pLatency->nOverheadSum += value;
+    if (value > pLatency->nOverheadMax)
+        pLatency->nOverheadMax = value;
+}
+
+/* must be called with hMutex held */
+static void AddSample(
+    EXYNOS_LATENCY           *pLatency,
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram,
+    OMX_U32                   nPortIndex,
+    LATENCY_STAGE_TYPE        eStage,
+    OMX_U64                   nStartTime,
+    OMX_U64                   nEndTime)
+{
+    OMX_U64 diff = nEndTime - nStartTime;
+    OMX_U32 value = (diff > 0xFFFFFFFF) ? 0xFFFFFFFF : (OMX_U32)diff;
+
+    pHistogram->nBucket[BucketIndex(value)]++;
+    pHistogram->nCount++;
+    pHistogram->nSum += value;
+    if (value < pHistogram->nMin)
+        pHistogram->nMin = value;
+    if (value > pHistogram->nMax)
+        pHistogram->nMax = value;
+
+    if (pLatency->pTrace != NULL) {
+        EXYNOS_LATENCY_TRACE_ENTRY *pEntry = &pLatency->pTrace[pLatency->nTracePos];
+
+        pEntry->nStartTime = nStartTime;
+        pEntry->nDuration  = value;
+        pEntry->nPortIndex = (OMX_U16)nPortIndex;
+        pEntry->eStage     = (OMX_U16)eStage;
+
+        pLatency->nTracePos++;
+        if (pLatency->nTracePos >= pLatency->nTraceNum) {
+            pLatency->nTracePos = 0;
+            pLatency->bTraceWrapped = OMX_TRUE;
+        }
+    }
+}
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyCreate(OMX_HANDLETYPE *phLatency, OMX_U32 nPortNum)
+{
+    OMX_ERRORTYPE   ret = OMX_ErrorNone;
+    EXYNOS_LATENCY *pLatency = NULL;
+    OMX_U32         i = 0;
+
+    if ((phLatency == NULL) || (nPortNum == 0)) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    pLatency = (EXYNOS_LATENCY *)Exynos_OSAL_Malloc(sizeof(EXYNOS_LATENCY));
+    if (pLatency == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    Exynos_OSAL_Memset(pLatency, 0, sizeof(EXYNOS_LATENCY));
+
+    pLatency->pHistogram = (EXYNOS_LATENCY_HISTOGRAM *)Exynos_OSAL_Malloc(sizeof(EXYNOS_LATENCY_HISTOGRAM) * nPortNum * LATENCY_STAGE_MAX);
+    if (pLatency->pHistogram == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    pLatency->nPortNum = nPortNum;
+    pLatency->nInstance = __sync_fetch_and_add(&latencyInstance, 1);
+    for (i = 0; i < nPortNum * LATENCY_STAGE_MAX; i++)
+        ResetHistogram(&pLatency->pHistogram[i]);
+
+    ret = Exynos_OSAL_MutexCreate(&pLatency->hMutex);
+    if (ret != OMX_ErrorNone)
+        goto EXIT;
+
+    *phLatency = (OMX_HANDLETYPE)pLatency;
+
+EXIT:
+    if ((ret != OMX_ErrorNone) && (pLatency != NULL)) {
+        if (pLatency->pHistogram != NULL)
+            Exynos_OSAL_Free(pLatency->pHistogram);
+        Exynos_OSAL_Free(pLatency);
+    }
+
+    return ret;
+}
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyTerminate(OMX_HANDLETYPE hLatency)
+{
+    EXYNOS_LATENCY *pLatency = (EXYNOS_LATENCY *)hLatency;
+
+    if (pLatency == NULL)
+        return OMX_ErrorBadParameter;
+
+    Exynos_OSAL_MutexTerminate(pLatency->hMutex);
+    if (pLatency->pTrace != NULL)
+        Exynos_OSAL_Free(pLatency->pTrace);
+    Exynos_OSAL_Free(pLatency->pHistogram);
+    Exynos_OSAL_Free(pLatency);
+
+    return OMX_ErrorNone;
+}
+
+void Exynos_OSAL_LatencyReset(OMX_HANDLETYPE hLatency)
+{
+    EXYNOS_LATENCY *pLatency = (EXYNOS_LATENCY *)hLatency;
+    OMX_U32         i = 0;
+
+    if (pLatency == NULL)
+        return;
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    for (i = 0; i < pLatency->nPortNum * LATENCY_STAGE_MAX; i++)
+        ResetHistogram(&pLatency->pHistogram[i]);
+    pLatency->nOverheadCount = 0;
+    pLatency->nOverheadSum = 0;
+    pLatency->nOverheadMax = 0;
+    pLatency->nTracePos = 0;
+    pLatency->bTraceWrapped = OMX_FALSE;
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+}
+
+void Exynos_OSAL_LatencyBegin(
+    OMX_HANDLETYPE      hLatency,
+    OMX_U32             nPortIndex,
+    LATENCY_STAGE_TYPE  eStage,
+    OMX_U64             nKey)
+{
+    EXYNOS_LATENCY           *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram = GetHistogram(pLatency, nPortIndex, eStage);
+    EXYNOS_LATENCY_PENDING   *pPending = NULL;
+    OMX_U64                   nowNs = 0;
+    OMX_U32                   i = 0;
+
+    if (pHistogram == NULL)
+        return;
+
+    nowNs = GetMonotonicTimeNs();
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    for (i = 0; i < LATENCY_PENDING_NUM; i++) {
+        if ((pHistogram->pending[i].nStartTime != 0) &&
+            (pHistogram->pending[i].nKey == nKey)) {
+            /* re-queued without a matching end, restart the measurement */
+            pPending = &pHistogram->pending[i];
+            break;
+        }
+        if ((pPending == NULL) && (pHistogram->pending[i].nStartTime == 0))
+            pPending = &pHistogram->pending[i];
+    }
+
+    if (pPending == NULL) {
+        /* every slot in flight, evict round-robin */
+        pPending = &pHistogram->pending[pHistogram->nPendingPos];
+        pHistogram->nPendingPos = (pHistogram->nPendingPos + 1) % LATENCY_PENDING_NUM;
+        pHistogram->nLost++;
+    }
+
+    pPending->nKey = nKey;
+    pPending->nStartTime = nowNs / 1000;
+    AddOverhead(pLatency, nowNs);
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+}
+
+void Exynos_OSAL_LatencyEnd(
+    OMX_HANDLETYPE      hLatency,
+    OMX_U32             nPortIndex,
+    LATENCY_STAGE_TYPE  eStage,
+    OMX_U64             nKey)
+{
+    EXYNOS_LATENCY           *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram = GetHistogram(pLatency, nPortIndex, eStage);
+    OMX_U64                   nowNs = 0;
+    OMX_U32                   i = 0;
+
+    if (pHistogram == NULL)
+        return;
+
+    nowNs = GetMonotonicTimeNs();
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    for (i = 0; i < LATENCY_PENDING_NUM; i++) {
+        if ((pHistogram->pending[i].nStartTime != 0) &&
+            (pHistogram->pending[i].nKey == nKey)) {
+            AddSample(pLatency, pHistogram, nPortIndex, eStage, pHistogram->pending[i].nStartTime, nowNs / 1000);
+            pHistogram->pending[i].nStartTime = 0;
+            break;
+        }
+    }
+    AddOverhead(pLatency, nowNs);
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+}
+
+/* drops the in-flight marks of a stage, e.g. on flush; they are not lost */
+void Exynos_OSAL_LatencyCancel(
+    OMX_HANDLETYPE      hLatency,
+    OMX_U32             nPortIndex,
+    LATENCY_STAGE_TYPE  eStage)
+{
+    EXYNOS_LATENCY           *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram = GetHistogram(pLatency, nPortIndex, eStage);
+    OMX_U32                   i = 0;
+
+    if (pHistogram == NULL)
+        return;
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    for (i = 0; i < LATENCY_PENDING_NUM; i++)
+        pHistogram->pending[i].nStartTime = 0;
+    pHistogram->nPendingPos = 0;
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+}
+
+void Exynos_OSAL_LatencyRecord(
+    OMX_HANDLETYPE      hLatency,
+    OMX_U32             nPortIndex,
+    LATENCY_STAGE_TYPE  eStage,
+    OMX_U64             nStartTime)
+{
+    EXYNOS_LATENCY           *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram = GetHistogram(pLatency, nPortIndex, eStage);
+    OMX_U64                   nowNs = 0;
+
+    if (pHistogram == NULL)
+        return;
+
+    nowNs = GetMonotonicTimeNs();
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    AddSample(pLatency, pHistogram, nPortIndex, eStage, nStartTime, nowNs / 1000);
+    AddOverhead(pLatency, nowNs);
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+}
+
+/* must be called with hMutex held */
+static OMX_U32 Percentile(EXYNOS_LATENCY_HISTOGRAM *pHistogram, OMX_U32 nPercent)
+{
+    OMX_U64 target = 0;
+    OMX_U64 sum = 0;
+    OMX_U64 limit = 0;
+    OMX_U32 i = 0;
+
+    if (pHistogram->nCount == 0)
+        return 0;
+
+    if (nPercent > 100)
+        nPercent = 100;
+
+    target = (((OMX_U64)pHistogram->nCount * nPercent) + 99) / 100;
+    if (target == 0)
+        target = 1;
+
+    for (i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        sum += pHistogram->nBucket[i];
+        if (sum >= target)
+            break;
+    }
+
+    /* report the bucket upper bound, but never beyond what was observed */
+    limit = BucketLimit(i) - 1;
+    if (limit > pHistogram->nMax)
+        limit = pHistogram->nMax;
+
+    return (OMX_U32)limit;
+}
+
+OMX_U32 Exynos_OSAL_LatencyPercentile(
+    OMX_HANDLETYPE      hLatency,
+    OMX_U32             nPortIndex,
+    LATENCY_STAGE_TYPE  eStage,
+    OMX_U32             nPercent)
+{
+    EXYNOS_LATENCY           *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram = GetHistogram(pLatency, nPortIndex, eStage);
+    OMX_U32                   value = 0;
+
+    if (pHistogram == NULL)
+        return 0;
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    value = Percentile(pHistogram, nPercent);
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+
+    return value;
+}
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyGetStat(
+    OMX_HANDLETYPE            hLatency,
+    OMX_U32                   nPortIndex,
+    LATENCY_STAGE_TYPE        eStage,
+    EXYNOS_OSAL_LATENCY_STAT *pStat)
+{
+    EXYNOS_LATENCY           *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_HISTOGRAM *pHistogram = GetHistogram(pLatency, nPortIndex, eStage);
+
+    if ((pHistogram == NULL) || (pStat == NULL))
+        return OMX_ErrorBadParameter;
+
+    Exynos_OSAL_Memset(pStat, 0, sizeof(EXYNOS_OSAL_LATENCY_STAT));
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    pStat->nCount = pHistogram->nCount;
+    pStat->nLost  = pHistogram->nLost;
+    if (pHistogram->nCount > 0) {
+        pStat->nMin = pHistogram->nMin;
+        pStat->nMax = pHistogram->nMax;
+        pStat->nAvg = (OMX_U32)(pHistogram->nSum / pHistogram->nCount);
+        pStat->nP50 = Percentile(pHistogram, 50);
+        pStat->nP90 = Percentile(pHistogram, 90);
+        pStat->nP99 = Percentile(pHistogram, 99);
+    }
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyGetOverhead(
+    OMX_HANDLETYPE                hLatency,
+    EXYNOS_OSAL_LATENCY_OVERHEAD *pOverhead)
+{
+    EXYNOS_LATENCY *pLatency = (EXYNOS_LATENCY *)hLatency;
+
+    if ((pLatency == NULL) || (pOverhead == NULL))
+        return OMX_ErrorBadParameter;
+
+    Exynos_OSAL_Memset(pOverhead, 0, sizeof(EXYNOS_OSAL_LATENCY_OVERHEAD));
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    pOverhead->nCount = pLatency->nOverheadCount;
+    if (pLatency->nOverheadCount > 0) {
+        pOverhead->nAvg = (OMX_U32)(pLatency->nOverheadSum / pLatency->nOverheadCount);
+        pOverhead->nMax = pLatency->nOverheadMax;
+    }
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+
+    return OMX_ErrorNone;
+}
+
+void Exynos_OSAL_LatencyPrint(OMX_HANDLETYPE hLatency, OMX_STRING prefix)
+{
+    EXYNOS_LATENCY               *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_OSAL_LATENCY_STAT      stat;
+    EXYNOS_OSAL_LATENCY_OVERHEAD  overhead;
+    OMX_U32                       i = 0, j = 0;
+
+    if (pLatency == NULL)
+        return;
+
+    for (i = 0; i < pLatency->nPortNum; i++) {
+        for (j = 0; j < LATENCY_STAGE_MAX; j++) {
+            if (Exynos_OSAL_LatencyGetStat(hLatency, i, (LATENCY_STAGE_TYPE)j, &stat) != OMX_ErrorNone)
+                continue;
+            if (stat.nCount == 0)
+                continue;
+
+            Exynos_OSAL_Log(EXYNOS_LOG_INFO, "%s port[%d] %s count:%d min:%d avg:%d p50:%d p90:%d p99:%d max:%d (us) lost:%d",
+                            prefix, i, stageName[j], stat.nCount, stat.nMin, stat.nAvg,
+                            stat.nP50, stat.nP90, stat.nP99, stat.nMax, stat.nLost);
+        }
+    }
+
+    if ((Exynos_OSAL_LatencyGetOverhead(hLatency, &overhead) == OMX_ErrorNone) &&
+        (overhead.nCount > 0))
+        Exynos_OSAL_Log(EXYNOS_LOG_INFO, "%s latency accounting calls:%d avg:%d max:%d (ns)",
+                        prefix, overhead.nCount, overhead.nAvg, overhead.nMax);
+}
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyTraceEnable(OMX_HANDLETYPE hLatency, OMX_U32 nEntryNum)
+{
+    EXYNOS_LATENCY             *pLatency = (EXYNOS_LATENCY *)hLatency;
+    EXYNOS_LATENCY_TRACE_ENTRY *pTrace = NULL;
+    EXYNOS_LATENCY_TRACE_ENTRY *pOldTrace = NULL;
+
+    if (pLatency == NULL)
+        return OMX_ErrorBadParameter;
+
+    if (nEntryNum > 0) {
+        pTrace = (EXYNOS_LATENCY_TRACE_ENTRY *)Exynos_OSAL_Malloc(sizeof(EXYNOS_LATENCY_TRACE_ENTRY) * nEntryNum);
+        if (pTrace == NULL)
+            return OMX_ErrorInsufficientResources;
+    }
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    pOldTrace = pLatency->pTrace;
+    pLatency->pTrace = pTrace;
+    pLatency->nTraceNum = nEntryNum;
+    pLatency->nTracePos = 0;
+    pLatency->bTraceWrapped = OMX_FALSE;
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+
+    if (pOldTrace != NULL)
+        Exynos_OSAL_Free(pOldTrace);
+
+    return OMX_ErrorNone;
+}
+
+/*
+ * Writes the trace ring in Chrome trace event format, loadable by Perfetto,
+ * to dir/omx_latency_<name>_<pid>_<instance>.json so that concurrent
+ * components and processes do not overwrite each other.
+ */
+OMX_ERRORTYPE Exynos_OSAL_LatencyTraceDump(OMX_HANDLETYPE hLatency, OMX_STRING dir, OMX_STRING name)
+{
+    OMX_ERRORTYPE   ret = OMX_ErrorNone;
+    EXYNOS_LATENCY *pLatency = (EXYNOS_LATENCY *)hLatency;
+    FILE           *fp = NULL;
+    OMX_U32         start = 0, count = 0, i = 0;
+    int             pid = (int)getpid();
+    char            path[256];
+
+    if ((pLatency == NULL) || (dir == NULL) || (name == NULL)) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    if (pLatency->pTrace == NULL) {
+        ret = OMX_ErrorNotReady;
+        goto EXIT;
+    }
+
+    snprintf(path, sizeof(path), "%s/omx_latency_%s_%d_%u.json",
+             dir, name, pid, (unsigned int)pLatency->nInstance);
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        Exynos_OSAL_Log(EXYNOS_LOG_ERROR, "%s: failed to open %s", __FUNCTION__, path);
+        ret = OMX_ErrorUndefined;
+        goto EXIT;
+    }
+
+    Exynos_OSAL_MutexLock(pLatency->hMutex);
+    if (pLatency->bTraceWrapped == OMX_TRUE) {
+        start = pLatency->nTracePos;
+        count = pLatency->nTraceNum;
+    } else {
+        start = 0;
+        count = pLatency->nTracePos;
+    }
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (i = 0; i < count; i++) {
+        EXYNOS_LATENCY_TRACE_ENTRY *pEntry = &pLatency->pTrace[(start + i) % pLatency->nTraceNum];
+
+        fprintf(fp, "{\"name\":\"%s\",\"cat\":\"omx\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":%d,\"tid\":%u}%s\n",
+                stageName[pEntry->eStage],
+                (unsigned long long)pEntry->nStartTime,
+                (unsigned int)pEntry->nDuration,
+                pid,
+                (unsigned int)pEntry->nPortIndex,
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+    Exynos_OSAL_MutexUnlock(pLatency->hMutex);
+
+    fclose(fp);
+
+EXIT:
+    return ret;
+}
@@ -0,0 +1,94 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OSAL_Latency.h
+ * @brief       per-component, per-port latency histogram and trace
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+#ifndef Exynos_OSAL_LATENCY
+#define Exynos_OSAL_LATENCY
+
+#include "OMX_Types.h"
+#include "OMX_Core.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum _LATENCY_STAGE_TYPE {
+    LATENCY_STAGE_ETB_EBD = 0,  /* EmptyThisBuffer -> EmptyBufferDone */
+    LATENCY_STAGE_FTB_FBD,      /* FillThisBuffer  -> FillBufferDone  */
+    LATENCY_STAGE_CODEC,        /* queued to codec -> dequeued from codec */
+    LATENCY_STAGE_CSC,          /* color space conversion */
+    LATENCY_STAGE_MAX,
+} LATENCY_STAGE_TYPE;
+
+/* log2 buckets, each split into 4 linear sub buckets, in usec */
+#define LATENCY_HISTOGRAM_SUB_BITS  2
+#define LATENCY_HISTOGRAM_BUCKETS   128
+
+/* in-flight begin marks kept per port and stage */
+#define LATENCY_PENDING_NUM         64
+
+typedef struct _EXYNOS_OSAL_LATENCY_STAT {
+    OMX_U32 nCount;
+    OMX_U32 nMin;       /* usec */
+    OMX_U32 nMax;       /* usec */
+    OMX_U32 nAvg;       /* usec */
+    OMX_U32 nP50;       /* usec */
+    OMX_U32 nP90;       /* usec */
+    OMX_U32 nP99;       /* usec */
+    OMX_U32 nLost;      /* begin marks overwritten before end */
+} EXYNOS_OSAL_LATENCY_STAT;
+
+/* time spent inside Begin/End/Record themselves, lock wait included */
+typedef struct _EXYNOS_OSAL_LATENCY_OVERHEAD {
+    OMX_U32 nCount;
+    OMX_U32 nAvg;       /* nsec */
+    OMX_U32 nMax;       /* nsec */
+} EXYNOS_OSAL_LATENCY_OVERHEAD;
+
+OMX_U64       Exynos_OSAL_GetMonotonicTime(void);
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyCreate(OMX_HANDLETYPE *phLatency, OMX_U32 nPortNum);
+OMX_ERRORTYPE Exynos_OSAL_LatencyTerminate(OMX_HANDLETYPE hLatency);
+void          Exynos_OSAL_LatencyReset(OMX_HANDLETYPE hLatency);
+
+void          Exynos_OSAL_LatencyBegin(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage, OMX_U64 nKey);
+void          Exynos_OSAL_LatencyEnd(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage, OMX_U64 nKey);
+void          Exynos_OSAL_LatencyCancel(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage);
+void          Exynos_OSAL_LatencyRecord(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage, OMX_U64 nStartTime);
+
+OMX_U32       Exynos_OSAL_LatencyPercentile(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage, OMX_U32 nPercent);
+OMX_ERRORTYPE Exynos_OSAL_LatencyGetStat(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage, EXYNOS_OSAL_LATENCY_STAT *pStat);
+OMX_ERRORTYPE Exynos_OSAL_LatencyGetOverhead(OMX_HANDLETYPE hLatency, EXYNOS_OSAL_LATENCY_OVERHEAD *pOverhead);
+void          Exynos_OSAL_LatencyPrint(OMX_HANDLETYPE hLatency, OMX_STRING prefix);
+
+OMX_ERRORTYPE Exynos_OSAL_LatencyTraceEnable(OMX_HANDLETYPE hLatency, OMX_U32 nEntryNum);
+OMX_ERRORTYPE Exynos_OSAL_LatencyTraceDump(OMX_HANDLETYPE hLatency, OMX_STRING dir, OMX_STRING name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
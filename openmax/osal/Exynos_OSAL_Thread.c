@@ -32,6 +32,10 @@
 #include <errno.h>
 #include <time.h>
 #include <unistd.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
 
 #include "Exynos_OSAL_Memory.h"
 #include "Exynos_OSAL_Thread.h"
@@ -42,16 +46,68 @@
 #include "Exynos_OSAL_Log.h"
 
 
+typedef void *(*EXYNOS_THREAD_FUNCTION)(void *);
+
 typedef struct _EXYNOS_THREAD_HANDLE_TYPE
 {
     pthread_t          pthread;
     pthread_attr_t     attr;
     struct sched_param schedparam;
     int                stack_size;
+
+    /* applied by the new thread itself, before function_name runs */
+    OMX_BOOL                bUseAttr;
+    EXYNOS_OSAL_THREAD_ATTR threadAttr;
+    EXYNOS_THREAD_FUNCTION  function;
+    OMX_PTR                 argument;
 } EXYNOS_THREAD_HANDLE_TYPE;
 
+static void Exynos_OSAL_ApplyThreadAttr(EXYNOS_OSAL_THREAD_ATTR *pAttr)
+{
+    struct sched_param param;
+
+    if (pAttr->szName[0] != '\0')
+        prctl(PR_SET_NAME, (unsigned long)pAttr->szName, 0, 0, 0);
+
+    if (pAttr->nCpuMask != 0) {
+        unsigned long mask = pAttr->nCpuMask;
+
+        if (syscall(__NR_sched_setaffinity, 0, sizeof(mask), &mask) != 0)
+            Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "%s: failed to set affinity 0x%x (%d)", pAttr->szName, pAttr->nCpuMask, errno);
+    }
+
+    if (pAttr->ePolicy == EXYNOS_OSAL_THREAD_POLICY_FIFO) {
+        Exynos_OSAL_Memset(&param, 0, sizeof(param));
+        param.sched_priority = pAttr->nPriority;
+        if (sched_setscheduler(0, SCHED_FIFO, &param) == 0)
+            return;
+
+        /* no CAP_SYS_NICE, fall back to the SCHED_OTHER setting */
+        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "%s: SCHED_FIFO(%d) is not allowed (%d), use nice %d",
+                        pAttr->szName, pAttr->nPriority, errno, pAttr->nNice);
+    }
+
+    /* on linux, setpriority() with 0 applies to the calling thread only */
+    if (setpriority(PRIO_PROCESS, 0, pAttr->nNice) != 0)
+        Exynos_OSAL_Log(EXYNOS_LOG_WARNING, "%s: failed to set nice %d (%d)", pAttr->szName, pAttr->nNice, errno);
+}
+
+static void *Exynos_OSAL_ThreadEntry(void *argument)
+{
+    EXYNOS_THREAD_HANDLE_TYPE *thread = (EXYNOS_THREAD_HANDLE_TYPE *)argument;
+
+    Exynos_OSAL_ApplyThreadAttr(&thread->threadAttr);
+
+    return thread->function(thread->argument);
+}
+
 
 OMX_ERRORTYPE Exynos_OSAL_ThreadCreate(OMX_HANDLETYPE *threadHandle, OMX_PTR function_name, OMX_PTR argument)
+{
+    return Exynos_OSAL_ThreadCreateWithAttr(threadHandle, function_name, argument, NULL);
+}
+
+OMX_ERRORTYPE Exynos_OSAL_ThreadCreateWithAttr(OMX_HANDLETYPE *threadHandle, OMX_PTR function_name, OMX_PTR argument, EXYNOS_OSAL_THREAD_ATTR *pAttr)
 {
     FunctionIn();
 
@@ -61,8 +117,22 @@ OMX_ERRORTYPE Exynos_OSAL_ThreadCreate(OMX_HANDLETYPE *threadHandle, OMX_PTR fun
     OMX_ERRORTYPE ret = OMX_ErrorNone;
 
     thread = Exynos_OSAL_Malloc(sizeof(EXYNOS_THREAD_HANDLE_TYPE));
+    if (thread == NULL) {
+        *threadHandle = NULL;
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
     Exynos_OSAL_Memset(thread, 0, sizeof(EXYNOS_THREAD_HANDLE_TYPE));
 
+    if (pAttr != NULL) {
+        Exynos_OSAL_Memcpy(&thread->threadAttr, pAttr, sizeof(EXYNOS_OSAL_THREAD_ATTR));
+        thread->threadAttr.szName[sizeof(thread->threadAttr.szName) - 1] = '\0';
+        thread->stack_size = pAttr->nStackSize;
+        thread->bUseAttr   = OMX_TRUE;
+        thread->function   = (EXYNOS_THREAD_FUNCTION)function_name;
+        thread->argument   = argument;
+    }
+
     pthread_attr_init(&thread->attr);
     if (thread->stack_size != 0)
         pthread_attr_setstacksize(&thread->attr, thread->stack_size);
@@ -79,7 +149,10 @@ OMX_ERRORTYPE Exynos_OSAL_ThreadCreate(OMX_HANDLETYPE *threadHandle, OMX_PTR fun
         goto EXIT;
     }
 
-    result = pthread_create(&thread->pthread, &thread->attr, function_name, (void *)argument);
+    if (thread->bUseAttr == OMX_TRUE)
+        result = pthread_create(&thread->pthread, &thread->attr, Exynos_OSAL_ThreadEntry, (void *)thread);
+    else
+        result = pthread_create(&thread->pthread, &thread->attr, function_name, (void *)argument);
     /* pthread_setschedparam(thread->pthread, SCHED_RR, &thread->schedparam); */
 
     switch (result) {
@@ -35,7 +35,22 @@
 extern "C" {
 #endif
 
+typedef enum _EXYNOS_OSAL_THREAD_POLICY {
+    EXYNOS_OSAL_THREAD_POLICY_OTHER = 0,    /* SCHED_OTHER, nNice is used */
+    EXYNOS_OSAL_THREAD_POLICY_FIFO,         /* SCHED_FIFO, nPriority is used */
+} EXYNOS_OSAL_THREAD_POLICY;
+
+typedef struct _EXYNOS_OSAL_THREAD_ATTR {
+    char                      szName[16];   /* thread name, 15 chars at most */
+    EXYNOS_OSAL_THREAD_POLICY ePolicy;
+    OMX_S32                   nPriority;    /* SCHED_FIFO priority, 1 ~ 99 */
+    OMX_S32                   nNice;        /* SCHED_OTHER nice, -20 ~ 19 */
+    OMX_U32                   nCpuMask;     /* 0 : no affinity */
+    OMX_U32                   nStackSize;   /* 0 : default */
+} EXYNOS_OSAL_THREAD_ATTR;
+
 OMX_ERRORTYPE Exynos_OSAL_ThreadCreate(OMX_HANDLETYPE *threadHandle, OMX_PTR function_name, OMX_PTR argument);
+OMX_ERRORTYPE Exynos_OSAL_ThreadCreateWithAttr(OMX_HANDLETYPE *threadHandle, OMX_PTR function_name, OMX_PTR argument, EXYNOS_OSAL_THREAD_ATTR *pAttr);
 OMX_ERRORTYPE Exynos_OSAL_ThreadTerminate(OMX_HANDLETYPE threadHandle);
 OMX_ERRORTYPE Exynos_OSAL_ThreadCancel(OMX_HANDLETYPE threadHandle);
 void          Exynos_OSAL_ThreadExit(void *value_ptr);
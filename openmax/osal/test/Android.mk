@@ -0,0 +1,25 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+	Exynos_OSAL_Latency_test.c \
+	../Exynos_OSAL_Latency.c \
+	../Exynos_OSAL_Mutex.c \
+	../Exynos_OSAL_Memory.c \
+	../Exynos_OSAL_Log.c
+
+LOCAL_MODULE := Exynos_OSAL_Latency_test
+
+LOCAL_CFLAGS :=
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lpthread -lrt
+
+LOCAL_C_INCLUDES := \
+	$(EXYNOS_OMX_INC)/khronos \
+	$(EXYNOS_OMX_INC)/exynos \
+	$(EXYNOS_OMX_TOP)/osal
+
+include $(BUILD_HOST_EXECUTABLE)
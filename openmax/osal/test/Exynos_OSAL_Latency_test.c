@@ -0,0 +1,255 @@
+/*
+ *
+ * Copyright 2012 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        Exynos_OSAL_Latency_test.c
+ * @brief       host test and overhead benchmark of the latency histogram
+ * @author      agent (agent@local)
+ * @version     2.0.0
+ * @history
+ *   2026.10.19 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Exynos_OSAL_Latency.h"
+
+/* average cost of one Begin/End/Record call allowed on the build host */
+#define LATENCY_TEST_OVERHEAD_BUDGET_NS 2000
+#define LATENCY_TEST_BENCH_LOOP         200000
+
+static int failCount = 0;
+
+#define CHECK(cond)                                                      \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                 \
+                    __FILE__, __LINE__, #cond);                          \
+            failCount++;                                                 \
+        }                                                                \
+    } while (0)
+
+static void GetStat(OMX_HANDLETYPE hLatency, OMX_U32 nPortIndex, LATENCY_STAGE_TYPE eStage, EXYNOS_OSAL_LATENCY_STAT *pStat)
+{
+    CHECK(Exynos_OSAL_LatencyGetStat(hLatency, nPortIndex, eStage, pStat) == OMX_ErrorNone);
+}
+
+/* Record() measures from the given start to now, so the sample is value..value+slack */
+static void TestPercentile(void)
+{
+    OMX_HANDLETYPE           hLatency = NULL;
+    EXYNOS_OSAL_LATENCY_STAT stat;
+    OMX_U32                  i = 0;
+
+    CHECK(Exynos_OSAL_LatencyCreate(&hLatency, 2) == OMX_ErrorNone);
+
+    /* 90 samples around 1ms, 10 around 10ms */
+    for (i = 0; i < 90; i++)
+        Exynos_OSAL_LatencyRecord(hLatency, 1, LATENCY_STAGE_CSC, Exynos_OSAL_GetMonotonicTime() - 1000);
+    for (i = 0; i < 10; i++)
+        Exynos_OSAL_LatencyRecord(hLatency, 1, LATENCY_STAGE_CSC, Exynos_OSAL_GetMonotonicTime() - 10000);
+
+    GetStat(hLatency, 1, LATENCY_STAGE_CSC, &stat);
+    CHECK(stat.nCount == 100);
+    CHECK(stat.nLost == 0);
+    CHECK(stat.nMin >= 1000);
+    CHECK(stat.nMax >= 10000);
+    /* 4 sub buckets per power of two keep the error under 25% */
+    CHECK((stat.nP50 >= 1000) && (stat.nP50 < 1250));
+    CHECK((stat.nP90 >= 1000) && (stat.nP90 < 1250));
+    CHECK((stat.nP99 >= 10000) && (stat.nP99 <= stat.nMax));
+    CHECK(Exynos_OSAL_LatencyPercentile(hLatency, 1, LATENCY_STAGE_CSC, 100) == stat.nMax);
+
+    /* other port and stage untouched, out of range ports rejected */
+    GetStat(hLatency, 0, LATENCY_STAGE_CSC, &stat);
+    CHECK(stat.nCount == 0);
+    CHECK(Exynos_OSAL_LatencyGetStat(hLatency, 2, LATENCY_STAGE_CSC, &stat) != OMX_ErrorNone);
+
+    Exynos_OSAL_LatencyReset(hLatency);
+    GetStat(hLatency, 1, LATENCY_STAGE_CSC, &stat);
+    CHECK(stat.nCount == 0);
+
+    Exynos_OSAL_LatencyTerminate(hLatency);
+}
+
+/* keys are codec frame tags, 0 is a valid tag */
+static void TestBeginEnd(void)
+{
+    OMX_HANDLETYPE           hLatency = NULL;
+    EXYNOS_OSAL_LATENCY_STAT stat;
+    OMX_U32                  i = 0;
+
+    CHECK(Exynos_OSAL_LatencyCreate(&hLatency, 2) == OMX_ErrorNone);
+
+    Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, 0);
+    Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, 1);
+    Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 1);
+    Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 0);
+    GetStat(hLatency, 0, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nCount == 2);
+    CHECK(stat.nLost == 0);
+
+    /* end without begin and a second end of the same key are ignored */
+    Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 5);
+    Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 0);
+    GetStat(hLatency, 0, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nCount == 2);
+
+    /* a re-queued key restarts, it does not take a second slot */
+    Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, 7);
+    Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, 7);
+    Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 7);
+    Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 7);
+    GetStat(hLatency, 0, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nCount == 3);
+    CHECK(stat.nLost == 0);
+
+    /* one more in flight than there are slots evicts exactly one */
+    for (i = 0; i <= LATENCY_PENDING_NUM; i++)
+        Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, 100 + i);
+    for (i = 0; i <= LATENCY_PENDING_NUM; i++)
+        Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, 100 + i);
+    GetStat(hLatency, 0, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nLost == 1);
+    CHECK(stat.nCount == 3 + LATENCY_PENDING_NUM);
+
+    Exynos_OSAL_LatencyTerminate(hLatency);
+}
+
+/* a flush drops in-flight marks without counting them lost */
+static void TestCancel(void)
+{
+    OMX_HANDLETYPE           hLatency = NULL;
+    EXYNOS_OSAL_LATENCY_STAT stat;
+    OMX_U32                  i = 0;
+
+    CHECK(Exynos_OSAL_LatencyCreate(&hLatency, 2) == OMX_ErrorNone);
+
+    for (i = 0; i < 10; i++)
+        Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, i);
+    Exynos_OSAL_LatencyBegin(hLatency, 1, LATENCY_STAGE_CODEC, 0);
+
+    Exynos_OSAL_LatencyCancel(hLatency, 0, LATENCY_STAGE_CODEC);
+    for (i = 0; i < 10; i++)
+        Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_CODEC, i);
+    GetStat(hLatency, 0, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nCount == 0);
+    CHECK(stat.nLost == 0);
+
+    /* other ports keep their marks */
+    Exynos_OSAL_LatencyEnd(hLatency, 1, LATENCY_STAGE_CODEC, 0);
+    GetStat(hLatency, 1, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nCount == 1);
+
+    /* after a cancel all slots are free again */
+    for (i = 0; i < LATENCY_PENDING_NUM; i++)
+        Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_CODEC, i);
+    GetStat(hLatency, 0, LATENCY_STAGE_CODEC, &stat);
+    CHECK(stat.nLost == 0);
+
+    Exynos_OSAL_LatencyTerminate(hLatency);
+}
+
+/* two components of the same name in one process must not share a dump */
+static void TestTraceDump(void)
+{
+    OMX_HANDLETYPE hLatency[2] = {NULL, NULL};
+    char           dir[] = "/tmp/omx_latency_test_XXXXXX";
+    char           cmd[128];
+    char           line[256];
+    FILE          *fp = NULL;
+    OMX_U32        fileNum = 0;
+    OMX_U32        i = 0;
+
+    CHECK(mkdtemp(dir) != NULL);
+
+    for (i = 0; i < 2; i++) {
+        CHECK(Exynos_OSAL_LatencyCreate(&hLatency[i], 2) == OMX_ErrorNone);
+        CHECK(Exynos_OSAL_LatencyTraceDump(hLatency[i], dir, "OMX.Exynos.AVC.Decoder") == OMX_ErrorNotReady);
+        CHECK(Exynos_OSAL_LatencyTraceEnable(hLatency[i], 16) == OMX_ErrorNone);
+        Exynos_OSAL_LatencyRecord(hLatency[i], 0, LATENCY_STAGE_CSC, Exynos_OSAL_GetMonotonicTime() - 100);
+        CHECK(Exynos_OSAL_LatencyTraceDump(hLatency[i], dir, "OMX.Exynos.AVC.Decoder") == OMX_ErrorNone);
+    }
+
+    snprintf(cmd, sizeof(cmd), "ls %s", dir);
+    fp = popen(cmd, "r");
+    CHECK(fp != NULL);
+    if (fp != NULL) {
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            CHECK(strncmp(line, "omx_latency_OMX.Exynos.AVC.Decoder_", 35) == 0);
+            fileNum++;
+        }
+        pclose(fp);
+    }
+    CHECK(fileNum == 2);
+
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    system(cmd);
+
+    for (i = 0; i < 2; i++)
+        Exynos_OSAL_LatencyTerminate(hLatency[i]);
+}
+
+/* cost paid on every ETB/FTB/EBD/FBD when the histogram is enabled */
+static void BenchOverhead(void)
+{
+    OMX_HANDLETYPE               hLatency = NULL;
+    EXYNOS_OSAL_LATENCY_OVERHEAD overhead;
+    OMX_U64                      start = 0, elapsed = 0;
+    OMX_U32                      i = 0;
+
+    CHECK(Exynos_OSAL_LatencyCreate(&hLatency, 2) == OMX_ErrorNone);
+
+    start = Exynos_OSAL_GetMonotonicTime();
+    for (i = 0; i < LATENCY_TEST_BENCH_LOOP; i++) {
+        /* keep a realistic number of buffers in flight */
+        Exynos_OSAL_LatencyBegin(hLatency, 0, LATENCY_STAGE_ETB_EBD, i);
+        if (i >= 8)
+            Exynos_OSAL_LatencyEnd(hLatency, 0, LATENCY_STAGE_ETB_EBD, i - 8);
+    }
+    elapsed = Exynos_OSAL_GetMonotonicTime() - start;
+
+    CHECK(Exynos_OSAL_LatencyGetOverhead(hLatency, &overhead) == OMX_ErrorNone);
+    CHECK(overhead.nCount == (LATENCY_TEST_BENCH_LOOP * 2) - 8);
+
+    printf("latency accounting: %u calls, avg %u ns, max %u ns, wall %.1f ns/call\n",
+           (unsigned int)overhead.nCount, (unsigned int)overhead.nAvg, (unsigned int)overhead.nMax,
+           (elapsed * 1000.0) / overhead.nCount);
+    CHECK(overhead.nAvg < LATENCY_TEST_OVERHEAD_BUDGET_NS);
+
+    Exynos_OSAL_LatencyTerminate(hLatency);
+}
+
+int main(void)
+{
+    TestPercentile();
+    TestBeginEnd();
+    TestCancel();
+    TestTraceDump();
+    BenchOverhead();
+
+    if (failCount != 0) {
+        printf("Exynos_OSAL_Latency_test: %d check(s) failed\n", failCount);
+        return 1;
+    }
+
+    printf("Exynos_OSAL_Latency_test: pass\n");
+    return 0;
+}